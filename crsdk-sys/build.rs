@@ -241,6 +241,48 @@ fn generate_enum_code(properties: &[(String, String, u32)]) -> String {
     writeln!(code, "    ];").unwrap();
     writeln!(code).unwrap();
 
+    // COUNT constant
+    writeln!(code, "    /// Number of property codes (length of `ALL`)").unwrap();
+    writeln!(code, "    pub const COUNT: usize = {};", non_reserved.len()).unwrap();
+    writeln!(code).unwrap();
+
+    // index
+    writeln!(
+        code,
+        "    /// Dense ordinal of this code (its position in `ALL`), for array-indexed tables"
+    )
+    .unwrap();
+    writeln!(code, "    #[inline]").unwrap();
+    writeln!(code, "    pub const fn index(self) -> usize {{").unwrap();
+    writeln!(code, "        match self {{").unwrap();
+    for (i, (_, prop_name, _)) in non_reserved.iter().enumerate() {
+        let variant_name = to_pascal_case(prop_name);
+        writeln!(code, "            Self::{} => {},", variant_name, i).unwrap();
+    }
+    writeln!(code, "        }}").unwrap();
+    writeln!(code, "    }}").unwrap();
+    writeln!(code).unwrap();
+
+    // from_index
+    writeln!(
+        code,
+        "    /// Look up a code by its dense ordinal (inverse of `index`)"
+    )
+    .unwrap();
+    writeln!(code, "    #[inline]").unwrap();
+    writeln!(
+        code,
+        "    pub const fn from_index(index: usize) -> Option<Self> {{"
+    )
+    .unwrap();
+    writeln!(code, "        if index < Self::COUNT {{").unwrap();
+    writeln!(code, "            Some(Self::ALL[index])").unwrap();
+    writeln!(code, "        }} else {{").unwrap();
+    writeln!(code, "            None").unwrap();
+    writeln!(code, "        }}").unwrap();
+    writeln!(code, "    }}").unwrap();
+    writeln!(code).unwrap();
+
     // as_raw
     writeln!(code, "    /// Get the raw SDK property code value").unwrap();
     writeln!(code, "    #[inline]").unwrap();
@@ -249,21 +291,44 @@ fn generate_enum_code(properties: &[(String, String, u32)]) -> String {
     writeln!(code, "    }}").unwrap();
     writeln!(code).unwrap();
 
-    // from_raw
-    writeln!(code, "    /// Create from raw SDK property code").unwrap();
-    writeln!(code, "    pub fn from_raw(code: u32) -> Option<Self> {{").unwrap();
-    writeln!(code, "        match code {{").unwrap();
-    for (const_name, prop_name, _) in &non_reserved {
+    // Sorted raw code table backing from_raw. Properties are sorted and
+    // deduplicated by value above, so `RAW_SORTED[i]` is `ALL[i].as_raw()`.
+    writeln!(
+        code,
+        "    /// Raw codes in ascending order, parallel to `ALL`"
+    )
+    .unwrap();
+    writeln!(code, "    const RAW_SORTED: [u32; Self::COUNT] = [").unwrap();
+    for (_, prop_name, _) in &non_reserved {
         let variant_name = to_pascal_case(prop_name);
-        writeln!(
-            code,
-            "            x if x == crate::SCRSDK::{} as u32 => Some(Self::{}),",
-            const_name, variant_name
-        )
-        .unwrap();
+        writeln!(code, "        Self::{} as u32,", variant_name).unwrap();
     }
-    writeln!(code, "            _ => None,").unwrap();
+    writeln!(code, "    ];").unwrap();
+    writeln!(code).unwrap();
+
+    // from_raw (binary search over RAW_SORTED)
+    writeln!(code, "    /// Create from raw SDK property code").unwrap();
+    writeln!(code, "    ///").unwrap();
+    writeln!(code, "    /// Binary searches a sorted table of raw codes.").unwrap();
+    writeln!(
+        code,
+        "    pub const fn from_raw(code: u32) -> Option<Self> {{"
+    )
+    .unwrap();
+    writeln!(code, "        let mut lo = 0;").unwrap();
+    writeln!(code, "        let mut hi = Self::COUNT;").unwrap();
+    writeln!(code, "        while lo < hi {{").unwrap();
+    writeln!(code, "            let mid = lo + (hi - lo) / 2;").unwrap();
+    writeln!(code, "            let raw = Self::RAW_SORTED[mid];").unwrap();
+    writeln!(code, "            if raw == code {{").unwrap();
+    writeln!(code, "                return Some(Self::ALL[mid]);").unwrap();
+    writeln!(code, "            }} else if raw < code {{").unwrap();
+    writeln!(code, "                lo = mid + 1;").unwrap();
+    writeln!(code, "            }} else {{").unwrap();
+    writeln!(code, "                hi = mid;").unwrap();
+    writeln!(code, "            }}").unwrap();
     writeln!(code, "        }}").unwrap();
+    writeln!(code, "        None").unwrap();
     writeln!(code, "    }}").unwrap();
     writeln!(code).unwrap();
 
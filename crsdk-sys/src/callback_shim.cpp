@@ -7,10 +7,22 @@
 // The RustCallback stores a context pointer (the Rust channel sender) and
 // calls Rust FFI functions for each event. These functions are non-blocking
 // and simply send to a tokio::sync::mpsc channel.
+//
+// Optionally the RustCallback owns an EventRing: events that fit a fixed-size
+// record are pushed there without calling into Rust at all, and Rust drains
+// them in batches with crsdk_drain_events. Only the push that makes the ring
+// non-empty wakes the Rust side.
 
+#include "CameraRemote_SDK.h"
+#include "CrImageDataBlock.h"
 #include "IDeviceCallback.h"
 #include "ICrCameraObjectInfo.h"
 
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+
 // C shim functions for ICrEnumCameraObjectInfo virtual methods
 extern "C" {
     CrInt32u crsdk_enum_camera_get_count(const SCRSDK::ICrEnumCameraObjectInfo* enumInfo) {
@@ -98,6 +110,335 @@ extern "C" {
     }
 }
 
+// C shim functions for live view (CrImageInfo / CrImageDataBlock are classes)
+
+// Status codes returned by crsdk_lv_get_image
+#define CRSDK_LV_OK 0
+#define CRSDK_LV_NOT_UPDATED 1
+#define CRSDK_LV_BUFFER_TOO_SMALL 2
+#define CRSDK_LV_ERROR 3
+
+// Focus/face frame flattened into a C struct (kind: 0 = focus, 1 = face)
+struct CrsdkLvFrameRect {
+    CrInt32u kind;
+    CrInt32u type;
+    CrInt32u state;
+    CrInt32u priority;
+    CrInt32u x_numerator;
+    CrInt32u x_denominator;
+    CrInt32u y_numerator;
+    CrInt32u y_denominator;
+    CrInt32u width;
+    CrInt32u height;
+};
+
+extern "C" {
+    // Buffer size needed for one live view frame, or 0 on error (see *err)
+    CrInt32u crsdk_lv_get_buffer_size(SCRSDK::CrDeviceHandle handle, CrInt32u* err) {
+        SCRSDK::CrImageInfo info;
+        SCRSDK::CrError result = SCRSDK::GetLiveViewImageInfo(handle, &info);
+        if (err) *err = static_cast<CrInt32u>(result);
+        if (CR_FAILED(result)) return 0;
+        return info.GetBufferSize();
+    }
+
+    // Fetch one frame into a caller-owned buffer. On success the JPEG lives
+    // at buf + *offset and is *image_size bytes long.
+    CrInt32 crsdk_lv_get_image(
+        SCRSDK::CrDeviceHandle handle,
+        CrInt8u* buf,
+        CrInt32u size,
+        CrInt32u* offset,
+        CrInt32u* image_size,
+        CrInt32u* frame_no,
+        CrInt32u* err
+    ) {
+        SCRSDK::CrImageDataBlock block;
+        block.SetSize(size);
+        block.SetData(buf);
+
+        SCRSDK::CrError result = SCRSDK::GetLiveViewImage(handle, &block);
+        if (err) *err = static_cast<CrInt32u>(result);
+        if (result == SCRSDK::CrWarning_Frame_NotUpdated) return CRSDK_LV_NOT_UPDATED;
+        if (result == SCRSDK::CrError_Memory_Insufficient) return CRSDK_LV_BUFFER_TOO_SMALL;
+        if (CR_FAILED(result)) return CRSDK_LV_ERROR;
+
+        CrInt8u* data = block.GetImageData();
+        CrInt32u len = block.GetImageSize();
+        if (!data || len == 0 || len > size) return CRSDK_LV_NOT_UPDATED;
+
+        if (data >= buf && data + len <= buf + size) {
+            *offset = static_cast<CrInt32u>(data - buf);
+        } else {
+            std::memmove(buf, data, len);
+            *offset = 0;
+        }
+        *image_size = len;
+        *frame_no = block.GetFrameNo();
+        return CRSDK_LV_OK;
+    }
+
+    // Copy up to `capacity` focus/face frames into `out`. Returns the total
+    // number of frames reported by the camera (may exceed capacity).
+    CrInt32u crsdk_lv_get_frame_rects(
+        SCRSDK::CrDeviceHandle handle,
+        CrsdkLvFrameRect* out,
+        CrInt32u capacity,
+        CrInt32u* err
+    ) {
+        SCRSDK::CrLiveViewProperty* props = nullptr;
+        CrInt32 num = 0;
+        SCRSDK::CrError result = SCRSDK::GetLiveViewProperties(handle, &props, &num);
+        if (err) *err = static_cast<CrInt32u>(result);
+        if (CR_FAILED(result) || !props) return 0;
+
+        CrInt32u total = 0;
+        auto push = [&](CrInt32u kind, CrInt32u type, CrInt32u state, CrInt32u priority,
+                        CrInt32u xn, CrInt32u xd, CrInt32u yn, CrInt32u yd,
+                        CrInt32u w, CrInt32u h) {
+            if (total < capacity) {
+                out[total] = CrsdkLvFrameRect{kind, type, state, priority, xn, xd, yn, yd, w, h};
+            }
+            total++;
+        };
+
+        for (CrInt32 i = 0; i < num; i++) {
+            const SCRSDK::CrLiveViewProperty& prop = props[i];
+            if (prop.GetValueSize() == 0 || !prop.GetValue()) continue;
+
+            switch (prop.GetFrameInfoType()) {
+            case SCRSDK::CrFrameInfoType_FocusFrameInfo: {
+                auto* frames = reinterpret_cast<const SCRSDK::CrFocusFrameInfo*>(prop.GetValue());
+                CrInt32u count = prop.GetValueSize() / sizeof(SCRSDK::CrFocusFrameInfo);
+                for (CrInt32u k = 0; k < count; k++) {
+                    const auto& f = frames[k];
+                    push(0, f.type, f.state, f.priority, f.xNumerator, f.xDenominator,
+                         f.yNumerator, f.yDenominator, f.width, f.height);
+                }
+                break;
+            }
+            case SCRSDK::CrFrameInfoType_FaceFrameInfo: {
+                auto* frames = reinterpret_cast<const SCRSDK::CrFaceFrameInfo*>(prop.GetValue());
+                CrInt32u count = prop.GetValueSize() / sizeof(SCRSDK::CrFaceFrameInfo);
+                for (CrInt32u k = 0; k < count; k++) {
+                    const auto& f = frames[k];
+                    push(1, f.type, f.state, f.priority, f.xNumerator, f.xDenominator,
+                         f.yNumerator, f.yDenominator, f.width, f.height);
+                }
+                break;
+            }
+            default:
+                break;
+            }
+        }
+
+        SCRSDK::ReleaseLiveViewProperties(handle, props);
+        return total;
+    }
+}
+
+// C shim functions for remote transfer (content listing and pulls)
+
+// Remote transfer notification classes returned by crsdk_remote_transfer_status
+#define CRSDK_RT_IN_PROGRESS 0
+#define CRSDK_RT_OK 1
+#define CRSDK_RT_FAILED 2
+#define CRSDK_RT_BUSY 3
+
+// Length of CrsdkContentFile::name in CrChar units, including the terminating NUL
+#define CRSDK_CONTENT_NAME_LEN 256
+
+// One file of a content (a content can hold e.g. a JPEG and a RAW)
+struct CrsdkContentFile {
+    CrInt32u content_id;
+    CrInt32u file_id;
+    CrInt64u size;
+    CrChar name[CRSDK_CONTENT_NAME_LEN];
+};
+
+extern "C" {
+    // Copy up to `capacity` files stored in `slot` into `out`. Returns the
+    // total number of files (may exceed capacity), or 0 on error (see *err).
+    CrInt32u crsdk_contents_list(
+        SCRSDK::CrDeviceHandle handle,
+        CrInt32u slot,
+        CrsdkContentFile* out,
+        CrInt32u capacity,
+        CrInt32u* err
+    ) {
+        SCRSDK::CrContentsInfo* list = nullptr;
+        CrInt32u num = 0;
+        SCRSDK::CrError result = SCRSDK::GetRemoteTransferContentsInfoList(
+            handle,
+            static_cast<SCRSDK::CrSlotNumber>(slot),
+            SCRSDK::CrGetContentsInfoListType_All,
+            nullptr,
+            0,
+            &list,
+            &num
+        );
+        if (err) *err = static_cast<CrInt32u>(result);
+        if (CR_FAILED(result) || !list) return 0;
+
+        CrInt32u total = 0;
+        for (CrInt32u i = 0; i < num; i++) {
+            const SCRSDK::CrContentsInfo& content = list[i];
+            for (CrInt32u k = 0; k < content.filesNum; k++) {
+                const SCRSDK::CrContentsFile& file = content.files[k];
+                if (total < capacity) {
+                    CrsdkContentFile& entry = out[total];
+                    entry.content_id = content.contentId;
+                    entry.file_id = file.fileId;
+                    entry.size = file.fileSize;
+                    // CrChar is wchar_t on Windows, so copy code units rather than bytes
+                    CrInt32u len = 0;
+                    if (file.filePath) {
+                        while (len < CRSDK_CONTENT_NAME_LEN - 1 && file.filePath[len] != 0) {
+                            entry.name[len] = file.filePath[len];
+                            len++;
+                        }
+                    }
+                    entry.name[len] = 0;
+                }
+                total++;
+            }
+        }
+
+        SCRSDK::ReleaseRemoteTransferContentsInfoList(handle, list);
+        return total;
+    }
+
+    // Start pulling one file in memory. Data arrives through
+    // OnNotifyRemoteTransferResult in chunks of up to `division_size` bytes.
+    CrInt32u crsdk_contents_pull(
+        SCRSDK::CrDeviceHandle handle,
+        CrInt32u slot,
+        CrInt32u content_id,
+        CrInt32u file_id,
+        CrInt32u division_size
+    ) {
+        // No path: the SDK delivers the data to the callback instead of disk
+        SCRSDK::CrError result = SCRSDK::GetRemoteTransferContentsDataFile(
+            handle,
+            static_cast<SCRSDK::CrSlotNumber>(slot),
+            content_id,
+            file_id,
+            division_size,
+            nullptr,
+            nullptr
+        );
+        return static_cast<CrInt32u>(result);
+    }
+
+    // Classify a remote transfer notification code
+    CrInt32u crsdk_remote_transfer_status(CrInt32u notify) {
+        switch (notify) {
+        case SCRSDK::CrNotify_RemoteTransfer_Result_OK:
+            return CRSDK_RT_OK;
+        case SCRSDK::CrNotify_RemoteTransfer_Result_NG:
+            return CRSDK_RT_FAILED;
+        case SCRSDK::CrNotify_RemoteTransfer_Result_DeviceBusy:
+            return CRSDK_RT_BUSY;
+        default:
+            return CRSDK_RT_IN_PROGRESS;
+        }
+    }
+}
+
+// Event ring records (see CrsdkEventRecord::kind)
+#define CRSDK_EVENT_CONNECTED 1
+#define CRSDK_EVENT_DISCONNECTED 2
+#define CRSDK_EVENT_PROPERTY_CHANGED 3
+#define CRSDK_EVENT_LV_PROPERTY_CHANGED 4
+#define CRSDK_EVENT_WARNING 5
+#define CRSDK_EVENT_WARNING_EXT 6
+#define CRSDK_EVENT_ERROR 7
+#define CRSDK_EVENT_CONTENTS_LIST_CHANGED 8
+#define CRSDK_EVENT_FIRMWARE_UPDATE 9
+
+// Property codes a record carries inline; longer lists take the slow path
+#define CRSDK_EVENT_INLINE_CODES 16
+
+// One callback flattened into plain data (96 bytes). Field use per kind:
+//   CONNECTED: arg0 = version          DISCONNECTED / ERROR: arg0 = code
+//   (LV_)PROPERTY_CHANGED: num_codes + codes
+//   WARNING: arg0 = code               WARNING_EXT: arg0 = code, arg1..3 = params
+//   CONTENTS_LIST_CHANGED: arg0 = notify, arg1 = slot, arg2 = added
+//   FIRMWARE_UPDATE: arg0 = notify
+// pushed_at is stamped by the ring (see crsdk_event_ring_clock_ns).
+struct CrsdkEventRecord {
+    CrInt32u kind;
+    CrInt32u arg0;
+    CrInt32u arg1;
+    CrInt32u arg2;
+    CrInt32u arg3;
+    CrInt32u num_codes;
+    CrInt32u codes[CRSDK_EVENT_INLINE_CODES];
+    CrInt64u pushed_at;
+};
+
+extern "C" {
+    // Monotonic clock the ring stamps records with, in nanoseconds
+    CrInt64u crsdk_event_ring_clock_ns() {
+        using namespace std::chrono;
+        return static_cast<CrInt64u>(
+            duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count());
+    }
+}
+
+namespace {
+    // Single-producer single-consumer ring of event records.
+    //
+    // The SDK delivers a device's callbacks from one thread (the producer);
+    // the Rust side serializes its drains (the consumer). head_ and tail_
+    // only ever grow and wrap naturally; capacity is a power of two.
+    class EventRing {
+    public:
+        explicit EventRing(CrInt32u capacity)
+            : slots_(new CrsdkEventRecord[capacity]), mask_(capacity - 1) {}
+
+        // Returns false when full. The fence orders the new head before
+        // the caller's check of whether the consumer is parked; the consumer
+        // fences between announcing it parks and its last look at head_.
+        bool push(const CrsdkEventRecord& record) {
+            CrInt32u head = head_.load(std::memory_order_relaxed);
+            CrInt32u tail = tail_.load(std::memory_order_acquire);
+            if (head - tail > mask_) return false;
+            CrsdkEventRecord& slot = slots_[head & mask_];
+            slot = record;
+            // Stamped here so the latency metrics include the time in the ring
+            slot.pushed_at = crsdk_event_ring_clock_ns();
+            head_.store(head + 1, std::memory_order_release);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            return true;
+        }
+
+        CrInt32u drain(CrsdkEventRecord* out, CrInt32u max) {
+            CrInt32u tail = tail_.load(std::memory_order_relaxed);
+            CrInt32u head = head_.load(std::memory_order_acquire);
+            CrInt32u count = head - tail;
+            if (count > max) count = max;
+            for (CrInt32u i = 0; i < count; i++) {
+                out[i] = slots_[(tail + i) & mask_];
+            }
+            tail_.store(tail + count, std::memory_order_release);
+            return count;
+        }
+
+    private:
+        std::unique_ptr<CrsdkEventRecord[]> slots_;
+        CrInt32u mask_;
+        alignas(64) std::atomic<CrInt32u> head_{0};
+        alignas(64) std::atomic<CrInt32u> tail_{0};
+    };
+
+    CrInt32u round_up_pow2(CrInt32u n) {
+        CrInt32u capacity = 1;
+        while (capacity < n && capacity < (1u << 30)) capacity <<= 1;
+        return capacity;
+    }
+}
+
 namespace {
     class MinimalCallback : public SCRSDK::IDeviceCallback {
     public:
@@ -123,6 +464,12 @@ extern "C" {
     void crsdk_event_remote_transfer_data(void* ctx, CrInt32u notify, CrInt32u percent, const CrInt8u* data, CrInt64u size);
     void crsdk_event_contents_list_changed(void* ctx, CrInt32u notify, CrInt32u slot, CrInt32u added);
     void crsdk_event_firmware_update(void* ctx, CrInt32u notify);
+
+    // Event ring hooks: a record was queued (wakes a parked drainer) / the
+    // ring must be drained before an event that bypasses it, to keep
+    // callbacks in order
+    void crsdk_event_ring_ready(void* ctx);
+    void crsdk_event_ring_flush(void* ctx);
 }
 
 // Callback class that forwards events to Rust
@@ -130,11 +477,20 @@ class RustCallback : public SCRSDK::IDeviceCallback {
 public:
     explicit RustCallback(void* ctx) : ctx_(ctx) {}
 
+    RustCallback(void* ctx, CrInt32u ring_capacity)
+        : ctx_(ctx), ring_(new EventRing(round_up_pow2(ring_capacity))) {}
+
+    CrInt32u drain(CrsdkEventRecord* out, CrInt32u max) {
+        return ring_ ? ring_->drain(out, max) : 0;
+    }
+
     void OnConnected(SCRSDK::DeviceConnectionVersioin version) override {
+        if (push(CRSDK_EVENT_CONNECTED, static_cast<CrInt32u>(version))) return;
         if (ctx_) crsdk_event_connected(ctx_, static_cast<CrInt32u>(version));
     }
 
     void OnDisconnected(CrInt32u error) override {
+        if (push(CRSDK_EVENT_DISCONNECTED, error)) return;
         if (ctx_) crsdk_event_disconnected(ctx_, error);
     }
 
@@ -143,6 +499,7 @@ public:
     }
 
     void OnPropertyChangedCodes(CrInt32u num, CrInt32u* codes) override {
+        if (push_codes(CRSDK_EVENT_PROPERTY_CHANGED, num, codes)) return;
         if (ctx_) crsdk_event_property_changed(ctx_, num, codes);
     }
 
@@ -151,42 +508,53 @@ public:
     }
 
     void OnLvPropertyChangedCodes(CrInt32u num, CrInt32u* codes) override {
+        if (push_codes(CRSDK_EVENT_LV_PROPERTY_CHANGED, num, codes)) return;
         if (ctx_) crsdk_event_lv_property_changed(ctx_, num, codes);
     }
 
     void OnCompleteDownload(CrChar* filename, CrInt32u /*type*/) override {
+        flush();
         if (ctx_) crsdk_event_download_complete(ctx_, filename);
     }
 
     void OnNotifyContentsTransfer(CrInt32u notify, SCRSDK::CrContentHandle handle, CrChar* filename) override {
+        flush();
         if (ctx_) crsdk_event_contents_transfer(ctx_, notify, handle, filename);
     }
 
     void OnWarning(CrInt32u warning) override {
+        if (push(CRSDK_EVENT_WARNING, warning)) return;
         if (ctx_) crsdk_event_warning(ctx_, warning);
     }
 
     void OnWarningExt(CrInt32u warning, CrInt32 p1, CrInt32 p2, CrInt32 p3) override {
+        if (push(CRSDK_EVENT_WARNING_EXT, warning, static_cast<CrInt32u>(p1),
+                 static_cast<CrInt32u>(p2), static_cast<CrInt32u>(p3))) return;
         if (ctx_) crsdk_event_warning_ext(ctx_, warning, p1, p2, p3);
     }
 
     void OnError(CrInt32u error) override {
+        if (push(CRSDK_EVENT_ERROR, error)) return;
         if (ctx_) crsdk_event_error(ctx_, error);
     }
 
     void OnNotifyRemoteTransferResult(CrInt32u notify, CrInt32u percent, CrChar* filename) override {
+        flush();
         if (ctx_) crsdk_event_remote_transfer_progress(ctx_, notify, percent, filename);
     }
 
     void OnNotifyRemoteTransferResult(CrInt32u notify, CrInt32u percent, CrInt8u* data, CrInt64u size) override {
+        flush();
         if (ctx_) crsdk_event_remote_transfer_data(ctx_, notify, percent, data, size);
     }
 
     void OnNotifyRemoteTransferContentsListChanged(CrInt32u notify, CrInt32u slot, CrInt32u added) override {
+        if (push(CRSDK_EVENT_CONTENTS_LIST_CHANGED, notify, slot, added)) return;
         if (ctx_) crsdk_event_contents_list_changed(ctx_, notify, slot, added);
     }
 
     void OnNotifyRemoteFirmwareUpdateResult(CrInt32u notify, const void* /*param*/) override {
+        if (push(CRSDK_EVENT_FIRMWARE_UPDATE, notify)) return;
         if (ctx_) crsdk_event_firmware_update(ctx_, notify);
     }
 
@@ -197,7 +565,53 @@ public:
     // void OnNotifyMonitorUpdated(...) override { }
 
 private:
+    // Fast path: queue a record. False means the caller takes the slow path
+    // (no ring, or the ring is full) after earlier records were flushed.
+    bool push(CrInt32u kind, CrInt32u arg0, CrInt32u arg1 = 0, CrInt32u arg2 = 0, CrInt32u arg3 = 0) {
+        if (!ring_ || !ctx_) return false;
+        CrsdkEventRecord record{};
+        record.kind = kind;
+        record.arg0 = arg0;
+        record.arg1 = arg1;
+        record.arg2 = arg2;
+        record.arg3 = arg3;
+        return push_record(record);
+    }
+
+    bool push_codes(CrInt32u kind, CrInt32u num, const CrInt32u* codes) {
+        if (!ring_ || !ctx_) return false;
+        if (num > CRSDK_EVENT_INLINE_CODES || (num > 0 && !codes)) {
+            flush();
+            return false;
+        }
+        CrsdkEventRecord record{};
+        record.kind = kind;
+        record.num_codes = num;
+        if (num > 0) std::memcpy(record.codes, codes, num * sizeof(CrInt32u));
+        return push_record(record);
+    }
+
+    bool push_record(const CrsdkEventRecord& record) {
+        if (ring_->push(record)) {
+            // Cheap unless the drainer is parked; see RingConsumer::wake
+            crsdk_event_ring_ready(ctx_);
+            return true;
+        }
+        // Full: drain synchronously, then deliver this one directly
+        flush();
+        return false;
+    }
+
+    // Deliver everything still in the ring before an event that bypasses it.
+    // Always goes through Rust, even when the ring looks empty: the drainer
+    // advances the tail before it has dispatched what it took, and the flush
+    // waits for that batch to be delivered.
+    void flush() {
+        if (ring_ && ctx_) crsdk_event_ring_flush(ctx_);
+    }
+
     void* ctx_;
+    std::unique_ptr<EventRing> ring_;
 };
 
 extern "C" {
@@ -210,6 +624,21 @@ extern "C" {
         return new RustCallback(ctx);
     }
 
+    // Create a RustCallback that queues fixed-size events in a ring of at
+    // least `ring_capacity` records (rounded up to a power of two)
+    SCRSDK::IDeviceCallback* crsdk_create_rust_callback_with_ring(void* ctx, CrInt32u ring_capacity) {
+        if (ring_capacity == 0) return new RustCallback(ctx);
+        return new RustCallback(ctx, ring_capacity);
+    }
+
+    // Move up to `max` queued records into `out`, returning how many.
+    // `callback` must come from one of the crsdk_create_rust_callback*
+    // functions; callers must not drain the same callback concurrently.
+    CrInt32u crsdk_drain_events(SCRSDK::IDeviceCallback* callback, CrsdkEventRecord* out, CrInt32u max) {
+        if (!callback || !out) return 0;
+        return static_cast<RustCallback*>(callback)->drain(out, max);
+    }
+
     // Destroy a RustCallback
     void crsdk_destroy_rust_callback(SCRSDK::IDeviceCallback* callback) {
         delete callback;
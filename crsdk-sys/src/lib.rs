@@ -28,6 +28,13 @@ include!(concat!(env!("OUT_DIR"), "/property_codes.rs"));
 // Re-export SCRSDK namespace at crate root for convenience
 pub use root::SCRSDK;
 
+/// The SDK's `CrChar`: UTF-16 `wchar_t` on Windows, `char` (UTF-8) elsewhere
+#[cfg(windows)]
+pub type CrChar = u16;
+/// The SDK's `CrChar`: UTF-16 `wchar_t` on Windows, `char` (UTF-8) elsewhere
+#[cfg(not(windows))]
+pub type CrChar = std::ffi::c_char;
+
 // Callback shim from callback_shim.cpp
 extern "C" {
     /// Get a pointer to a minimal IDeviceCallback implementation
@@ -49,13 +56,13 @@ extern "C" {
     pub fn crsdk_enum_camera_release(enum_info: *mut SCRSDK::ICrEnumCameraObjectInfo);
 
     /// Get the camera model name
-    pub fn crsdk_camera_info_get_model(info: *const SCRSDK::ICrCameraObjectInfo) -> *const i8;
+    pub fn crsdk_camera_info_get_model(info: *const SCRSDK::ICrCameraObjectInfo) -> *const CrChar;
 
     /// Get the camera model name size
     pub fn crsdk_camera_info_get_model_size(info: *const SCRSDK::ICrCameraObjectInfo) -> u32;
 
     /// Get the camera device name
-    pub fn crsdk_camera_info_get_name(info: *const SCRSDK::ICrCameraObjectInfo) -> *const i8;
+    pub fn crsdk_camera_info_get_name(info: *const SCRSDK::ICrCameraObjectInfo) -> *const CrChar;
 
     /// Get the camera device name size
     pub fn crsdk_camera_info_get_name_size(info: *const SCRSDK::ICrCameraObjectInfo) -> u32;
@@ -67,7 +74,7 @@ extern "C" {
     /// Get the connection type name (e.g., "Ethernet", "USB")
     pub fn crsdk_camera_info_get_connection_type(
         info: *const SCRSDK::ICrCameraObjectInfo,
-    ) -> *const i8;
+    ) -> *const CrChar;
 
     /// Get the IP address as a packed u32
     pub fn crsdk_camera_info_get_ip_address(info: *const SCRSDK::ICrCameraObjectInfo) -> u32;
@@ -75,7 +82,7 @@ extern "C" {
     /// Get the IP address as a string
     pub fn crsdk_camera_info_get_ip_address_str(
         info: *const SCRSDK::ICrCameraObjectInfo,
-    ) -> *const i8;
+    ) -> *const CrChar;
 
     /// Get the MAC address bytes
     pub fn crsdk_camera_info_get_mac_address(info: *const SCRSDK::ICrCameraObjectInfo)
@@ -104,6 +111,216 @@ extern "C" {
 
     /// Destroy a RustCallback created with crsdk_create_rust_callback
     pub fn crsdk_destroy_rust_callback(callback: *mut SCRSDK::IDeviceCallback);
+
+    /// Create a RustCallback that queues fixed-size events in a ring
+    ///
+    /// The ring holds at least `ring_capacity` records (rounded up to a power
+    /// of two); 0 creates a plain callback. With a ring, the callback calls
+    /// `crsdk_event_ring_ready(ctx)` after every queued record and
+    /// `crsdk_event_ring_flush(ctx)` before any event that bypasses it (the
+    /// ring is full, or the event carries strings or data).
+    pub fn crsdk_create_rust_callback_with_ring(
+        ctx: *mut std::ffi::c_void,
+        ring_capacity: u32,
+    ) -> *mut SCRSDK::IDeviceCallback;
+
+    /// Current time on the monotonic clock event ring records are stamped
+    /// with, in nanoseconds
+    pub fn crsdk_event_ring_clock_ns() -> u64;
+
+    /// Move up to `max` queued records into `out`, returning how many
+    ///
+    /// Drains of one callback must not run concurrently.
+    pub fn crsdk_drain_events(
+        callback: *mut SCRSDK::IDeviceCallback,
+        out: *mut CrsdkEventRecord,
+        max: u32,
+    ) -> u32;
+}
+
+/// `CrsdkEventRecord::kind`: `OnConnected` (`arg0` = version)
+pub const CRSDK_EVENT_CONNECTED: u32 = 1;
+/// `CrsdkEventRecord::kind`: `OnDisconnected` (`arg0` = error)
+pub const CRSDK_EVENT_DISCONNECTED: u32 = 2;
+/// `CrsdkEventRecord::kind`: `OnPropertyChangedCodes` (`codes`)
+pub const CRSDK_EVENT_PROPERTY_CHANGED: u32 = 3;
+/// `CrsdkEventRecord::kind`: `OnLvPropertyChangedCodes` (`codes`)
+pub const CRSDK_EVENT_LV_PROPERTY_CHANGED: u32 = 4;
+/// `CrsdkEventRecord::kind`: `OnWarning` (`arg0` = code)
+pub const CRSDK_EVENT_WARNING: u32 = 5;
+/// `CrsdkEventRecord::kind`: `OnWarningExt` (`arg0` = code, `arg1..=arg3` = params)
+pub const CRSDK_EVENT_WARNING_EXT: u32 = 6;
+/// `CrsdkEventRecord::kind`: `OnError` (`arg0` = code)
+pub const CRSDK_EVENT_ERROR: u32 = 7;
+/// `CrsdkEventRecord::kind`: `OnNotifyRemoteTransferContentsListChanged`
+/// (`arg0` = notify, `arg1` = slot, `arg2` = added)
+pub const CRSDK_EVENT_CONTENTS_LIST_CHANGED: u32 = 8;
+/// `CrsdkEventRecord::kind`: `OnNotifyRemoteFirmwareUpdateResult` (`arg0` = notify)
+pub const CRSDK_EVENT_FIRMWARE_UPDATE: u32 = 9;
+
+/// Property codes a `CrsdkEventRecord` carries inline
+pub const CRSDK_EVENT_INLINE_CODES: usize = 16;
+
+/// One callback flattened into plain data by the callback's event ring
+#[repr(C)]
+#[derive(Debug, Default, Clone, Copy, PartialEq, Eq)]
+pub struct CrsdkEventRecord {
+    /// One of the `CRSDK_EVENT_*` constants
+    pub kind: u32,
+    /// First argument (see the `CRSDK_EVENT_*` constants)
+    pub arg0: u32,
+    /// Second argument
+    pub arg1: u32,
+    /// Third argument
+    pub arg2: u32,
+    /// Fourth argument
+    pub arg3: u32,
+    /// Number of valid entries in `codes`
+    pub num_codes: u32,
+    /// Property codes of (live view) property change records
+    pub codes: [u32; CRSDK_EVENT_INLINE_CODES],
+    /// When the callback pushed the record, on the
+    /// [`crsdk_event_ring_clock_ns`] clock
+    pub pushed_at: u64,
+}
+
+impl CrsdkEventRecord {
+    /// The valid property codes
+    pub fn codes(&self) -> &[u32] {
+        &self.codes[..(self.num_codes as usize).min(CRSDK_EVENT_INLINE_CODES)]
+    }
+}
+
+// Live view shims (CrImageInfo / CrImageDataBlock are C++ classes)
+
+/// `crsdk_lv_get_image` status: a new frame was written to the buffer
+pub const CRSDK_LV_OK: i32 = 0;
+/// `crsdk_lv_get_image` status: the camera has no new frame yet
+pub const CRSDK_LV_NOT_UPDATED: i32 = 1;
+/// `crsdk_lv_get_image` status: the buffer is smaller than the frame
+pub const CRSDK_LV_BUFFER_TOO_SMALL: i32 = 2;
+/// `crsdk_lv_get_image` status: the SDK returned an error (see `err`)
+pub const CRSDK_LV_ERROR: i32 = 3;
+
+/// Focus or face frame flattened from `CrFocusFrameInfo` / `CrFaceFrameInfo`
+#[repr(C)]
+#[derive(Debug, Default, Clone, Copy, PartialEq, Eq)]
+pub struct CrsdkLvFrameRect {
+    /// 0 = focus frame, 1 = face frame
+    pub kind: u32,
+    /// SDK frame type
+    pub type_: u32,
+    /// SDK frame state
+    pub state: u32,
+    /// Display priority
+    pub priority: u32,
+    /// Left edge numerator (relative to `x_denominator`)
+    pub x_numerator: u32,
+    /// Horizontal denominator
+    pub x_denominator: u32,
+    /// Top edge numerator (relative to `y_denominator`)
+    pub y_numerator: u32,
+    /// Vertical denominator
+    pub y_denominator: u32,
+    /// Width in `x_denominator` units
+    pub width: u32,
+    /// Height in `y_denominator` units
+    pub height: u32,
+}
+
+extern "C" {
+    /// Get the buffer size needed for one live view frame (0 on error)
+    pub fn crsdk_lv_get_buffer_size(handle: i64, err: *mut u32) -> u32;
+
+    /// Fetch one live view frame into a caller-owned buffer
+    ///
+    /// Returns one of the `CRSDK_LV_*` status codes. On `CRSDK_LV_OK` the JPEG
+    /// is at `buf + *offset` and is `*image_size` bytes long.
+    pub fn crsdk_lv_get_image(
+        handle: i64,
+        buf: *mut u8,
+        size: u32,
+        offset: *mut u32,
+        image_size: *mut u32,
+        frame_no: *mut u32,
+        err: *mut u32,
+    ) -> i32;
+
+    /// Copy up to `capacity` focus/face frames into `out`
+    ///
+    /// Returns the total number of frames the camera reported.
+    pub fn crsdk_lv_get_frame_rects(
+        handle: i64,
+        out: *mut CrsdkLvFrameRect,
+        capacity: u32,
+        err: *mut u32,
+    ) -> u32;
+}
+
+// Remote transfer shims (content lists are nested C++ structs)
+
+/// `crsdk_remote_transfer_status`: the transfer is still running
+pub const CRSDK_RT_IN_PROGRESS: u32 = 0;
+/// `crsdk_remote_transfer_status`: the transfer finished successfully
+pub const CRSDK_RT_OK: u32 = 1;
+/// `crsdk_remote_transfer_status`: the transfer failed
+pub const CRSDK_RT_FAILED: u32 = 2;
+/// `crsdk_remote_transfer_status`: the camera was busy and refused the transfer
+pub const CRSDK_RT_BUSY: u32 = 3;
+
+/// Length of [`CrsdkContentFile::name`] in `CrChar` units, including the terminating NUL
+pub const CRSDK_CONTENT_NAME_LEN: usize = 256;
+
+/// One file of a content, flattened from `CrContentsInfo` / `CrContentsFile`
+#[repr(C)]
+#[derive(Debug, Clone, Copy)]
+pub struct CrsdkContentFile {
+    /// Content the file belongs to
+    pub content_id: u32,
+    /// File within the content
+    pub file_id: u32,
+    /// File size in bytes
+    pub size: u64,
+    /// NUL-terminated file path on the card (empty if the SDK gave none)
+    pub name: [CrChar; CRSDK_CONTENT_NAME_LEN],
+}
+
+impl Default for CrsdkContentFile {
+    fn default() -> Self {
+        Self {
+            content_id: 0,
+            file_id: 0,
+            size: 0,
+            name: [0; CRSDK_CONTENT_NAME_LEN],
+        }
+    }
+}
+
+extern "C" {
+    /// Copy up to `capacity` files stored in `slot` into `out`
+    ///
+    /// Returns the total number of files in the slot, or 0 on error (see `err`).
+    pub fn crsdk_contents_list(
+        handle: i64,
+        slot: u32,
+        out: *mut CrsdkContentFile,
+        capacity: u32,
+        err: *mut u32,
+    ) -> u32;
+
+    /// Start an in-memory pull of one file, delivered in `division_size` chunks
+    ///
+    /// Returns the SDK error code (0 on success).
+    pub fn crsdk_contents_pull(
+        handle: i64,
+        slot: u32,
+        content_id: u32,
+        file_id: u32,
+        division_size: u32,
+    ) -> u32;
+
+    /// Classify a remote transfer notification as one of the `CRSDK_RT_*` codes
+    pub fn crsdk_remote_transfer_status(notify: u32) -> u32;
 }
 
 #[cfg(test)]
@@ -117,4 +334,19 @@ mod tests {
         let version_func_exists = SCRSDK::GetSDKVersion as usize;
         assert_ne!(version_func_exists, 0);
     }
+
+    #[test]
+    fn test_property_code_lookup_round_trips() {
+        assert_eq!(DevicePropertyCode::ALL.len(), DevicePropertyCode::COUNT);
+        for (i, &code) in DevicePropertyCode::ALL.iter().enumerate() {
+            assert_eq!(code.index(), i);
+            assert_eq!(DevicePropertyCode::from_index(i), Some(code));
+            assert_eq!(DevicePropertyCode::from_raw(code.as_raw()), Some(code));
+        }
+        assert_eq!(
+            DevicePropertyCode::from_index(DevicePropertyCode::COUNT),
+            None
+        );
+        assert_eq!(DevicePropertyCode::from_raw(u32::MAX), None);
+    }
 }
@@ -0,0 +1,101 @@
+//! SDK callbacks end to end: FFI entry point, event queue, receiver
+
+use criterion::{black_box, criterion_group, criterion_main, BenchmarkId, Criterion, Throughput};
+use crsdk::backend::{CallbackRecord, CallbackRecording, MockBackend, ReplayTiming};
+use crsdk::blocking::CameraDevice;
+use crsdk::{DevicePropertyCode, EventChannelConfig};
+use std::sync::Arc;
+use std::time::Duration;
+
+/// Callbacks per replayed burst
+const BURST: usize = 256;
+
+fn device(capacity: usize, property_cache: bool) -> CameraDevice {
+    CameraDevice::builder()
+        .event_channel(EventChannelConfig::with_capacity(capacity))
+        .property_cache(property_cache)
+        .connect_with_backend(Arc::new(MockBackend::default()))
+}
+
+fn burst(record: impl Fn(usize) -> CallbackRecord) -> CallbackRecording {
+    let mut recording = CallbackRecording::new();
+    for i in 0..BURST {
+        recording.push(Duration::ZERO, record(i));
+    }
+    recording
+}
+
+fn property_burst() -> CallbackRecording {
+    let codes = DevicePropertyCode::ALL;
+    burst(|i| CallbackRecord::PropertyChanged {
+        codes: codes[i % codes.len()..]
+            .iter()
+            .take(4)
+            .map(|c| c.as_raw())
+            .collect(),
+    })
+}
+
+fn bench_bridge(c: &mut Criterion) {
+    let cases = [
+        ("property_changed", property_burst()),
+        (
+            "warning_ext",
+            burst(|_| CallbackRecord::WarningExt {
+                code: 0x0002_0002,
+                params: (1, 2, 3),
+            }),
+        ),
+        (
+            "transfer_data",
+            burst(|_| CallbackRecord::RemoteTransferData {
+                notify: 0,
+                percent: 50,
+                data: vec![0u8; 64 * 1024],
+            }),
+        ),
+    ];
+
+    let mut group = c.benchmark_group("bridge");
+    group.throughput(Throughput::Elements(BURST as u64));
+    for (name, recording) in &cases {
+        let mut camera = device(BURST, false);
+        group.bench_function(BenchmarkId::new("replay_and_drain", name), |b| {
+            b.iter(|| {
+                camera.replay_callbacks(recording, ReplayTiming::Immediate);
+                while let Some(event) = camera.try_recv_event() {
+                    black_box(event);
+                }
+            })
+        });
+    }
+    group.finish();
+}
+
+fn bench_overflow(c: &mut Criterion) {
+    let recording = property_burst();
+
+    let mut group = c.benchmark_group("overflow");
+    group.throughput(Throughput::Elements(BURST as u64));
+    for property_cache in [false, true] {
+        // A full queue coalesces the storm into the last slot
+        let mut camera = device(8, property_cache);
+        let id = if property_cache {
+            "coalesce_cached"
+        } else {
+            "coalesce"
+        };
+        group.bench_function(id, |b| {
+            b.iter(|| {
+                camera.replay_callbacks(&recording, ReplayTiming::Immediate);
+                while let Some(event) = camera.try_recv_event() {
+                    black_box(event);
+                }
+            })
+        });
+    }
+    group.finish();
+}
+
+criterion_group!(benches, bench_bridge, bench_overflow);
+criterion_main!(benches);
@@ -0,0 +1,121 @@
+//! Shared property fixtures for the benches
+//!
+//! Properties are built as [`RecordedProperty`] values so they go through
+//! the same SDK-layout parsing path as a connected camera, via
+//! [`MockBackend`].
+
+#![allow(dead_code)]
+
+use crsdk::backend::{MockBackend, RecordedProperty};
+use crsdk::blocking::CameraDevice;
+use crsdk::DevicePropertyCode;
+use crsdk_sys::SCRSDK::{
+    CrDataType_CrDataType_Int32, CrDataType_CrDataType_UInt32,
+    CrPropertyEnableFlag_CrEnableValue_True,
+};
+use std::sync::Arc;
+
+const ARRAY_BIT: u32 = 0x2000;
+const RANGE_BIT: u32 = 0x4000;
+
+/// Properties in the small fixture (a typical exposure panel)
+pub const SMALL_COUNT: usize = 16;
+/// Values in each small discrete list
+pub const SMALL_LIST_LEN: usize = 8;
+/// Values in each large discrete list (e.g. shutter speed or ISO tables)
+pub const LARGE_LIST_LEN: usize = 256;
+
+/// A property set to benchmark against
+pub struct Fixture {
+    /// Label used in benchmark ids
+    pub name: &'static str,
+    /// The recorded properties
+    pub properties: Vec<RecordedProperty>,
+}
+
+impl Fixture {
+    /// The first few property codes with short lists
+    pub fn small() -> Self {
+        Self {
+            name: "small",
+            properties: build(&DevicePropertyCode::ALL[..SMALL_COUNT], SMALL_LIST_LEN),
+        }
+    }
+
+    /// Every property code, with long lists, ranges and strings mixed in
+    pub fn large() -> Self {
+        Self {
+            name: "large",
+            properties: build(DevicePropertyCode::ALL, LARGE_LIST_LEN),
+        }
+    }
+
+    /// Both fixtures, small first
+    pub fn all() -> [Self; 2] {
+        [Self::small(), Self::large()]
+    }
+
+    /// Raw codes of every property in the fixture
+    pub fn codes(&self) -> Vec<DevicePropertyCode> {
+        self.properties
+            .iter()
+            .filter_map(|p| DevicePropertyCode::from_raw(p.code))
+            .collect()
+    }
+
+    /// A device answering from this fixture
+    pub fn device(&self) -> CameraDevice {
+        let backend = Arc::new(MockBackend::new(self.properties.clone()));
+        CameraDevice::builder().connect_with_backend(backend)
+    }
+}
+
+fn build(codes: &[DevicePropertyCode], list_len: usize) -> Vec<RecordedProperty> {
+    codes
+        .iter()
+        .enumerate()
+        .map(|(i, code)| match i % 4 {
+            // Every fourth property is a range, as exposure compensation is
+            0 => range(*code, -15, 15, 1),
+            // and one in eight carries a current string
+            1 if i % 8 == 1 => with_string(discrete(*code, list_len), "Custom Setting"),
+            _ => discrete(*code, list_len),
+        })
+        .collect()
+}
+
+fn record(code: DevicePropertyCode, value_type: u32, values: Vec<u8>) -> RecordedProperty {
+    RecordedProperty {
+        code: code.as_raw(),
+        value_type,
+        enable_flag: CrPropertyEnableFlag_CrEnableValue_True,
+        variable_flag: Default::default(),
+        current_value: 1,
+        current_str: None,
+        values,
+        get_set_values: Vec::new(),
+    }
+}
+
+fn discrete(code: DevicePropertyCode, len: usize) -> RecordedProperty {
+    let values = (0..len as u32).flat_map(|v| v.to_ne_bytes()).collect();
+    record(code, CrDataType_CrDataType_UInt32 | ARRAY_BIT, values)
+}
+
+fn range(code: DevicePropertyCode, min: i32, max: i32, step: i32) -> RecordedProperty {
+    let values = [min, max, step]
+        .iter()
+        .flat_map(|v| v.to_ne_bytes())
+        .collect();
+    record(code, CrDataType_CrDataType_Int32 | RANGE_BIT, values)
+}
+
+fn with_string(mut prop: RecordedProperty, s: &str) -> RecordedProperty {
+    // SDK layout: length including the terminator, then UTF-16 with NUL
+    let mut utf16: Vec<u16> = s.encode_utf16().collect();
+    utf16.push(0);
+    let mut current = vec![utf16.len() as u16];
+    current.extend(utf16);
+    prop.current_str = Some(current);
+    prop
+}
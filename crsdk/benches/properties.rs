@@ -0,0 +1,105 @@
+//! Property parsing, code lookup, value formatting and constraint checks
+
+mod fixtures;
+
+use criterion::{black_box, criterion_group, criterion_main, BenchmarkId, Criterion, Throughput};
+use crsdk::{property_value_type, DevicePropertyCode, TypedValue, ValueConstraint};
+use fixtures::{Fixture, LARGE_LIST_LEN};
+use std::collections::HashSet;
+
+fn bench_parse(c: &mut Criterion) {
+    let mut group = c.benchmark_group("parse");
+
+    for fixture in Fixture::all() {
+        let camera = fixture.device();
+        let codes = fixture.codes();
+        group.throughput(Throughput::Elements(fixture.properties.len() as u64));
+
+        group.bench_function(BenchmarkId::new("get_all_properties", fixture.name), |b| {
+            b.iter(|| camera.get_all_properties().unwrap())
+        });
+        group.bench_function(BenchmarkId::new("get_properties", fixture.name), |b| {
+            b.iter(|| camera.get_properties(black_box(&codes)).unwrap())
+        });
+    }
+
+    group.finish();
+}
+
+fn bench_code_lookup(c: &mut Criterion) {
+    let raw: Vec<u32> = DevicePropertyCode::ALL.iter().map(|c| c.as_raw()).collect();
+
+    let mut group = c.benchmark_group("code_lookup");
+    group.throughput(Throughput::Elements(raw.len() as u64));
+    group.bench_function("from_raw", |b| {
+        b.iter(|| {
+            raw.iter()
+                .filter_map(|code| DevicePropertyCode::from_raw(black_box(*code)))
+                .count()
+        })
+    });
+    group.bench_function("from_raw_miss", |b| {
+        b.iter(|| {
+            (0..raw.len() as u32)
+                .map(|i| DevicePropertyCode::from_raw(black_box(0xFFFF_0000 | i)))
+                .count()
+        })
+    });
+    group.finish();
+}
+
+fn bench_format(c: &mut Criterion) {
+    // One representative code per value type
+    let mut seen = HashSet::new();
+    let codes: Vec<DevicePropertyCode> = DevicePropertyCode::ALL
+        .iter()
+        .copied()
+        .filter(|code| seen.insert(property_value_type(*code)))
+        .collect();
+    // Mix of small enum values, f-numbers and packed shutter fractions
+    let raws = [0u64, 1, 2, 280, 0x0001_00FA, 0xFFFF_FFFF];
+
+    let mut group = c.benchmark_group("format");
+    for code in codes {
+        let id = format!("{:?}", property_value_type(code));
+        group.bench_function(BenchmarkId::new("from_raw_display", id), |b| {
+            b.iter(|| {
+                for raw in raws {
+                    black_box(TypedValue::from_raw(code, black_box(raw)).to_string());
+                }
+            })
+        });
+    }
+    group.finish();
+}
+
+fn bench_constraint(c: &mut Criterion) {
+    let discrete = ValueConstraint::Discrete((0..LARGE_LIST_LEN as u64).collect());
+    let range = ValueConstraint::Range {
+        min: -300,
+        max: 300,
+        step: 3,
+    };
+
+    let mut group = c.benchmark_group("constraint");
+    group.bench_function("is_valid_discrete_hit", |b| {
+        b.iter(|| discrete.is_valid(black_box(LARGE_LIST_LEN as u64 - 1)))
+    });
+    group.bench_function("is_valid_discrete_miss", |b| {
+        b.iter(|| discrete.is_valid(black_box(u64::MAX)))
+    });
+    group.bench_function("is_valid_range", |b| {
+        b.iter(|| range.is_valid(black_box(150)))
+    });
+    group.bench_function("expand_range", |b| b.iter(|| range.expand_range()));
+    group.finish();
+}
+
+criterion_group!(
+    benches,
+    bench_parse,
+    bench_code_lookup,
+    bench_format,
+    bench_constraint
+);
+criterion_main!(benches);
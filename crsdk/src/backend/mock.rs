@@ -0,0 +1,239 @@
+//! Backend serving recorded property arrays
+
+use super::{PropertyList, SdkBackend};
+use crate::error::{Error, Result};
+use crsdk_sys::SCRSDK::{
+    CrDataType, CrDeviceProperty, CrPropertyEnableFlag, CrPropertyVariableFlag,
+};
+use std::ptr;
+use std::sync::{Arc, Mutex, RwLock};
+
+/// An owned copy of one `CrDeviceProperty`, including its value arrays
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub struct RecordedProperty {
+    /// Raw property code
+    pub code: u32,
+    /// SDK data type (with array/range bits)
+    pub value_type: CrDataType,
+    /// SDK enable flag
+    pub enable_flag: CrPropertyEnableFlag,
+    /// SDK variable flag
+    pub variable_flag: CrPropertyVariableFlag,
+    /// Current value
+    pub current_value: u64,
+    /// Current string in SDK layout (length prefix, then UTF-16 with NUL)
+    pub current_str: Option<Vec<u16>>,
+    /// Raw `values` bytes
+    pub values: Vec<u8>,
+    /// Raw `getSetValues` bytes
+    pub get_set_values: Vec<u8>,
+}
+
+impl RecordedProperty {
+    /// Copy a property returned by the SDK
+    ///
+    /// # Safety
+    ///
+    /// `prop` must come from the SDK (or follow its layout): the value
+    /// pointers must be valid for their sizes and `currentStr`, if set, must
+    /// start with its length.
+    pub unsafe fn from_sdk(prop: &CrDeviceProperty) -> Self {
+        let bytes = |data: *mut u8, size: u32| {
+            if data.is_null() || size == 0 {
+                Vec::new()
+            } else {
+                // SAFETY: caller guarantees `data` holds `size` bytes
+                unsafe { std::slice::from_raw_parts(data, size as usize) }.to_vec()
+            }
+        };
+
+        let current_str = if prop.currentStr.is_null() {
+            None
+        } else {
+            // SAFETY: caller guarantees the length prefix and the characters
+            // after it are readable
+            unsafe {
+                let len = *prop.currentStr as usize;
+                Some(std::slice::from_raw_parts(prop.currentStr, len + 1).to_vec())
+            }
+        };
+
+        Self {
+            code: prop.code,
+            value_type: prop.valueType,
+            enable_flag: prop.enableFlag,
+            variable_flag: prop.variableFlag,
+            current_value: prop.currentValue,
+            current_str,
+            values: bytes(prop.values, prop.valuesSize),
+            get_set_values: bytes(prop.getSetValues, prop.getSetValuesSize),
+        }
+    }
+
+    /// SDK-layout view of this record; valid while `self` is
+    pub(crate) fn as_sdk(&self) -> CrDeviceProperty {
+        // The parsers only read through these pointers; the casts to *mut
+        // just match the SDK struct
+        let data = |bytes: &Vec<u8>| {
+            if bytes.is_empty() {
+                ptr::null_mut()
+            } else {
+                bytes.as_ptr() as *mut u8
+            }
+        };
+
+        CrDeviceProperty {
+            code: self.code,
+            valueType: self.value_type,
+            enableFlag: self.enable_flag,
+            variableFlag: self.variable_flag,
+            currentValue: self.current_value,
+            currentStr: self
+                .current_str
+                .as_ref()
+                .map_or(ptr::null_mut(), |s| s.as_ptr() as *mut u16),
+            valuesSize: self.values.len() as u32,
+            values: data(&self.values),
+            getSetValuesSize: self.get_set_values.len() as u32,
+            getSetValues: data(&self.get_set_values),
+        }
+    }
+}
+
+/// Backend answering property reads from recorded arrays
+///
+/// Writes update the stored current value and are logged along with sent
+/// commands, so tests can check what a device would have sent.
+#[derive(Debug, Default)]
+pub struct MockBackend {
+    properties: RwLock<Arc<Vec<RecordedProperty>>>,
+    writes: Mutex<Vec<(u32, u64)>>,
+    commands: Mutex<Vec<(u32, u16)>>,
+}
+
+impl MockBackend {
+    /// Serve `properties`, in the order given
+    pub fn new(properties: Vec<RecordedProperty>) -> Self {
+        Self {
+            properties: RwLock::new(Arc::new(properties)),
+            ..Default::default()
+        }
+    }
+
+    /// Change a property's current value, as if the camera had
+    pub fn set_current_value(&self, code: u32, value: u64) -> bool {
+        let mut properties = self.properties.write().unwrap();
+        match Arc::make_mut(&mut properties)
+            .iter_mut()
+            .find(|p| p.code == code)
+        {
+            Some(prop) => {
+                prop.current_value = value;
+                true
+            }
+            None => false,
+        }
+    }
+
+    /// `(code, value)` of every property write so far
+    pub fn writes(&self) -> Vec<(u32, u64)> {
+        self.writes.lock().unwrap().clone()
+    }
+
+    /// `(command, param)` of every command sent so far
+    pub fn commands(&self) -> Vec<(u32, u16)> {
+        self.commands.lock().unwrap().clone()
+    }
+
+    fn snapshot(&self) -> Arc<Vec<RecordedProperty>> {
+        self.properties.read().unwrap().clone()
+    }
+}
+
+impl SdkBackend for MockBackend {
+    fn get_select_properties(&self, _handle: i64, codes: &mut [u32]) -> Result<PropertyList> {
+        let codes: &[u32] = codes;
+        Ok(PropertyList::from_recorded(self.snapshot(), |p| {
+            codes.contains(&p.code)
+        }))
+    }
+
+    fn get_all_properties(&self, _handle: i64) -> Result<PropertyList> {
+        Ok(PropertyList::from_recorded(self.snapshot(), |_| true))
+    }
+
+    fn set_property(&self, _handle: i64, prop: &mut CrDeviceProperty) -> Result<()> {
+        if !self.set_current_value(prop.code, prop.currentValue) {
+            return Err(Error::PropertyNotSupported);
+        }
+        self.writes
+            .lock()
+            .unwrap()
+            .push((prop.code, prop.currentValue));
+        Ok(())
+    }
+
+    fn send_command(&self, _handle: i64, command: u32, param: u16) -> Result<()> {
+        self.commands.lock().unwrap().push((command, param));
+        Ok(())
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::blocking::CameraDevice;
+    use crsdk_sys::DevicePropertyCode;
+
+    fn iso_property(value: u64) -> RecordedProperty {
+        RecordedProperty {
+            code: DevicePropertyCode::IsoSensitivity.as_raw(),
+            value_type: crsdk_sys::SCRSDK::CrDataType_CrDataType_UInt32,
+            enable_flag: crsdk_sys::SCRSDK::CrPropertyEnableFlag_CrEnableValue_True,
+            variable_flag: Default::default(),
+            current_value: value,
+            current_str: None,
+            values: [100u32, 200, 400]
+                .iter()
+                .flat_map(|v| v.to_le_bytes())
+                .collect(),
+            get_set_values: Vec::new(),
+        }
+    }
+
+    #[test]
+    fn test_recorded_property_round_trips_sdk_layout() {
+        let mut record = iso_property(200);
+        record.current_str = Some(vec![3, 'I' as u16, 'S' as u16, 0]);
+
+        let copy = unsafe { RecordedProperty::from_sdk(&record.as_sdk()) };
+        assert_eq!(copy, record);
+    }
+
+    #[test]
+    fn test_mock_device_reads_and_writes_properties() {
+        let backend = Arc::new(MockBackend::new(vec![iso_property(100)]));
+        let camera = CameraDevice::builder().connect_with_backend(backend.clone());
+
+        let iso = camera
+            .get_property(DevicePropertyCode::IsoSensitivity)
+            .unwrap();
+        assert_eq!(iso.current_value, 100);
+        assert!(camera.get_property(DevicePropertyCode::FNumber).is_err());
+
+        camera
+            .set_property(DevicePropertyCode::IsoSensitivity, 400)
+            .unwrap();
+        assert_eq!(
+            backend.writes(),
+            vec![(DevicePropertyCode::IsoSensitivity.as_raw(), 400)]
+        );
+        assert_eq!(
+            camera
+                .get_property(DevicePropertyCode::IsoSensitivity)
+                .unwrap()
+                .current_value,
+            400
+        );
+    }
+}
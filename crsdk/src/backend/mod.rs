@@ -0,0 +1,212 @@
+//! Pluggable SDK backend for per-device calls
+//!
+//! [`blocking::CameraDevice`](crate::blocking::CameraDevice) sends its
+//! property and command traffic through an [`SdkBackend`]. Connected devices
+//! use [`NativeBackend`], which calls the Sony SDK. [`MockBackend`] answers
+//! from recorded property arrays instead, so the parsing, caching and event
+//! paths can be profiled and tested without a camera:
+//!
+//! ```no_run
+//! use crsdk::backend::{CallbackRecording, MockBackend, ReplayTiming};
+//! use crsdk::blocking::CameraDevice;
+//! use std::sync::Arc;
+//!
+//! # fn run(properties: Vec<crsdk::backend::RecordedProperty>, storm: CallbackRecording) {
+//! let backend = Arc::new(MockBackend::new(properties));
+//! let mut camera = CameraDevice::builder()
+//!     .property_cache(true)
+//!     .connect_with_backend(backend);
+//!
+//! camera.replay_callbacks(&storm, ReplayTiming::Recorded);
+//! while let Some(event) = camera.try_recv_event() {
+//!     println!("{}", event);
+//! }
+//! # }
+//! ```
+//!
+//! Callback streams are captured with a [`CallbackRecorder`] installed on the
+//! builder of a real connection, and replayed through the same FFI entry
+//! points the SDK callback uses.
+//!
+//! Live view and content download still talk to the SDK directly.
+
+mod mock;
+mod replay;
+
+pub use mock::{MockBackend, RecordedProperty};
+pub(crate) use replay::replay;
+pub use replay::{
+    CallbackRecord, CallbackRecorder, CallbackRecording, ReplayTiming, TimedCallback,
+};
+
+use crate::error::{Error, Result};
+use crsdk_sys::SCRSDK::CrDeviceProperty;
+use std::ptr;
+use std::sync::Arc;
+
+/// The SDK calls a device makes after it is connected
+pub trait SdkBackend: Send + Sync {
+    /// Fetch the properties with the given raw codes (`GetSelectDeviceProperties`)
+    fn get_select_properties(&self, handle: i64, codes: &mut [u32]) -> Result<PropertyList>;
+
+    /// Fetch every property the camera exposes (`GetDeviceProperties`)
+    fn get_all_properties(&self, handle: i64) -> Result<PropertyList>;
+
+    /// Write one property value (`SetDeviceProperty`)
+    fn set_property(&self, handle: i64, prop: &mut CrDeviceProperty) -> Result<()>;
+
+    /// Send a command (`SendCommand`)
+    fn send_command(&self, handle: i64, command: u32, param: u16) -> Result<()>;
+}
+
+/// Backend that forwards every call to the Sony SDK
+#[derive(Debug, Clone, Copy, Default)]
+pub struct NativeBackend;
+
+impl SdkBackend for NativeBackend {
+    fn get_select_properties(&self, handle: i64, codes: &mut [u32]) -> Result<PropertyList> {
+        let mut properties_ptr: *mut CrDeviceProperty = ptr::null_mut();
+        let mut num_properties: i32 = 0;
+
+        let result = unsafe {
+            crsdk_sys::SCRSDK::GetSelectDeviceProperties(
+                handle,
+                codes.len() as u32,
+                codes.as_mut_ptr(),
+                &mut properties_ptr,
+                &mut num_properties,
+            )
+        };
+
+        if result != 0 {
+            return Err(Error::from_sdk_error(result as u32));
+        }
+
+        Ok(PropertyList::from_sdk(
+            handle,
+            properties_ptr,
+            num_properties,
+        ))
+    }
+
+    fn get_all_properties(&self, handle: i64) -> Result<PropertyList> {
+        let mut properties_ptr: *mut CrDeviceProperty = ptr::null_mut();
+        let mut num_properties: i32 = 0;
+
+        let result = unsafe {
+            crsdk_sys::SCRSDK::GetDeviceProperties(handle, &mut properties_ptr, &mut num_properties)
+        };
+
+        if result != 0 {
+            return Err(Error::from_sdk_error(result as u32));
+        }
+
+        Ok(PropertyList::from_sdk(
+            handle,
+            properties_ptr,
+            num_properties,
+        ))
+    }
+
+    fn set_property(&self, handle: i64, prop: &mut CrDeviceProperty) -> Result<()> {
+        let result = unsafe { crsdk_sys::SCRSDK::SetDeviceProperty(handle, prop) };
+
+        if result != 0 {
+            return Err(Error::from_sdk_error(result as u32));
+        }
+
+        Ok(())
+    }
+
+    fn send_command(&self, handle: i64, command: u32, param: u16) -> Result<()> {
+        let result = unsafe { crsdk_sys::SCRSDK::SendCommand(handle, command, param) };
+
+        if result != 0 {
+            return Err(Error::from_sdk_error(result as u32));
+        }
+
+        Ok(())
+    }
+}
+
+/// Properties returned by a backend, released when dropped
+pub struct PropertyList {
+    inner: ListInner,
+}
+
+enum ListInner {
+    Empty,
+    /// Array owned by the SDK, freed with `ReleaseDeviceProperties`
+    Sdk {
+        handle: i64,
+        ptr: *mut CrDeviceProperty,
+        len: usize,
+    },
+    /// Views into recorded properties kept alive by `_data`
+    Recorded {
+        _data: Arc<Vec<RecordedProperty>>,
+        props: Vec<CrDeviceProperty>,
+    },
+}
+
+impl PropertyList {
+    /// A list with no properties
+    pub fn empty() -> Self {
+        Self {
+            inner: ListInner::Empty,
+        }
+    }
+
+    fn from_sdk(handle: i64, ptr: *mut CrDeviceProperty, num: i32) -> Self {
+        if ptr.is_null() || num <= 0 {
+            return Self::empty();
+        }
+        Self {
+            inner: ListInner::Sdk {
+                handle,
+                ptr,
+                len: num as usize,
+            },
+        }
+    }
+
+    /// Build SDK-layout views of `records` selected by `pick`
+    ///
+    /// The views point into `data`, which the list keeps alive.
+    pub(crate) fn from_recorded(
+        data: Arc<Vec<RecordedProperty>>,
+        mut pick: impl FnMut(&RecordedProperty) -> bool,
+    ) -> Self {
+        let props = data
+            .iter()
+            .filter(|record| pick(record))
+            .map(RecordedProperty::as_sdk)
+            .collect();
+        Self {
+            inner: ListInner::Recorded { _data: data, props },
+        }
+    }
+
+    /// The properties in SDK layout
+    pub fn as_slice(&self) -> &[CrDeviceProperty] {
+        match &self.inner {
+            ListInner::Empty => &[],
+            // SAFETY: the SDK returned `len` entries at `ptr`, valid until
+            // ReleaseDeviceProperties in Drop
+            ListInner::Sdk { ptr, len, .. } => unsafe { std::slice::from_raw_parts(*ptr, *len) },
+            ListInner::Recorded { props, .. } => props,
+        }
+    }
+}
+
+impl Drop for PropertyList {
+    fn drop(&mut self) {
+        if let ListInner::Sdk { handle, ptr, .. } = self.inner {
+            // SAFETY: ptr came from GetDeviceProperties/GetSelectDeviceProperties
+            // for this handle and is released exactly once
+            unsafe {
+                crsdk_sys::SCRSDK::ReleaseDeviceProperties(handle, ptr);
+            }
+        }
+    }
+}
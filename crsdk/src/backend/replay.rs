@@ -0,0 +1,342 @@
+//! Recording and replaying SDK callback streams
+//!
+//! A [`CallbackRecorder`] installed on a connection captures every callback
+//! at the FFI boundary, with the raw arguments the SDK passed and the time it
+//! arrived. Replaying a [`CallbackRecording`] calls the same `crsdk_event_*`
+//! entry points, so queueing, coalescing and cache invalidation behave
+//! exactly as they did live.
+
+use crate::event_sender::{
+    crsdk_event_connected, crsdk_event_contents_list_changed, crsdk_event_contents_transfer,
+    crsdk_event_disconnected, crsdk_event_download_complete, crsdk_event_error,
+    crsdk_event_firmware_update, crsdk_event_lv_property_changed, crsdk_event_property_changed,
+    crsdk_event_remote_transfer_data, crsdk_event_remote_transfer_progress, crsdk_event_warning,
+    crsdk_event_warning_ext,
+};
+use std::ffi::{c_void, CString};
+use std::sync::{Arc, Mutex};
+use std::time::{Duration, Instant};
+
+/// Raw arguments of one SDK callback
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub enum CallbackRecord {
+    /// `OnConnected`
+    Connected {
+        /// SDK protocol version
+        version: u32,
+    },
+    /// `OnDisconnected`
+    Disconnected {
+        /// Error code
+        error: u32,
+    },
+    /// `OnPropertyChangedCodes`
+    PropertyChanged {
+        /// Raw property codes
+        codes: Vec<u32>,
+    },
+    /// `OnLvPropertyChangedCodes`
+    LiveViewPropertyChanged {
+        /// Raw live view property codes
+        codes: Vec<u32>,
+    },
+    /// `OnCompleteDownload`
+    DownloadComplete {
+        /// Downloaded file name
+        filename: String,
+    },
+    /// `OnNotifyContentsTransfer`
+    ContentsTransfer {
+        /// Notification code
+        notify: u32,
+        /// Content handle
+        handle: u64,
+        /// File name, if given
+        filename: Option<String>,
+    },
+    /// `OnWarning`
+    Warning {
+        /// Warning code
+        code: u32,
+    },
+    /// `OnWarningExt`
+    WarningExt {
+        /// Warning code
+        code: u32,
+        /// Parameters
+        params: (i32, i32, i32),
+    },
+    /// `OnError`
+    Error {
+        /// Error code
+        code: u32,
+    },
+    /// `OnNotifyRemoteTransferResult` (file variant)
+    RemoteTransferProgress {
+        /// Notification code
+        notify: u32,
+        /// Progress percentage
+        percent: u32,
+        /// File name, if given
+        filename: Option<String>,
+    },
+    /// `OnNotifyRemoteTransferResult` (in-memory variant)
+    RemoteTransferData {
+        /// Notification code
+        notify: u32,
+        /// Progress percentage
+        percent: u32,
+        /// Data chunk
+        data: Vec<u8>,
+    },
+    /// `OnNotifyRemoteTransferContentsListChanged`
+    ContentsListChanged {
+        /// Notification code
+        notify: u32,
+        /// Card slot
+        slot: u32,
+        /// Number of contents added
+        added: u32,
+    },
+    /// `OnNotifyRemoteFirmwareUpdateResult`
+    FirmwareUpdate {
+        /// Notification code
+        notify: u32,
+    },
+}
+
+/// A callback and when it arrived, relative to the start of recording
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub struct TimedCallback {
+    /// Time since recording started
+    pub at: Duration,
+    /// The callback
+    pub record: CallbackRecord,
+}
+
+/// A captured callback stream, in arrival order
+#[derive(Debug, Clone, Default, PartialEq, Eq)]
+pub struct CallbackRecording {
+    /// Recorded callbacks
+    pub callbacks: Vec<TimedCallback>,
+}
+
+impl CallbackRecording {
+    /// Create an empty recording, e.g. to script a synthetic storm
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    /// Append a callback at offset `at`
+    pub fn push(&mut self, at: Duration, record: CallbackRecord) {
+        self.callbacks.push(TimedCallback { at, record });
+    }
+
+    /// Number of recorded callbacks
+    pub fn len(&self) -> usize {
+        self.callbacks.len()
+    }
+
+    /// Check whether nothing was recorded
+    pub fn is_empty(&self) -> bool {
+        self.callbacks.is_empty()
+    }
+
+    /// Offset of the last callback
+    pub fn duration(&self) -> Duration {
+        self.callbacks.last().map_or(Duration::ZERO, |c| c.at)
+    }
+}
+
+/// How replay paces callbacks
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub enum ReplayTiming {
+    /// Keep the recorded gaps between callbacks
+    Recorded,
+    /// Multiply the recorded offsets by this factor (0.5 = twice as fast)
+    Scaled(f64),
+    /// Deliver back to back, as fast as possible
+    Immediate,
+}
+
+/// Capture handle for a connection's callbacks
+///
+/// Clones share one recording. Recording starts when the recorder is created.
+#[derive(Debug, Clone)]
+pub struct CallbackRecorder {
+    inner: Arc<RecorderState>,
+}
+
+#[derive(Debug)]
+struct RecorderState {
+    started: Instant,
+    callbacks: Mutex<Vec<TimedCallback>>,
+}
+
+impl CallbackRecorder {
+    /// Start a new recording
+    pub fn new() -> Self {
+        Self {
+            inner: Arc::new(RecorderState {
+                started: Instant::now(),
+                callbacks: Mutex::new(Vec::new()),
+            }),
+        }
+    }
+
+    pub(crate) fn record(&self, record: CallbackRecord) {
+        let at = self.inner.started.elapsed();
+        self.inner
+            .callbacks
+            .lock()
+            .unwrap()
+            .push(TimedCallback { at, record });
+    }
+
+    /// Take everything recorded so far, leaving the recorder empty
+    pub fn take(&self) -> CallbackRecording {
+        CallbackRecording {
+            callbacks: std::mem::take(&mut *self.inner.callbacks.lock().unwrap()),
+        }
+    }
+}
+
+impl Default for CallbackRecorder {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+/// Feed `recording` into the event sender behind `ctx`
+pub(crate) fn replay(ctx: *mut c_void, recording: &CallbackRecording, timing: ReplayTiming) {
+    let started = Instant::now();
+    for callback in &recording.callbacks {
+        let due = match timing {
+            ReplayTiming::Recorded => Some(callback.at),
+            ReplayTiming::Scaled(factor) => Some(callback.at.mul_f64(factor.max(0.0))),
+            ReplayTiming::Immediate => None,
+        };
+        if let Some(due) = due {
+            let elapsed = started.elapsed();
+            if due > elapsed {
+                std::thread::sleep(due - elapsed);
+            }
+        }
+        dispatch(ctx, &callback.record);
+    }
+}
+
+fn c_string(s: &str) -> CString {
+    CString::new(s.replace('\0', "")).unwrap()
+}
+
+fn dispatch(ctx: *mut c_void, record: &CallbackRecord) {
+    match record {
+        CallbackRecord::Connected { version } => crsdk_event_connected(ctx, *version),
+        CallbackRecord::Disconnected { error } => crsdk_event_disconnected(ctx, *error),
+        CallbackRecord::PropertyChanged { codes } => {
+            crsdk_event_property_changed(ctx, codes.len() as u32, codes.as_ptr())
+        }
+        CallbackRecord::LiveViewPropertyChanged { codes } => {
+            crsdk_event_lv_property_changed(ctx, codes.len() as u32, codes.as_ptr())
+        }
+        CallbackRecord::DownloadComplete { filename } => {
+            let filename = c_string(filename);
+            crsdk_event_download_complete(ctx, filename.as_ptr().cast())
+        }
+        CallbackRecord::ContentsTransfer {
+            notify,
+            handle,
+            filename,
+        } => {
+            let filename = filename.as_deref().map(c_string);
+            let ptr = filename
+                .as_ref()
+                .map_or(std::ptr::null(), |f| f.as_ptr().cast());
+            crsdk_event_contents_transfer(ctx, *notify, *handle, ptr)
+        }
+        CallbackRecord::Warning { code } => crsdk_event_warning(ctx, *code),
+        CallbackRecord::WarningExt {
+            code,
+            params: (p1, p2, p3),
+        } => crsdk_event_warning_ext(ctx, *code, *p1, *p2, *p3),
+        CallbackRecord::Error { code } => crsdk_event_error(ctx, *code),
+        CallbackRecord::RemoteTransferProgress {
+            notify,
+            percent,
+            filename,
+        } => {
+            let filename = filename.as_deref().map(c_string);
+            let ptr = filename
+                .as_ref()
+                .map_or(std::ptr::null(), |f| f.as_ptr().cast());
+            crsdk_event_remote_transfer_progress(ctx, *notify, *percent, ptr)
+        }
+        CallbackRecord::RemoteTransferData {
+            notify,
+            percent,
+            data,
+        } => crsdk_event_remote_transfer_data(
+            ctx,
+            *notify,
+            *percent,
+            data.as_ptr(),
+            data.len() as u64,
+        ),
+        CallbackRecord::ContentsListChanged {
+            notify,
+            slot,
+            added,
+        } => crsdk_event_contents_list_changed(ctx, *notify, *slot, *added),
+        CallbackRecord::FirmwareUpdate { notify } => crsdk_event_firmware_update(ctx, *notify),
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::backend::MockBackend;
+    use crate::blocking::CameraDevice;
+    use crate::event::CameraEvent;
+    use crate::event_queue::EventChannelConfig;
+    use crsdk_sys::DevicePropertyCode;
+
+    #[test]
+    fn test_replay_reproduces_recorded_stream() {
+        let recorder = CallbackRecorder::new();
+        let mut camera = CameraDevice::builder()
+            .event_channel(EventChannelConfig::with_capacity(2))
+            .callback_recorder(recorder.clone())
+            .connect_with_backend(Arc::new(MockBackend::default()));
+
+        let mut storm = CallbackRecording::new();
+        storm.push(Duration::ZERO, CallbackRecord::Connected { version: 3 });
+        for i in 0..100 {
+            storm.push(
+                Duration::from_micros(i),
+                CallbackRecord::PropertyChanged {
+                    codes: vec![DevicePropertyCode::FNumber.as_raw()],
+                },
+            );
+        }
+
+        camera.replay_callbacks(&storm, ReplayTiming::Immediate);
+
+        assert!(matches!(
+            camera.try_recv_event(),
+            Some(CameraEvent::Connected { version: 3 })
+        ));
+        // Past capacity the property storm coalesces into one queued event
+        assert!(matches!(
+            camera.try_recv_event(),
+            Some(CameraEvent::PropertyChanged { codes }) if codes.contains(DevicePropertyCode::FNumber)
+        ));
+        assert!(camera.try_recv_event().is_none());
+        assert_eq!(camera.event_stats().coalesced, 99);
+
+        // Replayed callbacks are recorded like live ones
+        let recorded = recorder.take();
+        assert_eq!(recorded.len(), storm.len());
+        assert_eq!(recorded.callbacks[0].record, storm.callbacks[0].record);
+    }
+}
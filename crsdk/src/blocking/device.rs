@@ -4,38 +4,71 @@
 use asyncwrap::async_wrap;
 use asyncwrap::blocking_impl;
 
+use crate::backend::{
+    CallbackRecorder, CallbackRecording, NativeBackend, ReplayTiming, SdkBackend,
+};
 use crate::command::{CommandId, CommandParam};
+use crate::download::{self, ContentFile, DownloadConfig, DownloadStats, PullTarget};
 use crate::error::{Error, Result};
 use crate::event::CameraEvent;
+use crate::event_queue::{self, EventChannelConfig, EventReceiver, EventStats, EventStatsHandle};
+use crate::event_ring::{EventRingWorker, RingConsumer};
 use crate::event_sender::EventSender;
+use crate::interval::{self, IntervalPlan, IntervalReport, IntervalShot, IntervalTarget};
+use crate::live_view::{LiveViewConfig, LiveViewReceiver, LiveViewWorker};
+use crate::live_view_analysis::{AnalysisPool, AnalysisReceiver};
+use crate::metrics::{MetricsSnapshot, SdkCall, SdkCallMetrics};
+use crate::preset::{self, PresetReport, PresetTarget, PropertySignals};
+use crate::profile::ConnectionProfile;
 use crate::property::{
     device_property_from_sdk, device_property_from_sdk_debug, DeviceProperty, DriveMode,
-    ExposureProgram, FlashMode, FocusArea, FocusMode, LockIndicator, MeteringMode, PropertyValue,
-    WhiteBalance,
+    ExposureProgram, FlashMode, FocusArea, FocusMode, LockIndicator, MeteringMode, PropertyCache,
+    PropertyDiff, PropertyValue, WhiteBalance,
 };
+use crate::sdk_string;
+use crate::shot::{AfStatus, ShotSignals, DEFAULT_AF_TIMEOUT};
+use crate::transfer::{TransferSink, TransferSinkSlot};
 use crate::types::{
     CameraModel, ConnectionInfo, ConnectionType, DiscoveredCamera, MacAddr, ToCrsdk,
 };
 use crate::Sdk;
-use crsdk_sys::DevicePropertyCode;
+use crsdk_sys::{CrChar, DevicePropertyCode};
 use std::ffi::{c_void, CString};
+use std::io::Write;
 use std::net::Ipv4Addr;
+use std::ops::ControlFlow;
+use std::path::Path;
 use std::ptr;
-use std::sync::atomic::{AtomicBool, Ordering};
+use std::sync::{Arc, Mutex};
 use std::time::Duration;
-use tokio::sync::mpsc;
 
-static SDK_INITIALIZED: AtomicBool = AtomicBool::new(false);
+/// How long the shutter button is held down for a still capture
+pub(crate) const RELEASE_HOLD: Duration = Duration::from_millis(35);
+
+/// Whether the SDK has been initialized; the lock makes callers that race
+/// the first initialization wait for it instead of initializing twice
+static SDK_INITIALIZED: Mutex<bool> = Mutex::new(false);
 
 fn ensure_sdk_initialized() -> Result<()> {
-    if !SDK_INITIALIZED.load(Ordering::Acquire) {
+    let mut initialized = SDK_INITIALIZED.lock().unwrap();
+    if !*initialized {
         let sdk = Sdk::init()?;
         std::mem::forget(sdk); // Keep SDK alive for program lifetime
-        SDK_INITIALIZED.store(true, Ordering::Release);
+        *initialized = true;
     }
     Ok(())
 }
 
+/// Initialize the SDK ahead of the first discovery or connection
+///
+/// Discovery and connecting initialize the SDK on first use, which loads the
+/// network and USB adapters and can take a noticeable moment. Call this early
+/// (e.g. on a background thread while a UI is set up) to take that off the
+/// connect path. Safe to call more than once and from several threads.
+pub fn init_sdk() -> Result<()> {
+    ensure_sdk_initialized()
+}
+
 /// Discover cameras connected via network and USB
 ///
 /// This function enumerates all cameras that are currently connected and
@@ -87,28 +120,24 @@ pub fn discover_cameras(timeout_secs: u8) -> Result<Vec<DiscoveredCamera>> {
 
 /// Parse a string field from SDK camera info.
 ///
+/// Model and device names repeat across every camera of the same body, so
+/// the result is interned rather than allocated per camera.
+///
 /// # Safety
 /// The caller must ensure `info` is a valid pointer to ICrCameraObjectInfo
 /// that remains valid for the duration of this call.
 unsafe fn parse_sdk_string(
     info: *const crsdk_sys::SCRSDK::ICrCameraObjectInfo,
-    get_ptr: unsafe extern "C" fn(*const crsdk_sys::SCRSDK::ICrCameraObjectInfo) -> *const i8,
+    get_ptr: unsafe extern "C" fn(*const crsdk_sys::SCRSDK::ICrCameraObjectInfo) -> *const CrChar,
     get_size: unsafe extern "C" fn(*const crsdk_sys::SCRSDK::ICrCameraObjectInfo) -> u32,
-) -> String {
+) -> Arc<str> {
     // SAFETY: Caller guarantees info is valid. The SDK returns a pointer to
     // internal buffer that is valid for the lifetime of the enumeration.
     let ptr = unsafe { get_ptr(info) };
     let size = unsafe { get_size(info) };
-    if ptr.is_null() || size == 0 {
-        String::new()
-    } else {
-        // SAFETY: We verified ptr is non-null and size is from the SDK.
-        // The SDK guarantees the buffer contains at least `size` bytes.
-        let slice = unsafe { std::slice::from_raw_parts(ptr as *const u8, size as usize) };
-        String::from_utf8_lossy(slice)
-            .trim_end_matches('\0')
-            .to_string()
-    }
+    // SAFETY: The SDK guarantees the buffer holds `size` code units; the
+    // borrowed text is interned before the enumeration can go away.
+    sdk_string::intern(&unsafe { sdk_string::decode(ptr, Some(size as usize)) })
 }
 
 fn camera_info_from_sdk(
@@ -141,10 +170,9 @@ fn camera_info_from_sdk(
             ));
         }
         // SAFETY: SDK guarantees null-terminated string if pointer is non-null
-        let cstr = std::ffi::CStr::from_ptr(ptr);
-        let type_str = cstr.to_str().unwrap_or("");
+        let type_str = sdk_string::decode(ptr, None);
         // SDK returns "IP" for network connections and "USB" for USB connections
-        match type_str {
+        match type_str.as_ref() {
             "IP" => ConnectionType::Network,
             "USB" => ConnectionType::Usb,
             other => {
@@ -236,28 +264,64 @@ fn create_camera_info(
     Ok(camera_info_ptr)
 }
 
+/// Check that a property accepts a write of `value`
+pub(crate) fn check_writable_value(prop: &DeviceProperty, value: u64) -> Result<()> {
+    if !prop.is_writable() {
+        return Err(Error::PropertyNotWritable);
+    }
+
+    if !prop.is_valid_value(value) {
+        return Err(Error::InvalidPropertyValue);
+    }
+
+    Ok(())
+}
+
 /// A connected camera device (blocking/synchronous API)
 pub struct CameraDevice {
     handle: i64,
     model: CameraModel,
+    /// Where property and command calls go (the SDK, unless built with a mock)
+    backend: Arc<dyn SdkBackend>,
+    /// Latency of the SDK calls made through `backend` (and of Connect)
+    sdk_metrics: SdkCallMetrics,
     /// Event receiver - events from SDK callbacks arrive here
-    event_receiver: mpsc::UnboundedReceiver<CameraEvent>,
+    event_receiver: EventReceiver,
+    /// Counters of the event queue, readable after the receiver is taken
+    event_stats: EventStatsHandle,
     /// Callback pointer - must be destroyed when device is dropped
     callback_ptr: *mut crsdk_sys::SCRSDK::IDeviceCallback,
     /// Event sender pointer - must be reclaimed when device is dropped
     event_sender_ptr: *mut c_void,
+    /// Property snapshot cache (only when enabled on the builder)
+    property_cache: Option<PropertyCache>,
+    /// Active sink for in-memory transfer data, shared with the event sender
+    transfer_sink: TransferSinkSlot,
+    /// AF results and shot confirmations, fed by the event sender
+    shot_signals: ShotSignals,
+    /// Property changes reported by the camera, fed by the event sender
+    property_signals: PropertySignals,
+    /// Live view worker thread (while streaming)
+    live_view: Mutex<Option<LiveViewWorker>>,
+    /// Drainer of the callback's event ring (only when enabled on the builder)
+    event_ring: Option<EventRingWorker>,
 }
 
 // SAFETY: CameraDevice can be sent between threads because:
 // - handle is just an i64
 // - model is Copy
-// - event_receiver is Send
-// - callback_ptr and event_sender_ptr are only accessed in Drop
+// - backend is Send + Sync by trait bound
+// - event_receiver, property_cache, transfer_sink, shot_signals, property_signals and
+//   live_view are Send
+// - callback_ptr and event_sender_ptr are only accessed in Drop, and
+//   event_sender_ptr through a shared reference in replay_callbacks, the same
+//   way SDK callback threads use it
 unsafe impl Send for CameraDevice {}
 
 // SAFETY: CameraDevice can be shared between threads because:
-// - All mutable state access goes through the SDK which handles synchronization
-// - The raw pointers (callback_ptr, event_sender_ptr) are only accessed in Drop
+// - All mutable state access goes through the SDK (or a Sync backend)
+// - The raw pointers (callback_ptr, event_sender_ptr) are only accessed in Drop,
+//   apart from callback replay, which only reads through the EventSender
 // - The event_receiver is accessed via &mut self (exclusive access)
 unsafe impl Sync for CameraDevice {}
 
@@ -277,80 +341,148 @@ impl CameraDevice {
     /// Get a property from the camera
     ///
     /// Returns the property with its current value, possible values, and metadata.
+    /// Only the requested property is fetched from the camera.
     #[async_wrap]
     pub fn get_property(&self, code: DevicePropertyCode) -> Result<DeviceProperty> {
-        let mut properties_ptr: *mut crsdk_sys::SCRSDK::CrDeviceProperty = ptr::null_mut();
-        let mut num_properties: i32 = 0;
-
-        let result = unsafe {
-            crsdk_sys::SCRSDK::GetDeviceProperties(
-                self.handle,
-                &mut properties_ptr,
-                &mut num_properties,
-            )
-        };
+        self.get_properties(&[code])?
+            .into_iter()
+            .next()
+            .ok_or(Error::PropertyNotSupported)
+    }
 
-        if result != 0 {
-            return Err(Error::from_sdk_error(result as u32));
+    /// Get a set of properties from the camera in a single round trip
+    ///
+    /// Uses the SDK's selective property fetch so only the requested codes are
+    /// transferred. Properties the camera doesn't expose are omitted from the
+    /// result, so the returned vector may be shorter than `codes`.
+    #[async_wrap]
+    pub fn get_properties(&self, codes: &[DevicePropertyCode]) -> Result<Vec<DeviceProperty>> {
+        if codes.is_empty() {
+            return Ok(Vec::new());
         }
 
-        if properties_ptr.is_null() || num_properties == 0 {
-            return Err(Error::PropertyNotSupported);
-        }
+        let mut raw_codes: Vec<u32> = codes.iter().map(|c| c.as_raw()).collect();
+        let list = self.sdk_metrics.time(SdkCall::GetSelectProperties, || {
+            self.backend
+                .get_select_properties(self.handle, &mut raw_codes)
+        })?;
+
+        let properties = list
+            .as_slice()
+            .iter()
+            // The SDK may return entries for codes we didn't ask for
+            .filter(|prop| raw_codes.contains(&prop.code))
+            // SAFETY: backends hand out SDK-layout properties
+            .map(|prop| unsafe { device_property_from_sdk(prop) })
+            .collect();
 
-        let target_code = code.as_raw();
-        let mut found_property: Option<DeviceProperty> = None;
+        Ok(properties)
+    }
 
-        unsafe {
-            for i in 0..num_properties as usize {
-                let prop = &*properties_ptr.add(i);
-                if prop.code == target_code {
-                    found_property = Some(device_property_from_sdk(prop));
-                    break;
-                }
-            }
+    /// Get a property, serving it from the property cache when possible
+    ///
+    /// Falls back to `get_property()` (and caches the result) when caching is
+    /// disabled or the camera has reported a change since the snapshot was taken.
+    #[async_wrap]
+    pub fn get_property_cached(&self, code: DevicePropertyCode) -> Result<DeviceProperty> {
+        let Some(cache) = &self.property_cache else {
+            return self.get_property(code);
+        };
 
-            crsdk_sys::SCRSDK::ReleaseDeviceProperties(self.handle, properties_ptr);
+        if let Some(prop) = cache.get_fresh(code) {
+            return Ok(prop);
         }
 
-        found_property.ok_or(Error::PropertyNotSupported)
+        let generation = cache.generation();
+        let prop = self.get_property(code)?;
+        cache.apply(generation, &[], vec![prop.clone()]);
+        Ok(prop)
     }
 
-    /// Get all properties from the camera
+    /// Get the property cache, if it was enabled on the builder
+    pub fn property_cache(&self) -> Option<&PropertyCache> {
+        self.property_cache.as_ref()
+    }
+
+    /// Route in-memory transfer data into `sink` instead of the event channel
     ///
-    /// Returns all properties the camera currently exposes.
-    /// Useful for debugging what properties are available.
+    /// While a sink is installed, each chunk is handed to it on the SDK thread
+    /// and only a `RemoteTransferProgress` event is queued. Pass `None` to go
+    /// back to `RemoteTransferData` events.
+    pub fn set_transfer_sink(&self, sink: Option<Arc<dyn TransferSink>>) {
+        self.transfer_sink.set(sink);
+    }
+
+    /// Bring the property cache up to date and return what changed
+    ///
+    /// The first call fills the cache with every property. Later calls only
+    /// re-read codes the camera reported as changed, in one batched fetch.
     #[async_wrap]
-    pub fn get_all_properties(&self) -> Result<Vec<DeviceProperty>> {
-        let mut properties_ptr: *mut crsdk_sys::SCRSDK::CrDeviceProperty = ptr::null_mut();
-        let mut num_properties: i32 = 0;
+    pub fn refresh_properties(&self) -> Result<Vec<PropertyDiff>> {
+        let cache = self.enabled_property_cache()?;
+        let generation = cache.generation();
 
-        let result = unsafe {
-            crsdk_sys::SCRSDK::GetDeviceProperties(
-                self.handle,
-                &mut properties_ptr,
-                &mut num_properties,
-            )
-        };
+        if !cache.is_complete() {
+            let properties = self.get_all_properties()?;
+            return Ok(cache.apply_all(generation, properties));
+        }
 
-        if result != 0 {
-            return Err(Error::from_sdk_error(result as u32));
+        let stale = cache.stale_codes();
+        if stale.is_empty() {
+            return Ok(Vec::new());
         }
 
-        if properties_ptr.is_null() || num_properties == 0 {
+        let properties = self.get_properties(&stale)?;
+        Ok(cache.apply(generation, &stale, properties))
+    }
+
+    /// Read a few properties into the cache ahead of the full refresh
+    ///
+    /// For staged startup: fetch what a UI needs first (exposure, battery,
+    /// media) in one small round trip, show it, then call
+    /// `refresh_properties()` for the rest. Codes already cached and fresh
+    /// aren't re-read, and the ones read here come back from the refresh only
+    /// if they changed again in between.
+    #[async_wrap]
+    pub fn prefetch_properties(&self, codes: &[DevicePropertyCode]) -> Result<Vec<PropertyDiff>> {
+        let cache = self.enabled_property_cache()?;
+        let generation = cache.generation();
+
+        let wanted: Vec<_> = codes
+            .iter()
+            .copied()
+            .filter(|&code| cache.get_fresh(code).is_none())
+            .collect();
+        if wanted.is_empty() {
             return Ok(Vec::new());
         }
 
-        let mut properties = Vec::with_capacity(num_properties as usize);
+        let properties = self.get_properties(&wanted)?;
+        Ok(cache.apply(generation, &wanted, properties))
+    }
 
-        unsafe {
-            for i in 0..num_properties as usize {
-                let prop = &*properties_ptr.add(i);
-                properties.push(device_property_from_sdk(prop));
-            }
+    fn enabled_property_cache(&self) -> Result<&PropertyCache> {
+        self.property_cache
+            .as_ref()
+            .ok_or_else(|| Error::Other("Property cache is not enabled".to_string()))
+    }
 
-            crsdk_sys::SCRSDK::ReleaseDeviceProperties(self.handle, properties_ptr);
-        }
+    /// Get all properties from the camera
+    ///
+    /// Returns all properties the camera currently exposes.
+    /// Useful for debugging what properties are available.
+    #[async_wrap]
+    pub fn get_all_properties(&self) -> Result<Vec<DeviceProperty>> {
+        let list = self.sdk_metrics.time(SdkCall::GetAllProperties, || {
+            self.backend.get_all_properties(self.handle)
+        })?;
+
+        let properties = list
+            .as_slice()
+            .iter()
+            // SAFETY: backends hand out SDK-layout properties
+            .map(|prop| unsafe { device_property_from_sdk(prop) })
+            .collect();
 
         Ok(properties)
     }
@@ -358,35 +490,16 @@ impl CameraDevice {
     /// Get all properties with debug info (for debugging SDK values)
     #[async_wrap]
     pub fn get_all_properties_debug(&self) -> Result<Vec<(DeviceProperty, String)>> {
-        let mut properties_ptr: *mut crsdk_sys::SCRSDK::CrDeviceProperty = ptr::null_mut();
-        let mut num_properties: i32 = 0;
+        let list = self.sdk_metrics.time(SdkCall::GetAllProperties, || {
+            self.backend.get_all_properties(self.handle)
+        })?;
 
-        let result = unsafe {
-            crsdk_sys::SCRSDK::GetDeviceProperties(
-                self.handle,
-                &mut properties_ptr,
-                &mut num_properties,
-            )
-        };
-
-        if result != 0 {
-            return Err(Error::from_sdk_error(result as u32));
-        }
-
-        if properties_ptr.is_null() || num_properties == 0 {
-            return Ok(Vec::new());
-        }
-
-        let mut properties = Vec::with_capacity(num_properties as usize);
-
-        unsafe {
-            for i in 0..num_properties as usize {
-                let prop = &*properties_ptr.add(i);
-                properties.push(device_property_from_sdk_debug(prop));
-            }
-
-            crsdk_sys::SCRSDK::ReleaseDeviceProperties(self.handle, properties_ptr);
-        }
+        let properties = list
+            .as_slice()
+            .iter()
+            // SAFETY: backends hand out SDK-layout properties
+            .map(|prop| unsafe { device_property_from_sdk_debug(prop) })
+            .collect();
 
         Ok(properties)
     }
@@ -395,18 +508,24 @@ impl CameraDevice {
     ///
     /// The value should be a raw u64 value. Use the enum's `as_raw()` method
     /// for enumerated properties like FocusMode or WhiteBalance.
+    ///
+    /// With the property cache enabled, validation uses the cached snapshot
+    /// when it is fresh, and the written value is recorded in the cache.
     #[async_wrap]
     pub fn set_property(&self, code: DevicePropertyCode, value: u64) -> Result<()> {
-        let prop = self.get_property(code)?;
-
-        if !prop.is_writable() {
-            return Err(Error::PropertyNotWritable);
-        }
-
-        if !prop.is_valid_value(value) {
-            return Err(Error::InvalidPropertyValue);
-        }
+        let prop = self.get_property_cached(code)?;
+        check_writable_value(&prop, value)?;
+        self.set_property_unchecked(code, value)
+    }
 
+    /// Set a property value without reading it back first
+    ///
+    /// Issues exactly one SDK call. The camera still rejects values it doesn't
+    /// accept, but the error comes from the SDK instead of being
+    /// `PropertyNotWritable` or `InvalidPropertyValue`. Useful for control
+    /// wheels and exposure ramps, where the constraint is already known.
+    #[async_wrap]
+    pub fn set_property_unchecked(&self, code: DevicePropertyCode, value: u64) -> Result<()> {
         let mut sdk_prop = crsdk_sys::SCRSDK::CrDeviceProperty {
             code: code.as_raw(),
             valueType: 0,
@@ -420,15 +539,113 @@ impl CameraDevice {
             getSetValues: ptr::null_mut(),
         };
 
-        let result = unsafe { crsdk_sys::SCRSDK::SetDeviceProperty(self.handle, &mut sdk_prop) };
+        self.sdk_metrics.time(SdkCall::SetProperty, || {
+            self.backend.set_property(self.handle, &mut sdk_prop)
+        })?;
 
-        if result != 0 {
-            return Err(Error::from_sdk_error(result as u32));
+        if let Some(cache) = &self.property_cache {
+            cache.write_through(code, value);
+        }
+
+        Ok(())
+    }
+
+    /// Set several property values at once
+    ///
+    /// Every value is validated before anything is written, using one batched
+    /// read (or the property cache, when enabled and fresh). The writes are
+    /// then issued in order; if one fails, the earlier ones stay applied.
+    ///
+    /// ```no_run
+    /// # use crsdk::{blocking::CameraDevice, DevicePropertyCode};
+    /// # fn example(camera: &CameraDevice) -> crsdk::Result<()> {
+    /// camera.set_properties(&[
+    ///     (DevicePropertyCode::IsoSensitivity, 400),
+    ///     (DevicePropertyCode::ShutterSpeed, 0x0001_00C8), // 1/200
+    ///     (DevicePropertyCode::FNumber, 560),              // f/5.6
+    /// ])?;
+    /// # Ok(())
+    /// # }
+    /// ```
+    #[async_wrap]
+    pub fn set_properties(&self, values: &[(DevicePropertyCode, u64)]) -> Result<()> {
+        let codes: Vec<_> = values.iter().map(|&(code, _)| code).collect();
+        let known = self.properties_for_write(&codes)?;
+
+        for &(code, value) in values {
+            let prop = known
+                .iter()
+                .find(|p| p.code == code.as_raw())
+                .ok_or(Error::PropertyNotSupported)?;
+            check_writable_value(prop, value)?;
+        }
+
+        for &(code, value) in values {
+            self.set_property_unchecked(code, value)?;
         }
 
         Ok(())
     }
 
+    /// Apply a preset: several values, written in dependency order
+    ///
+    /// Properties that depend on another one in the preset (e.g.
+    /// `ShutterSpeed` on `ExposureProgramMode`) are written only after the
+    /// camera has reported that change, waiting up to `timeout` per stage
+    /// (see [`DEFAULT_PRESET_TIMEOUT`](crate::DEFAULT_PRESET_TIMEOUT)).
+    /// Writes within a stage go out back to back. Unlike
+    /// [`set_properties`](Self::set_properties), a value that is refused
+    /// doesn't stop the rest; the report says which values stuck.
+    ///
+    /// ```no_run
+    /// # use crsdk::{blocking::CameraDevice, DevicePropertyCode, DEFAULT_PRESET_TIMEOUT};
+    /// # fn example(camera: &CameraDevice) -> crsdk::Result<()> {
+    /// let report = camera.apply_preset(
+    ///     &[
+    ///         (DevicePropertyCode::ShutterSpeed, 0x0001_00C8), // 1/200
+    ///         (DevicePropertyCode::ExposureProgramMode, 0x0001), // manual
+    ///     ],
+    ///     DEFAULT_PRESET_TIMEOUT,
+    /// )?;
+    /// for entry in report.failures() {
+    ///     eprintln!("{:?}: {:?}", entry.code, entry.outcome);
+    /// }
+    /// # Ok(())
+    /// # }
+    /// ```
+    #[async_wrap]
+    pub fn apply_preset(
+        &self,
+        preset: &[(DevicePropertyCode, u64)],
+        timeout: Duration,
+    ) -> Result<PresetReport> {
+        preset::apply(self, preset, timeout)
+    }
+
+    /// Snapshots to validate writes against, from the cache where fresh
+    fn properties_for_write(&self, codes: &[DevicePropertyCode]) -> Result<Vec<DeviceProperty>> {
+        let mut known = Vec::with_capacity(codes.len());
+        let mut missing = Vec::new();
+
+        for &code in codes {
+            match self.property_cache.as_ref().and_then(|c| c.get_fresh(code)) {
+                Some(prop) => known.push(prop),
+                None => missing.push(code),
+            }
+        }
+
+        if !missing.is_empty() {
+            let generation = self.property_cache.as_ref().map(|c| c.generation());
+            let fetched = self.get_properties(&missing)?;
+            if let (Some(cache), Some(generation)) = (&self.property_cache, generation) {
+                cache.apply(generation, &[], fetched.clone());
+            }
+            known.extend(fetched);
+        }
+
+        Ok(known)
+    }
+
     // -------------------------------------------------------------------------
     // Convenience methods for common properties
     // -------------------------------------------------------------------------
@@ -568,16 +785,11 @@ impl CameraDevice {
     // -------------------------------------------------------------------------
 
     /// Send a command to the camera
-    fn send_command(&self, command: CommandId, param: CommandParam) -> Result<()> {
-        let result = unsafe {
-            crsdk_sys::SCRSDK::SendCommand(self.handle, command.as_raw(), param.as_raw() as u16)
-        };
-
-        if result != 0 {
-            return Err(Error::from_sdk_error(result as u32));
-        }
-
-        Ok(())
+    pub(crate) fn send_command(&self, command: CommandId, param: CommandParam) -> Result<()> {
+        self.sdk_metrics.time(SdkCall::SendCommand, || {
+            self.backend
+                .send_command(self.handle, command.as_raw(), param.as_raw() as u16)
+        })
     }
 
     /// Set the S1 (half-press shutter) lock state for autofocus
@@ -595,13 +807,9 @@ impl CameraDevice {
             getSetValues: ptr::null_mut(),
         };
 
-        let result = unsafe { crsdk_sys::SCRSDK::SetDeviceProperty(self.handle, &mut sdk_prop) };
-
-        if result != 0 {
-            return Err(Error::from_sdk_error(result as u32));
-        }
-
-        Ok(())
+        self.sdk_metrics.time(SdkCall::SetProperty, || {
+            self.backend.set_property(self.handle, &mut sdk_prop)
+        })
     }
 
     /// Take a photo (shutter release)
@@ -611,11 +819,26 @@ impl CameraDevice {
     #[async_wrap]
     pub fn capture(&self) -> Result<()> {
         self.send_command(CommandId::Release, CommandParam::Down)?;
-        std::thread::sleep(Duration::from_millis(35));
+        std::thread::sleep(RELEASE_HOLD);
         self.send_command(CommandId::Release, CommandParam::Up)?;
         Ok(())
     }
 
+    /// Take a photo and wait until the camera confirms it was saved
+    ///
+    /// Returns once `OnCompleteDownload` or a contents-transfer completion
+    /// reports the shot, with the filename if the camera gave one. Fails with
+    /// [`Error::Timeout`] if no confirmation arrives within `timeout`, e.g.
+    /// when the camera saves to its card only and doesn't notify the host.
+    #[async_wrap]
+    pub fn capture_and_wait(&self, timeout: Duration) -> Result<Option<String>> {
+        let mark = self.shot_signals.mark();
+        self.capture()?;
+        self.shot_signals
+            .wait_shot(mark, timeout)
+            .ok_or(Error::Timeout)
+    }
+
     /// Half-press the shutter to activate autofocus
     ///
     /// This is equivalent to pressing the shutter button halfway on a physical camera.
@@ -634,19 +857,66 @@ impl CameraDevice {
         self.set_s1_lock(LockIndicator::Unlocked)
     }
 
+    /// Half-press the shutter and wait for the autofocus result
+    ///
+    /// Returns the settled AF status (focused or not) as soon as the camera
+    /// reports it. The shutter stays half-pressed; call `capture()` and/or
+    /// `release_shutter()` next. Fails with [`Error::Timeout`] if the camera
+    /// reports no result within `timeout`.
+    #[async_wrap]
+    pub fn focus(&self, timeout: Duration) -> Result<AfStatus> {
+        let mark = self.shot_signals.mark();
+        self.half_press_shutter()?;
+        self.shot_signals
+            .wait_af(mark, timeout)
+            .ok_or(Error::Timeout)
+    }
+
+    /// Check the (cached) focus mode for MF, where no AF result ever comes
+    ///
+    /// An unreadable focus mode counts as AF, so callers still wait.
+    pub(crate) fn is_manual_focus(&self) -> bool {
+        self.get_property_cached(DevicePropertyCode::FocusMode)
+            .is_ok_and(|prop| FocusMode::from_raw(prop.current_value) == Some(FocusMode::Manual))
+    }
+
     /// Autofocus and capture in one operation
     ///
-    /// Half-presses to focus, waits briefly, then captures the image.
-    /// This is a convenience method that combines `half_press_shutter()` + delay + `capture()`.
+    /// Half-presses to focus, waits for the camera to report the AF result
+    /// (up to [`DEFAULT_AF_TIMEOUT`]), then captures the image. If no result
+    /// arrives in time the shot is taken anyway and the camera's release
+    /// priority setting decides. In MF there is nothing to wait for, so the
+    /// image is captured straight away.
     #[async_wrap]
     pub fn focus_and_capture(&self) -> Result<()> {
-        self.half_press_shutter()?;
-        std::thread::sleep(Duration::from_millis(500));
+        if self.is_manual_focus() {
+            return self.capture();
+        }
+        match self.focus(DEFAULT_AF_TIMEOUT) {
+            Ok(status) => tracing::debug!("AF settled: {:?}", status),
+            Err(Error::Timeout) => tracing::debug!("No AF result, capturing anyway"),
+            Err(e) => return Err(e),
+        }
         self.capture()?;
         self.release_shutter()?;
         Ok(())
     }
 
+    /// Shoot on a fixed host-timed schedule (timelapse)
+    ///
+    /// Runs `plan` on this thread until every slot has run, the card fills
+    /// up, or `progress` returns [`ControlFlow::Break`]. `progress` is called
+    /// once per slot, after the camera has had the chance to reject the shot.
+    /// See [`IntervalPlan`] for scheduling, buffer handling and exposure
+    /// ramps.
+    pub fn run_interval(
+        &self,
+        plan: &IntervalPlan,
+        mut progress: impl FnMut(&IntervalShot) -> ControlFlow<()>,
+    ) -> Result<IntervalReport> {
+        interval::run(self, plan, &mut progress)
+    }
+
     /// Start movie recording
     ///
     /// The camera must be in a mode that supports movie recording (Movie mode).
@@ -667,7 +937,34 @@ impl CameraDevice {
     /// Returns `None` if no events are currently available.
     /// For async code, use `events()` to get a stream instead.
     pub fn try_recv_event(&mut self) -> Option<CameraEvent> {
-        self.event_receiver.try_recv().ok()
+        self.event_receiver.try_recv()
+    }
+
+    /// Event queue counters (queued, dropped and coalesced events)
+    pub fn event_stats(&self) -> EventStats {
+        self.event_stats.stats()
+    }
+
+    /// Latency histograms and queue gauges measured so far
+    ///
+    /// Covers SDK call latency (Connect, property reads and writes, commands),
+    /// the time each kind of event waited between the SDK callback and
+    /// `recv_event`, and the event queue's counters.
+    pub fn metrics(&self) -> MetricsSnapshot {
+        MetricsSnapshot::new(
+            self.sdk_metrics.snapshot(),
+            self.event_stats.latencies(),
+            self.event_stats.stats(),
+        )
+    }
+
+    /// Feed a recorded callback stream through this device's event path
+    ///
+    /// Callbacks enter at the same FFI entry points the SDK uses, so the
+    /// event queue, property cache and capture helpers see them exactly as
+    /// they would live. Blocks until the last callback has been delivered.
+    pub fn replay_callbacks(&self, recording: &CallbackRecording, timing: ReplayTiming) {
+        crate::backend::replay(self.event_sender_ptr, recording, timing);
     }
 
     /// Take the event receiver for use with async code
@@ -675,12 +972,207 @@ impl CameraDevice {
     /// This consumes the receiver from this device. After calling this,
     /// `try_recv_event()` will always return `None`.
     ///
-    /// The returned receiver implements `Stream` and can be used with
+    /// The returned receiver can be used with
     /// `while let Some(event) = receiver.recv().await { ... }`
-    pub fn take_event_receiver(&mut self) -> mpsc::UnboundedReceiver<CameraEvent> {
-        // Replace with a dummy channel - the sender is never used
-        let (_, dummy_receiver) = mpsc::unbounded_channel();
-        std::mem::replace(&mut self.event_receiver, dummy_receiver)
+    pub fn take_event_receiver(&mut self) -> EventReceiver {
+        std::mem::replace(&mut self.event_receiver, EventReceiver::closed())
+    }
+
+    /// Hand back a receiver taken with `take_event_receiver()`
+    pub(crate) fn restore_event_receiver(&mut self, receiver: EventReceiver) {
+        self.event_receiver = receiver;
+    }
+
+    // -------------------------------------------------------------------------
+    // Live view
+    // -------------------------------------------------------------------------
+
+    /// Start streaming live view frames
+    ///
+    /// Spawns a dedicated thread that fetches frames at `config.fps` into
+    /// reusable buffers and publishes only the latest one. If a stream is
+    /// already running it is restarted with the new config; existing
+    /// receivers see the old stream end.
+    #[async_wrap]
+    pub fn start_live_view(&self, config: LiveViewConfig) -> Result<LiveViewReceiver> {
+        let mut live_view = self.live_view.lock().unwrap();
+        // Stop the old worker first so two threads never poll the camera
+        live_view.take();
+        let worker = LiveViewWorker::spawn(self.handle, config)?;
+        let receiver = worker.subscribe();
+        *live_view = Some(worker);
+        Ok(receiver)
+    }
+
+    /// Another receiver for the running live view stream, if any
+    pub fn live_view_receiver(&self) -> Option<LiveViewReceiver> {
+        self.live_view
+            .lock()
+            .unwrap()
+            .as_ref()
+            .map(LiveViewWorker::subscribe)
+    }
+
+    /// Analyze the running live view stream's frames on `pool`
+    ///
+    /// Each new frame is decoded on one of the pool's threads and reduced to
+    /// exposure histograms and a sharpness score inside the camera's focus
+    /// frame (start live view with `frame_info` for the camera's focus frame;
+    /// otherwise the centre of the image is used). Replaces any earlier
+    /// analysis of this stream; the receiver ends when live view stops or
+    /// restarts.
+    #[async_wrap]
+    pub fn start_live_view_analysis(&self, pool: &AnalysisPool) -> Result<AnalysisReceiver> {
+        let live_view = self.live_view.lock().unwrap();
+        let worker = live_view
+            .as_ref()
+            .ok_or_else(|| Error::Other("Live view is not running".to_string()))?;
+        Ok(worker.attach_analysis(pool))
+    }
+
+    /// Stop streaming live view frames
+    ///
+    /// Waits for the worker thread to finish its current frame.
+    #[async_wrap]
+    pub fn stop_live_view(&self) {
+        self.live_view.lock().unwrap().take();
+    }
+
+    // -------------------------------------------------------------------------
+    // Content download
+    // -------------------------------------------------------------------------
+
+    /// List the files stored on a memory card slot (1 or 2)
+    #[async_wrap]
+    pub fn list_contents(&self, slot: u32) -> Result<Vec<ContentFile>> {
+        let mut files = vec![crsdk_sys::CrsdkContentFile::default(); 256];
+        loop {
+            let mut err = 0u32;
+            // SAFETY: files holds files.len() entries, the capacity passed in
+            let total = unsafe {
+                crsdk_sys::crsdk_contents_list(
+                    self.handle,
+                    slot,
+                    files.as_mut_ptr(),
+                    files.len() as u32,
+                    &mut err,
+                )
+            } as usize;
+
+            if total == 0 && err != 0 {
+                return Err(Error::from_sdk_error(err));
+            }
+            if total <= files.len() {
+                return Ok(files[..total]
+                    .iter()
+                    .map(|file| ContentFile::from_sdk(slot, file))
+                    .collect());
+            }
+            // The card holds more than we asked for; retry with room for all
+            files.resize(total, crsdk_sys::CrsdkContentFile::default());
+        }
+    }
+
+    /// Download one file into `writer` as its data arrives
+    ///
+    /// Returns the number of bytes written. Uses the device's transfer sink
+    /// slot, so a sink installed with `set_transfer_sink()` is removed.
+    pub fn download_content_to<W: Write + Send + 'static>(
+        &self,
+        file: &ContentFile,
+        writer: W,
+        config: &DownloadConfig,
+    ) -> Result<u64> {
+        Ok(download::download_to(self, file, writer, 0, config)?.written)
+    }
+
+    /// Download files into `dir`, one after another
+    ///
+    /// Each file goes to [`ContentFile::local_path`] under `dir`. Complete
+    /// files already there are skipped and partial ones resumed
+    /// (see [`DownloadConfig::resume`]). `progress` is called after each
+    /// file with the running totals. Uses the device's transfer sink slot,
+    /// so a sink installed with `set_transfer_sink()` is removed.
+    pub fn download_contents(
+        &self,
+        files: &[ContentFile],
+        dir: &Path,
+        config: &DownloadConfig,
+        mut progress: impl FnMut(&ContentFile, &DownloadStats),
+    ) -> Result<DownloadStats> {
+        download::download_all(self, files, dir, config, &mut progress)
+    }
+}
+
+impl PresetTarget for CameraDevice {
+    fn property_signals(&self) -> &PropertySignals {
+        &self.property_signals
+    }
+
+    fn read_for_write(&self, codes: &[DevicePropertyCode]) -> Result<Vec<DeviceProperty>> {
+        self.properties_for_write(codes)
+    }
+
+    fn read_back(&self, codes: &[DevicePropertyCode]) -> Result<Vec<DeviceProperty>> {
+        self.get_properties(codes)
+    }
+
+    fn write(&self, code: DevicePropertyCode, value: u64) -> Result<()> {
+        self.set_property_unchecked(code, value)
+    }
+}
+
+impl IntervalTarget for CameraDevice {
+    fn shot_signals(&self) -> &ShotSignals {
+        &self.shot_signals
+    }
+
+    fn set_half_press(&self, pressed: bool) -> Result<()> {
+        self.set_s1_lock(if pressed {
+            LockIndicator::Locked
+        } else {
+            LockIndicator::Unlocked
+        })
+    }
+
+    fn set_release(&self, pressed: bool) -> Result<()> {
+        let param = if pressed {
+            CommandParam::Down
+        } else {
+            CommandParam::Up
+        };
+        self.send_command(CommandId::Release, param)
+    }
+
+    fn read_property(&self, code: DevicePropertyCode) -> Result<DeviceProperty> {
+        self.get_property(code)
+    }
+
+    fn write_property(&self, code: DevicePropertyCode, value: u64) -> Result<()> {
+        self.set_property(code, value)
+    }
+}
+
+impl PullTarget for CameraDevice {
+    fn set_sink(&self, sink: Option<Arc<dyn TransferSink>>) {
+        self.transfer_sink.set(sink);
+    }
+
+    fn start_pull(&self, file: &ContentFile, chunk_size: u32) -> Result<()> {
+        // SAFETY: plain values; the data arrives later through the callback
+        let result = unsafe {
+            crsdk_sys::crsdk_contents_pull(
+                self.handle,
+                file.slot,
+                file.content_id,
+                file.file_id,
+                chunk_size,
+            )
+        };
+        if result != 0 {
+            return Err(Error::from_sdk_error(result));
+        }
+        Ok(())
     }
 }
 
@@ -696,6 +1188,9 @@ impl Drop for CameraDevice {
         // 4. Reclaim EventSender - safe because callback is destroyed.
         //
         // This order ensures no callbacks can fire after we free memory.
+        // The live view thread is stopped before all of it, since it polls
+        // the SDK with our handle.
+        self.live_view.get_mut().unwrap().take();
 
         if self.handle != 0 {
             // SAFETY: handle is valid if non-zero, obtained from SDK Connect
@@ -705,6 +1200,10 @@ impl Drop for CameraDevice {
             }
         }
 
+        // The ring drainer reads from the callback, so it goes before it,
+        // delivering whatever the last callbacks queued
+        self.event_ring.take();
+
         if !self.callback_ptr.is_null() {
             // SAFETY: callback_ptr was created by crsdk_create_rust_callback
             // and SDK callbacks are complete after Disconnect()
@@ -728,6 +1227,26 @@ impl Drop for CameraDevice {
 pub struct CameraDeviceBuilder {
     info: ConnectionInfo,
     camera_info_ptr: Option<*mut crsdk_sys::SCRSDK::ICrCameraObjectInfo>,
+    property_cache: bool,
+    event_channel: EventChannelConfig,
+    callback_recorder: Option<CallbackRecorder>,
+    /// Saved snapshot the property cache starts out with
+    warm_properties: Vec<DeviceProperty>,
+    /// Capacity of the callback's event ring (0 = call into Rust directly)
+    event_ring: usize,
+}
+
+/// Event plumbing shared by every way of building a device
+struct EventWiring {
+    sender: EventSender,
+    receiver: EventReceiver,
+    stats: EventStatsHandle,
+    property_cache: Option<PropertyCache>,
+    transfer_sink: TransferSinkSlot,
+    shot_signals: ShotSignals,
+    property_signals: PropertySignals,
+    /// Consumer of the callback's event ring (if enabled)
+    ring: Option<Arc<RingConsumer>>,
 }
 
 impl CameraDeviceBuilder {
@@ -774,6 +1293,70 @@ impl CameraDeviceBuilder {
         self
     }
 
+    /// Enable the property snapshot cache
+    ///
+    /// See [`PropertyCache`] for details. Disabled by default.
+    pub fn property_cache(mut self, enabled: bool) -> Self {
+        self.property_cache = enabled;
+        self
+    }
+
+    /// Set the event queue capacity and overflow policies
+    ///
+    /// See [`EventChannelConfig`] for the defaults.
+    pub fn event_channel(mut self, config: EventChannelConfig) -> Self {
+        self.event_channel = config;
+        self
+    }
+
+    /// Record every SDK callback the device receives into `recorder`
+    ///
+    /// The recording can be replayed later with
+    /// [`CameraDevice::replay_callbacks`].
+    pub fn callback_recorder(mut self, recorder: CallbackRecorder) -> Self {
+        self.callback_recorder = Some(recorder);
+        self
+    }
+
+    /// Queue SDK callbacks in a lock-free ring of `capacity` records
+    ///
+    /// The SDK thread then only copies each callback into the ring, and a
+    /// dedicated thread delivers them to the event queue in batches, waking
+    /// the receiver once per batch. Cache invalidation and shot signals happen
+    /// when a batch is delivered rather than inside the callback, so they can
+    /// trail the camera by one drain. Callbacks carrying strings or data
+    /// still go through directly, in order. Capacity is rounded up to a power
+    /// of two; 0 (the default) disables the ring. See
+    /// [`DEFAULT_EVENT_RING_CAPACITY`](crate::DEFAULT_EVENT_RING_CAPACITY).
+    pub fn event_ring(mut self, capacity: usize) -> Self {
+        self.event_ring = capacity;
+        self
+    }
+
+    /// Connect the way a saved profile describes
+    ///
+    /// Sets address, model (if the profile knows it) and the verified SSH
+    /// fingerprint, and enables the property cache pre-filled with the
+    /// profile's snapshot (all entries stale, so `refresh_properties()`
+    /// re-reads them). SSH still needs
+    /// [`ssh_credentials`](Self::ssh_credentials), since profiles never store
+    /// the password.
+    pub fn profile(mut self, profile: &ConnectionProfile) -> Self {
+        self.info.ip_address = Some(profile.ip_address);
+        self.info.mac_address = Some(profile.mac_address);
+        if profile.model.is_some() {
+            self.info.model = profile.model;
+        }
+        if let Some(fingerprint) = &profile.ssh_fingerprint {
+            self.info.ssh_enabled = true;
+            self.info.ssh_fingerprint = Some(fingerprint.clone());
+        }
+        self.info.ssh_user = profile.ssh_user.clone();
+        self.property_cache = true;
+        self.warm_properties = profile.properties.clone();
+        self
+    }
+
     /// Fetch SSH fingerprint from camera for user confirmation
     ///
     /// This stores the camera info internally and reuses it for connection.
@@ -835,13 +1418,34 @@ impl CameraDeviceBuilder {
         };
 
         // Create event channel and callback
-        let (event_sender, event_receiver) = mpsc::unbounded_channel();
-        let event_sender = EventSender::new(event_sender);
-        let event_sender_ptr = event_sender.into_raw();
+        let events = self.event_wiring();
+        let event_sender_ptr = events.sender.into_raw();
 
         // Create the C++ callback that will forward events to our channel
-        // SAFETY: event_sender_ptr is a valid pointer from EventSender::into_raw()
-        let callback_ptr = unsafe { crsdk_sys::crsdk_create_rust_callback(event_sender_ptr) };
+        let (callback_ptr, event_ring) = match &events.ring {
+            Some(consumer) => {
+                let worker = match EventRingWorker::spawn(event_sender_ptr, consumer.clone()) {
+                    Ok(worker) => worker,
+                    Err(e) => {
+                        // SAFETY: nothing else has seen event_sender_ptr yet
+                        let _ = unsafe { EventSender::from_raw(event_sender_ptr) };
+                        return Err(e.into());
+                    }
+                };
+                let capacity = u32::try_from(self.event_ring).unwrap_or(u32::MAX);
+                // SAFETY: event_sender_ptr is a valid pointer from EventSender::into_raw()
+                let callback_ptr = unsafe {
+                    crsdk_sys::crsdk_create_rust_callback_with_ring(event_sender_ptr, capacity)
+                };
+                consumer.attach(callback_ptr.cast());
+                (callback_ptr, Some(worker))
+            }
+            // SAFETY: event_sender_ptr is a valid pointer from EventSender::into_raw()
+            None => (
+                unsafe { crsdk_sys::crsdk_create_rust_callback(event_sender_ptr) },
+                None,
+            ),
+        };
 
         let mut device_handle: i64 = 0;
 
@@ -870,7 +1474,8 @@ impl CameraDeviceBuilder {
             .as_ref()
             .map_or(0, |s| s.len() as u32);
 
-        let result = unsafe {
+        let sdk_metrics = SdkCallMetrics::default();
+        let result = sdk_metrics.time(SdkCall::Connect, || unsafe {
             crsdk_sys::SCRSDK::Connect(
                 camera_info_ptr,
                 callback_ptr,
@@ -882,10 +1487,12 @@ impl CameraDeviceBuilder {
                 fp_ptr,
                 fp_len,
             )
-        };
+        });
 
         if result != 0 {
-            // Clean up callback and event sender on failure
+            // Clean up callback and event sender on failure, after the
+            // drainer that reads from the callback
+            drop(event_ring);
             // SAFETY: callback_ptr was just created above
             unsafe {
                 crsdk_sys::crsdk_destroy_rust_callback(callback_ptr);
@@ -897,11 +1504,85 @@ impl CameraDeviceBuilder {
         Ok(CameraDevice {
             handle: device_handle,
             model,
-            event_receiver,
+            backend: Arc::new(NativeBackend),
+            sdk_metrics,
+            event_receiver: events.receiver,
+            event_stats: events.stats,
             callback_ptr,
             event_sender_ptr,
+            property_cache: events.property_cache,
+            transfer_sink: events.transfer_sink,
+            shot_signals: events.shot_signals,
+            property_signals: events.property_signals,
+            live_view: Mutex::new(None),
+            event_ring,
         })
     }
+
+    /// Build a device that sends its property and command calls to `backend`
+    ///
+    /// Nothing is connected and the SDK is not initialized; the device has no
+    /// handle and receives callbacks only through
+    /// [`CameraDevice::replay_callbacks`]. Everything else configured on the
+    /// builder (cache, event channel, recorder) applies as usual.
+    pub fn connect_with_backend(self, backend: Arc<dyn SdkBackend>) -> CameraDevice {
+        let events = self.event_wiring();
+
+        CameraDevice {
+            handle: 0,
+            model: self.info.model.unwrap_or(CameraModel::Fx3),
+            backend,
+            sdk_metrics: SdkCallMetrics::default(),
+            event_receiver: events.receiver,
+            event_stats: events.stats,
+            callback_ptr: ptr::null_mut(),
+            event_sender_ptr: events.sender.into_raw(),
+            property_cache: events.property_cache,
+            transfer_sink: events.transfer_sink,
+            shot_signals: events.shot_signals,
+            property_signals: events.property_signals,
+            live_view: Mutex::new(None),
+            event_ring: None,
+        }
+    }
+
+    /// Create the event queue and the sender the callback feeds it through
+    fn event_wiring(&self) -> EventWiring {
+        let (queue_sender, receiver) = event_queue::channel(self.event_channel);
+        let stats = queue_sender.stats_handle();
+        let mut sender = EventSender::new(queue_sender);
+        let property_cache = self.property_cache.then(PropertyCache::new);
+        if let Some(cache) = &property_cache {
+            if !self.warm_properties.is_empty() {
+                cache.seed(self.warm_properties.clone());
+            }
+            sender = sender.with_property_cache(cache.clone());
+        }
+        let transfer_sink = TransferSinkSlot::default();
+        sender = sender.with_transfer_sink(transfer_sink.clone());
+        let shot_signals = ShotSignals::default();
+        sender = sender.with_shot_signals(shot_signals.clone());
+        let property_signals = PropertySignals::default();
+        sender = sender.with_property_signals(property_signals.clone());
+        if let Some(recorder) = &self.callback_recorder {
+            sender = sender.with_recorder(recorder.clone());
+        }
+        let ring = (self.event_ring > 0).then(|| Arc::new(RingConsumer::native()));
+        if let Some(consumer) = &ring {
+            sender = sender.with_event_ring(consumer.clone());
+        }
+
+        EventWiring {
+            sender,
+            receiver,
+            stats,
+            property_cache,
+            transfer_sink,
+            shot_signals,
+            property_signals,
+            ring,
+        }
+    }
 }
 
 impl Drop for CameraDeviceBuilder {
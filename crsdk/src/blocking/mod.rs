@@ -34,4 +34,5 @@
 mod device;
 
 pub use crate::event::CameraEvent;
-pub use device::{discover_cameras, CameraDevice, CameraDeviceBuilder};
+pub(crate) use device::{check_writable_value, RELEASE_HOLD};
+pub use device::{discover_cameras, init_sdk, CameraDevice, CameraDeviceBuilder};
@@ -3,12 +3,25 @@
 //! This module provides async wrappers around the blocking API using `block_in_place`.
 //! For synchronous code, use `crsdk::blocking` instead.
 
+use crate::backend::CallbackRecorder;
 use crate::blocking;
+use crate::download::{ContentFile, DownloadConfig, DownloadStats};
 use crate::error::{Error, Result};
 use crate::event::CameraEvent;
+use crate::event_queue::{EventChannelConfig, EventReceiver, EventStats};
+use crate::interval::{IntervalPlan, IntervalReport, IntervalShot};
+use crate::live_view::LiveViewReceiver;
+use crate::metrics::MetricsSnapshot;
+use crate::pinned::PinnedCameraDevice;
+use crate::profile::ConnectionProfile;
+use crate::property::PropertyCache;
+use crate::transfer::TransferSink;
 use crate::types::{CameraModel, ConnectionInfo, DiscoveredCamera, MacAddr};
+use std::io::Write;
 use std::net::Ipv4Addr;
-use tokio::sync::mpsc;
+use std::ops::ControlFlow;
+use std::path::Path;
+use std::sync::Arc;
 
 /// Discover cameras connected via network and USB (async version)
 ///
@@ -42,6 +55,13 @@ pub async fn discover_cameras(timeout_secs: u8) -> Result<Vec<DiscoveredCamera>>
         .map_err(|e| Error::Other(format!("Task join error: {}", e)))?
 }
 
+/// Initialize the SDK ahead of first use. See [`blocking::init_sdk`].
+pub async fn init_sdk() -> Result<()> {
+    tokio::task::spawn_blocking(blocking::init_sdk)
+        .await
+        .map_err(|e| Error::Other(format!("Task join error: {}", e)))?
+}
+
 /// A connected camera device (async API)
 ///
 /// This wraps the blocking `CameraDevice` for use with async runtimes.
@@ -50,7 +70,7 @@ pub struct CameraDevice {
     /// The underlying blocking device (public for macro-generated code)
     pub(crate) inner: blocking::CameraDevice,
     /// Event receiver - taken from the blocking device for async access
-    event_receiver: Option<mpsc::UnboundedReceiver<CameraEvent>>,
+    event_receiver: Option<EventReceiver>,
 }
 
 impl CameraDevice {
@@ -60,10 +80,29 @@ impl CameraDevice {
     }
 
     /// Get the underlying blocking device
-    pub fn into_inner(self) -> blocking::CameraDevice {
+    ///
+    /// The event receiver goes with it, so the blocking device's
+    /// `try_recv_event()` keeps working, unless it was taken with
+    /// `take_event_receiver()`.
+    pub fn into_inner(mut self) -> blocking::CameraDevice {
+        if let Some(receiver) = self.event_receiver.take() {
+            self.inner.restore_event_receiver(receiver);
+        }
         self.inner
     }
 
+    /// Get the property cache, if it was enabled on the builder
+    pub fn property_cache(&self) -> Option<&PropertyCache> {
+        self.inner.property_cache()
+    }
+
+    /// Route in-memory transfer data into `sink` instead of the event channel
+    ///
+    /// See [`blocking::CameraDevice::set_transfer_sink`].
+    pub fn set_transfer_sink(&self, sink: Option<Arc<dyn TransferSink>>) {
+        self.inner.set_transfer_sink(sink);
+    }
+
     /// Wait for the next event from the camera
     ///
     /// Returns `None` if the event channel is closed (camera disconnected)
@@ -82,7 +121,7 @@ impl CameraDevice {
     /// receiver has been taken via `take_event_receiver()`.
     pub fn try_recv_event(&mut self) -> Option<CameraEvent> {
         if let Some(ref mut receiver) = self.event_receiver {
-            receiver.try_recv().ok()
+            receiver.try_recv()
         } else {
             None
         }
@@ -105,15 +144,67 @@ impl CameraDevice {
     ///     }
     /// }
     /// ```
-    pub fn take_event_receiver(&mut self) -> Option<mpsc::UnboundedReceiver<CameraEvent>> {
+    pub fn take_event_receiver(&mut self) -> Option<EventReceiver> {
         self.event_receiver.take()
     }
+
+    /// Event queue counters (queued, dropped and coalesced events)
+    ///
+    /// Keeps working after the receiver has been taken.
+    pub fn event_stats(&self) -> EventStats {
+        self.inner.event_stats()
+    }
+
+    /// Latency histograms and queue gauges. See [`blocking::CameraDevice::metrics`].
+    pub fn metrics(&self) -> MetricsSnapshot {
+        self.inner.metrics()
+    }
+
+    /// Another receiver for the running live view stream, if any
+    pub fn live_view_receiver(&self) -> Option<LiveViewReceiver> {
+        self.inner.live_view_receiver()
+    }
+
+    /// Download one file into `writer`. See [`blocking::CameraDevice::download_content_to`].
+    pub async fn download_content_to<W: Write + Send + 'static>(
+        &self,
+        file: &ContentFile,
+        writer: W,
+        config: &DownloadConfig,
+    ) -> Result<u64> {
+        tokio::task::block_in_place(|| self.inner.download_content_to(file, writer, config))
+    }
+
+    /// Download files into `dir`. See [`blocking::CameraDevice::download_contents`].
+    pub async fn download_contents(
+        &self,
+        files: &[ContentFile],
+        dir: &Path,
+        config: &DownloadConfig,
+        progress: impl FnMut(&ContentFile, &DownloadStats),
+    ) -> Result<DownloadStats> {
+        tokio::task::block_in_place(|| self.inner.download_contents(files, dir, config, progress))
+    }
+
+    /// Shoot on a fixed host-timed schedule. See [`blocking::CameraDevice::run_interval`].
+    pub async fn run_interval(
+        &self,
+        plan: &IntervalPlan,
+        progress: impl FnMut(&IntervalShot) -> ControlFlow<()>,
+    ) -> Result<IntervalReport> {
+        tokio::task::block_in_place(|| self.inner.run_interval(plan, progress))
+    }
 }
 
 /// Builder for configuring and connecting to a camera (async API)
 #[derive(Default)]
 pub struct CameraDeviceBuilder {
     info: ConnectionInfo,
+    property_cache: bool,
+    event_channel: EventChannelConfig,
+    callback_recorder: Option<CallbackRecorder>,
+    profile: Option<ConnectionProfile>,
+    event_ring: usize,
 }
 
 impl CameraDeviceBuilder {
@@ -160,6 +251,58 @@ impl CameraDeviceBuilder {
         self
     }
 
+    /// Enable the property snapshot cache
+    ///
+    /// See [`PropertyCache`] for details. Disabled by default.
+    pub fn property_cache(mut self, enabled: bool) -> Self {
+        self.property_cache = enabled;
+        self
+    }
+
+    /// Set the event queue capacity and overflow policies
+    ///
+    /// See [`EventChannelConfig`] for the defaults.
+    pub fn event_channel(mut self, config: EventChannelConfig) -> Self {
+        self.event_channel = config;
+        self
+    }
+
+    /// Record every SDK callback the device receives into `recorder`
+    ///
+    /// See [`blocking::CameraDeviceBuilder::callback_recorder`].
+    pub fn callback_recorder(mut self, recorder: CallbackRecorder) -> Self {
+        self.callback_recorder = Some(recorder);
+        self
+    }
+
+    /// Queue SDK callbacks in a lock-free ring of `capacity` records
+    ///
+    /// See [`blocking::CameraDeviceBuilder::event_ring`].
+    pub fn event_ring(mut self, capacity: usize) -> Self {
+        self.event_ring = capacity;
+        self
+    }
+
+    /// Connect the way a saved profile describes
+    ///
+    /// See [`blocking::CameraDeviceBuilder::profile`]. The profile's verified
+    /// fingerprint is used as is, without fetching it from the camera again.
+    pub fn profile(mut self, profile: &ConnectionProfile) -> Self {
+        self.info.ip_address = Some(profile.ip_address);
+        self.info.mac_address = Some(profile.mac_address);
+        if profile.model.is_some() {
+            self.info.model = profile.model;
+        }
+        if let Some(fingerprint) = &profile.ssh_fingerprint {
+            self.info.ssh_enabled = true;
+            self.info.ssh_fingerprint = Some(fingerprint.clone());
+        }
+        self.info.ssh_user = profile.ssh_user.clone();
+        self.property_cache = true;
+        self.profile = Some(profile.clone());
+        self
+    }
+
     /// Fetch SSH fingerprint from camera for user confirmation
     pub async fn fetch_ssh_fingerprint(&mut self) -> Result<String> {
         let info = self.info.clone();
@@ -190,41 +333,9 @@ impl CameraDeviceBuilder {
 
     /// Connect to the camera asynchronously
     pub async fn connect(self) -> Result<CameraDevice> {
-        let info = self.info;
-
-        let inner = tokio::task::spawn_blocking(move || {
-            let mut builder = blocking::CameraDeviceBuilder::new();
-
-            if let Some(ip) = info.ip_address {
-                builder = builder.ip_address(ip);
-            }
-            if let Some(mac) = info.mac_address {
-                builder = builder.mac_address(mac);
-            }
-            if let Some(model) = info.model {
-                builder = builder.model(model);
-            }
-            if info.ssh_enabled {
-                builder = builder.ssh_enabled(true);
-            }
-            if let Some(user) = &info.ssh_user {
-                if let Some(pass) = &info.ssh_password {
-                    builder = builder.ssh_credentials(user, pass);
-                }
-            }
-            if let Some(fp) = info.ssh_fingerprint {
-                builder = builder.ssh_fingerprint(fp);
-            }
-
-            // For SSH, we need to fetch fingerprint again since we can't reuse across threads
-            if info.ssh_enabled && info.ssh_user.is_some() {
-                builder.fetch_ssh_fingerprint()?;
-            }
-
-            builder.connect()
-        })
-        .await
-        .map_err(|e| Error::Other(format!("Task join error: {}", e)))??;
+        let inner = tokio::task::spawn_blocking(move || self.connect_blocking())
+            .await
+            .map_err(|e| Error::Other(format!("Task join error: {}", e)))??;
 
         // Take the event receiver from the blocking device for async access
         let mut inner = inner;
@@ -235,11 +346,74 @@ impl CameraDeviceBuilder {
             event_receiver,
         })
     }
+
+    /// Connect to the camera on a dedicated worker thread
+    ///
+    /// The returned [`PinnedCameraDevice`] owns that thread for its whole
+    /// life, so SDK calls never run on tokio worker threads and a
+    /// multi-threaded runtime isn't required. See [`PinnedCameraDevice`].
+    pub async fn connect_pinned(self) -> Result<PinnedCameraDevice> {
+        PinnedCameraDevice::spawn(move || self.connect_blocking()).await
+    }
+
+    /// Build the equivalent blocking builder and connect on the current thread
+    fn connect_blocking(self) -> Result<blocking::CameraDevice> {
+        let info = self.info;
+
+        let mut builder = blocking::CameraDeviceBuilder::new();
+        if let Some(profile) = &self.profile {
+            builder = builder.profile(profile);
+        }
+        builder = builder
+            .property_cache(self.property_cache)
+            .event_channel(self.event_channel)
+            .event_ring(self.event_ring);
+        if let Some(recorder) = self.callback_recorder {
+            builder = builder.callback_recorder(recorder);
+        }
+
+        if let Some(ip) = info.ip_address {
+            builder = builder.ip_address(ip);
+        }
+        if let Some(mac) = info.mac_address {
+            builder = builder.mac_address(mac);
+        }
+        if let Some(model) = info.model {
+            builder = builder.model(model);
+        }
+        if info.ssh_enabled {
+            builder = builder.ssh_enabled(true);
+        }
+        if let Some(user) = &info.ssh_user {
+            if let Some(pass) = &info.ssh_password {
+                builder = builder.ssh_credentials(user, pass);
+            }
+        }
+        // A fingerprint verified in an earlier session needs no new round trip
+        let verified = info.ssh_fingerprint.is_some()
+            && self
+                .profile
+                .as_ref()
+                .and_then(|p| p.ssh_fingerprint.as_ref())
+                == info.ssh_fingerprint.as_ref();
+        if let Some(fp) = info.ssh_fingerprint {
+            builder = builder.ssh_fingerprint(fp);
+        }
+
+        // For SSH, we need to fetch fingerprint again since we can't reuse across threads
+        if info.ssh_enabled && info.ssh_user.is_some() && !verified {
+            builder.fetch_ssh_fingerprint()?;
+        }
+
+        builder.connect()
+    }
 }
 
 #[cfg(test)]
 mod tests {
     use super::*;
+    use crate::backend::{CallbackRecord, CallbackRecording, MockBackend, ReplayTiming};
+    use std::time::Duration;
 
     #[test]
     fn test_builder_pattern() {
@@ -251,4 +425,25 @@ mod tests {
         assert!(builder.info.ip_address.is_some());
         assert!(builder.info.mac_address.is_some());
     }
+
+    #[test]
+    fn test_into_inner_keeps_event_receiver() {
+        let mut inner = blocking::CameraDevice::builder()
+            .connect_with_backend(Arc::new(MockBackend::default()));
+        let event_receiver = Some(inner.take_event_receiver());
+        let camera = CameraDevice {
+            inner,
+            event_receiver,
+        };
+
+        let mut device = camera.into_inner();
+        let mut storm = CallbackRecording::new();
+        storm.push(Duration::ZERO, CallbackRecord::Connected { version: 3 });
+        device.replay_callbacks(&storm, ReplayTiming::Immediate);
+
+        assert!(matches!(
+            device.try_recv_event(),
+            Some(CameraEvent::Connected { version: 3 })
+        ));
+    }
 }
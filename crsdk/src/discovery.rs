@@ -0,0 +1,378 @@
+//! Cached camera discovery with background rescans
+//!
+//! [`discover_cameras`] blocks for its whole timeout and returns a fresh list
+//! on every call. [`DiscoveryService`] instead keeps every camera it has seen,
+//! keyed by MAC address (USB bodies by product id and name), so
+//! [`cameras`](DiscoveryService::cameras) answers straight from the cache. A
+//! background task keeps the cache current with short scans and reports what
+//! changed as [`DiscoveryEvent`]s.
+//!
+//! A short scan can miss a camera that is slow to answer, so a camera is only
+//! removed once it has been absent from several scans in a row.
+
+use crate::device::discover_cameras;
+use crate::types::{DiscoveredCamera, MacAddr};
+use std::collections::{BTreeMap, BTreeSet};
+use std::sync::{Arc, Mutex};
+use std::time::Duration;
+use tokio::sync::{mpsc, Notify};
+use tokio::task::JoinHandle;
+
+/// Number of discovery events buffered for a consumer that isn't reading
+///
+/// Events past this are dropped (with a warning); `cameras()` stays
+/// accurate regardless.
+pub const DISCOVERY_EVENT_CAPACITY: usize = 256;
+
+/// Scan timings for a [`DiscoveryService`]
+#[derive(Debug, Clone)]
+pub struct DiscoveryConfig {
+    /// Timeout of the first scan, which fills the cache (seconds)
+    pub initial_scan_secs: u8,
+    /// Timeout of each background rescan (seconds)
+    pub rescan_secs: u8,
+    /// Pause between the end of one scan and the start of the next
+    pub interval: Duration,
+    /// Consecutive scans a camera must be missing from before it's removed
+    pub missed_scans: u32,
+}
+
+impl Default for DiscoveryConfig {
+    fn default() -> Self {
+        Self {
+            initial_scan_secs: 3,
+            rescan_secs: 1,
+            interval: Duration::from_secs(2),
+            missed_scans: 3,
+        }
+    }
+}
+
+/// A change in the set of discovered cameras
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub enum DiscoveryEvent {
+    /// The first scan finished, found cameras or not (each one also gets an
+    /// `Added` first)
+    Ready,
+    /// A camera was seen for the first time
+    Added(DiscoveredCamera),
+    /// A known camera came back with different details (e.g. a new IP)
+    Changed {
+        /// What the cache held before
+        old: DiscoveredCamera,
+        /// What the latest scan reported
+        new: DiscoveredCamera,
+    },
+    /// A camera was missing from too many scans in a row
+    Removed(DiscoveredCamera),
+}
+
+/// Identity of a camera across scans
+#[derive(Debug, Clone, PartialEq, Eq, PartialOrd, Ord)]
+enum CameraKey {
+    Mac(MacAddr),
+    Usb { pid: Option<i16>, name: Arc<str> },
+}
+
+impl CameraKey {
+    fn of(camera: &DiscoveredCamera) -> Self {
+        match camera.mac_address {
+            Some(mac) => Self::Mac(mac),
+            None => Self::Usb {
+                pid: camera.usb_pid,
+                name: camera.name.clone(),
+            },
+        }
+    }
+}
+
+#[derive(Debug)]
+struct Entry {
+    camera: DiscoveredCamera,
+    /// Scans in a row the camera has been missing from
+    missed: u32,
+}
+
+/// Known cameras, merged scan by scan
+#[derive(Debug)]
+pub(crate) struct DiscoveryCache {
+    entries: BTreeMap<CameraKey, Entry>,
+    missed_scans: u32,
+    /// Whether the first scan has finished
+    ready: bool,
+}
+
+impl DiscoveryCache {
+    pub(crate) fn new(missed_scans: u32) -> Self {
+        Self {
+            entries: BTreeMap::new(),
+            missed_scans: missed_scans.max(1),
+            ready: false,
+        }
+    }
+
+    /// Known cameras, ordered by MAC address, then USB bodies
+    pub(crate) fn cameras(&self) -> Vec<DiscoveredCamera> {
+        self.entries.values().map(|e| e.camera.clone()).collect()
+    }
+
+    /// Fold one scan into the cache and return what changed
+    pub(crate) fn merge(&mut self, scan: Vec<DiscoveredCamera>) -> Vec<DiscoveryEvent> {
+        let mut events = Vec::new();
+        let mut seen = BTreeSet::new();
+
+        for camera in scan {
+            let key = CameraKey::of(&camera);
+            match self.entries.get_mut(&key) {
+                Some(entry) => {
+                    entry.missed = 0;
+                    if entry.camera != camera {
+                        let old = std::mem::replace(&mut entry.camera, camera.clone());
+                        events.push(DiscoveryEvent::Changed { old, new: camera });
+                    }
+                }
+                None => {
+                    self.entries.insert(
+                        key.clone(),
+                        Entry {
+                            camera: camera.clone(),
+                            missed: 0,
+                        },
+                    );
+                    events.push(DiscoveryEvent::Added(camera));
+                }
+            }
+            seen.insert(key);
+        }
+
+        let missed_scans = self.missed_scans;
+        self.entries.retain(|key, entry| {
+            if seen.contains(key) {
+                return true;
+            }
+            entry.missed += 1;
+            if entry.missed < missed_scans {
+                return true;
+            }
+            events.push(DiscoveryEvent::Removed(entry.camera.clone()));
+            false
+        });
+
+        events
+    }
+}
+
+/// Camera discovery that answers from a cache and rescans in the background
+///
+/// Must be started from within a Tokio runtime. Dropping the service stops
+/// the background scans, but a scan already running on the blocking pool
+/// finishes on its own; [`stop`](Self::stop) waits for it.
+pub struct DiscoveryService {
+    cache: Arc<Mutex<DiscoveryCache>>,
+    rescan: Arc<Notify>,
+    stop: Arc<Notify>,
+    events: mpsc::Receiver<DiscoveryEvent>,
+    task: JoinHandle<()>,
+}
+
+impl DiscoveryService {
+    /// Start scanning with default timings
+    pub fn start() -> Self {
+        Self::with_config(DiscoveryConfig::default())
+    }
+
+    /// Start scanning with the given timings
+    pub fn with_config(config: DiscoveryConfig) -> Self {
+        let cache = Arc::new(Mutex::new(DiscoveryCache::new(config.missed_scans)));
+        let rescan = Arc::new(Notify::new());
+        let stop = Arc::new(Notify::new());
+        let (events_tx, events) = mpsc::channel(DISCOVERY_EVENT_CAPACITY);
+        let task = tokio::spawn(scan_loop(
+            config,
+            cache.clone(),
+            rescan.clone(),
+            stop.clone(),
+            events_tx,
+        ));
+
+        Self {
+            cache,
+            rescan,
+            stop,
+            events,
+            task,
+        }
+    }
+
+    /// Stop scanning, waiting for a scan in flight to finish
+    ///
+    /// Call this before connecting, so an `EnumCameraObjects` still running
+    /// on the blocking pool doesn't compete with `Connect` for the SDK.
+    pub async fn stop(mut self) {
+        self.stop.notify_one();
+        if let Err(e) = (&mut self.task).await {
+            tracing::warn!("Discovery task ended abnormally: {}", e);
+        }
+    }
+
+    /// Cameras known so far, without waiting for a scan
+    ///
+    /// Empty until the first scan has finished, which is signalled by
+    /// [`DiscoveryEvent::Ready`].
+    pub fn cameras(&self) -> Vec<DiscoveredCamera> {
+        self.cache.lock().unwrap().cameras()
+    }
+
+    /// Check whether at least one scan has finished
+    pub fn has_scanned(&self) -> bool {
+        self.cache.lock().unwrap().ready
+    }
+
+    /// Start the next scan now instead of waiting out the interval
+    pub fn rescan(&self) {
+        self.rescan.notify_one();
+    }
+
+    /// Wait for the next change
+    pub async fn recv_event(&mut self) -> Option<DiscoveryEvent> {
+        self.events.recv().await
+    }
+
+    /// Take the next change without waiting
+    pub fn try_recv_event(&mut self) -> Option<DiscoveryEvent> {
+        self.events.try_recv().ok()
+    }
+}
+
+impl Drop for DiscoveryService {
+    fn drop(&mut self) {
+        self.task.abort();
+    }
+}
+
+async fn scan_loop(
+    config: DiscoveryConfig,
+    cache: Arc<Mutex<DiscoveryCache>>,
+    rescan: Arc<Notify>,
+    stop: Arc<Notify>,
+    events: mpsc::Sender<DiscoveryEvent>,
+) {
+    let send = |event| {
+        if events.try_send(event).is_err() {
+            tracing::warn!("Discovery event dropped, consumer is behind");
+        }
+    };
+
+    let mut timeout = config.initial_scan_secs;
+    loop {
+        // A failed scan leaves the cache as it was rather than counting as a
+        // miss for every camera
+        let scan = discover_cameras(timeout).await;
+        let (changes, first) = {
+            let mut cache = cache.lock().unwrap();
+            let changes = match scan {
+                Ok(scan) => cache.merge(scan),
+                Err(e) => {
+                    tracing::warn!("Discovery scan failed: {}", e);
+                    Vec::new()
+                }
+            };
+            (changes, !std::mem::replace(&mut cache.ready, true))
+        };
+        changes.into_iter().for_each(send);
+        if first {
+            send(DiscoveryEvent::Ready);
+        }
+        timeout = config.rescan_secs;
+
+        // A stop requested during the scan left a permit, so this returns
+        // right after the scan rather than starting another
+        tokio::select! {
+            biased;
+            _ = stop.notified() => return,
+            _ = tokio::time::sleep(config.interval) => {}
+            _ = rescan.notified() => {}
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::types::ConnectionType;
+    use std::net::Ipv4Addr;
+
+    fn camera(mac: u8, ip: u8) -> DiscoveredCamera {
+        DiscoveredCamera {
+            model: "ILME-FX3".into(),
+            name: "ILME-FX3".into(),
+            connection_type: ConnectionType::Network,
+            ip_address: Some(Ipv4Addr::new(192, 168, 1, ip)),
+            mac_address: Some(MacAddr([0, 0, 0, 0, 0, mac])),
+            ssh_supported: true,
+            usb_pid: None,
+        }
+    }
+
+    #[test]
+    fn test_merge_reports_added_and_changed() {
+        let mut cache = DiscoveryCache::new(3);
+
+        let events = cache.merge(vec![camera(1, 10), camera(2, 11)]);
+        assert_eq!(
+            events,
+            vec![
+                DiscoveryEvent::Added(camera(1, 10)),
+                DiscoveryEvent::Added(camera(2, 11))
+            ]
+        );
+
+        // Same cameras again: nothing to report
+        assert!(cache.merge(vec![camera(2, 11), camera(1, 10)]).is_empty());
+
+        let events = cache.merge(vec![camera(1, 20), camera(2, 11)]);
+        assert_eq!(
+            events,
+            vec![DiscoveryEvent::Changed {
+                old: camera(1, 10),
+                new: camera(1, 20)
+            }]
+        );
+        assert_eq!(cache.cameras(), vec![camera(1, 20), camera(2, 11)]);
+    }
+
+    #[test]
+    fn test_camera_removed_after_missed_scans() {
+        let mut cache = DiscoveryCache::new(2);
+        cache.merge(vec![camera(1, 10), camera(2, 11)]);
+
+        // One miss is tolerated, and seeing the camera again resets the count
+        assert!(cache.merge(vec![camera(1, 10)]).is_empty());
+        assert!(cache.merge(vec![camera(1, 10), camera(2, 11)]).is_empty());
+        assert!(cache.merge(vec![camera(1, 10)]).is_empty());
+
+        let events = cache.merge(vec![camera(1, 10)]);
+        assert_eq!(events, vec![DiscoveryEvent::Removed(camera(2, 11))]);
+        assert_eq!(cache.cameras(), vec![camera(1, 10)]);
+    }
+
+    #[test]
+    fn test_usb_cameras_keyed_by_product_and_name() {
+        let usb = |name: &str| DiscoveredCamera {
+            connection_type: ConnectionType::Usb,
+            ip_address: None,
+            mac_address: None,
+            usb_pid: Some(0x0D9B),
+            name: name.into(),
+            ..camera(0, 0)
+        };
+        let mut cache = DiscoveryCache::new(1);
+
+        let events = cache.merge(vec![usb("A"), usb("B"), camera(1, 10)]);
+        assert_eq!(events.len(), 3);
+        assert_eq!(cache.cameras().len(), 3);
+
+        let events = cache.merge(vec![usb("A"), camera(1, 10)]);
+        assert_eq!(events, vec![DiscoveryEvent::Removed(usb("B"))]);
+    }
+}
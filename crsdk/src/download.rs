@@ -0,0 +1,610 @@
+//! Pulling content files off the camera's memory cards
+//!
+//! [`CameraDevice::list_contents`](crate::blocking::CameraDevice::list_contents)
+//! lists the files on a slot and
+//! [`CameraDevice::download_contents`](crate::blocking::CameraDevice::download_contents)
+//! pulls them to a directory. Data is streamed through a [`TransferSink`]: the
+//! SDK callback thread only copies each chunk into a pooled buffer and hands
+//! it to a writer thread, so disk latency never stalls the network side.
+//! After the first few chunks no memory is allocated. The callback never
+//! waits for the writer: while it is behind, more buffers are allocated, and
+//! a writer more than [`DownloadConfig::max_buffered`] behind fails the
+//! download.
+//!
+//! The SDK's transfer callbacks don't say which file a chunk belongs to, so
+//! one camera transfers one file at a time; download from several cameras at
+//! once to use more of the link.
+//!
+//! Files land under `slot<N>/` followed by their path on the card, so
+//! same-named files from different folders or slots stay apart. Files
+//! already on disk at full size are skipped. A shorter file is resumed
+//! by appending: the camera can't start mid-file, so the leading bytes still
+//! cross the network but aren't written again.
+
+use crate::error::{Error, Result};
+use crate::sdk_string;
+use crate::transfer::TransferSink;
+use std::fs::OpenOptions;
+use std::io::{self, Write};
+use std::path::{Component, Path, PathBuf};
+use std::sync::atomic::{AtomicU64, AtomicUsize, Ordering};
+use std::sync::mpsc as std_mpsc;
+use std::sync::{Arc, Condvar, Mutex};
+use std::thread::JoinHandle;
+use std::time::{Duration, Instant};
+
+/// Default SDK transfer chunk size (1 MiB)
+pub const DEFAULT_CHUNK_SIZE: u32 = 1 << 20;
+
+/// Default number of chunk buffers kept for reuse between the SDK and the
+/// writer thread
+pub const DEFAULT_WRITE_QUEUE_DEPTH: usize = 16;
+
+/// Default limit on bytes queued for a writer that has fallen behind (256 MiB)
+pub const DEFAULT_MAX_BUFFERED: u64 = 256 << 20;
+
+/// A file stored on one of the camera's memory cards
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub struct ContentFile {
+    /// Card slot the file is on
+    pub slot: u32,
+    /// Content the file belongs to (a JPEG and RAW pair share one)
+    pub content_id: u32,
+    /// File within the content
+    pub file_id: u32,
+    /// Size in bytes
+    pub size: u64,
+    /// Path on the card as reported by the camera
+    pub path: String,
+}
+
+impl ContentFile {
+    /// File name without the card directory
+    pub fn file_name(&self) -> &str {
+        self.path.rsplit(['/', '\\']).next().unwrap_or(&self.path)
+    }
+
+    /// Where `download_contents` stores the file, relative to its directory
+    ///
+    /// The slot, then the card path (`slot1/DCIM/100MSDCF/DSC00001.ARW`).
+    /// Components that could leave the directory (`..`, roots, drive
+    /// prefixes) are dropped.
+    pub fn local_path(&self) -> PathBuf {
+        let mut local = PathBuf::from(format!("slot{}", self.slot));
+        for part in self.path.split(['/', '\\']) {
+            let mut components = Path::new(part).components();
+            if let (Some(Component::Normal(name)), None) = (components.next(), components.next()) {
+                local.push(name);
+            }
+        }
+        local
+    }
+
+    pub(crate) fn from_sdk(slot: u32, file: &crsdk_sys::CrsdkContentFile) -> Self {
+        // SAFETY: the shim always NUL-terminates `name`
+        let path = unsafe { sdk_string::decode(file.name.as_ptr(), None) }.into_owned();
+        Self {
+            slot,
+            content_id: file.content_id,
+            file_id: file.file_id,
+            size: file.size,
+            path,
+        }
+    }
+}
+
+/// Content download options
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub struct DownloadConfig {
+    /// Chunk size requested from the SDK, in bytes
+    pub chunk_size: u32,
+    /// Chunk buffers kept for reuse; more are allocated while the writer is
+    /// behind and freed once it catches up
+    pub write_queue_depth: usize,
+    /// Bytes queued ahead of the writer before the download fails (the SDK
+    /// callback thread never waits for the writer)
+    pub max_buffered: u64,
+    /// Skip complete files and append to partial ones already on disk
+    pub resume: bool,
+    /// Give up on a file when no data arrives for this long
+    pub stall_timeout: Duration,
+}
+
+impl Default for DownloadConfig {
+    fn default() -> Self {
+        Self {
+            chunk_size: DEFAULT_CHUNK_SIZE,
+            write_queue_depth: DEFAULT_WRITE_QUEUE_DEPTH,
+            max_buffered: DEFAULT_MAX_BUFFERED,
+            resume: true,
+            stall_timeout: Duration::from_secs(30),
+        }
+    }
+}
+
+/// Running totals of a download
+#[derive(Debug, Clone, Copy, Default, PartialEq)]
+pub struct DownloadStats {
+    /// Files downloaded
+    pub files: usize,
+    /// Files skipped because they were already complete on disk
+    pub skipped: usize,
+    /// Bytes received from the camera
+    pub bytes_received: u64,
+    /// Bytes written to disk or the caller's writer
+    pub bytes_written: u64,
+    /// Time spent downloading
+    pub elapsed: Duration,
+}
+
+impl DownloadStats {
+    /// Average receive rate in bytes per second
+    pub fn throughput(&self) -> f64 {
+        let secs = self.elapsed.as_secs_f64();
+        if secs > 0.0 {
+            self.bytes_received as f64 / secs
+        } else {
+            0.0
+        }
+    }
+}
+
+/// Bytes moved for one file
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub(crate) struct FileTransfer {
+    pub(crate) received: u64,
+    pub(crate) written: u64,
+}
+
+/// Device side of a download: where the sink goes and how a pull starts
+pub(crate) trait PullTarget {
+    /// Install or remove the sink that receives transfer data
+    fn set_sink(&self, sink: Option<Arc<dyn TransferSink>>);
+
+    /// Ask the camera to start sending `file`
+    fn start_pull(&self, file: &ContentFile, chunk_size: u32) -> Result<()>;
+}
+
+/// Download every file in `files` into `dir`
+pub(crate) fn download_all<T: PullTarget + ?Sized>(
+    target: &T,
+    files: &[ContentFile],
+    dir: &Path,
+    config: &DownloadConfig,
+    progress: &mut dyn FnMut(&ContentFile, &DownloadStats),
+) -> Result<DownloadStats> {
+    let started = Instant::now();
+    let mut stats = DownloadStats::default();
+
+    for file in files {
+        let dest = dir.join(file.local_path());
+        if let Some(parent) = dest.parent() {
+            std::fs::create_dir_all(parent)?;
+        }
+        let existing = if config.resume {
+            std::fs::metadata(&dest).ok().map(|meta| meta.len())
+        } else {
+            None
+        };
+
+        if existing == Some(file.size) {
+            stats.skipped += 1;
+        } else {
+            // A file longer than the camera's copy isn't ours to resume
+            let skip = existing.filter(|&len| len < file.size).unwrap_or(0);
+            let out = OpenOptions::new()
+                .create(true)
+                .write(true)
+                .append(skip > 0)
+                .truncate(skip == 0)
+                .open(&dest)?;
+
+            let transfer = download_to(target, file, out, skip, config)?;
+            stats.files += 1;
+            stats.bytes_received += transfer.received;
+            stats.bytes_written += transfer.written;
+        }
+
+        stats.elapsed = started.elapsed();
+        progress(file, &stats);
+    }
+
+    Ok(stats)
+}
+
+/// Download one file into `writer`, discarding its first `skip` bytes
+pub(crate) fn download_to<T, W>(
+    target: &T,
+    file: &ContentFile,
+    writer: W,
+    skip: u64,
+    config: &DownloadConfig,
+) -> Result<FileTransfer>
+where
+    T: PullTarget + ?Sized,
+    W: Write + Send + 'static,
+{
+    let (chunk_tx, chunk_rx) = std_mpsc::channel::<Vec<u8>>();
+    let (pool_tx, pool_rx) = std_mpsc::channel::<Vec<u8>>();
+    let queue = Arc::new(QueueGauge {
+        bytes: AtomicU64::new(0),
+        buffers: AtomicUsize::new(0),
+        keep: config.write_queue_depth.max(1),
+    });
+
+    let writer_thread = {
+        let queue = queue.clone();
+        std::thread::Builder::new()
+            .name("crsdk-download".to_string())
+            .spawn(move || write_chunks(writer, chunk_rx, pool_tx, &queue))?
+    };
+
+    let sink = Arc::new(StreamSink::new(ChunkPipe {
+        chunks: chunk_tx,
+        pool: pool_rx,
+        queue,
+        skip,
+        chunk_capacity: config.chunk_size as usize,
+        max_buffered: config.max_buffered,
+        failed: false,
+    }));
+    target.set_sink(Some(sink.clone()));
+
+    let outcome = target
+        .start_pull(file, config.chunk_size)
+        .and_then(|()| sink.wait(config.stall_timeout));
+
+    // Once the slot is cleared the SDK can't reach the sink any more; dropping
+    // our handle then closes the chunk queue and lets the writer finish
+    target.set_sink(None);
+    let received = sink.received();
+    drop(sink);
+
+    // A write error explains a failed transfer better than the cut-off it caused
+    let written = join_writer(writer_thread)?;
+    outcome?;
+    Ok(FileTransfer { received, written })
+}
+
+fn join_writer(thread: JoinHandle<io::Result<u64>>) -> Result<u64> {
+    match thread.join() {
+        Ok(result) => Ok(result?),
+        Err(_) => Err(Error::Other("Download writer thread panicked".to_string())),
+    }
+}
+
+/// Chunks between the SDK callback and the writer thread
+struct QueueGauge {
+    /// Bytes sent to the writer and not yet written
+    bytes: AtomicU64,
+    /// Chunk buffers alive (queued, pooled or being filled)
+    buffers: AtomicUsize,
+    /// Buffers worth keeping once the writer has caught up
+    keep: usize,
+}
+
+/// Writer thread: drain chunks to `writer`, handing buffers back for reuse
+fn write_chunks<W: Write>(
+    mut writer: W,
+    chunks: std_mpsc::Receiver<Vec<u8>>,
+    pool: std_mpsc::Sender<Vec<u8>>,
+    queue: &QueueGauge,
+) -> io::Result<u64> {
+    let mut written = 0u64;
+    for mut chunk in chunks {
+        writer.write_all(&chunk)?;
+        written += chunk.len() as u64;
+        queue.bytes.fetch_sub(chunk.len() as u64, Ordering::Relaxed);
+        // Buffers allocated while the writer was behind are freed again
+        if queue.buffers.load(Ordering::Relaxed) > queue.keep {
+            queue.buffers.fetch_sub(1, Ordering::Relaxed);
+            continue;
+        }
+        chunk.clear();
+        let _ = pool.send(chunk);
+    }
+    writer.flush()?;
+    Ok(written)
+}
+
+#[derive(Debug)]
+struct StreamState {
+    received: u64,
+    last_data: Instant,
+    finished: Option<Result<()>>,
+}
+
+/// Pipe state only the SDK callback thread touches
+struct ChunkPipe {
+    chunks: std_mpsc::Sender<Vec<u8>>,
+    pool: std_mpsc::Receiver<Vec<u8>>,
+    queue: Arc<QueueGauge>,
+    skip: u64,
+    chunk_capacity: usize,
+    max_buffered: u64,
+    /// Set once the transfer failed; later chunks are dropped
+    failed: bool,
+}
+
+/// Transfer sink feeding one file's chunks to a writer thread
+struct StreamSink {
+    pipe: Mutex<ChunkPipe>,
+    state: Mutex<StreamState>,
+    changed: Condvar,
+}
+
+impl StreamSink {
+    fn new(pipe: ChunkPipe) -> Self {
+        Self {
+            pipe: Mutex::new(pipe),
+            state: Mutex::new(StreamState {
+                received: 0,
+                last_data: Instant::now(),
+                finished: None,
+            }),
+            changed: Condvar::new(),
+        }
+    }
+
+    fn received(&self) -> u64 {
+        self.state.lock().unwrap().received
+    }
+
+    fn finish(&self, result: Result<()>) {
+        let mut state = self.state.lock().unwrap();
+        if state.finished.is_none() {
+            state.finished = Some(result);
+        }
+        self.changed.notify_all();
+    }
+
+    /// Wait until the transfer finishes, failing if it stalls
+    fn wait(&self, stall_timeout: Duration) -> Result<()> {
+        let mut state = self.state.lock().unwrap();
+        loop {
+            if let Some(result) = state.finished.take() {
+                return result;
+            }
+            let idle = state.last_data.elapsed();
+            if idle >= stall_timeout {
+                return Err(Error::Timeout);
+            }
+            state = self
+                .changed
+                .wait_timeout(state, stall_timeout - idle)
+                .unwrap()
+                .0;
+        }
+    }
+}
+
+impl TransferSink for StreamSink {
+    fn on_data(&self, _notify: u32, _percent: u32, data: &[u8]) {
+        {
+            let mut state = self.state.lock().unwrap();
+            state.received += data.len() as u64;
+            state.last_data = Instant::now();
+        }
+
+        let mut pipe = self.pipe.lock().unwrap();
+        if pipe.failed {
+            return;
+        }
+        let skipped = pipe.skip.min(data.len() as u64) as usize;
+        pipe.skip -= skipped as u64;
+        let data = &data[skipped..];
+        if data.is_empty() {
+            return;
+        }
+
+        // Never wait for the writer here: this is the SDK callback thread
+        let queued = pipe.queue.bytes.load(Ordering::Relaxed);
+        let error = if queued + data.len() as u64 > pipe.max_buffered {
+            format!("Download writer fell {} bytes behind", queued)
+        } else {
+            let mut chunk = pipe.pool.try_recv().unwrap_or_else(|_| {
+                pipe.queue.buffers.fetch_add(1, Ordering::Relaxed);
+                Vec::with_capacity(pipe.chunk_capacity.max(data.len()))
+            });
+            chunk.extend_from_slice(data);
+            pipe.queue
+                .bytes
+                .fetch_add(chunk.len() as u64, Ordering::Relaxed);
+            if pipe.chunks.send(chunk).is_ok() {
+                return;
+            }
+            "Download writer stopped; see its I/O error".to_string()
+        };
+
+        pipe.failed = true;
+        drop(pipe);
+        self.finish(Err(Error::Other(error)));
+    }
+
+    fn on_finished(&self, result: Result<()>) {
+        self.finish(result);
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    /// Replays a fixed byte stream into the sink, in chunks, on another thread
+    struct FakeCamera {
+        data: Vec<u8>,
+        chunk: usize,
+        sink: Mutex<Option<Arc<dyn TransferSink>>>,
+    }
+
+    impl PullTarget for FakeCamera {
+        fn set_sink(&self, sink: Option<Arc<dyn TransferSink>>) {
+            *self.sink.lock().unwrap() = sink;
+        }
+
+        fn start_pull(&self, _file: &ContentFile, _chunk_size: u32) -> Result<()> {
+            let sink = self.sink.lock().unwrap().clone().unwrap();
+            let data = self.data.clone();
+            let chunk = self.chunk;
+            std::thread::spawn(move || {
+                for part in data.chunks(chunk) {
+                    sink.on_data(0, 0, part);
+                }
+                sink.on_finished(Ok(()));
+            });
+            Ok(())
+        }
+    }
+
+    fn camera(len: usize) -> (FakeCamera, ContentFile) {
+        let data: Vec<u8> = (0..len).map(|i| i as u8).collect();
+        let file = ContentFile {
+            slot: 1,
+            content_id: 1,
+            file_id: 1,
+            size: len as u64,
+            path: "DCIM/100MSDCF/DSC00001.ARW".to_string(),
+        };
+        let camera = FakeCamera {
+            data,
+            chunk: 7,
+            sink: Mutex::new(None),
+        };
+        (camera, file)
+    }
+
+    #[derive(Clone, Default)]
+    struct SharedWriter(Arc<Mutex<Vec<u8>>>);
+
+    impl Write for SharedWriter {
+        fn write(&mut self, buf: &[u8]) -> io::Result<usize> {
+            self.0.lock().unwrap().extend_from_slice(buf);
+            Ok(buf.len())
+        }
+
+        fn flush(&mut self) -> io::Result<()> {
+            Ok(())
+        }
+    }
+
+    #[test]
+    fn test_file_name_strips_card_path() {
+        let (_, file) = camera(0);
+        assert_eq!(file.file_name(), "DSC00001.ARW");
+    }
+
+    #[test]
+    fn test_from_sdk_decodes_name_units() {
+        let mut entry = crsdk_sys::CrsdkContentFile {
+            content_id: 4,
+            file_id: 2,
+            size: 10,
+            ..Default::default()
+        };
+        for (unit, byte) in entry.name.iter_mut().zip(b"DCIM/100MSDCF/DSC00004.JPG") {
+            *unit = *byte as crsdk_sys::CrChar;
+        }
+
+        let file = ContentFile::from_sdk(1, &entry);
+        assert_eq!(file.path, "DCIM/100MSDCF/DSC00004.JPG");
+        assert_eq!((file.content_id, file.file_id, file.size), (4, 2, 10));
+
+        let empty = ContentFile::from_sdk(1, &crsdk_sys::CrsdkContentFile::default());
+        assert_eq!(empty.path, "");
+    }
+
+    #[test]
+    fn test_local_path_keeps_slot_and_folders() {
+        let (_, mut file) = camera(0);
+        assert_eq!(
+            file.local_path(),
+            Path::new("slot1/DCIM/100MSDCF/DSC00001.ARW")
+        );
+
+        file.slot = 2;
+        file.path = "\\DCIM\\..\\101MSDCF\\DSC00001.ARW".to_string();
+        assert_eq!(
+            file.local_path(),
+            Path::new("slot2/DCIM/101MSDCF/DSC00001.ARW")
+        );
+    }
+
+    #[test]
+    fn test_download_streams_whole_file() {
+        let (camera, file) = camera(100);
+        let out = SharedWriter::default();
+        let config = DownloadConfig {
+            write_queue_depth: 2,
+            ..Default::default()
+        };
+
+        let transfer = download_to(&camera, &file, out.clone(), 0, &config).unwrap();
+
+        assert_eq!(
+            transfer,
+            FileTransfer {
+                received: 100,
+                written: 100
+            }
+        );
+        assert_eq!(*out.0.lock().unwrap(), camera.data);
+        assert!(camera.sink.lock().unwrap().is_none());
+    }
+
+    #[test]
+    fn test_download_resume_skips_existing_bytes() {
+        let (camera, file) = camera(50);
+        let out = SharedWriter::default();
+
+        let transfer =
+            download_to(&camera, &file, out.clone(), 20, &DownloadConfig::default()).unwrap();
+
+        assert_eq!(
+            transfer,
+            FileTransfer {
+                received: 50,
+                written: 30
+            }
+        );
+        assert_eq!(*out.0.lock().unwrap(), camera.data[20..]);
+    }
+
+    #[test]
+    fn test_slow_writer_fails_instead_of_blocking_callback() {
+        struct SlowWriter;
+
+        impl Write for SlowWriter {
+            fn write(&mut self, buf: &[u8]) -> io::Result<usize> {
+                std::thread::sleep(Duration::from_millis(20));
+                Ok(buf.len())
+            }
+
+            fn flush(&mut self) -> io::Result<()> {
+                Ok(())
+            }
+        }
+
+        let (camera, file) = camera(100);
+        let config = DownloadConfig {
+            max_buffered: 20,
+            ..Default::default()
+        };
+
+        // 15 chunks at 20 ms each if the callback waited for the writer
+        let started = Instant::now();
+        let result = download_to(&camera, &file, SlowWriter, 0, &config);
+        assert!(matches!(result, Err(Error::Other(_))));
+        assert!(started.elapsed() < Duration::from_millis(15 * 20));
+    }
+
+    #[test]
+    fn test_throughput() {
+        let stats = DownloadStats {
+            bytes_received: 1000,
+            elapsed: Duration::from_millis(500),
+            ..Default::default()
+        };
+        assert_eq!(stats.throughput(), 2000.0);
+        assert_eq!(DownloadStats::default().throughput(), 0.0);
+    }
+}
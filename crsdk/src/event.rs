@@ -3,7 +3,103 @@
 //! Events are delivered asynchronously when the camera state changes.
 //! Use `CameraDevice::events()` to receive them.
 
-use crsdk_sys::DevicePropertyCode;
+use crate::property::PropertyCodeSet;
+use std::fmt;
+use std::ops::Deref;
+use std::sync::Arc;
+
+/// Maximum number of codes a [`LiveViewCodes`] holds inline
+pub const LIVE_VIEW_CODES_CAPACITY: usize = 16;
+
+/// Live view property codes carried inline, without a heap allocation
+///
+/// The SDK only defines a handful of live view properties, so a change
+/// notification rarely lists more than a few. If more distinct codes arrive
+/// than fit, the extra ones are dropped and [`is_overflowed`](Self::is_overflowed)
+/// reports that every live view property should be treated as changed.
+#[derive(Clone, Copy, PartialEq, Eq)]
+pub struct LiveViewCodes {
+    codes: [u32; LIVE_VIEW_CODES_CAPACITY],
+    len: u8,
+    overflowed: bool,
+}
+
+impl LiveViewCodes {
+    /// Create an empty list
+    pub const fn new() -> Self {
+        Self {
+            codes: [0; LIVE_VIEW_CODES_CAPACITY],
+            len: 0,
+            overflowed: false,
+        }
+    }
+
+    /// Build from raw SDK codes, ignoring duplicates
+    pub fn from_slice(codes: &[u32]) -> Self {
+        let mut list = Self::new();
+        for &code in codes {
+            list.insert(code);
+        }
+        list
+    }
+
+    /// Add a code unless it's already present
+    pub fn insert(&mut self, code: u32) {
+        if self.contains(&code) {
+            return;
+        }
+        match self.codes.get_mut(self.len as usize) {
+            Some(slot) => {
+                *slot = code;
+                self.len += 1;
+            }
+            None => self.overflowed = true,
+        }
+    }
+
+    /// Merge another list into this one
+    pub fn merge(&mut self, other: &Self) {
+        for &code in other.iter() {
+            self.insert(code);
+        }
+        self.overflowed |= other.overflowed;
+    }
+
+    /// Whether codes were dropped because the list was full
+    pub fn is_overflowed(&self) -> bool {
+        self.overflowed
+    }
+
+    /// Flag the list as overflowed, for lists rebuilt from a log
+    pub(crate) fn set_overflowed(&mut self) {
+        self.overflowed = true;
+    }
+}
+
+impl Default for LiveViewCodes {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+impl Deref for LiveViewCodes {
+    type Target = [u32];
+
+    fn deref(&self) -> &[u32] {
+        &self.codes[..self.len as usize]
+    }
+}
+
+impl fmt::Debug for LiveViewCodes {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        let mut list = f.debug_list();
+        list.entries(self.iter());
+        if self.overflowed {
+            list.entry(&"..");
+        }
+        list.finish()
+    }
+}
 
 /// Events received from the camera via SDK callbacks
 #[derive(Debug, Clone)]
@@ -26,19 +122,19 @@ pub enum CameraEvent {
     /// Call `camera.get_property()` to read the new values.
     PropertyChanged {
         /// Property codes that changed
-        codes: Vec<DevicePropertyCode>,
+        codes: PropertyCodeSet,
     },
 
     /// Live view properties changed
     LiveViewPropertyChanged {
         /// Property codes that changed
-        codes: Vec<u32>,
+        codes: LiveViewCodes,
     },
 
     /// File download completed
     DownloadComplete {
         /// Filename of the downloaded file
-        filename: String,
+        filename: Arc<str>,
     },
 
     /// Content transfer notification
@@ -48,7 +144,7 @@ pub enum CameraEvent {
         /// Content handle
         handle: u64,
         /// Optional filename
-        filename: Option<String>,
+        filename: Option<Arc<str>>,
     },
 
     /// Warning from the camera
@@ -72,7 +168,7 @@ pub enum CameraEvent {
         /// Progress percentage (0-100)
         percent: u32,
         /// Filename being transferred
-        filename: Option<String>,
+        filename: Option<Arc<str>>,
     },
 
     /// Remote transfer data received (for in-memory transfers)
@@ -225,10 +321,27 @@ mod tests {
         let event = CameraEvent::Disconnected { error: 0x8200 };
         assert_eq!(event.to_string(), "Disconnected (error: 0x00008200)");
 
-        let event = CameraEvent::PropertyChanged { codes: vec![] };
+        let event = CameraEvent::PropertyChanged {
+            codes: PropertyCodeSet::new(),
+        };
         assert_eq!(event.to_string(), "PropertyChanged (0 properties)");
     }
 
+    #[test]
+    fn test_live_view_codes_inline() {
+        let mut codes = LiveViewCodes::from_slice(&[1, 2, 2, 3]);
+        assert_eq!(*codes, [1, 2, 3]);
+
+        codes.merge(&LiveViewCodes::from_slice(&[3, 4]));
+        assert_eq!(*codes, [1, 2, 3, 4]);
+        assert!(!codes.is_overflowed());
+
+        let many: Vec<u32> = (0..LIVE_VIEW_CODES_CAPACITY as u32 + 1).collect();
+        let codes = LiveViewCodes::from_slice(&many);
+        assert_eq!(codes.len(), LIVE_VIEW_CODES_CAPACITY);
+        assert!(codes.is_overflowed());
+    }
+
     #[test]
     fn test_event_clone() {
         let event = CameraEvent::RemoteTransferData {
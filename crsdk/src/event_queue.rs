@@ -0,0 +1,538 @@
+//! Bounded camera event queue with per-event overflow policies
+//!
+//! The SDK delivers events on its own callback thread, which must never block.
+//! This queue accepts every push immediately: once it holds `capacity` events,
+//! the configured [`OverflowPolicy`] decides what gives. Disconnects and errors
+//! are never dropped, even past capacity, so a lagging consumer still learns
+//! that the connection went away.
+
+use crate::event::CameraEvent;
+use crate::metrics::{EventKind, EventLatencyMetrics, LatencySnapshot};
+use std::collections::VecDeque;
+use std::sync::atomic::{AtomicBool, AtomicU64, AtomicUsize, Ordering};
+use std::sync::{Arc, Mutex};
+use std::time::Instant;
+use tokio::sync::Notify;
+
+/// Default number of queued events before the overflow policy applies
+pub const DEFAULT_EVENT_CAPACITY: usize = 1024;
+
+/// What to do with an event that arrives while the queue is full
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum OverflowPolicy {
+    /// Drop the oldest queued event to make room
+    DropOldest,
+    /// Drop the incoming event
+    DropNewest,
+    /// Merge the incoming codes into the newest queued event of the same kind
+    ///
+    /// Only applies to `PropertyChanged` and `LiveViewPropertyChanged`; other
+    /// events fall back to [`DropOldest`](Self::DropOldest).
+    Coalesce,
+}
+
+/// Event queue capacity and overflow policies
+///
+/// `Disconnected` and `Error` events are never dropped regardless of policy.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct EventChannelConfig {
+    /// Number of queued events before the overflow policy applies
+    pub capacity: usize,
+    /// Policy for `PropertyChanged`
+    pub property_changed: OverflowPolicy,
+    /// Policy for `LiveViewPropertyChanged`
+    pub live_view_property_changed: OverflowPolicy,
+    /// Policy for every other droppable event
+    pub other: OverflowPolicy,
+}
+
+impl Default for EventChannelConfig {
+    fn default() -> Self {
+        Self {
+            capacity: DEFAULT_EVENT_CAPACITY,
+            property_changed: OverflowPolicy::Coalesce,
+            live_view_property_changed: OverflowPolicy::DropOldest,
+            other: OverflowPolicy::DropOldest,
+        }
+    }
+}
+
+impl EventChannelConfig {
+    /// Use the default policies with a different capacity
+    pub fn with_capacity(capacity: usize) -> Self {
+        Self {
+            capacity,
+            ..Self::default()
+        }
+    }
+
+    fn policy_for(&self, event: &CameraEvent) -> OverflowPolicy {
+        match event {
+            CameraEvent::PropertyChanged { .. } => self.property_changed,
+            CameraEvent::LiveViewPropertyChanged { .. } => self.live_view_property_changed,
+            _ => self.other,
+        }
+    }
+}
+
+/// Snapshot of event queue counters
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct EventStats {
+    /// Events currently waiting to be received
+    pub queued: usize,
+    /// Most events ever waiting at once
+    pub peak_queued: usize,
+    /// Events discarded because the queue was full
+    pub dropped: u64,
+    /// Events merged into an already queued event because the queue was full
+    pub coalesced: u64,
+}
+
+/// Events that must reach the consumer no matter how far behind it is
+fn is_critical(event: &CameraEvent) -> bool {
+    matches!(
+        event,
+        CameraEvent::Disconnected { .. } | CameraEvent::Error { .. }
+    )
+}
+
+/// An event and when its SDK callback arrived
+#[derive(Debug)]
+struct Queued {
+    event: CameraEvent,
+    at: Instant,
+}
+
+#[derive(Debug)]
+struct QueueState {
+    events: VecDeque<Queued>,
+    sender_alive: bool,
+    receiver_alive: bool,
+}
+
+#[derive(Debug)]
+struct Shared {
+    config: EventChannelConfig,
+    state: Mutex<QueueState>,
+    notify: Notify,
+    dropped: AtomicU64,
+    coalesced: AtomicU64,
+    peak_queued: AtomicUsize,
+    latency: EventLatencyMetrics,
+    /// Open [`EventQueueSender::batch`] scopes; sends skip the wakeup while set
+    deferring: AtomicUsize,
+    /// A send inside a batch still owes the receiver a wakeup
+    pending_notify: AtomicBool,
+}
+
+impl Shared {
+    fn stats(&self) -> EventStats {
+        EventStats {
+            queued: self.state.lock().unwrap().events.len(),
+            peak_queued: self.peak_queued.load(Ordering::Relaxed),
+            dropped: self.dropped.load(Ordering::Relaxed),
+            coalesced: self.coalesced.load(Ordering::Relaxed),
+        }
+    }
+
+    /// Record how long a dequeued event waited and hand it out
+    fn deliver(&self, queued: Queued) -> CameraEvent {
+        self.latency
+            .record(EventKind::of(&queued.event), queued.at.elapsed());
+        queued.event
+    }
+}
+
+/// Create a bounded event queue
+pub(crate) fn channel(config: EventChannelConfig) -> (EventQueueSender, EventReceiver) {
+    let shared = Arc::new(Shared {
+        config,
+        state: Mutex::new(QueueState {
+            events: VecDeque::with_capacity(config.capacity.min(DEFAULT_EVENT_CAPACITY)),
+            sender_alive: true,
+            receiver_alive: true,
+        }),
+        notify: Notify::new(),
+        dropped: AtomicU64::new(0),
+        coalesced: AtomicU64::new(0),
+        peak_queued: AtomicUsize::new(0),
+        latency: EventLatencyMetrics::default(),
+        deferring: AtomicUsize::new(0),
+        pending_notify: AtomicBool::new(false),
+    });
+    (
+        EventQueueSender {
+            shared: shared.clone(),
+        },
+        EventReceiver {
+            shared: Some(shared),
+        },
+    )
+}
+
+/// Producer side of the event queue, owned by the SDK callback
+#[derive(Debug)]
+pub struct EventQueueSender {
+    shared: Arc<Shared>,
+}
+
+impl EventQueueSender {
+    /// Queue an event without blocking
+    ///
+    /// If the receiver is gone, the event is silently discarded.
+    pub(crate) fn send(&self, event: CameraEvent) {
+        self.send_at(event, Instant::now());
+    }
+
+    /// Queue an event whose callback arrived at `at`
+    ///
+    /// `at` is where delivery latency is measured from.
+    pub(crate) fn send_at(&self, event: CameraEvent, at: Instant) {
+        let shared = &*self.shared;
+        let mut state = shared.state.lock().unwrap();
+        if !state.receiver_alive {
+            return;
+        }
+
+        if state.events.len() >= shared.config.capacity && !is_critical(&event) {
+            match shared.config.policy_for(&event) {
+                OverflowPolicy::DropNewest => {
+                    shared.dropped.fetch_add(1, Ordering::Relaxed);
+                    return;
+                }
+                OverflowPolicy::Coalesce => {
+                    if coalesce_into(&mut state.events, &event) {
+                        shared.coalesced.fetch_add(1, Ordering::Relaxed);
+                        return;
+                    }
+                    drop_oldest(&mut state.events, &shared.dropped);
+                }
+                OverflowPolicy::DropOldest => {
+                    drop_oldest(&mut state.events, &shared.dropped);
+                }
+            }
+        }
+
+        state.events.push_back(Queued { event, at });
+        shared
+            .peak_queued
+            .fetch_max(state.events.len(), Ordering::Relaxed);
+        drop(state);
+        self.wake();
+    }
+
+    /// Send several events with a single receiver wakeup
+    ///
+    /// Sends made by `f`, or by other threads while it runs, only flag that a
+    /// wakeup is owed; it is delivered once when the last open batch ends.
+    pub(crate) fn batch<R>(&self, f: impl FnOnce() -> R) -> R {
+        struct Scope<'a>(&'a Shared);
+
+        impl Drop for Scope<'_> {
+            fn drop(&mut self) {
+                if self.0.deferring.fetch_sub(1, Ordering::SeqCst) == 1
+                    && self.0.pending_notify.swap(false, Ordering::SeqCst)
+                {
+                    self.0.notify.notify_one();
+                }
+            }
+        }
+
+        self.shared.deferring.fetch_add(1, Ordering::SeqCst);
+        let _scope = Scope(&self.shared);
+        f()
+    }
+
+    fn wake(&self) {
+        let shared = &*self.shared;
+        if shared.deferring.load(Ordering::SeqCst) == 0 {
+            shared.notify.notify_one();
+            return;
+        }
+        shared.pending_notify.store(true, Ordering::SeqCst);
+        // The batch may have closed before it could see the flag
+        if shared.deferring.load(Ordering::SeqCst) == 0
+            && shared.pending_notify.swap(false, Ordering::SeqCst)
+        {
+            shared.notify.notify_one();
+        }
+    }
+
+    /// Handle for reading counters after the receiver has been handed out
+    pub(crate) fn stats_handle(&self) -> EventStatsHandle {
+        EventStatsHandle {
+            shared: self.shared.clone(),
+        }
+    }
+}
+
+impl Drop for EventQueueSender {
+    fn drop(&mut self) {
+        self.shared.state.lock().unwrap().sender_alive = false;
+        self.shared.notify.notify_one();
+    }
+}
+
+/// Merge a code-list event into the newest queued event of the same kind
+///
+/// The merged event keeps its original arrival time, so its delivery latency
+/// covers the oldest change it carries.
+fn coalesce_into(events: &mut VecDeque<Queued>, incoming: &CameraEvent) -> bool {
+    for queued in events.iter_mut().rev() {
+        match (&mut queued.event, incoming) {
+            (
+                CameraEvent::PropertyChanged { codes: target },
+                CameraEvent::PropertyChanged { codes },
+            ) => *target |= *codes,
+            (
+                CameraEvent::LiveViewPropertyChanged { codes: target },
+                CameraEvent::LiveViewPropertyChanged { codes },
+            ) => target.merge(codes),
+            _ => continue,
+        }
+        return true;
+    }
+    false
+}
+
+/// Remove the oldest non-critical event, if any
+///
+/// When only critical events are queued nothing is removed and the queue
+/// briefly exceeds its capacity.
+fn drop_oldest(events: &mut VecDeque<Queued>, dropped: &AtomicU64) {
+    if let Some(index) = events.iter().position(|q| !is_critical(&q.event)) {
+        events.remove(index);
+        dropped.fetch_add(1, Ordering::Relaxed);
+    }
+}
+
+/// Receiving side of a camera's event queue
+#[derive(Debug)]
+pub struct EventReceiver {
+    shared: Option<Arc<Shared>>,
+}
+
+impl EventReceiver {
+    /// A receiver that is already closed and never yields events
+    pub(crate) fn closed() -> Self {
+        Self { shared: None }
+    }
+
+    /// Wait for the next event
+    ///
+    /// Returns `None` once the camera has been dropped and every queued event
+    /// has been received.
+    pub async fn recv(&mut self) -> Option<CameraEvent> {
+        let shared = self.shared.as_ref()?;
+        loop {
+            {
+                let mut state = shared.state.lock().unwrap();
+                if let Some(queued) = state.events.pop_front() {
+                    drop(state);
+                    return Some(shared.deliver(queued));
+                }
+                if !state.sender_alive {
+                    return None;
+                }
+            }
+            shared.notify.notified().await;
+        }
+    }
+
+    /// Receive an event if one is queued, without waiting
+    pub fn try_recv(&mut self) -> Option<CameraEvent> {
+        let shared = self.shared.as_ref()?;
+        let queued = shared.state.lock().unwrap().events.pop_front()?;
+        Some(shared.deliver(queued))
+    }
+
+    /// Current queue counters
+    pub fn stats(&self) -> EventStats {
+        self.shared
+            .as_ref()
+            .map(|shared| shared.stats())
+            .unwrap_or_default()
+    }
+}
+
+impl Drop for EventReceiver {
+    fn drop(&mut self) {
+        if let Some(shared) = &self.shared {
+            let mut state = shared.state.lock().unwrap();
+            state.receiver_alive = false;
+            state.events.clear();
+        }
+    }
+}
+
+/// Read-only access to a queue's counters
+#[derive(Debug, Clone)]
+pub struct EventStatsHandle {
+    shared: Arc<Shared>,
+}
+
+impl EventStatsHandle {
+    pub(crate) fn stats(&self) -> EventStats {
+        self.shared.stats()
+    }
+
+    /// Callback-to-receive latency per event kind
+    pub(crate) fn latencies(&self) -> [LatencySnapshot; EventKind::COUNT] {
+        self.shared.latency.snapshot()
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::event::LiveViewCodes;
+    use crsdk_sys::DevicePropertyCode;
+
+    fn config(capacity: usize) -> EventChannelConfig {
+        EventChannelConfig::with_capacity(capacity)
+    }
+
+    #[test]
+    fn test_events_delivered_in_order() {
+        let (tx, mut rx) = channel(config(8));
+        tx.send(CameraEvent::Connected { version: 1 });
+        tx.send(CameraEvent::Warning {
+            code: 2,
+            params: None,
+        });
+
+        assert!(matches!(
+            rx.try_recv(),
+            Some(CameraEvent::Connected { version: 1 })
+        ));
+        assert!(matches!(
+            rx.try_recv(),
+            Some(CameraEvent::Warning { code: 2, .. })
+        ));
+        assert!(rx.try_recv().is_none());
+    }
+
+    #[test]
+    fn test_delivery_latency_and_peak_depth() {
+        let (tx, mut rx) = channel(config(8));
+        let handle = tx.stats_handle();
+        for version in 0..3 {
+            tx.send(CameraEvent::Connected { version });
+        }
+        while rx.try_recv().is_some() {}
+
+        assert_eq!(rx.stats().queued, 0);
+        assert_eq!(rx.stats().peak_queued, 3);
+        assert_eq!(handle.latencies()[EventKind::Connected as usize].count, 3);
+        assert!(handle.latencies()[EventKind::Warning as usize].is_empty());
+    }
+
+    #[test]
+    fn test_property_changed_coalesces_when_full() {
+        let (tx, mut rx) = channel(config(1));
+        tx.send(CameraEvent::PropertyChanged {
+            codes: [DevicePropertyCode::FNumber].into_iter().collect(),
+        });
+        tx.send(CameraEvent::PropertyChanged {
+            codes: [
+                DevicePropertyCode::FNumber,
+                DevicePropertyCode::IsoSensitivity,
+            ]
+            .into_iter()
+            .collect(),
+        });
+
+        let stats = rx.stats();
+        assert_eq!(stats.queued, 1);
+        assert_eq!(stats.coalesced, 1);
+        assert_eq!(stats.dropped, 0);
+
+        match rx.try_recv() {
+            Some(CameraEvent::PropertyChanged { codes }) => assert_eq!(
+                codes.to_vec(),
+                vec![
+                    DevicePropertyCode::FNumber,
+                    DevicePropertyCode::IsoSensitivity
+                ]
+            ),
+            other => panic!("Expected PropertyChanged, got {:?}", other),
+        }
+    }
+
+    #[test]
+    fn test_live_view_drops_oldest_when_full() {
+        let (tx, mut rx) = channel(config(2));
+        for code in 1..=3 {
+            tx.send(CameraEvent::LiveViewPropertyChanged {
+                codes: LiveViewCodes::from_slice(&[code]),
+            });
+        }
+
+        assert_eq!(rx.stats().dropped, 1);
+        assert!(matches!(
+            rx.try_recv(),
+            Some(CameraEvent::LiveViewPropertyChanged { codes }) if *codes == [2]
+        ));
+        assert!(matches!(
+            rx.try_recv(),
+            Some(CameraEvent::LiveViewPropertyChanged { codes }) if *codes == [3]
+        ));
+    }
+
+    #[test]
+    fn test_critical_events_never_dropped() {
+        let (tx, mut rx) = channel(EventChannelConfig {
+            other: OverflowPolicy::DropNewest,
+            ..config(1)
+        });
+        tx.send(CameraEvent::Error { code: 1 });
+        tx.send(CameraEvent::Warning {
+            code: 2,
+            params: None,
+        });
+        tx.send(CameraEvent::Disconnected { error: 3 });
+
+        let stats = rx.stats();
+        assert_eq!(stats.queued, 2);
+        assert_eq!(stats.dropped, 1);
+        assert!(matches!(rx.try_recv(), Some(CameraEvent::Error { .. })));
+        assert!(matches!(
+            rx.try_recv(),
+            Some(CameraEvent::Disconnected { .. })
+        ));
+    }
+
+    #[tokio::test]
+    async fn test_recv_returns_none_after_sender_dropped() {
+        let (tx, mut rx) = channel(config(4));
+        tx.send(CameraEvent::Connected { version: 1 });
+        drop(tx);
+
+        assert!(rx.recv().await.is_some());
+        assert!(rx.recv().await.is_none());
+    }
+
+    #[tokio::test]
+    async fn test_batch_defers_wakeup_until_end() {
+        let (tx, mut rx) = channel(config(8));
+        tx.batch(|| {
+            for version in 0..3 {
+                tx.send(CameraEvent::Connected { version });
+            }
+            assert!(tx.shared.pending_notify.load(Ordering::SeqCst));
+        });
+        assert!(!tx.shared.pending_notify.load(Ordering::SeqCst));
+
+        for _ in 0..3 {
+            assert!(rx.recv().await.is_some());
+        }
+        assert!(rx.try_recv().is_none());
+    }
+
+    #[test]
+    fn test_closed_receiver_is_empty() {
+        let mut rx = EventReceiver::closed();
+        assert!(rx.try_recv().is_none());
+        assert_eq!(rx.stats(), EventStats::default());
+    }
+}
@@ -0,0 +1,500 @@
+//! Batched delivery of callbacks queued in the C++ event ring
+//!
+//! With [`CameraDeviceBuilder::event_ring`](crate::blocking::CameraDeviceBuilder::event_ring)
+//! the C++ callback copies each fixed-size callback into a lock-free
+//! single-producer ring instead of calling into Rust, so the SDK thread spends
+//! a few nanoseconds per event. After each push the callback unparks a drainer
+//! thread if it is parked; the drainer moves records out in batches through
+//! `crsdk_drain_events` and feeds them through the usual `crsdk_event_*`
+//! entry points: cache invalidation, shot signals and recording behave as
+//! without the ring, and the queue's receiver is woken once per batch.
+//!
+//! Callbacks that don't fit a record (file names, transfer data, long code
+//! lists) or find the ring full still go straight to Rust, after the ring has
+//! been flushed on the SDK thread so events keep their order. The flush takes
+//! the consumer lock, so it also waits for a batch the drainer has taken out
+//! of the ring but not yet delivered.
+//!
+//! The ring stamps each record with a monotonic time as it is pushed, and
+//! the drainer carries that stamp into the queue, so the delivery latency
+//! metrics count the time a record spent waiting in the ring.
+//!
+//! Parking follows the eventcount pattern: the drainer announces it is about
+//! to park, then drains once more before parking, and the producer checks
+//! the announcement after publishing a record (both sides fence in between).
+//! A record is therefore either seen by that last drain or triggers a wakeup.
+
+use crate::event_sender::{
+    crsdk_event_connected, crsdk_event_contents_list_changed, crsdk_event_disconnected,
+    crsdk_event_error, crsdk_event_firmware_update, crsdk_event_lv_property_changed,
+    crsdk_event_property_changed, crsdk_event_warning, crsdk_event_warning_ext, with_callback_time,
+    EventSender,
+};
+use crsdk_sys::CrsdkEventRecord;
+use std::ffi::c_void;
+use std::sync::atomic::{fence, AtomicBool, AtomicPtr, Ordering};
+use std::sync::{Arc, Mutex, OnceLock};
+use std::thread::{JoinHandle, Thread};
+use std::time::{Duration, Instant};
+
+/// Ring size used when the builder asks for the default
+pub const DEFAULT_EVENT_RING_CAPACITY: usize = 256;
+
+/// Records moved per `crsdk_drain_events` call
+const DRAIN_BATCH: usize = 64;
+
+/// Pulls up to `max` records from `source` into `out`
+pub(crate) type DrainFn = unsafe fn(*mut c_void, *mut CrsdkEventRecord, u32) -> u32;
+
+/// Reads the clock records are stamped with (`pushed_at`), in nanoseconds
+pub(crate) type ClockFn = fn() -> u64;
+
+/// Consumer side of one callback's ring
+///
+/// Shared by the drainer thread and SDK-thread flushes; the buffer mutex makes
+/// sure only one of them drains at a time, as the ring requires.
+pub(crate) struct RingConsumer {
+    drain: DrainFn,
+    clock: ClockFn,
+    /// What `drain` reads from (the C++ callback), set once it exists
+    source: AtomicPtr<c_void>,
+    buffer: Mutex<Box<[CrsdkEventRecord]>>,
+    drainer: OnceLock<Thread>,
+    /// Set by the drainer before its last drain ahead of parking
+    parked: AtomicBool,
+    stop: AtomicBool,
+}
+
+/// `DrainFn` for rings inside a C++ `RustCallback`
+unsafe fn drain_callback(source: *mut c_void, out: *mut CrsdkEventRecord, max: u32) -> u32 {
+    // SAFETY: source is a callback from crsdk_create_rust_callback_with_ring
+    // and out has room for `max` records (caller guarantees both)
+    unsafe { crsdk_sys::crsdk_drain_events(source.cast(), out, max) }
+}
+
+/// `ClockFn` for rings inside a C++ `RustCallback`
+fn callback_clock() -> u64 {
+    // SAFETY: reads a clock, no arguments
+    unsafe { crsdk_sys::crsdk_event_ring_clock_ns() }
+}
+
+impl RingConsumer {
+    /// Consumer for the ring of a C++ callback, attached later with `attach`
+    pub(crate) fn native() -> Self {
+        Self::with_drain(drain_callback, callback_clock)
+    }
+
+    pub(crate) fn with_drain(drain: DrainFn, clock: ClockFn) -> Self {
+        Self {
+            drain,
+            clock,
+            source: AtomicPtr::new(std::ptr::null_mut()),
+            buffer: Mutex::new(vec![CrsdkEventRecord::default(); DRAIN_BATCH].into_boxed_slice()),
+            drainer: OnceLock::new(),
+            parked: AtomicBool::new(false),
+            stop: AtomicBool::new(false),
+        }
+    }
+
+    /// Start draining from `source`
+    pub(crate) fn attach(&self, source: *mut c_void) {
+        self.source.store(source, Ordering::Release);
+    }
+
+    /// Wake the drainer thread if it is parked (a record was just queued)
+    ///
+    /// The producer fences after publishing the record, pairing with the
+    /// fence in `park_unless_pending`.
+    pub(crate) fn wake(&self) {
+        if self.parked.load(Ordering::SeqCst) && self.parked.swap(false, Ordering::SeqCst) {
+            if let Some(thread) = self.drainer.get() {
+                thread.unpark();
+            }
+        }
+    }
+
+    /// Park the drainer until `wake`, unless records arrived meanwhile
+    fn park_unless_pending(&self, sender: &EventSender) {
+        self.parked.store(true, Ordering::SeqCst);
+        fence(Ordering::SeqCst);
+        // A push published before `parked` was visible didn't wake us
+        if self.drain_into(sender) == 0 && !self.stop.load(Ordering::Acquire) {
+            std::thread::park();
+        }
+        self.parked.store(false, Ordering::SeqCst);
+    }
+
+    /// Deliver every queued record through `sender`, returning how many
+    pub(crate) fn drain_into(&self, sender: &EventSender) -> usize {
+        let source = self.source.load(Ordering::Acquire);
+        if source.is_null() {
+            return 0;
+        }
+        let ctx = sender as *const EventSender as *mut c_void;
+
+        let mut buffer = self.buffer.lock().unwrap();
+        sender.batch(|| {
+            let mut total = 0;
+            loop {
+                // SAFETY: source was attached by the device that owns it and
+                // stays alive until the drainer is stopped; the buffer lock
+                // keeps drains from overlapping
+                let count =
+                    unsafe { (self.drain)(source, buffer.as_mut_ptr(), buffer.len() as u32) }
+                        as usize;
+                if count == 0 {
+                    return total;
+                }
+                // Map push stamps onto Instant through one reading of both clocks
+                let (now, now_ns) = (Instant::now(), (self.clock)());
+                for record in &buffer[..count.min(buffer.len())] {
+                    let waited = Duration::from_nanos(now_ns.saturating_sub(record.pushed_at));
+                    let pushed_at = now.checked_sub(waited).unwrap_or(now);
+                    with_callback_time(pushed_at, || dispatch(ctx, record));
+                }
+                total += count;
+            }
+        })
+    }
+}
+
+/// Feed one record through the same entry point the direct callback uses
+fn dispatch(ctx: *mut c_void, record: &CrsdkEventRecord) {
+    use crsdk_sys::{
+        CRSDK_EVENT_CONNECTED, CRSDK_EVENT_CONTENTS_LIST_CHANGED, CRSDK_EVENT_DISCONNECTED,
+        CRSDK_EVENT_ERROR, CRSDK_EVENT_FIRMWARE_UPDATE, CRSDK_EVENT_LV_PROPERTY_CHANGED,
+        CRSDK_EVENT_PROPERTY_CHANGED, CRSDK_EVENT_WARNING, CRSDK_EVENT_WARNING_EXT,
+    };
+
+    match record.kind {
+        CRSDK_EVENT_CONNECTED => crsdk_event_connected(ctx, record.arg0),
+        CRSDK_EVENT_DISCONNECTED => crsdk_event_disconnected(ctx, record.arg0),
+        CRSDK_EVENT_PROPERTY_CHANGED => {
+            let codes = record.codes();
+            crsdk_event_property_changed(ctx, codes.len() as u32, codes.as_ptr())
+        }
+        CRSDK_EVENT_LV_PROPERTY_CHANGED => {
+            let codes = record.codes();
+            crsdk_event_lv_property_changed(ctx, codes.len() as u32, codes.as_ptr())
+        }
+        CRSDK_EVENT_WARNING => crsdk_event_warning(ctx, record.arg0),
+        CRSDK_EVENT_WARNING_EXT => crsdk_event_warning_ext(
+            ctx,
+            record.arg0,
+            record.arg1 as i32,
+            record.arg2 as i32,
+            record.arg3 as i32,
+        ),
+        CRSDK_EVENT_ERROR => crsdk_event_error(ctx, record.arg0),
+        CRSDK_EVENT_CONTENTS_LIST_CHANGED => {
+            crsdk_event_contents_list_changed(ctx, record.arg0, record.arg1, record.arg2)
+        }
+        CRSDK_EVENT_FIRMWARE_UPDATE => crsdk_event_firmware_update(ctx, record.arg0),
+        kind => tracing::warn!("Unknown event ring record kind {}", kind),
+    }
+}
+
+/// Thread that drains a device's ring whenever the callback wakes it
+pub(crate) struct EventRingWorker {
+    consumer: Arc<RingConsumer>,
+    thread: Option<JoinHandle<()>>,
+}
+
+/// Event sender pointer handed to the drainer thread
+struct SenderPtr(*mut c_void);
+
+// SAFETY: the EventSender behind the pointer is Sync and outlives the thread
+// (the device stops the worker before reclaiming it)
+unsafe impl Send for SenderPtr {}
+
+impl EventRingWorker {
+    /// Spawn a drainer feeding the event sender behind `ctx`
+    pub(crate) fn spawn(ctx: *mut c_void, consumer: Arc<RingConsumer>) -> std::io::Result<Self> {
+        let ctx = SenderPtr(ctx);
+        let thread = {
+            let consumer = consumer.clone();
+            std::thread::Builder::new()
+                .name("crsdk-events".to_string())
+                .spawn(move || {
+                    let ctx = ctx;
+                    // SAFETY: see SenderPtr
+                    let sender = unsafe { &*(ctx.0 as *const EventSender) };
+                    loop {
+                        let stopping = consumer.stop.load(Ordering::Acquire);
+                        consumer.drain_into(sender);
+                        if stopping {
+                            return;
+                        }
+                        consumer.park_unless_pending(sender);
+                    }
+                })?
+        };
+        let _ = consumer.drainer.set(thread.thread().clone());
+
+        Ok(Self {
+            consumer,
+            thread: Some(thread),
+        })
+    }
+}
+
+impl Drop for EventRingWorker {
+    /// Deliver whatever is left and join the thread
+    fn drop(&mut self) {
+        self.consumer.stop.store(true, Ordering::Release);
+        if let Some(thread) = self.thread.take() {
+            thread.thread().unpark();
+            let _ = thread.join();
+        }
+    }
+}
+
+// =============================================================================
+// FFI hooks called by the C++ callback
+//
+// SAFETY: `ctx` is a valid EventSender pointer, as for the crsdk_event_*
+// functions.
+// =============================================================================
+
+#[no_mangle]
+pub extern "C" fn crsdk_event_ring_ready(ctx: *mut c_void) {
+    if ctx.is_null() {
+        return;
+    }
+    // SAFETY: C++ guarantees ctx is a valid EventSender pointer
+    let sender = unsafe { &*(ctx as *const EventSender) };
+    if let Some(ring) = sender.event_ring() {
+        ring.wake();
+    }
+}
+
+#[no_mangle]
+pub extern "C" fn crsdk_event_ring_flush(ctx: *mut c_void) {
+    if ctx.is_null() {
+        return;
+    }
+    // SAFETY: C++ guarantees ctx is a valid EventSender pointer
+    let sender = unsafe { &*(ctx as *const EventSender) };
+    if let Some(ring) = sender.event_ring() {
+        ring.drain_into(sender);
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::event::CameraEvent;
+    use crate::event_queue::{self, EventChannelConfig};
+    use crate::metrics::EventKind;
+    use crate::property::PropertyCache;
+    use crsdk_sys::DevicePropertyCode;
+    use std::collections::VecDeque;
+
+    /// Stand-in for the C++ ring: a locked queue behind the source pointer
+    type FakeRing = Mutex<VecDeque<CrsdkEventRecord>>;
+
+    /// Stand-in for the C++ ring clock
+    fn clock_fake() -> u64 {
+        static EPOCH: OnceLock<Instant> = OnceLock::new();
+        EPOCH.get_or_init(Instant::now).elapsed().as_nanos() as u64
+    }
+
+    unsafe fn drain_fake(source: *mut c_void, out: *mut CrsdkEventRecord, max: u32) -> u32 {
+        // SAFETY: tests attach a live FakeRing
+        let ring = unsafe { &*(source as *const FakeRing) };
+        let mut ring = ring.lock().unwrap();
+        let count = ring.len().min(max as usize);
+        for (i, record) in ring.drain(..count).enumerate() {
+            // SAFETY: out has room for max records
+            unsafe { out.add(i).write(record) };
+        }
+        count as u32
+    }
+
+    fn record(kind: u32, arg0: u32) -> CrsdkEventRecord {
+        CrsdkEventRecord {
+            kind,
+            arg0,
+            ..Default::default()
+        }
+    }
+
+    fn property_record(code: DevicePropertyCode) -> CrsdkEventRecord {
+        let mut record = record(crsdk_sys::CRSDK_EVENT_PROPERTY_CHANGED, 0);
+        record.codes[0] = code.as_raw();
+        record.num_codes = 1;
+        record
+    }
+
+    #[test]
+    fn test_latency_counts_time_in_ring() {
+        let ring = FakeRing::default();
+        let consumer = Arc::new(RingConsumer::with_drain(drain_fake, clock_fake));
+        consumer.attach(&ring as *const FakeRing as *mut c_void);
+
+        let (tx, mut rx) = event_queue::channel(EventChannelConfig::default());
+        let stats = tx.stats_handle();
+        let ptr = EventSender::new(tx).with_event_ring(consumer).into_raw();
+
+        let mut connected = record(crsdk_sys::CRSDK_EVENT_CONNECTED, 3);
+        connected.pushed_at = clock_fake();
+        ring.lock().unwrap().push_back(connected);
+        std::thread::sleep(Duration::from_millis(20));
+        crsdk_event_ring_flush(ptr);
+
+        assert!(rx.try_recv().is_some());
+        let latency = &stats.latencies()[EventKind::Connected as usize];
+        assert_eq!(latency.count, 1);
+        assert!(latency.max >= Duration::from_millis(20));
+
+        // SAFETY: ptr came from into_raw above
+        let _ = unsafe { EventSender::from_raw(ptr) };
+    }
+
+    #[test]
+    fn test_flush_dispatches_records_in_order() {
+        let ring = FakeRing::default();
+        let consumer = Arc::new(RingConsumer::with_drain(drain_fake, clock_fake));
+        consumer.attach(&ring as *const FakeRing as *mut c_void);
+
+        let cache = PropertyCache::new();
+        let (tx, mut rx) = event_queue::channel(EventChannelConfig::default());
+        let sender = EventSender::new(tx)
+            .with_property_cache(cache.clone())
+            .with_event_ring(consumer);
+        let ptr = sender.into_raw();
+
+        {
+            let mut queued = ring.lock().unwrap();
+            queued.push_back(record(crsdk_sys::CRSDK_EVENT_CONNECTED, 3));
+            // More than one drain batch
+            for _ in 0..DRAIN_BATCH {
+                queued.push_back(property_record(DevicePropertyCode::FNumber));
+            }
+            let mut warning = record(crsdk_sys::CRSDK_EVENT_WARNING_EXT, 0x20);
+            warning.arg1 = -1i32 as u32;
+            queued.push_back(warning);
+        }
+        crsdk_event_ring_flush(ptr);
+
+        assert!(ring.lock().unwrap().is_empty());
+        assert!(matches!(
+            rx.try_recv(),
+            Some(CameraEvent::Connected { version: 3 })
+        ));
+        for _ in 0..DRAIN_BATCH {
+            assert!(matches!(
+                rx.try_recv(),
+                Some(CameraEvent::PropertyChanged { codes }) if codes.contains(DevicePropertyCode::FNumber)
+            ));
+        }
+        assert!(matches!(
+            rx.try_recv(),
+            Some(CameraEvent::Warning {
+                code: 0x20,
+                params: Some((-1, 0, 0))
+            })
+        ));
+        assert!(rx.try_recv().is_none());
+        assert!(cache.is_stale(DevicePropertyCode::FNumber));
+
+        let _ = unsafe { EventSender::from_raw(ptr) };
+    }
+
+    #[test]
+    fn test_worker_drains_on_wake_and_on_stop() {
+        let ring = Box::leak(Box::new(FakeRing::default()));
+        let consumer = Arc::new(RingConsumer::with_drain(drain_fake, clock_fake));
+        consumer.attach(ring as *const FakeRing as *mut c_void);
+
+        let (tx, mut rx) = event_queue::channel(EventChannelConfig::default());
+        let ptr = EventSender::new(tx)
+            .with_event_ring(consumer.clone())
+            .into_raw();
+        let worker = EventRingWorker::spawn(ptr, consumer).unwrap();
+
+        ring.lock()
+            .unwrap()
+            .push_back(record(crsdk_sys::CRSDK_EVENT_ERROR, 7));
+        crsdk_event_ring_ready(ptr);
+
+        let deadline = Instant::now() + Duration::from_secs(5);
+        let event = loop {
+            if let Some(event) = rx.try_recv() {
+                break event;
+            }
+            assert!(Instant::now() < deadline, "drainer never delivered");
+            std::thread::sleep(Duration::from_millis(1));
+        };
+        assert!(matches!(event, CameraEvent::Error { code: 7 }));
+
+        // Records still queued when the device goes away are delivered
+        ring.lock()
+            .unwrap()
+            .push_back(record(crsdk_sys::CRSDK_EVENT_DISCONNECTED, 0));
+        drop(worker);
+        assert!(matches!(
+            rx.try_recv(),
+            Some(CameraEvent::Disconnected { error: 0 })
+        ));
+
+        let _ = unsafe { EventSender::from_raw(ptr) };
+    }
+
+    #[test]
+    fn test_concurrent_producer_never_strands_records() {
+        const RECORDS: u32 = 20_000;
+
+        let ring: &'static FakeRing = Box::leak(Box::new(FakeRing::default()));
+        let consumer = Arc::new(RingConsumer::with_drain(drain_fake, clock_fake));
+        consumer.attach(ring as *const FakeRing as *mut c_void);
+
+        let (tx, mut rx) = event_queue::channel(EventChannelConfig::default());
+        let ptr = EventSender::new(tx)
+            .with_event_ring(consumer.clone())
+            .into_raw();
+        let worker = EventRingWorker::spawn(ptr, consumer).unwrap();
+
+        // Push like the C++ callback does, pausing now and then so the
+        // drainer keeps going idle and parking between bursts
+        let ctx = SenderPtr(ptr);
+        let producer = std::thread::spawn(move || {
+            let ctx = ctx;
+            for code in 0..RECORDS {
+                ring.lock()
+                    .unwrap()
+                    .push_back(record(crsdk_sys::CRSDK_EVENT_ERROR, code));
+                crsdk_event_ring_ready(ctx.0);
+                if code % 97 == 0 {
+                    std::thread::sleep(Duration::from_micros(50));
+                }
+            }
+        });
+
+        // Without a final wakeup the last records would sit in the ring
+        let deadline = Instant::now() + Duration::from_secs(10);
+        let mut expected = 0;
+        while expected < RECORDS {
+            match rx.try_recv() {
+                Some(CameraEvent::Error { code }) => {
+                    assert_eq!(code, expected);
+                    expected += 1;
+                }
+                Some(other) => panic!("unexpected event {:?}", other),
+                None => {
+                    assert!(
+                        Instant::now() < deadline,
+                        "stranded after {} of {} records",
+                        expected,
+                        RECORDS
+                    );
+                    std::thread::yield_now();
+                }
+            }
+        }
+
+        producer.join().unwrap();
+        drop(worker);
+        let _ = unsafe { EventSender::from_raw(ptr) };
+    }
+}
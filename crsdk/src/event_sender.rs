@@ -1,8 +1,8 @@
 //! Event sender for C++ callback to Rust channel bridge
 //!
 //! This module provides the FFI functions that C++ callbacks call to send events
-//! to Rust. The EventSender wraps a tokio::sync::mpsc::UnboundedSender and is
-//! passed to C++ as a void pointer.
+//! to Rust. The EventSender wraps the producer side of the bounded event queue
+//! (see `event_queue`) and is passed to C++ as a void pointer.
 //!
 //! # Safety
 //!
@@ -10,23 +10,126 @@
 //! pointer obtained from `EventSender::into_raw()`, and must not use the pointer
 //! after calling `EventSender::from_raw()` to reclaim it.
 
-use crate::event::CameraEvent;
-use crsdk_sys::DevicePropertyCode;
+use crate::backend::{CallbackRecord, CallbackRecorder};
+use crate::event::{CameraEvent, LiveViewCodes};
+use crate::event_queue::EventQueueSender;
+use crate::event_ring::RingConsumer;
+use crate::preset::PropertySignals;
+use crate::property::{PropertyCache, PropertyCodeSet};
+use crate::sdk_string;
+use crate::shot::ShotSignals;
+use crate::transfer::TransferSinkSlot;
+use crsdk_sys::CrChar;
+use std::cell::Cell;
 use std::ffi::c_void;
-use tokio::sync::mpsc::UnboundedSender;
+use std::sync::Arc;
+use std::time::Instant;
+
+thread_local! {
+    /// When the callback being dispatched on this thread reached the shim,
+    /// if that was before it entered Rust (records from the event ring)
+    static CALLBACK_TIME: Cell<Option<Instant>> = const { Cell::new(None) };
+}
+
+/// Run `f`, stamping the events it sends as if their callback ran at `at`
+pub(crate) fn with_callback_time<R>(at: Instant, f: impl FnOnce() -> R) -> R {
+    struct Reset;
+
+    impl Drop for Reset {
+        fn drop(&mut self) {
+            CALLBACK_TIME.with(|time| time.set(None));
+        }
+    }
+
+    CALLBACK_TIME.with(|time| time.set(Some(at)));
+    let _reset = Reset;
+    f()
+}
 
 /// Wrapper around a channel sender for passing to C++
 ///
 /// This is heap-allocated and passed to C++ as a raw pointer.
 /// C++ callback functions will call back into Rust with this pointer.
 pub struct EventSender {
-    sender: UnboundedSender<CameraEvent>,
+    sender: EventQueueSender,
+    /// Cache to invalidate on property changes (if caching is enabled)
+    property_cache: Option<PropertyCache>,
+    /// Where in-memory transfer data goes instead of the channel (if set)
+    transfer_sink: TransferSinkSlot,
+    /// AF results and shot confirmations for the device's capture helpers
+    shot_signals: ShotSignals,
+    /// Property changes, for waiting on specific codes
+    property_signals: PropertySignals,
+    /// Captures raw callback arguments for later replay (if set)
+    recorder: Option<CallbackRecorder>,
+    /// Consumer of the C++ event ring (if the callback queues into one)
+    event_ring: Option<Arc<RingConsumer>>,
 }
 
 impl EventSender {
-    /// Create a new EventSender wrapping the given channel sender
-    pub fn new(sender: UnboundedSender<CameraEvent>) -> Self {
-        Self { sender }
+    /// Create a new EventSender wrapping the given queue sender
+    pub fn new(sender: EventQueueSender) -> Self {
+        Self {
+            sender,
+            property_cache: None,
+            transfer_sink: TransferSinkSlot::default(),
+            shot_signals: ShotSignals::default(),
+            property_signals: PropertySignals::default(),
+            recorder: None,
+            event_ring: None,
+        }
+    }
+
+    /// Invalidate entries in `cache` whenever the camera reports a property change
+    pub fn with_property_cache(mut self, cache: PropertyCache) -> Self {
+        self.property_cache = Some(cache);
+        self
+    }
+
+    /// Route transfer data into whatever sink is installed in `slot`
+    pub(crate) fn with_transfer_sink(mut self, slot: TransferSinkSlot) -> Self {
+        self.transfer_sink = slot;
+        self
+    }
+
+    /// Record AF results and shot confirmations into `signals`
+    pub(crate) fn with_shot_signals(mut self, signals: ShotSignals) -> Self {
+        self.shot_signals = signals;
+        self
+    }
+
+    /// Record reported property changes into `signals`
+    pub(crate) fn with_property_signals(mut self, signals: PropertySignals) -> Self {
+        self.property_signals = signals;
+        self
+    }
+
+    /// Record every callback into `recorder`
+    pub(crate) fn with_recorder(mut self, recorder: CallbackRecorder) -> Self {
+        self.recorder = Some(recorder);
+        self
+    }
+
+    /// Drain the callback's event ring through `consumer`
+    pub(crate) fn with_event_ring(mut self, consumer: Arc<RingConsumer>) -> Self {
+        self.event_ring = Some(consumer);
+        self
+    }
+
+    pub(crate) fn event_ring(&self) -> Option<&Arc<RingConsumer>> {
+        self.event_ring.as_ref()
+    }
+
+    /// Send the events queued by `f` with a single receiver wakeup
+    pub(crate) fn batch<R>(&self, f: impl FnOnce() -> R) -> R {
+        self.sender.batch(f)
+    }
+
+    /// Hand a callback to the recorder, building the record only if one is installed
+    fn record(&self, record: impl FnOnce() -> CallbackRecord) {
+        if let Some(recorder) = &self.recorder {
+            recorder.record(record());
+        }
     }
 
     /// Convert to a raw pointer for passing to C++
@@ -48,12 +151,14 @@ impl EventSender {
         *unsafe { Box::from_raw(ptr as *mut Self) }
     }
 
-    /// Send an event to the channel
+    /// Send an event to the queue
     ///
-    /// This is non-blocking and will never fail (unbounded channel).
-    /// If the receiver is dropped, the event is silently discarded.
+    /// This never blocks the SDK thread. When the queue is full the configured
+    /// overflow policy applies; if the receiver is dropped, the event is
+    /// silently discarded.
     fn send(&self, event: CameraEvent) {
-        let _ = self.sender.send(event);
+        let at = CALLBACK_TIME.with(Cell::get).unwrap_or_else(Instant::now);
+        self.sender.send_at(event, at);
     }
 }
 
@@ -74,6 +179,7 @@ pub extern "C" fn crsdk_event_connected(ctx: *mut c_void, version: u32) {
     }
     // SAFETY: C++ guarantees ctx is a valid EventSender pointer
     let sender = unsafe { &*(ctx as *const EventSender) };
+    sender.record(|| CallbackRecord::Connected { version });
     sender.send(CameraEvent::Connected { version });
 }
 
@@ -84,6 +190,7 @@ pub extern "C" fn crsdk_event_disconnected(ctx: *mut c_void, error: u32) {
     }
     // SAFETY: C++ guarantees ctx is a valid EventSender pointer
     let sender = unsafe { &*(ctx as *const EventSender) };
+    sender.record(|| CallbackRecord::Disconnected { error });
     sender.send(CameraEvent::Disconnected { error });
 }
 
@@ -95,16 +202,23 @@ pub extern "C" fn crsdk_event_property_changed(ctx: *mut c_void, num: u32, codes
     // SAFETY: C++ guarantees ctx is a valid EventSender pointer
     let sender = unsafe { &*(ctx as *const EventSender) };
 
-    let codes = if codes.is_null() || num == 0 {
-        Vec::new()
+    let codes: &[u32] = if codes.is_null() || num == 0 {
+        &[]
     } else {
         // SAFETY: C++ guarantees codes points to `num` valid u32 values
-        let slice = unsafe { std::slice::from_raw_parts(codes, num as usize) };
-        slice
-            .iter()
-            .filter_map(|&code| DevicePropertyCode::from_raw(code))
-            .collect()
+        unsafe { std::slice::from_raw_parts(codes, num as usize) }
     };
+    sender.record(|| CallbackRecord::PropertyChanged {
+        codes: codes.to_vec(),
+    });
+    let codes = PropertyCodeSet::from_raw_codes(codes);
+
+    // Invalidate before sending so a receiver never sees the event
+    // while the cache still reports the old value as fresh
+    if let Some(cache) = &sender.property_cache {
+        cache.invalidate(codes);
+    }
+    sender.property_signals.changed(codes);
 
     sender.send(CameraEvent::PropertyChanged { codes });
 }
@@ -117,35 +231,35 @@ pub extern "C" fn crsdk_event_lv_property_changed(ctx: *mut c_void, num: u32, co
     // SAFETY: C++ guarantees ctx is a valid EventSender pointer
     let sender = unsafe { &*(ctx as *const EventSender) };
 
-    let codes = if codes.is_null() || num == 0 {
-        Vec::new()
+    let codes: &[u32] = if codes.is_null() || num == 0 {
+        &[]
     } else {
         // SAFETY: C++ guarantees codes points to `num` valid u32 values
-        unsafe { std::slice::from_raw_parts(codes, num as usize).to_vec() }
+        unsafe { std::slice::from_raw_parts(codes, num as usize) }
     };
+    sender.record(|| CallbackRecord::LiveViewPropertyChanged {
+        codes: codes.to_vec(),
+    });
+    let codes = LiveViewCodes::from_slice(codes);
 
     sender.send(CameraEvent::LiveViewPropertyChanged { codes });
 }
 
 #[no_mangle]
-pub extern "C" fn crsdk_event_download_complete(ctx: *mut c_void, filename: *const i8) {
+pub extern "C" fn crsdk_event_download_complete(ctx: *mut c_void, filename: *const CrChar) {
     if ctx.is_null() {
         return;
     }
     // SAFETY: C++ guarantees ctx is a valid EventSender pointer
     let sender = unsafe { &*(ctx as *const EventSender) };
 
-    let filename = if filename.is_null() {
-        String::new()
-    } else {
-        // SAFETY: C++ guarantees filename is null-terminated
-        unsafe {
-            std::ffi::CStr::from_ptr(filename)
-                .to_string_lossy()
-                .into_owned()
-        }
-    };
+    // SAFETY: C++ guarantees filename is null or null-terminated
+    let filename = unsafe { sdk_string::decode_shared(filename, None) };
 
+    sender.record(|| CallbackRecord::DownloadComplete {
+        filename: filename.to_string(),
+    });
+    sender.shot_signals.shot_saved(Some(filename.clone()));
     sender.send(CameraEvent::DownloadComplete { filename });
 }
 
@@ -154,7 +268,7 @@ pub extern "C" fn crsdk_event_contents_transfer(
     ctx: *mut c_void,
     notify: u32,
     handle: u64,
-    filename: *const i8,
+    filename: *const CrChar,
 ) {
     if ctx.is_null() {
         return;
@@ -162,16 +276,20 @@ pub extern "C" fn crsdk_event_contents_transfer(
     // SAFETY: C++ guarantees ctx is a valid EventSender pointer
     let sender = unsafe { &*(ctx as *const EventSender) };
 
-    let filename = if filename.is_null() {
-        None
-    } else {
-        // SAFETY: C++ guarantees filename is null-terminated if not null
-        Some(unsafe {
-            std::ffi::CStr::from_ptr(filename)
-                .to_string_lossy()
-                .into_owned()
-        })
-    };
+    // SAFETY: C++ guarantees filename is null-terminated if not null
+    let filename =
+        (!filename.is_null()).then(|| unsafe { sdk_string::decode_shared(filename, None) });
+
+    sender.record(|| CallbackRecord::ContentsTransfer {
+        notify,
+        handle,
+        filename: filename.as_deref().map(str::to_owned),
+    });
+
+    // Only the completion notification names the saved file
+    if filename.is_some() {
+        sender.shot_signals.shot_saved(filename.clone());
+    }
 
     sender.send(CameraEvent::ContentsTransfer {
         notify,
@@ -187,6 +305,8 @@ pub extern "C" fn crsdk_event_warning(ctx: *mut c_void, warning: u32) {
     }
     // SAFETY: C++ guarantees ctx is a valid EventSender pointer
     let sender = unsafe { &*(ctx as *const EventSender) };
+    sender.record(|| CallbackRecord::Warning { code: warning });
+    sender.shot_signals.warning(warning, None);
     sender.send(CameraEvent::Warning {
         code: warning,
         params: None,
@@ -206,9 +326,18 @@ pub extern "C" fn crsdk_event_warning_ext(
     }
     // SAFETY: C++ guarantees ctx is a valid EventSender pointer
     let sender = unsafe { &*(ctx as *const EventSender) };
+
+    sender.record(|| CallbackRecord::WarningExt {
+        code: warning,
+        params: (p1, p2, p3),
+    });
+
+    let params = Some((p1, p2, p3));
+    sender.shot_signals.warning(warning, params);
+
     sender.send(CameraEvent::Warning {
         code: warning,
-        params: Some((p1, p2, p3)),
+        params,
     });
 }
 
@@ -219,6 +348,7 @@ pub extern "C" fn crsdk_event_error(ctx: *mut c_void, error: u32) {
     }
     // SAFETY: C++ guarantees ctx is a valid EventSender pointer
     let sender = unsafe { &*(ctx as *const EventSender) };
+    sender.record(|| CallbackRecord::Error { code: error });
     sender.send(CameraEvent::Error { code: error });
 }
 
@@ -227,7 +357,7 @@ pub extern "C" fn crsdk_event_remote_transfer_progress(
     ctx: *mut c_void,
     notify: u32,
     percent: u32,
-    filename: *const i8,
+    filename: *const CrChar,
 ) {
     if ctx.is_null() {
         return;
@@ -235,15 +365,16 @@ pub extern "C" fn crsdk_event_remote_transfer_progress(
     // SAFETY: C++ guarantees ctx is a valid EventSender pointer
     let sender = unsafe { &*(ctx as *const EventSender) };
 
-    let filename = if filename.is_null() {
-        None
-    } else {
-        Some(unsafe {
-            std::ffi::CStr::from_ptr(filename)
-                .to_string_lossy()
-                .into_owned()
-        })
-    };
+    // SAFETY: C++ guarantees filename is null-terminated if not null
+    let filename =
+        (!filename.is_null()).then(|| unsafe { sdk_string::decode_shared(filename, None) });
+
+    sender.record(|| CallbackRecord::RemoteTransferProgress {
+        notify,
+        percent,
+        filename: filename.as_deref().map(str::to_owned),
+    });
+    sender.transfer_sink.finish(notify);
 
     sender.send(CameraEvent::RemoteTransferProgress {
         notify,
@@ -266,12 +397,32 @@ pub extern "C" fn crsdk_event_remote_transfer_data(
     // SAFETY: C++ guarantees ctx is a valid EventSender pointer
     let sender = unsafe { &*(ctx as *const EventSender) };
 
-    let data = if data.is_null() || size == 0 {
-        Vec::new()
+    let data: &[u8] = if data.is_null() || size == 0 {
+        &[]
     } else {
-        // SAFETY: C++ guarantees data points to `size` valid bytes
-        unsafe { std::slice::from_raw_parts(data, size as usize).to_vec() }
+        // SAFETY: C++ guarantees data points to `size` valid bytes for the
+        // duration of this call
+        unsafe { std::slice::from_raw_parts(data, size as usize) }
     };
+    sender.record(|| CallbackRecord::RemoteTransferData {
+        notify,
+        percent,
+        data: data.to_vec(),
+    });
+
+    // With a sink installed the chunk is consumed in place and only
+    // progress is queued
+    if sender.transfer_sink.deliver(notify, percent, data) {
+        sender.transfer_sink.finish(notify);
+        sender.send(CameraEvent::RemoteTransferProgress {
+            notify,
+            percent,
+            filename: None,
+        });
+        return;
+    }
+
+    let data = data.to_vec();
 
     sender.send(CameraEvent::RemoteTransferData {
         notify,
@@ -292,6 +443,11 @@ pub extern "C" fn crsdk_event_contents_list_changed(
     }
     // SAFETY: C++ guarantees ctx is a valid EventSender pointer
     let sender = unsafe { &*(ctx as *const EventSender) };
+    sender.record(|| CallbackRecord::ContentsListChanged {
+        notify,
+        slot,
+        added,
+    });
     sender.send(CameraEvent::ContentsListChanged {
         notify,
         slot,
@@ -306,16 +462,20 @@ pub extern "C" fn crsdk_event_firmware_update(ctx: *mut c_void, notify: u32) {
     }
     // SAFETY: C++ guarantees ctx is a valid EventSender pointer
     let sender = unsafe { &*(ctx as *const EventSender) };
+    sender.record(|| CallbackRecord::FirmwareUpdate { notify });
     sender.send(CameraEvent::FirmwareUpdateProgress { notify });
 }
 
 #[cfg(test)]
 mod tests {
     use super::*;
+    use crate::event_queue::{self, EventChannelConfig};
+    use crate::shot::AfStatus;
+    use crsdk_sys::DevicePropertyCode;
 
     #[test]
     fn test_event_sender_connected() {
-        let (tx, mut rx) = tokio::sync::mpsc::unbounded_channel();
+        let (tx, mut rx) = event_queue::channel(EventChannelConfig::default());
         let sender = EventSender::new(tx);
         let ptr = sender.into_raw();
 
@@ -334,7 +494,7 @@ mod tests {
 
     #[test]
     fn test_event_sender_disconnected() {
-        let (tx, mut rx) = tokio::sync::mpsc::unbounded_channel();
+        let (tx, mut rx) = event_queue::channel(EventChannelConfig::default());
         let sender = EventSender::new(tx);
         let ptr = sender.into_raw();
 
@@ -352,7 +512,7 @@ mod tests {
 
     #[test]
     fn test_event_sender_property_changed() {
-        let (tx, mut rx) = tokio::sync::mpsc::unbounded_channel();
+        let (tx, mut rx) = event_queue::channel(EventChannelConfig::default());
         let sender = EventSender::new(tx);
         let ptr = sender.into_raw();
 
@@ -366,8 +526,8 @@ mod tests {
         let event = rx.try_recv().unwrap();
         if let CameraEvent::PropertyChanged { codes } = event {
             assert_eq!(codes.len(), 2);
-            assert_eq!(codes[0], DevicePropertyCode::FNumber);
-            assert_eq!(codes[1], DevicePropertyCode::IsoSensitivity);
+            assert!(codes.contains(DevicePropertyCode::FNumber));
+            assert!(codes.contains(DevicePropertyCode::IsoSensitivity));
         } else {
             panic!("Expected PropertyChanged event");
         }
@@ -375,6 +535,77 @@ mod tests {
         let _ = unsafe { EventSender::from_raw(ptr) };
     }
 
+    #[test]
+    fn test_event_sender_property_changed_invalidates_cache() {
+        let (tx, mut rx) = event_queue::channel(EventChannelConfig::default());
+        let cache = PropertyCache::new();
+        let sender = EventSender::new(tx).with_property_cache(cache.clone());
+        let ptr = sender.into_raw();
+
+        let codes: [u32; 1] = [crsdk_sys::SCRSDK::CrDevicePropertyCode_CrDeviceProperty_FNumber];
+        crsdk_event_property_changed(ptr, 1, codes.as_ptr());
+
+        assert!(cache.is_stale(DevicePropertyCode::FNumber));
+        assert!(!cache.is_stale(DevicePropertyCode::IsoSensitivity));
+        assert!(matches!(
+            rx.try_recv().unwrap(),
+            CameraEvent::PropertyChanged { .. }
+        ));
+
+        let _ = unsafe { EventSender::from_raw(ptr) };
+    }
+
+    #[test]
+    fn test_event_sender_remote_transfer_data_uses_sink() {
+        use crate::transfer::TransferBuffer;
+        use std::sync::Arc;
+
+        let (tx, mut rx) = event_queue::channel(EventChannelConfig::default());
+        let slot = TransferSinkSlot::default();
+        let sender = EventSender::new(tx).with_transfer_sink(slot.clone());
+        let ptr = sender.into_raw();
+
+        let chunk = [1u8, 2, 3, 4];
+        crsdk_event_remote_transfer_data(ptr, 0, 10, chunk.as_ptr(), chunk.len() as u64);
+        assert!(matches!(
+            rx.try_recv().unwrap(),
+            CameraEvent::RemoteTransferData { data, .. } if data == chunk
+        ));
+
+        let buffer = TransferBuffer::with_capacity(16);
+        slot.set(Some(Arc::new(buffer.clone())));
+        crsdk_event_remote_transfer_data(ptr, 0, 100, chunk.as_ptr(), chunk.len() as u64);
+        assert_eq!(buffer.to_vec(), chunk);
+        assert!(matches!(
+            rx.try_recv().unwrap(),
+            CameraEvent::RemoteTransferProgress { percent: 100, .. }
+        ));
+
+        let _ = unsafe { EventSender::from_raw(ptr) };
+    }
+
+    #[test]
+    fn test_event_sender_af_status_signals_waiters() {
+        let (tx, mut rx) = event_queue::channel(EventChannelConfig::default());
+        let signals = ShotSignals::default();
+        let sender = EventSender::new(tx).with_shot_signals(signals.clone());
+        let ptr = sender.into_raw();
+
+        let mark = signals.mark();
+        crsdk_event_warning_ext(ptr, crate::shot::AF_STATUS_WARNING, 0x02, 0, 0);
+
+        assert_eq!(
+            signals.wait_af(mark, std::time::Duration::ZERO),
+            Some(AfStatus::Focused)
+        );
+        assert!(matches!(
+            rx.try_recv().unwrap(),
+            CameraEvent::Warning { .. }
+        ));
+
+        let _ = unsafe { EventSender::from_raw(ptr) };
+    }
+
     #[test]
     fn test_event_sender_null_ctx_no_panic() {
         crsdk_event_connected(std::ptr::null_mut(), 1);
@@ -386,7 +617,7 @@ mod tests {
 
     #[test]
     fn test_event_sender_multiple_events() {
-        let (tx, mut rx) = tokio::sync::mpsc::unbounded_channel();
+        let (tx, mut rx) = event_queue::channel(EventChannelConfig::default());
         let sender = EventSender::new(tx);
         let ptr = sender.into_raw();
 
@@ -403,7 +634,7 @@ mod tests {
             CameraEvent::Warning { .. }
         ));
         assert!(matches!(rx.try_recv().unwrap(), CameraEvent::Error { .. }));
-        assert!(rx.try_recv().is_err()); // No more events
+        assert!(rx.try_recv().is_none()); // No more events
 
         let _ = unsafe { EventSender::from_raw(ptr) };
     }
@@ -0,0 +1,612 @@
+//! Managing many cameras at once
+//!
+//! [`CameraFleet`] connects a set of cameras concurrently, so bringing up an
+//! array takes about as long as its slowest body instead of the sum of all of
+//! them. Each camera keeps its own SDK callback and event queue; the fleet
+//! merges those queues into one stream of [`FleetEvent`]s tagged with a
+//! [`CameraId`].
+//!
+//! [`CameraFleet::trigger`] fires every camera at once for bullet-time and
+//! volumetric rigs, and reports how far apart the releases went out and
+//! which bodies failed to focus.
+
+use crate::blocking::{self, RELEASE_HOLD};
+use crate::command::{CommandId, CommandParam};
+use crate::device::{discover_cameras, CameraDevice, CameraDeviceBuilder};
+use crate::error::{Error, Result};
+use crate::event::CameraEvent;
+use crate::event_queue::EventReceiver;
+use crate::shot::AfStatus;
+use crate::types::DiscoveredCamera;
+use std::collections::BTreeMap;
+use std::fmt;
+use std::sync::{Arc, Condvar, Mutex};
+use std::time::{Duration, Instant};
+use tokio::sync::mpsc;
+use tokio::task::{JoinHandle, JoinSet};
+
+/// Number of merged events buffered before per-camera forwarding waits
+///
+/// While the merged stream is full, events back up in each camera's own
+/// queue, where its overflow policy applies.
+pub const FLEET_EVENT_CAPACITY: usize = 1024;
+
+/// How long past the AF timeout a trigger waits for every camera to arm
+///
+/// Covers the half-press and focus mode round trips; a camera that hasn't
+/// armed by then aborts the trigger.
+pub const TRIGGER_ARM_SLACK: Duration = Duration::from_secs(5);
+
+/// Identifies a camera within a fleet
+///
+/// Ids are assigned in the order builders are passed to
+/// [`CameraFleet::connect`], starting at 0.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash, PartialOrd, Ord)]
+pub struct CameraId(pub usize);
+
+impl fmt::Display for CameraId {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        write!(f, "camera {}", self.0)
+    }
+}
+
+/// An event from one camera of a fleet
+#[derive(Debug, Clone)]
+pub struct FleetEvent {
+    /// Camera the event came from
+    pub camera: CameraId,
+    /// The event itself
+    pub event: CameraEvent,
+}
+
+/// Outcome of one camera in a synchronized trigger
+#[derive(Debug)]
+pub struct TriggerShot {
+    /// Camera that was fired
+    pub camera: CameraId,
+    /// When Release Down was handed to the SDK (`None` if arming failed)
+    pub sent_at: Option<Instant>,
+    /// How long the Release Down call took to return
+    pub send_latency: Duration,
+    /// AF result the camera settled on before the rendezvous (`None` in MF or
+    /// if arming failed)
+    pub af: Option<AfStatus>,
+    /// First error from arming, releasing or disarming, if any
+    ///
+    /// A camera that reports no AF result within the timeout fails to arm
+    /// with [`Error::Timeout`].
+    pub error: Option<Error>,
+}
+
+/// Per-camera results of [`CameraFleet::trigger`], in camera id order
+#[derive(Debug)]
+pub struct TriggerReport {
+    /// One entry per camera in the fleet
+    pub shots: Vec<TriggerShot>,
+}
+
+impl TriggerReport {
+    /// Check whether every camera fired without error
+    pub fn all_fired(&self) -> bool {
+        self.shots.iter().all(|shot| shot.error.is_none())
+    }
+
+    /// Cameras that fired after reporting a failed AF result
+    pub fn unfocused(&self) -> impl Iterator<Item = CameraId> + '_ {
+        self.shots
+            .iter()
+            .filter(|shot| shot.sent_at.is_some())
+            .filter(|shot| shot.af.is_some_and(|af| !af.is_focused()))
+            .map(|shot| shot.camera)
+    }
+
+    /// Time between the earliest and latest Release Down send
+    ///
+    /// `None` if no camera got as far as sending.
+    pub fn skew(&self) -> Option<Duration> {
+        let mut sent = self.shots.iter().filter_map(|shot| shot.sent_at);
+        let first = sent.next()?;
+        let (earliest, latest) = sent.fold((first, first), |(lo, hi), t| (lo.min(t), hi.max(t)));
+        Some(latest - earliest)
+    }
+
+    /// Each camera's send time relative to the earliest send
+    pub fn offsets(&self) -> impl Iterator<Item = (CameraId, Duration)> + '_ {
+        let earliest = self.shots.iter().filter_map(|shot| shot.sent_at).min();
+        self.shots.iter().filter_map(move |shot| {
+            let offset = shot.sent_at?.saturating_duration_since(earliest?);
+            Some((shot.camera, offset))
+        })
+    }
+}
+
+/// A set of connected cameras with a merged event stream
+pub struct CameraFleet {
+    /// Shared with the threads of a trigger in flight
+    cameras: BTreeMap<CameraId, Arc<CameraDevice>>,
+    forwarders: BTreeMap<CameraId, JoinHandle<()>>,
+    events_tx: mpsc::Sender<FleetEvent>,
+    events_rx: mpsc::Receiver<FleetEvent>,
+}
+
+impl CameraFleet {
+    /// Discover cameras once, for building the fleet's connection list
+    ///
+    /// Blocks for the whole timeout. Tools that rescan repeatedly should keep
+    /// a [`DiscoveryService`](crate::DiscoveryService) instead, which answers
+    /// from its cache.
+    pub async fn discover(timeout_secs: u8) -> Result<Vec<DiscoveredCamera>> {
+        discover_cameras(timeout_secs).await
+    }
+
+    /// Connect every camera concurrently
+    ///
+    /// Returns the fleet of cameras that connected, plus the error for each
+    /// one that didn't. A failed camera doesn't hold up or cancel the others.
+    pub async fn connect(
+        builders: impl IntoIterator<Item = CameraDeviceBuilder>,
+    ) -> (Self, Vec<(CameraId, Error)>) {
+        let mut tasks = JoinSet::new();
+        let mut pending = Vec::new();
+        for (index, builder) in builders.into_iter().enumerate() {
+            let id = CameraId(index);
+            pending.push(id);
+            tasks.spawn(async move { (id, builder.connect().await) });
+        }
+
+        let mut fleet = Self::new();
+        let mut failures = Vec::new();
+
+        while let Some(joined) = tasks.join_next().await {
+            match joined {
+                Ok((id, Ok(device))) => {
+                    pending.retain(|&p| p != id);
+                    fleet.insert(id, device);
+                }
+                Ok((id, Err(error))) => {
+                    pending.retain(|&p| p != id);
+                    failures.push((id, error));
+                }
+                Err(e) => tracing::warn!("Camera connect task failed: {}", e),
+            }
+        }
+
+        // Tasks that panicked never reported their id
+        for id in pending {
+            failures.push((id, Error::Other("Connect task panicked".to_string())));
+        }
+        failures.sort_by_key(|(id, _)| *id);
+
+        (fleet, failures)
+    }
+
+    fn new() -> Self {
+        let (events_tx, events_rx) = mpsc::channel(FLEET_EVENT_CAPACITY);
+        Self {
+            cameras: BTreeMap::new(),
+            forwarders: BTreeMap::new(),
+            events_tx,
+            events_rx,
+        }
+    }
+
+    fn insert(&mut self, id: CameraId, mut device: CameraDevice) {
+        if let Some(receiver) = device.take_event_receiver() {
+            let forwarder = tokio::spawn(forward_events(id, receiver, self.events_tx.clone()));
+            self.forwarders.insert(id, forwarder);
+        }
+        self.cameras.insert(id, Arc::new(device));
+    }
+
+    /// Number of connected cameras
+    pub fn len(&self) -> usize {
+        self.cameras.len()
+    }
+
+    /// Check whether no cameras are connected
+    pub fn is_empty(&self) -> bool {
+        self.cameras.is_empty()
+    }
+
+    /// Ids of connected cameras, in ascending order
+    pub fn ids(&self) -> impl Iterator<Item = CameraId> + '_ {
+        self.cameras.keys().copied()
+    }
+
+    /// Get a camera by id
+    pub fn get(&self, id: CameraId) -> Option<&CameraDevice> {
+        self.cameras.get(&id).map(|device| &**device)
+    }
+
+    /// Get a camera by id, mutably
+    ///
+    /// `None` also while a trigger whose future was dropped is still
+    /// finishing on the camera.
+    pub fn get_mut(&mut self, id: CameraId) -> Option<&mut CameraDevice> {
+        self.cameras.get_mut(&id).and_then(Arc::get_mut)
+    }
+
+    /// Iterate over connected cameras
+    pub fn iter(&self) -> impl Iterator<Item = (CameraId, &CameraDevice)> {
+        self.cameras.iter().map(|(&id, device)| (id, &**device))
+    }
+
+    /// Remove a camera from the fleet
+    ///
+    /// Its events stop flowing into the merged stream; the returned device has
+    /// no event receiver of its own. `None` also while a trigger whose future
+    /// was dropped is still finishing on the camera; it stays in the fleet.
+    pub fn remove(&mut self, id: CameraId) -> Option<CameraDevice> {
+        let device = match Arc::try_unwrap(self.cameras.remove(&id)?) {
+            Ok(device) => device,
+            Err(shared) => {
+                self.cameras.insert(id, shared);
+                return None;
+            }
+        };
+        if let Some(forwarder) = self.forwarders.remove(&id) {
+            forwarder.abort();
+        }
+        Some(device)
+    }
+
+    /// Fire every camera as close to simultaneously as possible
+    ///
+    /// Each camera gets its own thread, which half-presses the shutter and
+    /// waits up to `af_timeout` for the AF result before meeting the others
+    /// at a shared rendezvous, so slower-focusing bodies don't fire late. Once
+    /// every camera is armed the rendezvous releases all threads and each
+    /// sends Release Down immediately, so the skew is bounded by thread
+    /// wake-up rather than by serial SDK round trips. The shutter is then
+    /// released and the half-press undone. Bodies in MF arm without waiting.
+    ///
+    /// If any camera fails to arm (including one that reports no AF result in
+    /// time, or isn't armed [`TRIGGER_ARM_SLACK`] past the AF timeout), no
+    /// camera fires: every thread lets go of S1 and reports the abort. A
+    /// camera that reports a failed AF result fires anyway and is listed by
+    /// [`TriggerReport::unfocused`].
+    ///
+    /// The threads are started from the blocking pool, so this works on any
+    /// runtime.
+    pub async fn trigger(&self, af_timeout: Duration) -> TriggerReport {
+        let cameras: Vec<_> = self
+            .cameras
+            .iter()
+            .map(|(&id, device)| (id, device.clone()))
+            .collect();
+        let ids: Vec<_> = cameras.iter().map(|(id, _)| *id).collect();
+
+        let trigger = tokio::task::spawn_blocking(move || trigger_blocking(&cameras, af_timeout));
+        match trigger.await {
+            Ok(report) => report,
+            Err(e) => TriggerReport {
+                shots: ids
+                    .into_iter()
+                    .map(|id| unfired(id, Error::Other(format!("Trigger task failed: {}", e))))
+                    .collect(),
+            },
+        }
+    }
+
+    /// Wait for the next event from any camera
+    pub async fn recv(&mut self) -> Option<FleetEvent> {
+        self.events_rx.recv().await
+    }
+
+    /// Receive an event from any camera if one is queued, without waiting
+    pub fn try_recv(&mut self) -> Option<FleetEvent> {
+        self.events_rx.try_recv().ok()
+    }
+}
+
+impl Drop for CameraFleet {
+    fn drop(&mut self) {
+        for forwarder in self.forwarders.values() {
+            forwarder.abort();
+        }
+    }
+}
+
+/// Fire `cameras` together, one thread each
+fn trigger_blocking(
+    cameras: &[(CameraId, Arc<CameraDevice>)],
+    af_timeout: Duration,
+) -> TriggerReport {
+    let rendezvous = Rendezvous::new(
+        cameras.len(),
+        Instant::now() + af_timeout + TRIGGER_ARM_SLACK,
+    );
+
+    let shots = std::thread::scope(|scope| {
+        let threads: Vec<_> = cameras
+            .iter()
+            .map(|(id, device)| {
+                let (id, rendezvous, camera) = (*id, &rendezvous, &device.inner);
+                (
+                    id,
+                    scope.spawn(move || {
+                        let _abort = AbortOnPanic(rendezvous);
+                        fire(id, camera, rendezvous, af_timeout)
+                    }),
+                )
+            })
+            .collect();
+
+        threads
+            .into_iter()
+            .map(|(id, thread)| {
+                thread.join().unwrap_or_else(|_| {
+                    unfired(id, Error::Other("Trigger thread panicked".to_string()))
+                })
+            })
+            .collect()
+    });
+
+    TriggerReport { shots }
+}
+
+/// Result for a camera that never sent Release Down
+fn unfired(camera: CameraId, error: Error) -> TriggerShot {
+    TriggerShot {
+        camera,
+        sent_at: None,
+        send_latency: Duration::ZERO,
+        af: None,
+        error: Some(error),
+    }
+}
+
+/// Meeting point of a trigger's threads that any one of them can call off
+///
+/// Unlike `std::sync::Barrier`, a thread that fails or panics before
+/// arriving releases the others instead of leaving them waiting forever.
+struct Rendezvous {
+    parties: usize,
+    deadline: Instant,
+    state: Mutex<RendezvousState>,
+    changed: Condvar,
+}
+
+#[derive(Default)]
+struct RendezvousState {
+    arrived: usize,
+    aborted: bool,
+}
+
+impl Rendezvous {
+    fn new(parties: usize, deadline: Instant) -> Self {
+        Self {
+            parties,
+            deadline,
+            state: Mutex::new(RendezvousState::default()),
+            changed: Condvar::new(),
+        }
+    }
+
+    /// Arrive and wait for the rest; `false` if the trigger was called off
+    ///
+    /// Waiting past the deadline calls it off for everyone.
+    fn wait(&self) -> bool {
+        let mut state = self.state.lock().unwrap();
+        state.arrived += 1;
+        self.changed.notify_all();
+        loop {
+            if state.aborted {
+                return false;
+            }
+            if state.arrived >= self.parties {
+                return true;
+            }
+            let left = self.deadline.saturating_duration_since(Instant::now());
+            if left.is_zero() {
+                state.aborted = true;
+                self.changed.notify_all();
+                return false;
+            }
+            state = self.changed.wait_timeout(state, left).unwrap().0;
+        }
+    }
+
+    /// Call the trigger off, releasing every waiting thread
+    ///
+    /// No-op once everyone has arrived, so the release can't be taken back.
+    fn abort(&self) {
+        let mut state = self.state.lock().unwrap();
+        if state.arrived < self.parties {
+            state.aborted = true;
+            self.changed.notify_all();
+        }
+    }
+}
+
+/// Calls the rendezvous off if its thread panics before arriving
+struct AbortOnPanic<'a>(&'a Rendezvous);
+
+impl Drop for AbortOnPanic<'_> {
+    fn drop(&mut self) {
+        if std::thread::panicking() {
+            self.0.abort();
+        }
+    }
+}
+
+/// Half-press one camera and wait for its AF result (`None` in MF)
+fn arm(camera: &blocking::CameraDevice, af_timeout: Duration) -> Result<Option<AfStatus>> {
+    if camera.is_manual_focus() {
+        return camera.half_press_shutter().map(|()| None);
+    }
+    camera.focus(af_timeout).map(Some)
+}
+
+/// Arm one camera, wait for the rest, then press and release the shutter
+fn fire(
+    id: CameraId,
+    camera: &blocking::CameraDevice,
+    rendezvous: &Rendezvous,
+    af_timeout: Duration,
+) -> TriggerShot {
+    let armed = arm(camera, af_timeout);
+    let released = match &armed {
+        Ok(_) => rendezvous.wait(),
+        Err(_) => {
+            rendezvous.abort();
+            false
+        }
+    };
+
+    let af = match (armed, released) {
+        (Ok(af), true) => af,
+        (armed, _) => {
+            let _ = camera.release_shutter();
+            let error = armed.err().unwrap_or_else(|| {
+                Error::Other("Trigger aborted: another camera failed to arm".to_string())
+            });
+            return unfired(id, error);
+        }
+    };
+
+    let sent_at = Instant::now();
+    let pressed = camera.send_command(CommandId::Release, CommandParam::Down);
+    let send_latency = sent_at.elapsed();
+
+    std::thread::sleep(RELEASE_HOLD);
+    let released = camera.send_command(CommandId::Release, CommandParam::Up);
+    let disarmed = camera.release_shutter();
+
+    TriggerShot {
+        camera: id,
+        sent_at: Some(sent_at),
+        send_latency,
+        af,
+        error: pressed.and(released).and(disarmed).err(),
+    }
+}
+
+/// Move events from one camera's queue into the merged stream
+async fn forward_events(id: CameraId, mut receiver: EventReceiver, tx: mpsc::Sender<FleetEvent>) {
+    while let Some(event) = receiver.recv().await {
+        let event = FleetEvent { camera: id, event };
+        if tx.send(event).await.is_err() {
+            break;
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::event_queue::{self, EventChannelConfig};
+
+    #[test]
+    fn test_camera_id_display() {
+        assert_eq!(CameraId(3).to_string(), "camera 3");
+    }
+
+    #[test]
+    fn test_trigger_report_skew_and_offsets() {
+        let start = Instant::now();
+        let shot = |id, offset_ms: Option<u64>| TriggerShot {
+            camera: CameraId(id),
+            sent_at: offset_ms.map(|ms| start + Duration::from_millis(ms)),
+            send_latency: Duration::ZERO,
+            af: Some(AfStatus::Focused),
+            error: None,
+        };
+        let report = TriggerReport {
+            shots: vec![
+                shot(0, Some(2)),
+                shot(1, None),
+                shot(2, Some(0)),
+                shot(3, Some(5)),
+            ],
+        };
+
+        assert_eq!(report.skew(), Some(Duration::from_millis(5)));
+        assert_eq!(
+            report.offsets().collect::<Vec<_>>(),
+            vec![
+                (CameraId(0), Duration::from_millis(2)),
+                (CameraId(2), Duration::ZERO),
+                (CameraId(3), Duration::from_millis(5)),
+            ]
+        );
+        assert!(TriggerReport { shots: vec![] }.skew().is_none());
+    }
+
+    #[test]
+    fn test_rendezvous_releases_when_all_arrive() {
+        let rendezvous = Rendezvous::new(3, Instant::now() + Duration::from_secs(10));
+        let released = std::thread::scope(|scope| {
+            let threads: Vec<_> = (0..3).map(|_| scope.spawn(|| rendezvous.wait())).collect();
+            threads
+                .into_iter()
+                .map(|thread| thread.join().unwrap())
+                .collect::<Vec<_>>()
+        });
+        assert_eq!(released, [true, true, true]);
+    }
+
+    #[test]
+    fn test_rendezvous_abort_releases_waiters() {
+        let rendezvous = Rendezvous::new(3, Instant::now() + Duration::from_secs(10));
+        let start = Instant::now();
+        let released = std::thread::scope(|scope| {
+            let waiters: Vec<_> = (0..2).map(|_| scope.spawn(|| rendezvous.wait())).collect();
+            let failing = scope.spawn(|| {
+                let _abort = AbortOnPanic(&rendezvous);
+                std::thread::sleep(Duration::from_millis(20));
+                panic!("arm failed");
+            });
+            assert!(failing.join().is_err());
+            waiters
+                .into_iter()
+                .map(|thread| thread.join().unwrap())
+                .collect::<Vec<_>>()
+        });
+        assert_eq!(released, [false, false]);
+        assert!(start.elapsed() < Duration::from_secs(5));
+    }
+
+    #[test]
+    fn test_rendezvous_times_out() {
+        let rendezvous = Rendezvous::new(2, Instant::now() + Duration::from_millis(20));
+        assert!(!rendezvous.wait());
+        // Whoever arrives late finds the trigger already called off
+        assert!(!rendezvous.wait());
+    }
+
+    #[test]
+    fn test_trigger_report_unfocused() {
+        let shot = |id, af, fired: bool| TriggerShot {
+            camera: CameraId(id),
+            sent_at: fired.then(Instant::now),
+            send_latency: Duration::ZERO,
+            af,
+            error: None,
+        };
+        let report = TriggerReport {
+            shots: vec![
+                shot(0, Some(AfStatus::Focused), true),
+                shot(1, Some(AfStatus::NotFocused), true),
+                shot(2, None, true),
+                shot(3, Some(AfStatus::NotFocusedContinuous), false),
+            ],
+        };
+        assert_eq!(report.unfocused().collect::<Vec<_>>(), vec![CameraId(1)]);
+    }
+
+    #[tokio::test]
+    async fn test_forward_events_tags_camera() {
+        let (queue_tx, queue_rx) = event_queue::channel(EventChannelConfig::default());
+        let (tx, mut rx) = mpsc::channel(4);
+
+        queue_tx.send(CameraEvent::Connected { version: 1 });
+        drop(queue_tx);
+        forward_events(CameraId(7), queue_rx, tx).await;
+
+        let event = rx.recv().await.unwrap();
+        assert_eq!(event.camera, CameraId(7));
+        assert!(matches!(event.event, CameraEvent::Connected { version: 1 }));
+        assert!(rx.recv().await.is_none());
+    }
+}
@@ -0,0 +1,704 @@
+//! Host-timed interval (timelapse) shooting
+//!
+//! [`IntervalPlan`] describes a timelapse: a shot every `interval`, for a fixed
+//! number of shots or until the caller stops it.
+//! [`CameraDevice::run_interval`](crate::blocking::CameraDevice::run_interval)
+//! runs it on the calling thread.
+//!
+//! Shot `n` is due at `start + n * interval` on the monotonic clock, rather
+//! than one interval after the previous shot finished, so command latency and
+//! scheduler jitter never add up over a long sequence. Each release is sent
+//! early by the smoothed latency of the previous ones, so the camera acts on
+//! it at the slot rather than a round trip after it.
+//!
+//! Between shots the loop waits on the camera's shot signals, so a release
+//! turned away because the buffer is still writing, or a full card, is seen
+//! as soon as the camera reports it. [`BufferPolicy`] decides whether a
+//! rejected shot is dropped or retried before the next slot.
+//!
+//! With an S1 lead the shutter is half-pressed that long before each slot, so
+//! autofocus has settled when the release goes out. Exposure ramps step a
+//! property through the camera's allowed values between shots, one notch at a
+//! time, for day-to-night ("holy grail") sequences.
+
+use crate::blocking::RELEASE_HOLD;
+use crate::error::{Error, Result};
+use crate::property::{DeviceProperty, ValueConstraint};
+use crate::shot::{Backpressure, ShotMark, ShotSignals};
+use crsdk_sys::DevicePropertyCode;
+use std::ops::ControlFlow;
+use std::time::{Duration, Instant};
+
+/// How long after a release the camera gets to reject it
+const REJECT_WINDOW: Duration = Duration::from_millis(500);
+
+/// Pause between retries of a rejected shot under [`BufferPolicy::Queue`]
+const QUEUE_RETRY_DELAY: Duration = Duration::from_millis(250);
+
+/// The last stretch before a slot is spun rather than slept, for precision
+const SPIN_WINDOW: Duration = Duration::from_millis(2);
+
+/// Weight of a new sample in the release latency estimate
+const LATENCY_GAIN: f64 = 0.125;
+
+/// What to do with a shot the camera rejects because its buffer is full
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub enum BufferPolicy {
+    /// Drop the shot and wait for the next slot
+    #[default]
+    Skip,
+    /// Retry the shot until the camera takes it or the next slot is due
+    Queue,
+}
+
+/// Step a property from its current value to `target` over a number of shots
+///
+/// The property must have a discrete list of allowed values, and the ramp
+/// walks that list, so e.g. a shutter speed ramp moves in the camera's own
+/// third-stop increments and never skips a notch when `shots` is at least
+/// the distance between the two values.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct ExposureRamp {
+    /// Property to ramp
+    pub code: DevicePropertyCode,
+    /// Raw value to end at
+    pub target: u64,
+    /// Slot at which the target is reached
+    pub shots: u32,
+}
+
+/// Interval shooting options
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub struct IntervalPlan {
+    /// Time between shots
+    pub interval: Duration,
+    /// Number of slots to run, or `None` to run until stopped
+    pub shots: Option<u32>,
+    /// Half-press the shutter this long before each shot
+    pub s1_lead: Option<Duration>,
+    /// What to do when the camera rejects a shot
+    pub buffer_policy: BufferPolicy,
+    /// Exposure ramps applied between shots
+    pub ramps: Vec<ExposureRamp>,
+}
+
+impl IntervalPlan {
+    /// Shoot every `interval` until stopped, with no S1 lead or ramps
+    pub fn new(interval: Duration) -> Self {
+        Self {
+            interval,
+            shots: None,
+            s1_lead: None,
+            buffer_policy: BufferPolicy::default(),
+            ramps: Vec::new(),
+        }
+    }
+
+    fn validate(&self) -> Result<()> {
+        if self.interval <= RELEASE_HOLD {
+            return Err(Error::InvalidParameter(format!(
+                "interval must be longer than {:?}",
+                RELEASE_HOLD
+            )));
+        }
+        if self.s1_lead.is_some_and(|lead| lead >= self.interval) {
+            return Err(Error::InvalidParameter(
+                "S1 lead must be shorter than the interval".into(),
+            ));
+        }
+        Ok(())
+    }
+}
+
+/// What happened in one slot
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum ShotOutcome {
+    /// The camera took the shot on the first release
+    Fired,
+    /// The camera took the shot after rejecting `attempts` earlier releases
+    Retried {
+        /// Releases rejected before the one that was taken
+        attempts: u32,
+    },
+    /// No shot was taken in this slot
+    Skipped,
+}
+
+/// One slot of an interval run
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct IntervalShot {
+    /// Slot number, from 0
+    pub index: u32,
+    /// When the shot was due
+    pub due: Instant,
+    /// When the release that the camera took was sent
+    pub sent_at: Option<Instant>,
+    /// How long that release command took
+    pub send_latency: Duration,
+    /// Whether the shot was taken
+    pub outcome: ShotOutcome,
+}
+
+impl IntervalShot {
+    /// Distance between the slot and when the camera acted on the release
+    ///
+    /// The camera is taken to act on a release when the command returns.
+    /// `None` if no shot was taken.
+    pub fn timing_error(&self) -> Option<Duration> {
+        let acted = self.sent_at? + self.send_latency;
+        Some(if acted > self.due {
+            acted - self.due
+        } else {
+            self.due - acted
+        })
+    }
+}
+
+/// Why an interval run ended
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum IntervalStop {
+    /// Every planned slot ran
+    Completed,
+    /// The progress callback stopped the run
+    Cancelled,
+    /// The camera reported a full memory card
+    StorageFull,
+}
+
+/// Summary of an interval run
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct IntervalReport {
+    /// Shots the camera took
+    pub fired: u32,
+    /// Slots without a shot
+    pub skipped: u32,
+    /// Shots taken only after the camera rejected a release
+    pub retried: u32,
+    /// Worst timing error of a taken shot (see [`IntervalShot::timing_error`])
+    pub max_timing_error: Duration,
+    /// Release latency estimate at the end of the run
+    pub lead: Duration,
+    /// Why the run ended
+    pub stop: IntervalStop,
+}
+
+/// Device side of an interval run
+pub(crate) trait IntervalTarget {
+    /// Shot milestones and backpressure reported by the camera
+    fn shot_signals(&self) -> &ShotSignals;
+
+    /// Lock or unlock S1 (shutter half-press)
+    fn set_half_press(&self, pressed: bool) -> Result<()>;
+
+    /// Press (`true`) or release the shutter button
+    fn set_release(&self, pressed: bool) -> Result<()>;
+
+    /// Read a property
+    fn read_property(&self, code: DevicePropertyCode) -> Result<DeviceProperty>;
+
+    /// Write a property
+    fn write_property(&self, code: DevicePropertyCode, value: u64) -> Result<()>;
+}
+
+/// Run `plan` against `target`, calling `progress` after every slot
+pub(crate) fn run<T: IntervalTarget + ?Sized>(
+    target: &T,
+    plan: &IntervalPlan,
+    progress: &mut dyn FnMut(&IntervalShot) -> ControlFlow<()>,
+) -> Result<IntervalReport> {
+    plan.validate()?;
+
+    let mut ramps = plan
+        .ramps
+        .iter()
+        .map(|ramp| RampState::start(target, ramp))
+        .collect::<Result<Vec<_>>>()?;
+
+    let signals = target.shot_signals();
+    let s1_lead = plan.s1_lead.unwrap_or(Duration::ZERO);
+    let start = Instant::now() + s1_lead;
+    let mut latency = LatencyEstimate::default();
+    let mut mark = signals.mark();
+    let mut report = IntervalReport {
+        fired: 0,
+        skipped: 0,
+        retried: 0,
+        max_timing_error: Duration::ZERO,
+        lead: Duration::ZERO,
+        stop: IntervalStop::Completed,
+    };
+
+    for index in 0.. {
+        if plan.shots.is_some_and(|shots| index >= shots) {
+            break;
+        }
+
+        let due = start + plan.interval * index;
+        let next_due = due + plan.interval;
+        let mut shot = IntervalShot {
+            index,
+            due,
+            sent_at: None,
+            send_latency: Duration::ZERO,
+            outcome: ShotOutcome::Skipped,
+        };
+
+        // A slot overrun by more than half an interval is dropped, not rushed
+        if Instant::now() > due + plan.interval / 2 {
+            report.skipped += 1;
+            report.stop = match progress(&shot) {
+                ControlFlow::Continue(()) => continue,
+                ControlFlow::Break(()) => IntervalStop::Cancelled,
+            };
+            break;
+        }
+
+        let lead = latency.get().min(plan.interval / 2);
+        let next_arm = next_due - lead - s1_lead;
+        let mut s1 = HalfPress {
+            target,
+            held: false,
+        };
+        if plan.s1_lead.is_some() {
+            if sleep_until(signals, mark, due - lead - s1_lead) {
+                report.stop = IntervalStop::StorageFull;
+                break;
+            }
+            s1.press()?;
+        }
+        if sleep_until(signals, mark, due - lead) {
+            report.stop = IntervalStop::StorageFull;
+            break;
+        }
+
+        let mut rejected = 0;
+        let mut storage_full = false;
+        loop {
+            let release_mark = signals.mark();
+            let sent_at = Instant::now();
+            target.set_release(true)?;
+            let send_latency = sent_at.elapsed();
+            latency.observe(send_latency);
+            std::thread::sleep(RELEASE_HOLD);
+            target.set_release(false)?;
+
+            let window = (sent_at + REJECT_WINDOW).min(next_arm);
+            match signals.wait_backpressure(release_mark, remaining(window)) {
+                None => {
+                    shot.sent_at = Some(sent_at);
+                    shot.send_latency = send_latency;
+                    shot.outcome = match rejected {
+                        0 => ShotOutcome::Fired,
+                        attempts => ShotOutcome::Retried { attempts },
+                    };
+                    break;
+                }
+                Some(Backpressure::StorageFull) => {
+                    storage_full = true;
+                    break;
+                }
+                Some(Backpressure::Rejected) => {
+                    rejected += 1;
+                    let retry_at = Instant::now() + QUEUE_RETRY_DELAY;
+                    if plan.buffer_policy == BufferPolicy::Skip || retry_at >= next_arm {
+                        break;
+                    }
+                    if signals.wait_storage_full(signals.mark(), QUEUE_RETRY_DELAY) {
+                        storage_full = true;
+                        break;
+                    }
+                }
+            }
+        }
+        mark = signals.mark();
+        s1.release()?;
+
+        match shot.outcome {
+            ShotOutcome::Skipped => report.skipped += 1,
+            ShotOutcome::Fired => report.fired += 1,
+            ShotOutcome::Retried { .. } => {
+                report.fired += 1;
+                report.retried += 1;
+            }
+        }
+        if let Some(error) = shot.timing_error() {
+            report.max_timing_error = report.max_timing_error.max(error);
+        }
+
+        if storage_full {
+            report.stop = IntervalStop::StorageFull;
+            break;
+        }
+        if progress(&shot).is_break() {
+            report.stop = IntervalStop::Cancelled;
+            break;
+        }
+
+        if plan.shots.is_some_and(|shots| index + 1 >= shots) {
+            break;
+        }
+        for ramp in &mut ramps {
+            ramp.apply(target, index + 1)?;
+        }
+    }
+
+    report.lead = latency.get();
+    Ok(report)
+}
+
+/// S1 held for one slot, let go on every way out of it
+struct HalfPress<'a, T: IntervalTarget + ?Sized> {
+    target: &'a T,
+    held: bool,
+}
+
+impl<T: IntervalTarget + ?Sized> HalfPress<'_, T> {
+    fn press(&mut self) -> Result<()> {
+        self.target.set_half_press(true)?;
+        self.held = true;
+        Ok(())
+    }
+
+    fn release(&mut self) -> Result<()> {
+        if !std::mem::take(&mut self.held) {
+            return Ok(());
+        }
+        self.target.set_half_press(false)
+    }
+}
+
+impl<T: IntervalTarget + ?Sized> Drop for HalfPress<'_, T> {
+    fn drop(&mut self) {
+        // An early break or error: best effort, the original error wins
+        let _ = self.release();
+    }
+}
+
+/// Time left until `deadline`, zero once it has passed
+fn remaining(deadline: Instant) -> Duration {
+    deadline.saturating_duration_since(Instant::now())
+}
+
+/// Sleep until `deadline`; returns `true` early if the card fills up
+fn sleep_until(signals: &ShotSignals, mark: ShotMark, deadline: Instant) -> bool {
+    let coarse = deadline.checked_sub(SPIN_WINDOW).unwrap_or(deadline);
+    if signals.wait_storage_full(mark, remaining(coarse)) {
+        return true;
+    }
+    while Instant::now() < deadline {
+        std::hint::spin_loop();
+    }
+    false
+}
+
+/// Smoothed release command latency
+#[derive(Debug, Default)]
+struct LatencyEstimate {
+    smoothed: Option<Duration>,
+}
+
+impl LatencyEstimate {
+    fn observe(&mut self, sample: Duration) {
+        self.smoothed = Some(match self.smoothed {
+            None => sample,
+            Some(old) => old.mul_f64(1.0 - LATENCY_GAIN) + sample.mul_f64(LATENCY_GAIN),
+        });
+    }
+
+    fn get(&self) -> Duration {
+        self.smoothed.unwrap_or(Duration::ZERO)
+    }
+}
+
+/// An [`ExposureRamp`] resolved against the camera's allowed values
+#[derive(Debug)]
+struct RampState {
+    code: DevicePropertyCode,
+    values: Vec<u64>,
+    from: usize,
+    to: usize,
+    shots: u32,
+    applied: usize,
+}
+
+impl RampState {
+    fn start<T: IntervalTarget + ?Sized>(target: &T, ramp: &ExposureRamp) -> Result<Self> {
+        let prop = target.read_property(ramp.code)?;
+        let ValueConstraint::Discrete(values) = &prop.constraint else {
+            return Err(Error::InvalidParameter(format!(
+                "{} has no list of allowed values to ramp through",
+                ramp.code.name()
+            )));
+        };
+        let position = |value: u64| {
+            values.iter().position(|&v| v == value).ok_or_else(|| {
+                Error::InvalidParameter(format!(
+                    "{:#x} isn't an allowed value of {}",
+                    value,
+                    ramp.code.name()
+                ))
+            })
+        };
+        let from = position(prop.current_value)?;
+        let to = position(ramp.target)?;
+
+        Ok(Self {
+            code: ramp.code,
+            values: values.to_vec(),
+            from,
+            to,
+            shots: ramp.shots,
+            applied: from,
+        })
+    }
+
+    /// Position in the value list planned for `slot`
+    fn position_at(&self, slot: u32) -> usize {
+        if slot >= self.shots {
+            return self.to;
+        }
+        let span = self.to as f64 - self.from as f64;
+        let offset = (span * f64::from(slot) / f64::from(self.shots)).round();
+        (self.from as f64 + offset) as usize
+    }
+
+    /// Write the value planned for `slot` if it differs from the last one
+    fn apply<T: IntervalTarget + ?Sized>(&mut self, target: &T, slot: u32) -> Result<()> {
+        let position = self.position_at(slot);
+        if position != self.applied {
+            target.write_property(self.code, self.values[position])?;
+            self.applied = position;
+        }
+        Ok(())
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::property::{DataType, EnableFlag};
+    use crate::shot::{OPERATION_RESULT_WARNING, STORAGE_FULL_WARNING};
+    use std::sync::Mutex;
+
+    const SHUTTER_SPEEDS: [u64; 4] = [0x0001_0032, 0x0001_0028, 0x0001_001e, 0x0001_0019];
+
+    #[derive(Default)]
+    struct FakeCamera {
+        signals: ShotSignals,
+        /// Warning sent back for the n-th press, if any
+        warnings: Vec<(u32, u32)>,
+        /// Press that fails with an error, if any
+        failing_press: Option<u32>,
+        /// Half-press during which the card fills, if any
+        full_at_half_press: Option<u32>,
+        presses: Mutex<Vec<Instant>>,
+        half_presses: Mutex<u32>,
+        s1_held: Mutex<bool>,
+        writes: Mutex<Vec<u64>>,
+    }
+
+    impl IntervalTarget for FakeCamera {
+        fn shot_signals(&self) -> &ShotSignals {
+            &self.signals
+        }
+
+        fn set_half_press(&self, pressed: bool) -> Result<()> {
+            if pressed {
+                let mut half_presses = self.half_presses.lock().unwrap();
+                if self.full_at_half_press == Some(*half_presses) {
+                    self.signals.warning(STORAGE_FULL_WARNING, None);
+                }
+                *half_presses += 1;
+            }
+            *self.s1_held.lock().unwrap() = pressed;
+            Ok(())
+        }
+
+        fn set_release(&self, pressed: bool) -> Result<()> {
+            if !pressed {
+                return Ok(());
+            }
+            let mut presses = self.presses.lock().unwrap();
+            let press = presses.len() as u32;
+            if self.failing_press == Some(press) {
+                return Err(Error::Other("release failed".to_string()));
+            }
+            presses.push(Instant::now());
+            for &(at, code) in &self.warnings {
+                if at == press {
+                    let params = (code == OPERATION_RESULT_WARNING).then_some((4, 0, 0));
+                    self.signals.warning(code, params);
+                }
+            }
+            Ok(())
+        }
+
+        fn read_property(&self, code: DevicePropertyCode) -> Result<DeviceProperty> {
+            Ok(DeviceProperty {
+                code: code.as_raw(),
+                data_type: DataType::UInt32,
+                enable_flag: EnableFlag::ReadWrite,
+                current_value: SHUTTER_SPEEDS[0],
+                current_string: None,
+                constraint: ValueConstraint::Discrete(SHUTTER_SPEEDS.to_vec().into()),
+            })
+        }
+
+        fn write_property(&self, _code: DevicePropertyCode, value: u64) -> Result<()> {
+            self.writes.lock().unwrap().push(value);
+            Ok(())
+        }
+    }
+
+    fn plan(shots: u32) -> IntervalPlan {
+        IntervalPlan {
+            shots: Some(shots),
+            ..IntervalPlan::new(Duration::from_millis(60))
+        }
+    }
+
+    fn run_all(camera: &FakeCamera, plan: &IntervalPlan) -> (IntervalReport, Vec<IntervalShot>) {
+        let mut shots = Vec::new();
+        let report = run(camera, plan, &mut |shot| {
+            shots.push(*shot);
+            ControlFlow::Continue(())
+        })
+        .unwrap();
+        (report, shots)
+    }
+
+    #[test]
+    fn test_slots_stay_on_the_grid() {
+        let camera = FakeCamera::default();
+        let (report, shots) = run_all(&camera, &plan(4));
+
+        assert_eq!(report.fired, 4);
+        assert_eq!(report.stop, IntervalStop::Completed);
+        for pair in shots.windows(2) {
+            assert_eq!(pair[1].due - pair[0].due, Duration::from_millis(60));
+        }
+        let presses = camera.presses.lock().unwrap();
+        for (shot, press) in shots.iter().zip(presses.iter()) {
+            assert!(*press >= shot.due - Duration::from_millis(1));
+        }
+    }
+
+    #[test]
+    fn test_rejected_shot_is_skipped_or_retried() {
+        let camera = FakeCamera {
+            warnings: vec![(1, OPERATION_RESULT_WARNING)],
+            ..Default::default()
+        };
+        let (report, shots) = run_all(&camera, &plan(3));
+        assert_eq!(report.fired, 2);
+        assert_eq!(report.skipped, 1);
+        assert_eq!(shots[1].outcome, ShotOutcome::Skipped);
+
+        let camera = FakeCamera {
+            warnings: vec![(1, OPERATION_RESULT_WARNING)],
+            ..Default::default()
+        };
+        let queued = IntervalPlan {
+            interval: Duration::from_millis(400),
+            buffer_policy: BufferPolicy::Queue,
+            ..plan(2)
+        };
+        let (report, shots) = run_all(&camera, &queued);
+        assert_eq!(report.fired, 2);
+        assert_eq!(report.retried, 1);
+        assert_eq!(shots[1].outcome, ShotOutcome::Retried { attempts: 1 });
+    }
+
+    #[test]
+    fn test_storage_full_stops_the_run() {
+        let camera = FakeCamera {
+            warnings: vec![(1, STORAGE_FULL_WARNING)],
+            ..Default::default()
+        };
+        let (report, _) = run_all(&camera, &plan(5));
+        assert_eq!(report.stop, IntervalStop::StorageFull);
+        assert_eq!(camera.presses.lock().unwrap().len(), 2);
+    }
+
+    #[test]
+    fn test_s1_lead_and_cancel() {
+        let camera = FakeCamera::default();
+        let plan = IntervalPlan {
+            s1_lead: Some(Duration::from_millis(10)),
+            ..IntervalPlan::new(Duration::from_millis(60))
+        };
+        let report = run(&camera, &plan, &mut |shot| {
+            if shot.index == 2 {
+                ControlFlow::Break(())
+            } else {
+                ControlFlow::Continue(())
+            }
+        })
+        .unwrap();
+        assert_eq!(report.stop, IntervalStop::Cancelled);
+        assert_eq!(report.fired, 3);
+        assert_eq!(*camera.half_presses.lock().unwrap(), 3);
+        assert!(!*camera.s1_held.lock().unwrap());
+    }
+
+    #[test]
+    fn test_s1_released_on_early_exit() {
+        let s1_plan = IntervalPlan {
+            s1_lead: Some(Duration::from_millis(10)),
+            ..plan(5)
+        };
+
+        // Card fills while S1 is held for the next slot
+        let camera = FakeCamera {
+            full_at_half_press: Some(1),
+            ..Default::default()
+        };
+        let (report, _) = run_all(&camera, &s1_plan);
+        assert_eq!(report.stop, IntervalStop::StorageFull);
+        assert_eq!(camera.presses.lock().unwrap().len(), 1);
+        assert!(!*camera.s1_held.lock().unwrap());
+
+        let camera = FakeCamera {
+            failing_press: Some(1),
+            ..Default::default()
+        };
+        assert!(run(&camera, &s1_plan, &mut |_| ControlFlow::Continue(())).is_err());
+        assert!(!*camera.s1_held.lock().unwrap());
+    }
+
+    #[test]
+    fn test_ramp_walks_allowed_values() {
+        let camera = FakeCamera::default();
+        let ramp = ExposureRamp {
+            code: DevicePropertyCode::ShutterSpeed,
+            target: SHUTTER_SPEEDS[3],
+            shots: 3,
+        };
+        let state = RampState::start(&camera, &ramp).unwrap();
+        let positions: Vec<_> = (0..5).map(|slot| state.position_at(slot)).collect();
+        assert_eq!(positions, [0, 1, 2, 3, 3]);
+
+        let plan = IntervalPlan {
+            ramps: vec![ramp],
+            ..plan(5)
+        };
+        run_all(&camera, &plan);
+        assert_eq!(*camera.writes.lock().unwrap(), SHUTTER_SPEEDS[1..]);
+
+        let bad = ExposureRamp { target: 7, ..ramp };
+        assert!(RampState::start(&camera, &bad).is_err());
+    }
+
+    #[test]
+    fn test_plan_validation() {
+        let camera = FakeCamera::default();
+        let mut progress = |_: &IntervalShot| ControlFlow::Continue(());
+        let too_short = IntervalPlan::new(Duration::from_millis(10));
+        assert!(run(&camera, &too_short, &mut progress).is_err());
+        let long_lead = IntervalPlan {
+            s1_lead: Some(Duration::from_millis(60)),
+            ..plan(1)
+        };
+        assert!(run(&camera, &long_lead, &mut progress).is_err());
+    }
+}
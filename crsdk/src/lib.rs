@@ -42,46 +42,108 @@
 //!
 //! ✅ SDK initialization and lifecycle
 //! ✅ Camera discovery (network and USB enumeration)
+//! ✅ Cached discovery with background rescans and change events
 //! ✅ Basic connection (IP + MAC + SSH)
 //! ✅ Error handling
 //! ✅ Property system (ISO, aperture, shutter speed, focus mode, etc.)
 //! ✅ Shooting operations (capture, autofocus, movie recording)
+//! ✅ Live view streaming
+//! ✅ Content download (list card contents, pull files to disk)
+//! ✅ Latency metrics (SDK calls, event delivery, queue depth)
+//! ✅ Saved connection profiles for fast reconnects
+//! ✅ Lock-free callback ring with batched event delivery
+//! ✅ Host-timed interval shooting with exposure ramps
+//! ✅ Presets applied in dependency order with confirmed writes
+//! ✅ Binary state logs of property snapshots and events, with an indexed reader
 //!
 //! ## Planned Features
 //!
-//! - Live view streaming
 //! - Event callbacks
-//! - Content transfer (download images)
 //! - Advanced features (firmware update, settings management)
 
 #![deny(unsafe_op_in_unsafe_fn)]
 #![warn(missing_docs)]
 
+pub mod backend;
 pub mod blocking;
 mod command;
 mod device;
+mod discovery;
+mod download;
 mod error;
 mod event;
+mod event_queue;
+mod event_ring;
 mod event_sender;
+mod fleet;
+mod interval;
+mod live_view;
+mod live_view_analysis;
+mod metrics;
+mod pinned;
+mod preset;
+mod profile;
 pub mod property;
 mod sdk;
+mod sdk_string;
+mod shot;
+mod state_log;
+mod transfer;
 mod types;
 
 // Re-exports for async API (default)
 pub use command::{CommandId, CommandParam};
-pub use device::{discover_cameras, CameraDevice, CameraDeviceBuilder};
+pub use device::{discover_cameras, init_sdk, CameraDevice, CameraDeviceBuilder};
+pub use discovery::{DiscoveryConfig, DiscoveryEvent, DiscoveryService, DISCOVERY_EVENT_CAPACITY};
+pub use download::{
+    ContentFile, DownloadConfig, DownloadStats, DEFAULT_CHUNK_SIZE, DEFAULT_MAX_BUFFERED,
+    DEFAULT_WRITE_QUEUE_DEPTH,
+};
 pub use error::{Error, Result};
-pub use event::{warning_code_name, warning_param_description, CameraEvent};
+pub use event::{
+    warning_code_name, warning_param_description, CameraEvent, LiveViewCodes,
+    LIVE_VIEW_CODES_CAPACITY,
+};
+pub use event_queue::{
+    EventChannelConfig, EventReceiver, EventStats, OverflowPolicy, DEFAULT_EVENT_CAPACITY,
+};
+pub use event_ring::DEFAULT_EVENT_RING_CAPACITY;
+pub use fleet::{
+    CameraFleet, CameraId, FleetEvent, TriggerReport, TriggerShot, FLEET_EVENT_CAPACITY,
+};
+pub use interval::{
+    BufferPolicy, ExposureRamp, IntervalPlan, IntervalReport, IntervalShot, IntervalStop,
+    ShotOutcome,
+};
+pub use live_view::{
+    FrameRect, FrameRectKind, LiveViewConfig, LiveViewFrame, LiveViewReceiver, MAX_FRAME_RECTS,
+};
+pub use live_view_analysis::{
+    AnalysisPool, AnalysisReceiver, Clipping, FrameAnalysis, Histogram, HIGHLIGHT_CLIP_LEVEL,
+    SHADOW_CLIP_LEVEL,
+};
+pub use metrics::{EventKind, LatencySnapshot, MetricsSnapshot, SdkCall, LATENCY_BUCKETS};
+pub use pinned::PinnedCameraDevice;
+pub use preset::{PresetEntry, PresetOutcome, PresetReport, DEFAULT_PRESET_TIMEOUT};
+pub use profile::{
+    ConnectionProfile, ProfileStore, ReconnectBackoff, DEFAULT_RECONNECT_INITIAL,
+    DEFAULT_RECONNECT_MAX,
+};
 pub use property::{
-    property_value_type, AspectRatio, AutoManual, DataType, DeviceProperty, DriveMode, EnableFlag,
-    ExposureCtrlType, ExposureProgram, FileType, FlashMode, FocusArea, FocusMode,
-    FocusTrackingStatus, ImageQuality, ImageSize, IntervalRecShutterType, LiveViewDisplayEffect,
-    LockIndicator, MeteringMode, MovieFileFormat, MovieQuality, OnOff, PrioritySetInAF,
-    PrioritySetInAWB, PropertyValue, PropertyValueType, ShutterMode, ShutterModeStatus,
-    SilentModeApertureDrive, SubjectRecognitionAF, Switch, TypedValue, ValueConstraint,
-    WhiteBalance,
+    property_value_type, AspectRatio, AutoManual, DataType, DeviceProperty, DiscreteValues,
+    DriveMode, EnableFlag, ExposureCtrlType, ExposureProgram, FileType, FlashMode, FocusArea,
+    FocusMode, FocusTrackingStatus, ImageQuality, ImageSize, IntervalRecShutterType,
+    LiveViewDisplayEffect, LockIndicator, MeteringMode, MovieFileFormat, MovieQuality, OnOff,
+    PrioritySetInAF, PrioritySetInAWB, PropertyCache, PropertyCodeSet, PropertyDiff, PropertyValue,
+    PropertyValueType, ShutterMode, ShutterModeStatus, SilentModeApertureDrive,
+    SubjectRecognitionAF, Switch, TypedValue, ValueConstraint, WhiteBalance,
 };
 pub(crate) use sdk::Sdk;
+pub use shot::{
+    AfStatus, AF_STATUS_WARNING, DEFAULT_AF_TIMEOUT, OPERATION_RESULT_WARNING, STORAGE_FULL_WARNING,
+};
+pub use state_log::{LogEntry, LogRecord, StateLogReader, StateLogWriter, KEYFRAME_INTERVAL};
+pub use transfer::{TransferBuffer, TransferSink};
 pub use types::{CameraModel, ConnectionInfo, ConnectionType, DiscoveredCamera, MacAddr};
 
 // Re-export generated property codes (complete SDK coverage)
@@ -0,0 +1,422 @@
+//! Live view frame streaming
+//!
+//! [`CameraDevice::start_live_view`](crate::blocking::CameraDevice::start_live_view)
+//! spawns a dedicated thread that pulls JPEG frames from the camera at a target
+//! frame rate and publishes them through a latest-frame-wins slot. Slow
+//! consumers simply skip frames; nothing queues up.
+//!
+//! Frames are double-buffered: the worker fills a back buffer sized from
+//! `GetLiveViewImageInfo` and swaps it with the published frame, so after the
+//! first two frames no memory is allocated per frame.
+//!
+//! An attached [`AnalysisPool`](crate::AnalysisPool) stream gets a copy of
+//! each new frame before it is published; see [`crate::live_view_analysis`].
+
+use crate::error::{Error, Result};
+use crate::live_view_analysis::{AnalysisPool, AnalysisReceiver, AnalysisStream};
+use std::sync::atomic::{AtomicBool, Ordering};
+use std::sync::{Arc, Mutex};
+use std::thread::JoinHandle;
+use std::time::{Duration, Instant};
+use tokio::sync::watch;
+
+/// Maximum number of focus/face frames kept per live view frame
+pub const MAX_FRAME_RECTS: usize = 32;
+
+/// Live view streaming options
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub struct LiveViewConfig {
+    /// Target frames per second
+    pub fps: f32,
+    /// Also fetch focus and face frames with every image (one extra SDK call)
+    pub frame_info: bool,
+}
+
+impl Default for LiveViewConfig {
+    fn default() -> Self {
+        Self {
+            fps: 30.0,
+            frame_info: true,
+        }
+    }
+}
+
+/// Kind of overlay rectangle reported with a live view frame
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum FrameRectKind {
+    /// AF area / focus frame
+    Focus,
+    /// Detected face
+    Face,
+}
+
+/// A focus or face frame, in fractions of the live view image
+///
+/// `x`/`width` are relative to `x_denominator` and `y`/`height` to
+/// `y_denominator`, exactly as the SDK reports them.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct FrameRect {
+    /// Focus or face frame
+    pub kind: FrameRectKind,
+    /// SDK frame type
+    pub frame_type: u32,
+    /// SDK frame state (e.g. focused, not focused)
+    pub state: u32,
+    /// Display priority
+    pub priority: u32,
+    /// Left edge numerator
+    pub x: u32,
+    /// Top edge numerator
+    pub y: u32,
+    /// Width numerator
+    pub width: u32,
+    /// Height numerator
+    pub height: u32,
+    /// Horizontal denominator
+    pub x_denominator: u32,
+    /// Vertical denominator
+    pub y_denominator: u32,
+}
+
+impl FrameRect {
+    /// Rectangle as `(x, y, width, height)` fractions of the image (0.0..=1.0)
+    pub fn normalized(&self) -> (f32, f32, f32, f32) {
+        let xd = self.x_denominator.max(1) as f32;
+        let yd = self.y_denominator.max(1) as f32;
+        (
+            self.x as f32 / xd,
+            self.y as f32 / yd,
+            self.width as f32 / xd,
+            self.height as f32 / yd,
+        )
+    }
+
+    fn from_sdk(rect: &crsdk_sys::CrsdkLvFrameRect) -> Self {
+        Self {
+            kind: if rect.kind == 1 {
+                FrameRectKind::Face
+            } else {
+                FrameRectKind::Focus
+            },
+            frame_type: rect.type_,
+            state: rect.state,
+            priority: rect.priority,
+            x: rect.x_numerator,
+            y: rect.y_numerator,
+            width: rect.width,
+            height: rect.height,
+            x_denominator: rect.x_denominator,
+            y_denominator: rect.y_denominator,
+        }
+    }
+}
+
+/// One live view frame
+#[derive(Debug, Clone, Default)]
+pub struct LiveViewFrame {
+    /// SDK-sized buffer; the JPEG is a sub-slice of it
+    buffer: Vec<u8>,
+    offset: usize,
+    len: usize,
+    /// Camera frame counter
+    pub frame_no: u32,
+    /// When the frame was fetched (`None` before the first frame)
+    pub captured_at: Option<Instant>,
+    /// Focus and face frames reported with this image
+    pub frame_rects: Vec<FrameRect>,
+}
+
+impl LiveViewFrame {
+    /// JPEG bytes of the frame (empty before the first frame arrives)
+    pub fn jpeg(&self) -> &[u8] {
+        &self.buffer[self.offset..self.offset + self.len]
+    }
+
+    /// Check whether this slot holds a real frame yet
+    pub fn is_empty(&self) -> bool {
+        self.len == 0
+    }
+}
+
+/// Receiving side of a live view stream
+///
+/// Holds only the most recent frame. Cloning creates another independent
+/// receiver of the same stream.
+#[derive(Debug, Clone)]
+pub struct LiveViewReceiver {
+    rx: watch::Receiver<LiveViewFrame>,
+}
+
+impl LiveViewReceiver {
+    /// Wait until a frame newer than the last one seen is available
+    ///
+    /// Returns `false` once the stream has stopped.
+    pub async fn changed(&mut self) -> bool {
+        self.rx.changed().await.is_ok()
+    }
+
+    /// Check whether a frame newer than the last one seen is available
+    pub fn has_changed(&self) -> bool {
+        self.rx.has_changed().unwrap_or(false)
+    }
+
+    /// Run `f` on the latest frame without copying it, marking it as seen
+    ///
+    /// Keep `f` short: the worker can't publish the next frame while it runs.
+    pub fn with_latest<R>(&mut self, f: impl FnOnce(&LiveViewFrame) -> R) -> R {
+        f(&self.rx.borrow_and_update())
+    }
+}
+
+/// Handle to a running live view worker thread
+pub(crate) struct LiveViewWorker {
+    stop: Arc<AtomicBool>,
+    thread: Option<JoinHandle<()>>,
+    tx: Arc<watch::Sender<LiveViewFrame>>,
+    analysis: Arc<Mutex<Option<Arc<AnalysisStream>>>>,
+}
+
+impl LiveViewWorker {
+    /// Spawn the worker for the device `handle`
+    ///
+    /// Queries the frame buffer size up front so a camera that can't stream
+    /// live view fails here rather than in the background.
+    pub(crate) fn spawn(handle: i64, config: LiveViewConfig) -> Result<Self> {
+        if !(config.fps > 0.0 && config.fps.is_finite()) {
+            return Err(Error::InvalidParameter(format!(
+                "Live view fps must be positive, got {}",
+                config.fps
+            )));
+        }
+
+        let buffer_size = query_buffer_size(handle)?;
+        let (tx, _) = watch::channel(LiveViewFrame::default());
+        let tx = Arc::new(tx);
+        let stop = Arc::new(AtomicBool::new(false));
+        let analysis = Arc::new(Mutex::new(None));
+
+        let thread = {
+            let tx = tx.clone();
+            let stop = stop.clone();
+            let analysis = analysis.clone();
+            std::thread::Builder::new()
+                .name(format!("crsdk-liveview-{}", handle))
+                .spawn(move || run_worker(handle, config, buffer_size, &tx, &analysis, &stop))?
+        };
+
+        Ok(Self {
+            stop,
+            thread: Some(thread),
+            tx,
+            analysis,
+        })
+    }
+
+    /// New receiver for this stream
+    pub(crate) fn subscribe(&self) -> LiveViewReceiver {
+        LiveViewReceiver {
+            rx: self.tx.subscribe(),
+        }
+    }
+
+    /// Send this stream's frames to `pool`, replacing any earlier attachment
+    pub(crate) fn attach_analysis(&self, pool: &AnalysisPool) -> AnalysisReceiver {
+        let (stream, receiver) = pool.stream();
+        *self.analysis.lock().unwrap() = Some(stream);
+        receiver
+    }
+}
+
+impl Drop for LiveViewWorker {
+    fn drop(&mut self) {
+        self.stop.store(true, Ordering::Relaxed);
+        if let Some(thread) = self.thread.take() {
+            let _ = thread.join();
+        }
+        // Dropping the last sender makes receivers' `changed()` return false
+    }
+}
+
+fn query_buffer_size(handle: i64) -> Result<usize> {
+    let mut err = 0u32;
+    // SAFETY: handle belongs to a connected device that outlives the worker
+    let size = unsafe { crsdk_sys::crsdk_lv_get_buffer_size(handle, &mut err) };
+    if size == 0 {
+        return Err(if err != 0 {
+            Error::from_sdk_error(err)
+        } else {
+            Error::Other("Live view is not available".to_string())
+        });
+    }
+    Ok(size as usize)
+}
+
+/// Outcome of one frame fetch
+enum Fetch {
+    Frame,
+    NotUpdated,
+}
+
+fn fetch_frame(handle: i64, frame: &mut LiveViewFrame, frame_info: bool) -> Result<Fetch> {
+    let mut offset = 0u32;
+    let mut image_size = 0u32;
+    let mut frame_no = 0u32;
+    let mut err = 0u32;
+
+    // SAFETY: buffer is valid for buffer.len() bytes and the out-params are
+    // plain locals; the shim never writes past `size`
+    let status = unsafe {
+        crsdk_sys::crsdk_lv_get_image(
+            handle,
+            frame.buffer.as_mut_ptr(),
+            frame.buffer.len() as u32,
+            &mut offset,
+            &mut image_size,
+            &mut frame_no,
+            &mut err,
+        )
+    };
+
+    match status {
+        crsdk_sys::CRSDK_LV_OK => {}
+        crsdk_sys::CRSDK_LV_NOT_UPDATED => return Ok(Fetch::NotUpdated),
+        crsdk_sys::CRSDK_LV_BUFFER_TOO_SMALL => {
+            // The camera switched to a larger frame size; grow once and retry
+            // on the next tick
+            let size = query_buffer_size(handle)?;
+            frame.buffer.resize(size.max(frame.buffer.len() * 2), 0);
+            return Ok(Fetch::NotUpdated);
+        }
+        _ => return Err(Error::from_sdk_error(err)),
+    }
+
+    frame.offset = offset as usize;
+    frame.len = image_size as usize;
+    frame.frame_no = frame_no;
+    frame.captured_at = Some(Instant::now());
+
+    frame.frame_rects.clear();
+    if frame_info {
+        let mut rects = [crsdk_sys::CrsdkLvFrameRect::default(); MAX_FRAME_RECTS];
+        // SAFETY: rects holds MAX_FRAME_RECTS entries, which is the capacity
+        // passed to the shim
+        let total = unsafe {
+            crsdk_sys::crsdk_lv_get_frame_rects(
+                handle,
+                rects.as_mut_ptr(),
+                MAX_FRAME_RECTS as u32,
+                &mut err,
+            )
+        };
+        let count = (total as usize).min(MAX_FRAME_RECTS);
+        frame
+            .frame_rects
+            .extend(rects[..count].iter().map(FrameRect::from_sdk));
+    }
+
+    Ok(Fetch::Frame)
+}
+
+fn run_worker(
+    handle: i64,
+    config: LiveViewConfig,
+    buffer_size: usize,
+    tx: &watch::Sender<LiveViewFrame>,
+    analysis_tap: &Mutex<Option<Arc<AnalysisStream>>>,
+    stop: &AtomicBool,
+) {
+    let interval = Duration::from_secs_f32(1.0 / config.fps);
+    let mut back = LiveViewFrame {
+        buffer: vec![0; buffer_size],
+        frame_rects: Vec::with_capacity(MAX_FRAME_RECTS),
+        ..Default::default()
+    };
+    let mut next_tick = Instant::now();
+
+    while !stop.load(Ordering::Relaxed) {
+        let analysis = {
+            let mut tap = analysis_tap.lock().unwrap();
+            // Drop an attachment whose receivers are all gone
+            if tap.as_ref().is_some_and(|stream| !stream.is_watched()) {
+                tap.take();
+            }
+            tap.clone()
+        };
+
+        // Nobody is watching - don't spend SDK calls on frames
+        if tx.receiver_count() > 0 || analysis.is_some() {
+            match fetch_frame(handle, &mut back, config.frame_info) {
+                Ok(Fetch::Frame) => {
+                    if let Some(stream) = &analysis {
+                        stream.submit(&back);
+                    }
+                    tx.send_modify(|published| {
+                        std::mem::swap(published, &mut back);
+                        // First swap hands us the empty initial slot; give it
+                        // a buffer so the next fetch writes in place
+                        if published.buffer.len() > back.buffer.len() {
+                            back.buffer.resize(published.buffer.len(), 0);
+                        }
+                    });
+                }
+                Ok(Fetch::NotUpdated) => {}
+                Err(e) => tracing::debug!("Live view frame fetch failed: {}", e),
+            }
+        }
+
+        next_tick += interval;
+        let now = Instant::now();
+        if next_tick > now {
+            std::thread::sleep(next_tick - now);
+        } else {
+            // Fell behind (slow camera or host); don't try to catch up
+            next_tick = now;
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_frame_rect_normalized() {
+        let rect = FrameRect {
+            kind: FrameRectKind::Focus,
+            frame_type: 0,
+            state: 0,
+            priority: 0,
+            x: 250,
+            y: 500,
+            width: 100,
+            height: 200,
+            x_denominator: 1000,
+            y_denominator: 1000,
+        };
+        assert_eq!(rect.normalized(), (0.25, 0.5, 0.1, 0.2));
+    }
+
+    #[test]
+    fn test_empty_frame_has_no_jpeg() {
+        let frame = LiveViewFrame::default();
+        assert!(frame.is_empty());
+        assert!(frame.jpeg().is_empty());
+    }
+
+    #[tokio::test]
+    async fn test_receiver_sees_latest_frame_only() {
+        let (tx, rx) = watch::channel(LiveViewFrame::default());
+        let mut receiver = LiveViewReceiver { rx };
+
+        for frame_no in 1..=3 {
+            tx.send_modify(|frame| frame.frame_no = frame_no);
+        }
+
+        assert!(receiver.changed().await);
+        assert_eq!(receiver.with_latest(|frame| frame.frame_no), 3);
+        assert!(!receiver.has_changed());
+
+        drop(tx);
+        assert!(!receiver.changed().await);
+    }
+}
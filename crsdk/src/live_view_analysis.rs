@@ -0,0 +1,680 @@
+//! Exposure and focus analysis of live view frames
+//!
+//! [`CameraDevice::start_live_view_analysis`](crate::blocking::CameraDevice::start_live_view_analysis)
+//! taps a running live view stream and hands its frames to an
+//! [`AnalysisPool`], a fixed set of worker threads shared by every camera
+//! attached to it. Each frame is decoded and reduced to luma and RGB
+//! histograms, clipping fractions and a sharpness score (the variance of
+//! the Laplacian inside the camera's focus frame), published through a
+//! latest-result-wins [`AnalysisReceiver`].
+//!
+//! Like the frame stream itself, analysis never queues: while a camera's
+//! previous frame is still being analyzed, newer frames replace the waiting
+//! one, so a busy pool lowers the analysis rate instead of adding latency.
+//!
+//! The hot loops work on whole rows with plain integer arithmetic so the
+//! compiler can vectorize them, and the histograms count into several
+//! sub-tables to keep runs of equal pixels from serializing on one counter.
+
+use crate::error::{Error, Result};
+use crate::live_view::{FrameRect, FrameRectKind, LiveViewFrame};
+use std::collections::VecDeque;
+use std::sync::{Arc, Condvar, Mutex};
+use std::thread::JoinHandle;
+use std::time::{Duration, Instant};
+use tokio::sync::watch;
+
+/// Luma at or below this counts as crushed shadows
+pub const SHADOW_CLIP_LEVEL: u8 = 2;
+
+/// Luma at or above this counts as blown highlights
+pub const HIGHLIGHT_CLIP_LEVEL: u8 = 253;
+
+/// 256-bin histogram of 8-bit values
+#[derive(Clone, PartialEq, Eq)]
+pub struct Histogram {
+    bins: [u32; 256],
+}
+
+impl Histogram {
+    /// Count per value
+    pub fn bins(&self) -> &[u32; 256] {
+        &self.bins
+    }
+
+    /// Number of samples counted
+    pub fn total(&self) -> u64 {
+        self.bins.iter().map(|&n| n as u64).sum()
+    }
+
+    /// Mean value (0.0 for an empty histogram)
+    pub fn mean(&self) -> f32 {
+        let total = self.total();
+        if total == 0 {
+            return 0.0;
+        }
+        let sum: u64 = (0..256).map(|v| v as u64 * self.bins[v] as u64).sum();
+        (sum as f64 / total as f64) as f32
+    }
+
+    /// Fractions of samples in the shadow and highlight clipping bins
+    pub fn clipping(&self) -> Clipping {
+        let total = self.total().max(1) as f32;
+        let shadows: u64 = self.bins[..=SHADOW_CLIP_LEVEL as usize]
+            .iter()
+            .map(|&n| n as u64)
+            .sum();
+        let highlights: u64 = self.bins[HIGHLIGHT_CLIP_LEVEL as usize..]
+            .iter()
+            .map(|&n| n as u64)
+            .sum();
+        Clipping {
+            shadows: shadows as f32 / total,
+            highlights: highlights as f32 / total,
+        }
+    }
+
+    /// Merge the bins into `buckets` wider ones, e.g. one per terminal column
+    pub fn downsample(&self, buckets: usize) -> Vec<u64> {
+        let buckets = buckets.clamp(1, 256);
+        let mut out = vec![0; buckets];
+        for (value, &count) in self.bins.iter().enumerate() {
+            out[value * buckets / 256] += count as u64;
+        }
+        out
+    }
+}
+
+impl Default for Histogram {
+    fn default() -> Self {
+        Self { bins: [0; 256] }
+    }
+}
+
+impl std::fmt::Debug for Histogram {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        f.debug_struct("Histogram")
+            .field("total", &self.total())
+            .field("mean", &self.mean())
+            .finish()
+    }
+}
+
+/// Share of an image at the ends of the tonal range
+#[derive(Debug, Clone, Copy, PartialEq, Default)]
+pub struct Clipping {
+    /// Fraction (0.0..=1.0) at or below [`SHADOW_CLIP_LEVEL`]
+    pub shadows: f32,
+    /// Fraction (0.0..=1.0) at or above [`HIGHLIGHT_CLIP_LEVEL`]
+    pub highlights: f32,
+}
+
+/// Analysis of one live view frame
+#[derive(Debug, Clone)]
+pub struct FrameAnalysis {
+    /// Camera frame counter of the analyzed frame
+    pub frame_no: u32,
+    /// When the frame was fetched from the camera
+    pub captured_at: Option<Instant>,
+    /// Decoded width in pixels
+    pub width: u32,
+    /// Decoded height in pixels
+    pub height: u32,
+    /// Rec. 601 luma histogram
+    pub luma: Histogram,
+    /// Red channel histogram (the luma histogram for grayscale frames)
+    pub red: Histogram,
+    /// Green channel histogram
+    pub green: Histogram,
+    /// Blue channel histogram
+    pub blue: Histogram,
+    /// Variance of the Laplacian of luma inside the focus frame
+    ///
+    /// Higher is sharper. Only comparable between frames of the same scene
+    /// and frame size, e.g. while racking focus. `None` if the area is
+    /// smaller than 3×3 pixels.
+    pub sharpness: Option<f32>,
+    /// Focus frame the sharpness was measured in (`None`: the centre ninth
+    /// of the image, used when the camera reports no focus frame)
+    pub focus_frame: Option<FrameRect>,
+    /// Time spent decoding and analyzing the frame
+    pub elapsed: Duration,
+}
+
+impl FrameAnalysis {
+    /// Luma clipping fractions
+    pub fn clipping(&self) -> Clipping {
+        self.luma.clipping()
+    }
+}
+
+/// Receiving side of a live view analysis stream
+///
+/// Holds only the most recent result. Ends when the live view stream it
+/// taps stops or is restarted.
+#[derive(Debug, Clone)]
+pub struct AnalysisReceiver {
+    rx: watch::Receiver<Option<Arc<FrameAnalysis>>>,
+}
+
+impl AnalysisReceiver {
+    /// Wait until a result newer than the last one seen is available
+    ///
+    /// Returns `false` once the stream has stopped.
+    pub async fn changed(&mut self) -> bool {
+        self.rx.changed().await.is_ok()
+    }
+
+    /// Check whether a result newer than the last one seen is available
+    pub fn has_changed(&self) -> bool {
+        self.rx.has_changed().unwrap_or(false)
+    }
+
+    /// Latest result (`None` before the first frame is analyzed), marking it as seen
+    pub fn latest(&mut self) -> Option<Arc<FrameAnalysis>> {
+        self.rx.borrow_and_update().clone()
+    }
+}
+
+/// Worker threads that analyze live view frames for any number of cameras
+///
+/// Dropping the pool stops its threads; streams attached to it stop
+/// producing results.
+pub struct AnalysisPool {
+    shared: Arc<PoolShared>,
+    threads: Vec<JoinHandle<()>>,
+}
+
+impl AnalysisPool {
+    /// Start `threads` workers (0 picks half the available CPUs)
+    pub fn new(threads: usize) -> Result<Self> {
+        let threads = match threads {
+            0 => std::thread::available_parallelism().map_or(1, |n| (n.get() / 2).max(1)),
+            n => n,
+        };
+        let shared = Arc::new(PoolShared {
+            state: Mutex::new(PoolState {
+                ready: VecDeque::new(),
+                stop: false,
+            }),
+            work: Condvar::new(),
+        });
+
+        let mut pool = Self {
+            shared,
+            threads: Vec::with_capacity(threads),
+        };
+        for index in 0..threads {
+            let shared = pool.shared.clone();
+            let thread = std::thread::Builder::new()
+                .name(format!("crsdk-lv-analysis-{}", index))
+                .spawn(move || run_worker(&shared))?;
+            pool.threads.push(thread);
+        }
+        Ok(pool)
+    }
+
+    /// Number of worker threads
+    pub fn threads(&self) -> usize {
+        self.threads.len()
+    }
+
+    /// New stream of results for one camera
+    pub(crate) fn stream(&self) -> (Arc<AnalysisStream>, AnalysisReceiver) {
+        let (tx, rx) = watch::channel(None);
+        let stream = Arc::new(AnalysisStream {
+            pool: self.shared.clone(),
+            slot: Mutex::new(Slot::default()),
+            tx,
+        });
+        (stream, AnalysisReceiver { rx })
+    }
+}
+
+impl Drop for AnalysisPool {
+    fn drop(&mut self) {
+        let mut state = self.shared.state.lock().unwrap();
+        state.stop = true;
+        state.ready.clear();
+        drop(state);
+        self.shared.work.notify_all();
+        for thread in self.threads.drain(..) {
+            let _ = thread.join();
+        }
+    }
+}
+
+struct PoolShared {
+    state: Mutex<PoolState>,
+    work: Condvar,
+}
+
+struct PoolState {
+    /// Streams with a frame waiting, each listed at most once
+    ready: VecDeque<Arc<AnalysisStream>>,
+    stop: bool,
+}
+
+/// One camera's connection to the pool
+pub(crate) struct AnalysisStream {
+    pool: Arc<PoolShared>,
+    slot: Mutex<Slot>,
+    tx: watch::Sender<Option<Arc<FrameAnalysis>>>,
+}
+
+#[derive(Default)]
+struct Slot {
+    /// Latest frame not yet picked up by a worker
+    frame: Option<PendingFrame>,
+    /// Buffer of the last analyzed frame, reused for the next copy
+    spare: Vec<u8>,
+    /// Whether the stream is in the pool's ready queue
+    queued: bool,
+}
+
+struct PendingFrame {
+    jpeg: Vec<u8>,
+    frame_no: u32,
+    captured_at: Option<Instant>,
+    frame_rects: Vec<FrameRect>,
+}
+
+impl AnalysisStream {
+    /// Whether anyone still holds a receiver
+    pub(crate) fn is_watched(&self) -> bool {
+        self.tx.receiver_count() > 0
+    }
+
+    /// Queue a copy of `frame`, replacing a frame still waiting
+    pub(crate) fn submit(self: &Arc<Self>, frame: &LiveViewFrame) {
+        if frame.is_empty() || !self.is_watched() {
+            return;
+        }
+
+        let mut slot = self.slot.lock().unwrap();
+        let mut jpeg = match slot.frame.take() {
+            Some(stale) => stale.jpeg,
+            None => std::mem::take(&mut slot.spare),
+        };
+        jpeg.clear();
+        jpeg.extend_from_slice(frame.jpeg());
+        slot.frame = Some(PendingFrame {
+            jpeg,
+            frame_no: frame.frame_no,
+            captured_at: frame.captured_at,
+            frame_rects: frame.frame_rects.clone(),
+        });
+        if std::mem::replace(&mut slot.queued, true) {
+            return;
+        }
+        drop(slot);
+
+        let mut state = self.pool.state.lock().unwrap();
+        if state.stop {
+            return;
+        }
+        state.ready.push_back(self.clone());
+        drop(state);
+        self.pool.work.notify_one();
+    }
+
+    /// Publish `analysis` unless a newer frame's result got there first
+    fn publish(&self, analysis: FrameAnalysis) {
+        self.tx.send_if_modified(|latest| {
+            let newer = latest
+                .as_ref()
+                .is_some_and(|prev| prev.captured_at > analysis.captured_at);
+            if !newer {
+                *latest = Some(Arc::new(analysis));
+            }
+            !newer
+        });
+    }
+}
+
+fn run_worker(shared: &PoolShared) {
+    let mut luma = Vec::new();
+    loop {
+        let stream = {
+            let mut state = shared.state.lock().unwrap();
+            loop {
+                if state.stop {
+                    return;
+                }
+                if let Some(stream) = state.ready.pop_front() {
+                    break stream;
+                }
+                state = shared.work.wait(state).unwrap();
+            }
+        };
+
+        let pending = {
+            let mut slot = stream.slot.lock().unwrap();
+            slot.queued = false;
+            slot.frame.take()
+        };
+        let Some(pending) = pending else {
+            continue;
+        };
+
+        match analyze_jpeg(&pending, &mut luma) {
+            Ok(analysis) => stream.publish(analysis),
+            Err(e) => tracing::debug!("Live view analysis failed: {}", e),
+        }
+
+        let mut slot = stream.slot.lock().unwrap();
+        if slot.spare.capacity() < pending.jpeg.capacity() {
+            slot.spare = pending.jpeg;
+        }
+    }
+}
+
+fn analyze_jpeg(frame: &PendingFrame, luma: &mut Vec<u8>) -> Result<FrameAnalysis> {
+    let started = Instant::now();
+    let mut decoder = jpeg_decoder::Decoder::new(frame.jpeg.as_slice());
+    let pixels = decoder
+        .decode()
+        .map_err(|e| Error::Other(format!("Live view JPEG decode failed: {}", e)))?;
+    let info = decoder
+        .info()
+        .ok_or_else(|| Error::Other("Live view JPEG has no header".to_string()))?;
+    let channels = match info.pixel_format {
+        jpeg_decoder::PixelFormat::L8 => 1,
+        jpeg_decoder::PixelFormat::RGB24 => 3,
+        other => {
+            return Err(Error::Other(format!(
+                "Unsupported live view pixel format {:?}",
+                other
+            )))
+        }
+    };
+
+    let image = Image {
+        pixels: &pixels,
+        width: info.width as usize,
+        height: info.height as usize,
+        channels,
+    };
+    let mut analysis = analyze(&image, &frame.frame_rects, luma);
+    analysis.frame_no = frame.frame_no;
+    analysis.captured_at = frame.captured_at;
+    analysis.elapsed = started.elapsed();
+    Ok(analysis)
+}
+
+/// A decoded frame: rows of `width` pixels of 1 (gray) or 3 (RGB) bytes
+struct Image<'a> {
+    pixels: &'a [u8],
+    width: usize,
+    height: usize,
+    channels: usize,
+}
+
+/// Histograms, clipping and sharpness of `image`; `luma` is scratch space
+fn analyze(image: &Image<'_>, frame_rects: &[FrameRect], luma: &mut Vec<u8>) -> FrameAnalysis {
+    let (red, green, blue) = if image.channels == 3 {
+        to_luma(image.pixels, luma);
+        let mut rgb: [Histogram; 3] = Default::default();
+        count_rgb(image.pixels, &mut rgb);
+        let [red, green, blue] = rgb;
+        (red, green, blue)
+    } else {
+        luma.clear();
+        luma.extend_from_slice(image.pixels);
+        let mut gray = Histogram::default();
+        count(luma, &mut gray.bins);
+        (gray.clone(), gray.clone(), gray)
+    };
+    let mut luma_histogram = Histogram::default();
+    count(luma, &mut luma_histogram.bins);
+
+    let focus_frame = frame_rects
+        .iter()
+        .find(|rect| rect.kind == FrameRectKind::Focus)
+        .copied();
+    let area = match &focus_frame {
+        Some(rect) => pixel_area(rect, image.width, image.height),
+        None => (
+            image.width / 3,
+            image.height / 3,
+            image.width * 2 / 3,
+            image.height * 2 / 3,
+        ),
+    };
+
+    FrameAnalysis {
+        frame_no: 0,
+        captured_at: None,
+        width: image.width as u32,
+        height: image.height as u32,
+        luma: luma_histogram,
+        red,
+        green,
+        blue,
+        sharpness: laplacian_variance(luma, image.width, area),
+        focus_frame,
+        elapsed: Duration::ZERO,
+    }
+}
+
+/// Rec. 601 luma of packed RGB pixels, in fixed point
+fn to_luma(rgb: &[u8], luma: &mut Vec<u8>) {
+    luma.clear();
+    luma.extend(rgb.chunks_exact(3).map(|px| {
+        let y = 77 * px[0] as u32 + 150 * px[1] as u32 + 29 * px[2] as u32;
+        ((y + 128) >> 8) as u8
+    }));
+}
+
+/// Count bytes into `bins`, four sub-tables at a time
+fn count(values: &[u8], bins: &mut [u32; 256]) {
+    let mut tables = [[0u32; 256]; 4];
+    let mut chunks = values.chunks_exact(4);
+    for chunk in &mut chunks {
+        tables[0][chunk[0] as usize] += 1;
+        tables[1][chunk[1] as usize] += 1;
+        tables[2][chunk[2] as usize] += 1;
+        tables[3][chunk[3] as usize] += 1;
+    }
+    for &value in chunks.remainder() {
+        tables[0][value as usize] += 1;
+    }
+    for (i, bin) in bins.iter_mut().enumerate() {
+        *bin += tables[0][i] + tables[1][i] + tables[2][i] + tables[3][i];
+    }
+}
+
+/// Count packed RGB pixels into one histogram per channel, two pixels at a time
+fn count_rgb(rgb: &[u8], histograms: &mut [Histogram; 3]) {
+    let mut tables = [[[0u32; 256]; 3]; 2];
+    let mut pairs = rgb.chunks_exact(6);
+    for pair in &mut pairs {
+        for channel in 0..3 {
+            tables[0][channel][pair[channel] as usize] += 1;
+            tables[1][channel][pair[3 + channel] as usize] += 1;
+        }
+    }
+    for px in pairs.remainder().chunks_exact(3) {
+        for channel in 0..3 {
+            tables[0][channel][px[channel] as usize] += 1;
+        }
+    }
+    for (channel, histogram) in histograms.iter_mut().enumerate() {
+        for (i, bin) in histogram.bins.iter_mut().enumerate() {
+            *bin += tables[0][channel][i] + tables[1][channel][i];
+        }
+    }
+}
+
+/// `(x0, y0, x1, y1)` pixel bounds of a focus frame, clamped to the image
+fn pixel_area(rect: &FrameRect, width: usize, height: usize) -> (usize, usize, usize, usize) {
+    let (x, y, w, h) = rect.normalized();
+    let scale = |fraction: f32, size: usize| (fraction.clamp(0.0, 1.0) * size as f32) as usize;
+    (
+        scale(x, width),
+        scale(y, height),
+        scale(x + w, width),
+        scale(y + h, height),
+    )
+}
+
+/// Variance of the 4-neighbour Laplacian over the interior of `area`
+fn laplacian_variance(
+    luma: &[u8],
+    width: usize,
+    (x0, y0, x1, y1): (usize, usize, usize, usize),
+) -> Option<f32> {
+    if x1 < x0 + 3 || y1 < y0 + 3 {
+        return None;
+    }
+
+    let (mut sum, mut sum_sq, mut n) = (0i64, 0i64, 0i64);
+    for y in y0 + 1..y1 - 1 {
+        let row = |dy: isize| {
+            let start = (y as isize + dy) as usize * width;
+            &luma[start + x0..start + x1]
+        };
+        let (up, mid, down) = (row(-1), row(0), row(1));
+
+        let mut row_sum = 0i32;
+        let mut row_sq = 0i64;
+        for x in 1..mid.len() - 1 {
+            let lap = 4 * mid[x] as i32
+                - mid[x - 1] as i32
+                - mid[x + 1] as i32
+                - up[x] as i32
+                - down[x] as i32;
+            row_sum += lap;
+            row_sq += (lap * lap) as i64;
+        }
+        sum += row_sum as i64;
+        sum_sq += row_sq;
+        n += mid.len() as i64 - 2;
+    }
+
+    let mean = sum as f64 / n as f64;
+    Some((sum_sq as f64 / n as f64 - mean * mean) as f32)
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn gray(width: usize, height: usize, f: impl Fn(usize, usize) -> u8) -> Vec<u8> {
+        (0..height)
+            .flat_map(|y| (0..width).map(move |x| (x, y)))
+            .map(|(x, y)| f(x, y))
+            .collect()
+    }
+
+    fn analyze_gray(
+        width: usize,
+        height: usize,
+        pixels: &[u8],
+        rects: &[FrameRect],
+    ) -> FrameAnalysis {
+        let image = Image {
+            pixels,
+            width,
+            height,
+            channels: 1,
+        };
+        analyze(&image, rects, &mut Vec::new())
+    }
+
+    #[test]
+    fn test_histograms_and_clipping() {
+        // Left half black, right half white, one RGB pixel row
+        let rgb: Vec<u8> = (0..64)
+            .flat_map(|x| if x < 32 { [0, 0, 0] } else { [255, 255, 255] })
+            .collect();
+        let image = Image {
+            pixels: &rgb,
+            width: 64,
+            height: 1,
+            channels: 3,
+        };
+        let analysis = analyze(&image, &[], &mut Vec::new());
+
+        assert_eq!(analysis.luma.total(), 64);
+        assert_eq!(analysis.luma.bins()[0], 32);
+        assert_eq!(analysis.luma.bins()[255], 32);
+        assert_eq!(analysis.red, analysis.blue);
+        assert_eq!(
+            analysis.clipping(),
+            Clipping {
+                shadows: 0.5,
+                highlights: 0.5
+            }
+        );
+        assert_eq!(analysis.luma.downsample(2), vec![32, 32]);
+    }
+
+    #[test]
+    fn test_luma_weights_sum_to_full_scale() {
+        let mut luma = Vec::new();
+        to_luma(&[255, 255, 255, 255, 0, 0, 0, 255, 0, 0, 0, 255], &mut luma);
+        assert_eq!(luma, vec![255, 77, 149, 29]);
+    }
+
+    #[test]
+    fn test_sharpness_prefers_detail_in_focus_frame() {
+        // Checkerboard in the left half, flat grey in the right half
+        let (w, h) = (64, 32);
+        let pixels = gray(w, h, |x, y| {
+            if x < w / 2 && (x + y) % 2 == 0 {
+                255
+            } else {
+                128
+            }
+        });
+        let frame = |x| FrameRect {
+            kind: FrameRectKind::Focus,
+            frame_type: 0,
+            state: 0,
+            priority: 0,
+            x,
+            y: 0,
+            width: 500,
+            height: 1000,
+            x_denominator: 1000,
+            y_denominator: 1000,
+        };
+
+        let detailed = analyze_gray(w, h, &pixels, &[frame(0)]);
+        let flat = analyze_gray(w, h, &pixels, &[frame(500)]);
+        assert!(detailed.sharpness.unwrap() > 1000.0);
+        assert_eq!(flat.sharpness, Some(0.0));
+        assert_eq!(detailed.focus_frame, Some(frame(0)));
+
+        // No focus frame: the centre of the image is measured
+        assert!(analyze_gray(w, h, &pixels, &[]).focus_frame.is_none());
+        assert_eq!(analyze_gray(2, 2, &[0; 4], &[]).sharpness, None);
+    }
+
+    #[test]
+    fn test_stream_keeps_newest_result() {
+        let pool = AnalysisPool::new(1).unwrap();
+        let (stream, mut receiver) = pool.stream();
+        let result = |at| FrameAnalysis {
+            frame_no: 0,
+            captured_at: Some(at),
+            width: 0,
+            height: 0,
+            luma: Histogram::default(),
+            red: Histogram::default(),
+            green: Histogram::default(),
+            blue: Histogram::default(),
+            sharpness: None,
+            focus_frame: None,
+            elapsed: Duration::ZERO,
+        };
+
+        let earlier = Instant::now();
+        let later = earlier + Duration::from_millis(33);
+        stream.publish(result(later));
+        stream.publish(result(earlier));
+        assert_eq!(receiver.latest().unwrap().captured_at, Some(later));
+        assert!(!receiver.has_changed());
+    }
+}
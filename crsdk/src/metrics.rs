@@ -0,0 +1,370 @@
+//! Latency instrumentation for SDK calls and event delivery
+//!
+//! Every device keeps lock-free histograms of how long its SDK calls take
+//! and how long each kind of event waits between the SDK callback and the
+//! consumer receiving it. [`MetricsSnapshot`] reads them all at once,
+//! together with the event queue's depth gauges. With the event ring, an
+//! event's wait starts when the C++ callback pushed it, not when the drainer
+//! delivered it.
+//!
+//! SDK calls are also wrapped in `sdk_call` spans at `TRACE` level, so a
+//! `tracing` subscriber can attribute them without any extra setup.
+
+use crate::event::CameraEvent;
+use crate::event_queue::EventStats;
+use std::sync::atomic::{AtomicU64, Ordering};
+use std::time::{Duration, Instant};
+
+/// Number of buckets in a latency histogram
+///
+/// Bucket 0 counts samples under 1µs; bucket `i` counts samples in
+/// `[2^(i-1), 2^i)` µs. The last bucket also takes everything slower.
+pub const LATENCY_BUCKETS: usize = 32;
+
+/// An instrumented SDK call
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+pub enum SdkCall {
+    /// `Connect`
+    Connect,
+    /// `GetSelectDeviceProperties`
+    GetSelectProperties,
+    /// `GetDeviceProperties`
+    GetAllProperties,
+    /// `SetDeviceProperty`
+    SetProperty,
+    /// `SendCommand`
+    SendCommand,
+}
+
+impl SdkCall {
+    /// Every instrumented call, in display order
+    pub const ALL: [Self; 5] = [
+        Self::Connect,
+        Self::GetSelectProperties,
+        Self::GetAllProperties,
+        Self::SetProperty,
+        Self::SendCommand,
+    ];
+
+    /// Name of the SDK function
+    pub fn name(self) -> &'static str {
+        match self {
+            Self::Connect => "Connect",
+            Self::GetSelectProperties => "GetSelectDeviceProperties",
+            Self::GetAllProperties => "GetDeviceProperties",
+            Self::SetProperty => "SetDeviceProperty",
+            Self::SendCommand => "SendCommand",
+        }
+    }
+
+    fn index(self) -> usize {
+        self as usize
+    }
+}
+
+/// Kind of [`CameraEvent`], for per-kind delivery latency
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+pub enum EventKind {
+    /// [`CameraEvent::Connected`]
+    Connected,
+    /// [`CameraEvent::Disconnected`]
+    Disconnected,
+    /// [`CameraEvent::PropertyChanged`]
+    PropertyChanged,
+    /// [`CameraEvent::LiveViewPropertyChanged`]
+    LiveViewPropertyChanged,
+    /// [`CameraEvent::DownloadComplete`]
+    DownloadComplete,
+    /// [`CameraEvent::ContentsTransfer`]
+    ContentsTransfer,
+    /// [`CameraEvent::Warning`]
+    Warning,
+    /// [`CameraEvent::Error`]
+    Error,
+    /// [`CameraEvent::RemoteTransferProgress`]
+    RemoteTransferProgress,
+    /// [`CameraEvent::RemoteTransferData`]
+    RemoteTransferData,
+    /// [`CameraEvent::ContentsListChanged`]
+    ContentsListChanged,
+    /// [`CameraEvent::FirmwareUpdateProgress`]
+    FirmwareUpdateProgress,
+}
+
+impl EventKind {
+    /// Number of event kinds
+    pub const COUNT: usize = 12;
+
+    /// Every event kind, in display order
+    pub const ALL: [Self; Self::COUNT] = [
+        Self::Connected,
+        Self::Disconnected,
+        Self::PropertyChanged,
+        Self::LiveViewPropertyChanged,
+        Self::DownloadComplete,
+        Self::ContentsTransfer,
+        Self::Warning,
+        Self::Error,
+        Self::RemoteTransferProgress,
+        Self::RemoteTransferData,
+        Self::ContentsListChanged,
+        Self::FirmwareUpdateProgress,
+    ];
+
+    /// Kind of `event`
+    pub fn of(event: &CameraEvent) -> Self {
+        match event {
+            CameraEvent::Connected { .. } => Self::Connected,
+            CameraEvent::Disconnected { .. } => Self::Disconnected,
+            CameraEvent::PropertyChanged { .. } => Self::PropertyChanged,
+            CameraEvent::LiveViewPropertyChanged { .. } => Self::LiveViewPropertyChanged,
+            CameraEvent::DownloadComplete { .. } => Self::DownloadComplete,
+            CameraEvent::ContentsTransfer { .. } => Self::ContentsTransfer,
+            CameraEvent::Warning { .. } => Self::Warning,
+            CameraEvent::Error { .. } => Self::Error,
+            CameraEvent::RemoteTransferProgress { .. } => Self::RemoteTransferProgress,
+            CameraEvent::RemoteTransferData { .. } => Self::RemoteTransferData,
+            CameraEvent::ContentsListChanged { .. } => Self::ContentsListChanged,
+            CameraEvent::FirmwareUpdateProgress { .. } => Self::FirmwareUpdateProgress,
+        }
+    }
+
+    /// Short display name
+    pub fn name(self) -> &'static str {
+        match self {
+            Self::Connected => "Connected",
+            Self::Disconnected => "Disconnected",
+            Self::PropertyChanged => "PropertyChanged",
+            Self::LiveViewPropertyChanged => "LiveViewPropertyChanged",
+            Self::DownloadComplete => "DownloadComplete",
+            Self::ContentsTransfer => "ContentsTransfer",
+            Self::Warning => "Warning",
+            Self::Error => "Error",
+            Self::RemoteTransferProgress => "RemoteTransferProgress",
+            Self::RemoteTransferData => "RemoteTransferData",
+            Self::ContentsListChanged => "ContentsListChanged",
+            Self::FirmwareUpdateProgress => "FirmwareUpdateProgress",
+        }
+    }
+
+    fn index(self) -> usize {
+        self as usize
+    }
+}
+
+/// Lock-free latency histogram with power-of-two microsecond buckets
+#[derive(Debug)]
+pub(crate) struct LatencyHistogram {
+    count: AtomicU64,
+    total_nanos: AtomicU64,
+    max_nanos: AtomicU64,
+    buckets: [AtomicU64; LATENCY_BUCKETS],
+}
+
+impl Default for LatencyHistogram {
+    fn default() -> Self {
+        Self {
+            count: AtomicU64::new(0),
+            total_nanos: AtomicU64::new(0),
+            max_nanos: AtomicU64::new(0),
+            buckets: std::array::from_fn(|_| AtomicU64::new(0)),
+        }
+    }
+}
+
+fn bucket_for(latency: Duration) -> usize {
+    let micros = latency.as_micros().min(u64::MAX as u128) as u64;
+    let bucket = (u64::BITS - micros.leading_zeros()) as usize;
+    bucket.min(LATENCY_BUCKETS - 1)
+}
+
+impl LatencyHistogram {
+    pub(crate) fn record(&self, latency: Duration) {
+        let nanos = latency.as_nanos().min(u64::MAX as u128) as u64;
+        self.count.fetch_add(1, Ordering::Relaxed);
+        self.total_nanos.fetch_add(nanos, Ordering::Relaxed);
+        self.max_nanos.fetch_max(nanos, Ordering::Relaxed);
+        self.buckets[bucket_for(latency)].fetch_add(1, Ordering::Relaxed);
+    }
+
+    pub(crate) fn snapshot(&self) -> LatencySnapshot {
+        LatencySnapshot {
+            count: self.count.load(Ordering::Relaxed),
+            total: Duration::from_nanos(self.total_nanos.load(Ordering::Relaxed)),
+            max: Duration::from_nanos(self.max_nanos.load(Ordering::Relaxed)),
+            buckets: std::array::from_fn(|i| self.buckets[i].load(Ordering::Relaxed)),
+        }
+    }
+}
+
+/// Point-in-time copy of one latency histogram
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct LatencySnapshot {
+    /// Number of samples
+    pub count: u64,
+    /// Sum of all samples
+    pub total: Duration,
+    /// Slowest sample
+    pub max: Duration,
+    /// Sample counts per bucket (see [`LATENCY_BUCKETS`])
+    pub buckets: [u64; LATENCY_BUCKETS],
+}
+
+impl Default for LatencySnapshot {
+    fn default() -> Self {
+        Self {
+            count: 0,
+            total: Duration::ZERO,
+            max: Duration::ZERO,
+            buckets: [0; LATENCY_BUCKETS],
+        }
+    }
+}
+
+impl LatencySnapshot {
+    /// Check whether nothing has been recorded
+    pub fn is_empty(&self) -> bool {
+        self.count == 0
+    }
+
+    /// Average sample, or zero when empty
+    pub fn mean(&self) -> Duration {
+        if self.count == 0 {
+            return Duration::ZERO;
+        }
+        self.total / self.count.min(u32::MAX as u64) as u32
+    }
+
+    /// Upper bound of the bucket holding the `q` quantile (0.0..=1.0)
+    ///
+    /// Accurate to a factor of two, and never above [`max`](Self::max).
+    pub fn percentile(&self, q: f64) -> Duration {
+        if self.count == 0 {
+            return Duration::ZERO;
+        }
+        let rank = ((self.count as f64) * q.clamp(0.0, 1.0)).ceil().max(1.0) as u64;
+        let mut seen = 0;
+        for (i, n) in self.buckets.iter().enumerate() {
+            seen += n;
+            if seen >= rank {
+                return Duration::from_micros(1 << i).min(self.max);
+            }
+        }
+        self.max
+    }
+}
+
+/// Per-device SDK call histograms
+#[derive(Debug, Default)]
+pub(crate) struct SdkCallMetrics {
+    calls: [LatencyHistogram; SdkCall::ALL.len()],
+}
+
+impl SdkCallMetrics {
+    /// Run `f` as one `call`, recording how long it took
+    pub(crate) fn time<R>(&self, call: SdkCall, f: impl FnOnce() -> R) -> R {
+        let _span = tracing::trace_span!("sdk_call", call = call.name()).entered();
+        let started = Instant::now();
+        let result = f();
+        self.calls[call.index()].record(started.elapsed());
+        result
+    }
+
+    pub(crate) fn snapshot(&self) -> [LatencySnapshot; SdkCall::ALL.len()] {
+        std::array::from_fn(|i| self.calls[i].snapshot())
+    }
+}
+
+/// Per-kind event delivery histograms, owned by the event queue
+#[derive(Debug, Default)]
+pub(crate) struct EventLatencyMetrics {
+    kinds: [LatencyHistogram; EventKind::COUNT],
+}
+
+impl EventLatencyMetrics {
+    pub(crate) fn record(&self, kind: EventKind, latency: Duration) {
+        self.kinds[kind.index()].record(latency);
+    }
+
+    pub(crate) fn snapshot(&self) -> [LatencySnapshot; EventKind::COUNT] {
+        std::array::from_fn(|i| self.kinds[i].snapshot())
+    }
+}
+
+/// Everything a device has measured so far
+#[derive(Debug, Clone, Default, PartialEq, Eq)]
+pub struct MetricsSnapshot {
+    sdk_calls: [LatencySnapshot; SdkCall::ALL.len()],
+    events: [LatencySnapshot; EventKind::COUNT],
+    /// Event queue counters and depth gauges
+    pub queue: EventStats,
+}
+
+impl MetricsSnapshot {
+    pub(crate) fn new(
+        sdk_calls: [LatencySnapshot; SdkCall::ALL.len()],
+        events: [LatencySnapshot; EventKind::COUNT],
+        queue: EventStats,
+    ) -> Self {
+        Self {
+            sdk_calls,
+            events,
+            queue,
+        }
+    }
+
+    /// Latency of one SDK call
+    pub fn sdk_call(&self, call: SdkCall) -> &LatencySnapshot {
+        &self.sdk_calls[call.index()]
+    }
+
+    /// Time from SDK callback to `recv_event` for one event kind
+    pub fn event(&self, kind: EventKind) -> &LatencySnapshot {
+        &self.events[kind.index()]
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_buckets_are_powers_of_two_micros() {
+        assert_eq!(bucket_for(Duration::from_nanos(500)), 0);
+        assert_eq!(bucket_for(Duration::from_micros(1)), 1);
+        assert_eq!(bucket_for(Duration::from_micros(3)), 2);
+        assert_eq!(bucket_for(Duration::from_micros(4)), 3);
+        assert_eq!(
+            bucket_for(Duration::from_secs(100_000)),
+            LATENCY_BUCKETS - 1
+        );
+    }
+
+    #[test]
+    fn test_histogram_snapshot_stats() {
+        let histogram = LatencyHistogram::default();
+        for micros in [10, 20, 30, 1000] {
+            histogram.record(Duration::from_micros(micros));
+        }
+
+        let snapshot = histogram.snapshot();
+        assert_eq!(snapshot.count, 4);
+        assert_eq!(snapshot.mean(), Duration::from_micros(265));
+        assert_eq!(snapshot.max, Duration::from_micros(1000));
+        // 10..30µs land in the 16µs and 32µs buckets
+        assert_eq!(snapshot.percentile(0.5), Duration::from_micros(32));
+        assert_eq!(snapshot.percentile(1.0), Duration::from_micros(1000));
+        assert_eq!(LatencySnapshot::default().percentile(0.5), Duration::ZERO);
+    }
+
+    #[test]
+    fn test_sdk_call_timing() {
+        let metrics = SdkCallMetrics::default();
+        let value = metrics.time(SdkCall::SendCommand, || 7);
+        assert_eq!(value, 7);
+
+        let snapshot = metrics.snapshot();
+        assert_eq!(snapshot[SdkCall::SendCommand.index()].count, 1);
+        assert!(snapshot[SdkCall::Connect.index()].is_empty());
+    }
+}
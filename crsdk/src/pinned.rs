@@ -0,0 +1,226 @@
+//! Camera device pinned to a dedicated SDK thread
+//!
+//! The default async [`CameraDevice`](crate::CameraDevice) runs each SDK call
+//! through `block_in_place`, which occupies a tokio worker thread for the
+//! duration of the call and needs a multi-threaded runtime. A
+//! [`PinnedCameraDevice`] instead moves the blocking device onto one thread
+//! it owns and feeds it a command queue:
+//!
+//! - SDK calls for a camera are serialized on its own thread
+//! - runtime threads only enqueue a job and await a oneshot reply
+//! - requests are enqueued when the call is made, not when it is awaited,
+//!   so several requests to one camera can be in flight at once
+
+use crate::blocking;
+use crate::error::{Error, Result};
+use crate::event_queue::{EventReceiver, EventStats};
+use crate::metrics::MetricsSnapshot;
+use crate::property::DeviceProperty;
+use crate::types::CameraModel;
+use crsdk_sys::DevicePropertyCode;
+use std::future::Future;
+use std::sync::mpsc as std_mpsc;
+use tokio::sync::oneshot;
+
+type Job = Box<dyn FnOnce(&mut blocking::CameraDevice) + Send>;
+
+/// An async camera handle backed by its own SDK worker thread
+///
+/// Created with [`CameraDeviceBuilder::connect_pinned`](crate::CameraDeviceBuilder::connect_pinned).
+/// Dropping it closes the queue; the worker finishes pending jobs, then
+/// disconnects the camera. Use [`shutdown`](Self::shutdown) to wait for that.
+pub struct PinnedCameraDevice {
+    jobs: Option<std_mpsc::Sender<Job>>,
+    done: Option<oneshot::Receiver<()>>,
+    model: CameraModel,
+    event_receiver: Option<EventReceiver>,
+}
+
+impl PinnedCameraDevice {
+    /// Start the worker thread, connect on it with `connect`, then run jobs
+    pub(crate) async fn spawn<F>(connect: F) -> Result<Self>
+    where
+        F: FnOnce() -> Result<blocking::CameraDevice> + Send + 'static,
+    {
+        let (jobs_tx, jobs_rx) = std_mpsc::channel::<Job>();
+        let (ready_tx, ready_rx) = oneshot::channel();
+        let (done_tx, done_rx) = oneshot::channel();
+
+        std::thread::Builder::new()
+            .name("crsdk-camera".to_string())
+            .spawn(move || {
+                let mut device = match connect() {
+                    Ok(device) => device,
+                    Err(e) => {
+                        let _ = ready_tx.send(Err(e));
+                        return;
+                    }
+                };
+                let receiver = device.take_event_receiver();
+                if ready_tx.send(Ok((device.model(), receiver))).is_err() {
+                    return;
+                }
+
+                while let Ok(job) = jobs_rx.recv() {
+                    job(&mut device);
+                }
+
+                drop(device);
+                let _ = done_tx.send(());
+            })?;
+
+        let (model, receiver) = ready_rx
+            .await
+            .map_err(|_| Error::Other("Camera worker thread exited".to_string()))??;
+
+        Ok(Self {
+            jobs: Some(jobs_tx),
+            done: Some(done_rx),
+            model,
+            event_receiver: Some(receiver),
+        })
+    }
+
+    /// Run `f` on the worker thread against the blocking device
+    ///
+    /// The job is queued immediately; the returned future only waits for the
+    /// reply. Any blocking API is reachable this way.
+    pub fn call<R, F>(&self, f: F) -> impl Future<Output = Result<R>>
+    where
+        R: Send + 'static,
+        F: FnOnce(&mut blocking::CameraDevice) -> R + Send + 'static,
+    {
+        let (reply_tx, reply_rx) = oneshot::channel();
+        let job: Job = Box::new(move |device| {
+            let _ = reply_tx.send(f(device));
+        });
+        let queued = match &self.jobs {
+            Some(jobs) => jobs.send(job).is_ok(),
+            None => false,
+        };
+
+        async move {
+            if !queued {
+                return Err(Error::Disconnected);
+            }
+            reply_rx.await.map_err(|_| Error::Disconnected)
+        }
+    }
+
+    /// Get the camera model
+    pub fn model(&self) -> CameraModel {
+        self.model
+    }
+
+    /// Get a property value. See [`blocking::CameraDevice::get_property`].
+    pub fn get_property(
+        &self,
+        code: DevicePropertyCode,
+    ) -> impl Future<Output = Result<DeviceProperty>> {
+        let reply = self.call(move |device| device.get_property(code));
+        async move { reply.await? }
+    }
+
+    /// Get several properties in one call. See [`blocking::CameraDevice::get_properties`].
+    pub fn get_properties(
+        &self,
+        codes: Vec<DevicePropertyCode>,
+    ) -> impl Future<Output = Result<Vec<DeviceProperty>>> {
+        let reply = self.call(move |device| device.get_properties(&codes));
+        async move { reply.await? }
+    }
+
+    /// Set a property value. See [`blocking::CameraDevice::set_property`].
+    pub fn set_property(
+        &self,
+        code: DevicePropertyCode,
+        value: u64,
+    ) -> impl Future<Output = Result<()>> {
+        let reply = self.call(move |device| device.set_property(code, value));
+        async move { reply.await? }
+    }
+
+    /// Set a property value without validation. See
+    /// [`blocking::CameraDevice::set_property_unchecked`].
+    pub fn set_property_unchecked(
+        &self,
+        code: DevicePropertyCode,
+        value: u64,
+    ) -> impl Future<Output = Result<()>> {
+        let reply = self.call(move |device| device.set_property_unchecked(code, value));
+        async move { reply.await? }
+    }
+
+    /// Set several property values. See [`blocking::CameraDevice::set_properties`].
+    pub fn set_properties(
+        &self,
+        values: Vec<(DevicePropertyCode, u64)>,
+    ) -> impl Future<Output = Result<()>> {
+        let reply = self.call(move |device| device.set_properties(&values));
+        async move { reply.await? }
+    }
+
+    /// Take a picture. See [`blocking::CameraDevice::capture`].
+    pub fn capture(&self) -> impl Future<Output = Result<()>> {
+        let reply = self.call(|device| device.capture());
+        async move { reply.await? }
+    }
+
+    /// Wait for the next event from the camera
+    ///
+    /// Returns `None` if the receiver has been taken or the camera is gone.
+    pub async fn recv_event(&mut self) -> Option<crate::CameraEvent> {
+        match self.event_receiver.as_mut() {
+            Some(receiver) => receiver.recv().await,
+            None => None,
+        }
+    }
+
+    /// Take the event receiver for use elsewhere
+    pub fn take_event_receiver(&mut self) -> Option<EventReceiver> {
+        self.event_receiver.take()
+    }
+
+    /// Event queue counters
+    pub fn event_stats(&self) -> impl Future<Output = Result<EventStats>> {
+        self.call(|device| device.event_stats())
+    }
+
+    /// Latency histograms and queue gauges of the camera
+    pub fn metrics(&self) -> impl Future<Output = Result<MetricsSnapshot>> {
+        self.call(|device| device.metrics())
+    }
+
+    /// Close the queue and wait until the camera has been disconnected
+    pub async fn shutdown(mut self) {
+        self.jobs.take();
+        if let Some(done) = self.done.take() {
+            let _ = done.await;
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[tokio::test]
+    async fn test_call_after_shutdown_reports_disconnected() {
+        let device = PinnedCameraDevice {
+            jobs: None,
+            done: None,
+            model: CameraModel::Alpha1,
+            event_receiver: Some(EventReceiver::closed()),
+        };
+        assert!(matches!(
+            device.call(|_| ()).await,
+            Err(Error::Disconnected)
+        ));
+    }
+
+    #[tokio::test]
+    async fn test_spawn_reports_connect_error() {
+        let result = PinnedCameraDevice::spawn(|| Err(Error::Other("no camera".to_string()))).await;
+        assert!(matches!(result, Err(Error::Other(msg)) if msg == "no camera"));
+    }
+}
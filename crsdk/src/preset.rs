@@ -0,0 +1,519 @@
+//! Applying a set of property values as one preset
+//!
+//! [`CameraDevice::apply_preset`](crate::blocking::CameraDevice::apply_preset)
+//! writes a whole look at once. Properties whose writability depends on
+//! another one (shutter speed on the exposure program, colour temperature on
+//! the white balance mode) go out in a later stage, after the camera has
+//! confirmed the change they depend on.
+//!
+//! Within a stage every value is checked against one batched read, then the
+//! writes are sent back to back with no read in between. Completion comes
+//! from the camera's `PropertyChanged` callbacks, which the event sender
+//! records in [`PropertySignals`], so nothing is polled. One batched read at
+//! the end reports which values stuck.
+
+use crate::blocking::check_writable_value;
+use crate::error::{Error, Result};
+use crate::property::{DeviceProperty, PropertyCodeSet};
+use crsdk_sys::DevicePropertyCode;
+use std::collections::HashMap;
+use std::sync::{Arc, Condvar, Mutex};
+use std::time::{Duration, Instant};
+
+/// How long `apply_preset` waits for the camera to confirm a stage
+pub const DEFAULT_PRESET_TIMEOUT: Duration = Duration::from_secs(2);
+
+/// Properties whose writability or allowed values depend on another one
+///
+/// `(prerequisite, dependents)`: when a preset holds both, the prerequisite
+/// is written first and the dependents once the camera has confirmed it.
+const DEPENDENCIES: &[(DevicePropertyCode, &[DevicePropertyCode])] = &[
+    (
+        DevicePropertyCode::ExposureProgramMode,
+        &[
+            DevicePropertyCode::ShutterSpeed,
+            DevicePropertyCode::ShutterAngle,
+            DevicePropertyCode::FNumber,
+            DevicePropertyCode::IsoSensitivity,
+            DevicePropertyCode::ExposureBiasCompensation,
+        ],
+    ),
+    (
+        DevicePropertyCode::IrisModeSetting,
+        &[DevicePropertyCode::FNumber],
+    ),
+    (
+        DevicePropertyCode::WhiteBalance,
+        &[DevicePropertyCode::Colortemp],
+    ),
+    (
+        DevicePropertyCode::FocusMode,
+        &[
+            DevicePropertyCode::FocusArea,
+            DevicePropertyCode::AFTransitionSpeed,
+        ],
+    ),
+    (
+        DevicePropertyCode::FlashMode,
+        &[DevicePropertyCode::RedEyeReduction],
+    ),
+    (
+        DevicePropertyCode::FileType,
+        &[DevicePropertyCode::StillImageQuality],
+    ),
+    (
+        DevicePropertyCode::MovieFileFormat,
+        &[DevicePropertyCode::MovieRecordingSetting],
+    ),
+];
+
+/// What happened to one value of a preset
+#[derive(Debug)]
+pub enum PresetOutcome {
+    /// Written, and the camera now holds the requested value
+    Applied,
+    /// The camera already held the requested value, so it wasn't written
+    Unchanged,
+    /// Written, but the camera holds a different value
+    Overridden {
+        /// Value the camera reports instead
+        actual: u64,
+    },
+    /// The camera doesn't expose this property
+    Unsupported,
+    /// The value was refused before or while writing it
+    Failed(Error),
+}
+
+/// One value of a preset and what became of it
+#[derive(Debug)]
+pub struct PresetEntry {
+    /// Property code
+    pub code: DevicePropertyCode,
+    /// Value the preset asked for
+    pub requested: u64,
+    /// Whether it stuck
+    pub outcome: PresetOutcome,
+    /// Whether the camera reported the change before the stage timed out
+    pub confirmed: bool,
+}
+
+/// Result of [`apply_preset`](crate::blocking::CameraDevice::apply_preset)
+#[derive(Debug)]
+pub struct PresetReport {
+    /// Every value of the preset, in the order they were written
+    pub entries: Vec<PresetEntry>,
+}
+
+impl PresetReport {
+    /// Check whether the camera now holds every requested value
+    pub fn is_complete(&self) -> bool {
+        self.entries.iter().all(|entry| {
+            matches!(
+                entry.outcome,
+                PresetOutcome::Applied | PresetOutcome::Unchanged
+            )
+        })
+    }
+
+    /// The entry for `code`, if the preset had one
+    pub fn get(&self, code: DevicePropertyCode) -> Option<&PresetEntry> {
+        self.entries.iter().find(|entry| entry.code == code)
+    }
+
+    /// Entries whose value didn't stick
+    pub fn failures(&self) -> impl Iterator<Item = &PresetEntry> {
+        self.entries.iter().filter(|entry| {
+            !matches!(
+                entry.outcome,
+                PresetOutcome::Applied | PresetOutcome::Unchanged
+            )
+        })
+    }
+}
+
+#[derive(Debug, Default)]
+struct ChangeState {
+    generation: u64,
+    /// Generation of the last reported change, per code
+    changed_at: HashMap<DevicePropertyCode, u64>,
+}
+
+/// Property changes reported by the camera, for waiting on specific codes
+///
+/// Cloning yields a handle to the same state, shared between a device and
+/// its event sender.
+#[derive(Debug, Clone, Default)]
+pub(crate) struct PropertySignals {
+    inner: Arc<(Mutex<ChangeState>, Condvar)>,
+}
+
+impl PropertySignals {
+    /// Record a `PropertyChanged` report
+    pub(crate) fn changed(&self, codes: PropertyCodeSet) {
+        if codes.is_empty() {
+            return;
+        }
+        let (state, changed) = &*self.inner;
+        let mut state = state.lock().unwrap();
+        state.generation += 1;
+        let generation = state.generation;
+        for code in codes {
+            state.changed_at.insert(code, generation);
+        }
+        changed.notify_all();
+    }
+
+    /// Current position, to wait for changes reported after it
+    pub(crate) fn mark(&self) -> u64 {
+        self.inner.0.lock().unwrap().generation
+    }
+
+    /// Wait until every code in `codes` is reported changed after `mark`
+    ///
+    /// Returns the codes that were, which is all of them unless `timeout`
+    /// ran out first.
+    pub(crate) fn wait_all(
+        &self,
+        mark: u64,
+        codes: PropertyCodeSet,
+        timeout: Duration,
+    ) -> PropertyCodeSet {
+        let deadline = Instant::now() + timeout;
+        let (state, changed) = &*self.inner;
+        let mut state = state.lock().unwrap();
+        loop {
+            let confirmed: PropertyCodeSet = codes
+                .iter()
+                .filter(|code| state.changed_at.get(code).is_some_and(|&g| g > mark))
+                .collect();
+            let now = Instant::now();
+            if confirmed == codes || now >= deadline {
+                return confirmed;
+            }
+            state = changed.wait_timeout(state, deadline - now).unwrap().0;
+        }
+    }
+}
+
+/// Device side of applying a preset
+pub(crate) trait PresetTarget {
+    /// Property changes reported by the camera
+    fn property_signals(&self) -> &PropertySignals;
+
+    /// Read properties to check writes against (cached snapshots allowed)
+    fn read_for_write(&self, codes: &[DevicePropertyCode]) -> Result<Vec<DeviceProperty>>;
+
+    /// Read properties from the camera
+    fn read_back(&self, codes: &[DevicePropertyCode]) -> Result<Vec<DeviceProperty>>;
+
+    /// Write a value without reading the property first
+    fn write(&self, code: DevicePropertyCode, value: u64) -> Result<()>;
+}
+
+/// Stage a code is written in: one after the latest of its prerequisites
+/// that is also part of the preset
+fn stage_of(code: DevicePropertyCode, preset: &PropertyCodeSet) -> usize {
+    DEPENDENCIES
+        .iter()
+        .filter(|(prerequisite, dependents)| {
+            preset.contains(*prerequisite) && dependents.contains(&code)
+        })
+        .map(|&(prerequisite, _)| stage_of(prerequisite, preset) + 1)
+        .max()
+        .unwrap_or(0)
+}
+
+/// Group `preset` into write stages, later duplicates of a code winning
+fn stages(preset: &[(DevicePropertyCode, u64)]) -> Vec<Vec<(DevicePropertyCode, u64)>> {
+    let mut values: Vec<(DevicePropertyCode, u64)> = Vec::with_capacity(preset.len());
+    for &(code, value) in preset {
+        match values.iter_mut().find(|(c, _)| *c == code) {
+            Some(entry) => entry.1 = value,
+            None => values.push((code, value)),
+        }
+    }
+
+    let codes: PropertyCodeSet = values.iter().map(|&(code, _)| code).collect();
+    let mut stages: Vec<Vec<_>> = Vec::new();
+    for (code, value) in values {
+        let stage = stage_of(code, &codes);
+        if stages.len() <= stage {
+            stages.resize_with(stage + 1, Vec::new);
+        }
+        stages[stage].push((code, value));
+    }
+    stages
+}
+
+/// Apply `preset` to `target`, waiting up to `timeout` for each stage
+pub(crate) fn apply<T: PresetTarget + ?Sized>(
+    target: &T,
+    preset: &[(DevicePropertyCode, u64)],
+    timeout: Duration,
+) -> Result<PresetReport> {
+    let signals = target.property_signals();
+    let mut entries = Vec::with_capacity(preset.len());
+    let mut written = Vec::new();
+
+    for (index, stage) in stages(preset).into_iter().enumerate() {
+        let codes: Vec<_> = stage.iter().map(|&(code, _)| code).collect();
+        // A prerequisite change can make dependents writable or change their
+        // allowed values, so later stages always read the camera
+        let properties = if index == 0 {
+            target.read_for_write(&codes)?
+        } else {
+            target.read_back(&codes)?
+        };
+
+        let mark = signals.mark();
+        let mut pending = PropertyCodeSet::new();
+        for (code, requested) in stage {
+            let outcome = match properties.iter().find(|p| p.code == code.as_raw()) {
+                None => PresetOutcome::Unsupported,
+                Some(prop) if prop.current_value == requested => PresetOutcome::Unchanged,
+                Some(prop) => match check_writable_value(prop, requested)
+                    .and_then(|()| target.write(code, requested))
+                {
+                    Ok(()) => {
+                        pending.insert(code);
+                        written.push(code);
+                        PresetOutcome::Applied
+                    }
+                    Err(error) => PresetOutcome::Failed(error),
+                },
+            };
+            entries.push(PresetEntry {
+                code,
+                requested,
+                outcome,
+                confirmed: false,
+            });
+        }
+
+        if !pending.is_empty() {
+            let confirmed = signals.wait_all(mark, pending, timeout);
+            for entry in &mut entries {
+                entry.confirmed |= confirmed.contains(entry.code);
+            }
+        }
+    }
+
+    if !written.is_empty() {
+        let properties = target.read_back(&written)?;
+        for entry in entries.iter_mut().filter(|e| written.contains(&e.code)) {
+            entry.outcome = match properties.iter().find(|p| p.code == entry.code.as_raw()) {
+                Some(prop) if prop.current_value == entry.requested => PresetOutcome::Applied,
+                Some(prop) => PresetOutcome::Overridden {
+                    actual: prop.current_value,
+                },
+                None => PresetOutcome::Unsupported,
+            };
+        }
+    }
+
+    Ok(PresetReport { entries })
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::property::{DataType, EnableFlag, ValueConstraint};
+
+    const MANUAL: u64 = 1;
+    const APERTURE_PRIORITY: u64 = 3;
+
+    /// Camera where shutter speed is only writable in manual exposure
+    #[derive(Default)]
+    struct FakeCamera {
+        signals: PropertySignals,
+        values: Mutex<HashMap<DevicePropertyCode, u64>>,
+        writes: Mutex<Vec<DevicePropertyCode>>,
+        /// Codes the camera accepts but then overrides with this value
+        clamp: Option<(DevicePropertyCode, u64)>,
+        /// Don't report changes back
+        silent: bool,
+    }
+
+    impl FakeCamera {
+        fn new(values: &[(DevicePropertyCode, u64)]) -> Self {
+            Self {
+                values: Mutex::new(values.iter().copied().collect()),
+                ..Default::default()
+            }
+        }
+
+        fn read(&self, codes: &[DevicePropertyCode]) -> Vec<DeviceProperty> {
+            let values = self.values.lock().unwrap();
+            let manual = values.get(&DevicePropertyCode::ExposureProgramMode) == Some(&MANUAL);
+            codes
+                .iter()
+                .filter_map(|code| {
+                    let writable = *code != DevicePropertyCode::ShutterSpeed || manual;
+                    Some(DeviceProperty {
+                        code: code.as_raw(),
+                        data_type: DataType::UInt32,
+                        enable_flag: if writable {
+                            EnableFlag::ReadWrite
+                        } else {
+                            EnableFlag::ReadOnly
+                        },
+                        current_value: *values.get(code)?,
+                        current_string: None,
+                        constraint: ValueConstraint::None,
+                    })
+                })
+                .collect()
+        }
+    }
+
+    impl PresetTarget for FakeCamera {
+        fn property_signals(&self) -> &PropertySignals {
+            &self.signals
+        }
+
+        fn read_for_write(&self, codes: &[DevicePropertyCode]) -> Result<Vec<DeviceProperty>> {
+            Ok(self.read(codes))
+        }
+
+        fn read_back(&self, codes: &[DevicePropertyCode]) -> Result<Vec<DeviceProperty>> {
+            Ok(self.read(codes))
+        }
+
+        fn write(&self, code: DevicePropertyCode, value: u64) -> Result<()> {
+            let value = match self.clamp {
+                Some((clamped, actual)) if clamped == code => actual,
+                _ => value,
+            };
+            self.values.lock().unwrap().insert(code, value);
+            self.writes.lock().unwrap().push(code);
+            if !self.silent {
+                self.signals.changed([code].into_iter().collect());
+            }
+            Ok(())
+        }
+    }
+
+    #[test]
+    fn test_stages_follow_dependencies() {
+        let staged = stages(&[
+            (DevicePropertyCode::ShutterSpeed, 10),
+            (DevicePropertyCode::IsoSensitivity, 400),
+            (DevicePropertyCode::ExposureProgramMode, MANUAL),
+            (DevicePropertyCode::IsoSensitivity, 800),
+        ]);
+        assert_eq!(
+            staged,
+            vec![
+                vec![(DevicePropertyCode::ExposureProgramMode, MANUAL)],
+                vec![
+                    (DevicePropertyCode::ShutterSpeed, 10),
+                    (DevicePropertyCode::IsoSensitivity, 800),
+                ],
+            ]
+        );
+
+        // Without its prerequisite in the preset, a dependent goes first
+        assert_eq!(stages(&[(DevicePropertyCode::ShutterSpeed, 10)]).len(), 1);
+    }
+
+    #[test]
+    fn test_dependent_written_after_prerequisite() {
+        let camera = FakeCamera::new(&[
+            (DevicePropertyCode::ExposureProgramMode, APERTURE_PRIORITY),
+            (DevicePropertyCode::ShutterSpeed, 20),
+            (DevicePropertyCode::IsoSensitivity, 400),
+        ]);
+
+        let report = apply(
+            &camera,
+            &[
+                (DevicePropertyCode::ShutterSpeed, 10),
+                (DevicePropertyCode::IsoSensitivity, 400),
+                (DevicePropertyCode::ExposureProgramMode, MANUAL),
+            ],
+            Duration::from_secs(1),
+        )
+        .unwrap();
+
+        assert!(report.is_complete());
+        assert_eq!(
+            *camera.writes.lock().unwrap(),
+            vec![
+                DevicePropertyCode::ExposureProgramMode,
+                DevicePropertyCode::ShutterSpeed
+            ]
+        );
+        let iso = report.get(DevicePropertyCode::IsoSensitivity).unwrap();
+        assert!(matches!(iso.outcome, PresetOutcome::Unchanged));
+        assert!(
+            report
+                .get(DevicePropertyCode::ShutterSpeed)
+                .unwrap()
+                .confirmed
+        );
+    }
+
+    #[test]
+    fn test_report_shows_what_did_not_stick() {
+        let camera = FakeCamera {
+            clamp: Some((DevicePropertyCode::IsoSensitivity, 3200)),
+            silent: true,
+            ..FakeCamera::new(&[
+                (DevicePropertyCode::ExposureProgramMode, APERTURE_PRIORITY),
+                (DevicePropertyCode::ShutterSpeed, 20),
+                (DevicePropertyCode::IsoSensitivity, 400),
+            ])
+        };
+
+        let report = apply(
+            &camera,
+            &[
+                (DevicePropertyCode::ShutterSpeed, 10),
+                (DevicePropertyCode::IsoSensitivity, 6400),
+                (DevicePropertyCode::FNumber, 280),
+            ],
+            Duration::from_millis(10),
+        )
+        .unwrap();
+
+        assert!(!report.is_complete());
+        assert_eq!(report.failures().count(), 3);
+        let outcome = |code| &report.get(code).unwrap().outcome;
+        assert!(matches!(
+            outcome(DevicePropertyCode::ShutterSpeed),
+            PresetOutcome::Failed(Error::PropertyNotWritable)
+        ));
+        assert!(matches!(
+            outcome(DevicePropertyCode::IsoSensitivity),
+            PresetOutcome::Overridden { actual: 3200 }
+        ));
+        assert!(matches!(
+            outcome(DevicePropertyCode::FNumber),
+            PresetOutcome::Unsupported
+        ));
+        assert!(
+            !report
+                .get(DevicePropertyCode::IsoSensitivity)
+                .unwrap()
+                .confirmed
+        );
+    }
+
+    #[test]
+    fn test_wait_all_ignores_changes_before_mark() {
+        let signals = PropertySignals::default();
+        let iso = DevicePropertyCode::IsoSensitivity;
+        let fnum = DevicePropertyCode::FNumber;
+        signals.changed([iso].into_iter().collect());
+
+        let mark = signals.mark();
+        let both: PropertyCodeSet = [iso, fnum].into_iter().collect();
+        signals.changed([fnum].into_iter().collect());
+        let confirmed = signals.wait_all(mark, both, Duration::ZERO);
+        assert!(confirmed.contains(fnum) && !confirmed.contains(iso));
+
+        signals.changed([iso].into_iter().collect());
+        assert_eq!(signals.wait_all(mark, both, Duration::ZERO), both);
+    }
+}
@@ -0,0 +1,513 @@
+//! Saved per-camera connection profiles
+//!
+//! Connecting from scratch means enumerating, fetching the SSH fingerprint and
+//! waiting for a full property read. A [`ConnectionProfile`] keeps what a
+//! previous session already learned (address, model, the fingerprint the user
+//! verified, the last property snapshot), so a reconnect can go straight to
+//! `Connect` and show the last known settings while the live refresh runs.
+//!
+//! Profiles are stored as small line-based text files, one per camera, in a
+//! [`ProfileStore`] directory. The SSH password is never written.
+
+use crate::error::{Error, Result};
+use crate::property::{DataType, DeviceProperty, EnableFlag, ValueConstraint};
+use crate::types::{CameraModel, MacAddr};
+use std::fmt::Write as _;
+use std::net::Ipv4Addr;
+use std::path::{Path, PathBuf};
+use std::time::Duration;
+
+/// First line of every profile file
+const PROFILE_HEADER: &str = "crsdk-profile 1";
+
+/// File extension of profiles in a [`ProfileStore`]
+const PROFILE_EXTENSION: &str = "profile";
+
+/// Default delay before the first reconnect attempt
+pub const DEFAULT_RECONNECT_INITIAL: Duration = Duration::from_millis(250);
+
+/// Default upper bound on the delay between reconnect attempts
+pub const DEFAULT_RECONNECT_MAX: Duration = Duration::from_secs(8);
+
+/// What a previous session learned about one camera
+#[derive(Debug, Clone, PartialEq)]
+pub struct ConnectionProfile {
+    /// IP address
+    pub ip_address: Ipv4Addr,
+    /// MAC address (identifies the camera in a [`ProfileStore`])
+    pub mac_address: MacAddr,
+    /// Camera model (`None` until the camera has reported it)
+    pub model: Option<CameraModel>,
+    /// SSH user, if the camera was reached over SSH
+    pub ssh_user: Option<String>,
+    /// SSH fingerprint the user verified
+    pub ssh_fingerprint: Option<String>,
+    /// Last property snapshot
+    pub properties: Vec<DeviceProperty>,
+}
+
+impl ConnectionProfile {
+    /// Create a profile without SSH details or a property snapshot
+    pub fn new(ip_address: Ipv4Addr, mac_address: MacAddr, model: Option<CameraModel>) -> Self {
+        Self {
+            ip_address,
+            mac_address,
+            model,
+            ssh_user: None,
+            ssh_fingerprint: None,
+            properties: Vec::new(),
+        }
+    }
+
+    /// Record the SSH user and the fingerprint the user verified
+    pub fn with_ssh(mut self, user: impl Into<String>, fingerprint: impl Into<String>) -> Self {
+        self.ssh_user = Some(user.into());
+        self.ssh_fingerprint = Some(fingerprint.into());
+        self
+    }
+
+    /// Replace the property snapshot
+    pub fn with_properties(mut self, properties: Vec<DeviceProperty>) -> Self {
+        self.properties = properties;
+        self
+    }
+
+    /// Check whether the camera is reached over SSH
+    pub fn uses_ssh(&self) -> bool {
+        self.ssh_fingerprint.is_some()
+    }
+
+    /// Serialize to the profile file format
+    pub fn to_text(&self) -> String {
+        let mut out = String::new();
+        let _ = writeln!(out, "{}", PROFILE_HEADER);
+        let _ = writeln!(out, "ip {}", self.ip_address);
+        let _ = writeln!(out, "mac {}", self.mac_address);
+        if let Some(model) = self.model {
+            let _ = writeln!(out, "model {:?}", model);
+        }
+        if let Some(user) = &self.ssh_user {
+            let _ = writeln!(out, "ssh-user {}", hex_encode(user.as_bytes()));
+        }
+        if let Some(fingerprint) = &self.ssh_fingerprint {
+            let _ = writeln!(
+                out,
+                "ssh-fingerprint {}",
+                hex_encode(fingerprint.as_bytes())
+            );
+        }
+        for prop in &self.properties {
+            let _ = writeln!(out, "prop {}", encode_property(prop));
+        }
+        out
+    }
+
+    /// Parse the profile file format
+    pub fn parse(text: &str) -> Result<Self> {
+        let mut lines = text.lines();
+        if lines.next().map(str::trim) != Some(PROFILE_HEADER) {
+            return Err(invalid("missing header"));
+        }
+
+        let mut ip_address = None;
+        let mut mac_address = None;
+        let mut model = None;
+        let mut ssh_user = None;
+        let mut ssh_fingerprint = None;
+        let mut properties = Vec::new();
+
+        for line in lines {
+            let line = line.trim();
+            if line.is_empty() {
+                continue;
+            }
+            let (key, value) = line.split_once(' ').unwrap_or((line, ""));
+            match key {
+                "ip" => {
+                    ip_address = Some(
+                        value
+                            .parse::<Ipv4Addr>()
+                            .map_err(|e| Error::AddrParse(e.to_string()))?,
+                    )
+                }
+                "mac" => mac_address = Some(value.parse::<MacAddr>()?),
+                "model" => model = Some(decode_model(value)?),
+                "ssh-user" => ssh_user = Some(hex_decode_string(value)?),
+                "ssh-fingerprint" => ssh_fingerprint = Some(hex_decode_string(value)?),
+                "prop" => properties.push(decode_property(value)?),
+                // Keys from newer versions are skipped rather than rejected
+                _ => {}
+            }
+        }
+
+        Ok(Self {
+            ip_address: ip_address.ok_or_else(|| invalid("missing ip"))?,
+            mac_address: mac_address.ok_or_else(|| invalid("missing mac"))?,
+            model,
+            ssh_user,
+            ssh_fingerprint,
+            properties,
+        })
+    }
+}
+
+/// Directory of connection profiles, one file per camera MAC address
+#[derive(Debug, Clone)]
+pub struct ProfileStore {
+    dir: PathBuf,
+}
+
+impl ProfileStore {
+    /// Use `dir` for profiles (created on first save)
+    pub fn new(dir: impl Into<PathBuf>) -> Self {
+        Self { dir: dir.into() }
+    }
+
+    /// Directory the profiles live in
+    pub fn dir(&self) -> &Path {
+        &self.dir
+    }
+
+    /// File a camera's profile is stored in
+    pub fn path(&self, mac: MacAddr) -> PathBuf {
+        let name: String = mac.to_string().chars().filter(|c| *c != ':').collect();
+        self.dir.join(format!("{}.{}", name, PROFILE_EXTENSION))
+    }
+
+    /// Load the profile saved for `mac`, if any
+    pub fn load(&self, mac: MacAddr) -> Result<Option<ConnectionProfile>> {
+        match std::fs::read_to_string(self.path(mac)) {
+            Ok(text) => ConnectionProfile::parse(&text).map(Some),
+            Err(e) if e.kind() == std::io::ErrorKind::NotFound => Ok(None),
+            Err(e) => Err(e.into()),
+        }
+    }
+
+    /// Save `profile`, replacing any previous one for the same camera
+    ///
+    /// Writes to a temporary file first so a crash never leaves a truncated
+    /// profile behind.
+    pub fn save(&self, profile: &ConnectionProfile) -> Result<()> {
+        std::fs::create_dir_all(&self.dir)?;
+        let path = self.path(profile.mac_address);
+        let tmp = path.with_extension("tmp");
+        std::fs::write(&tmp, profile.to_text())?;
+        std::fs::rename(&tmp, &path)?;
+        Ok(())
+    }
+
+    /// Forget the profile saved for `mac`
+    pub fn remove(&self, mac: MacAddr) -> Result<()> {
+        match std::fs::remove_file(self.path(mac)) {
+            Err(e) if e.kind() != std::io::ErrorKind::NotFound => Err(e.into()),
+            _ => Ok(()),
+        }
+    }
+}
+
+/// Exponential backoff between reconnect attempts
+///
+/// Each [`next_delay`](Self::next_delay) doubles the previous one up to the
+/// maximum; [`reset`](Self::reset) once the camera reports `Connected` again.
+#[derive(Debug, Clone)]
+pub struct ReconnectBackoff {
+    initial: Duration,
+    max: Duration,
+    attempt: u32,
+}
+
+impl ReconnectBackoff {
+    /// Start at `initial` and never wait longer than `max`
+    pub fn new(initial: Duration, max: Duration) -> Self {
+        Self {
+            initial,
+            max: max.max(initial),
+            attempt: 0,
+        }
+    }
+
+    /// Delay before the next attempt, advancing the attempt counter
+    pub fn next_delay(&mut self) -> Duration {
+        let factor = 1u32.checked_shl(self.attempt).unwrap_or(u32::MAX);
+        self.attempt = self.attempt.saturating_add(1);
+        self.initial.saturating_mul(factor).min(self.max)
+    }
+
+    /// Number of attempts handed out since the last reset
+    pub fn attempt(&self) -> u32 {
+        self.attempt
+    }
+
+    /// Start over from the initial delay
+    pub fn reset(&mut self) {
+        self.attempt = 0;
+    }
+}
+
+impl Default for ReconnectBackoff {
+    fn default() -> Self {
+        Self::new(DEFAULT_RECONNECT_INITIAL, DEFAULT_RECONNECT_MAX)
+    }
+}
+
+fn invalid(reason: &str) -> Error {
+    Error::Other(format!("Invalid connection profile: {}", reason))
+}
+
+fn decode_model(value: &str) -> Result<CameraModel> {
+    CameraModel::ALL
+        .iter()
+        .copied()
+        .find(|model| format!("{:?}", model) == value)
+        .ok_or_else(|| invalid("unknown model"))
+}
+
+/// `<code> <type> <flag> <current> <constraint> <string>`, with hex for
+/// numbers and strings and `-` for empty fields
+fn encode_property(prop: &DeviceProperty) -> String {
+    let constraint = match &prop.constraint {
+        ValueConstraint::None => "-".to_string(),
+        ValueConstraint::Discrete(values) => {
+            let mut out = String::from("d");
+            for (i, value) in values.iter().enumerate() {
+                out.push(if i == 0 { ':' } else { ',' });
+                let _ = write!(out, "{:x}", value);
+            }
+            out
+        }
+        ValueConstraint::Range { min, max, step } => format!("r:{}:{}:{}", min, max, step),
+    };
+    let string = prop
+        .current_string
+        .as_deref()
+        .map_or_else(|| "-".to_string(), |s| hex_encode(s.as_bytes()));
+
+    format!(
+        "{:x} {} {} {:x} {} {}",
+        prop.code,
+        encode_data_type(prop.data_type),
+        encode_enable_flag(prop.enable_flag),
+        prop.current_value,
+        constraint,
+        string
+    )
+}
+
+fn decode_property(value: &str) -> Result<DeviceProperty> {
+    let fields: Vec<&str> = value.split(' ').collect();
+    let [code, data_type, flag, current, constraint, string] = fields[..] else {
+        return Err(invalid("malformed property"));
+    };
+
+    let constraint = match constraint {
+        "-" => ValueConstraint::None,
+        "d" => ValueConstraint::Discrete(Default::default()),
+        _ if constraint.starts_with("d:") => ValueConstraint::Discrete(
+            constraint[2..]
+                .split(',')
+                .map(parse_hex)
+                .collect::<Result<Vec<_>>>()?
+                .into(),
+        ),
+        _ if constraint.starts_with("r:") => {
+            let parts: Vec<i64> = constraint[2..]
+                .split(':')
+                .map(|p| p.parse().map_err(|_| invalid("malformed range")))
+                .collect::<Result<_>>()?;
+            let [min, max, step] = parts[..] else {
+                return Err(invalid("malformed range"));
+            };
+            ValueConstraint::Range { min, max, step }
+        }
+        _ => return Err(invalid("malformed constraint")),
+    };
+
+    Ok(DeviceProperty {
+        code: parse_hex(code)? as u32,
+        data_type: decode_data_type(data_type)?,
+        enable_flag: decode_enable_flag(flag)?,
+        current_value: parse_hex(current)?,
+        current_string: match string {
+            "-" => None,
+            _ => Some(hex_decode_string(string)?),
+        },
+        constraint,
+    })
+}
+
+fn encode_data_type(data_type: DataType) -> String {
+    match data_type {
+        DataType::UInt8 => "u8".to_string(),
+        DataType::UInt16 => "u16".to_string(),
+        DataType::UInt32 => "u32".to_string(),
+        DataType::UInt64 => "u64".to_string(),
+        DataType::Int8 => "i8".to_string(),
+        DataType::Int16 => "i16".to_string(),
+        DataType::Int32 => "i32".to_string(),
+        DataType::Int64 => "i64".to_string(),
+        DataType::String => "str".to_string(),
+        DataType::Unknown(raw) => format!("?{:x}", raw),
+    }
+}
+
+fn decode_data_type(value: &str) -> Result<DataType> {
+    Ok(match value {
+        "u8" => DataType::UInt8,
+        "u16" => DataType::UInt16,
+        "u32" => DataType::UInt32,
+        "u64" => DataType::UInt64,
+        "i8" => DataType::Int8,
+        "i16" => DataType::Int16,
+        "i32" => DataType::Int32,
+        "i64" => DataType::Int64,
+        "str" => DataType::String,
+        _ => match value.strip_prefix('?') {
+            Some(raw) => DataType::Unknown(parse_hex(raw)? as u32),
+            None => return Err(invalid("unknown data type")),
+        },
+    })
+}
+
+fn encode_enable_flag(flag: EnableFlag) -> &'static str {
+    match flag {
+        EnableFlag::NotSupported => "na",
+        EnableFlag::Disabled => "off",
+        EnableFlag::ReadWrite => "rw",
+        EnableFlag::ReadOnly => "ro",
+        EnableFlag::WriteOnly => "wo",
+    }
+}
+
+fn decode_enable_flag(value: &str) -> Result<EnableFlag> {
+    Ok(match value {
+        "na" => EnableFlag::NotSupported,
+        "off" => EnableFlag::Disabled,
+        "rw" => EnableFlag::ReadWrite,
+        "ro" => EnableFlag::ReadOnly,
+        "wo" => EnableFlag::WriteOnly,
+        _ => return Err(invalid("unknown enable flag")),
+    })
+}
+
+fn parse_hex(value: &str) -> Result<u64> {
+    u64::from_str_radix(value, 16).map_err(|_| invalid("malformed number"))
+}
+
+fn hex_encode(bytes: &[u8]) -> String {
+    let mut out = String::with_capacity(bytes.len() * 2);
+    for byte in bytes {
+        let _ = write!(out, "{:02x}", byte);
+    }
+    out
+}
+
+fn hex_decode_string(value: &str) -> Result<String> {
+    if value.len() % 2 != 0 {
+        return Err(invalid("malformed string"));
+    }
+    let bytes = (0..value.len())
+        .step_by(2)
+        .map(|i| u8::from_str_radix(&value[i..i + 2], 16).map_err(|_| invalid("malformed string")))
+        .collect::<Result<Vec<u8>>>()?;
+    String::from_utf8(bytes).map_err(|_| invalid("malformed string"))
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crsdk_sys::DevicePropertyCode;
+
+    fn sample() -> ConnectionProfile {
+        ConnectionProfile::new(
+            "192.168.1.100".parse().unwrap(),
+            "aa:bb:cc:dd:ee:ff".parse().unwrap(),
+            Some(CameraModel::Alpha7Iv),
+        )
+        .with_ssh("admin", "SHA256:ab cd/ef")
+        .with_properties(vec![
+            DeviceProperty {
+                code: DevicePropertyCode::IsoSensitivity.as_raw(),
+                data_type: DataType::UInt32,
+                enable_flag: EnableFlag::ReadWrite,
+                current_value: 800,
+                current_string: None,
+                constraint: ValueConstraint::Discrete(vec![100, 200, 400, 800, 1600, 3200].into()),
+            },
+            DeviceProperty {
+                code: DevicePropertyCode::ExposureBiasCompensation.as_raw(),
+                data_type: DataType::Int16,
+                enable_flag: EnableFlag::ReadOnly,
+                current_value: (-300i16) as u16 as u64,
+                current_string: Some("−0.3 EV".to_string()),
+                constraint: ValueConstraint::Range {
+                    min: -3000,
+                    max: 3000,
+                    step: 300,
+                },
+            },
+        ])
+    }
+
+    #[test]
+    fn test_profile_text_round_trip() {
+        let profile = sample();
+        assert_eq!(
+            ConnectionProfile::parse(&profile.to_text()).unwrap(),
+            profile
+        );
+        assert!(profile.uses_ssh());
+
+        let unknown = ConnectionProfile {
+            model: None,
+            ..profile
+        };
+        assert_eq!(
+            ConnectionProfile::parse(&unknown.to_text()).unwrap(),
+            unknown
+        );
+    }
+
+    #[test]
+    fn test_profile_rejects_garbage() {
+        assert!(ConnectionProfile::parse("").is_err());
+        assert!(ConnectionProfile::parse("crsdk-profile 1\nip 10.0.0.1\n").is_err());
+        let broken = format!("{}prop 1 u8\n", sample().to_text());
+        assert!(ConnectionProfile::parse(&broken).is_err());
+    }
+
+    #[test]
+    fn test_profile_store_save_load_remove() {
+        let dir = std::env::temp_dir().join(format!("crsdk-profiles-{}", std::process::id()));
+        let store = ProfileStore::new(&dir);
+        let profile = sample();
+
+        assert_eq!(store.load(profile.mac_address).unwrap(), None);
+        store.save(&profile).unwrap();
+        assert_eq!(
+            store.load(profile.mac_address).unwrap(),
+            Some(profile.clone())
+        );
+        assert!(store
+            .path(profile.mac_address)
+            .ends_with("AABBCCDDEEFF.profile"));
+
+        store.remove(profile.mac_address).unwrap();
+        assert_eq!(store.load(profile.mac_address).unwrap(), None);
+        let _ = std::fs::remove_dir_all(dir);
+    }
+
+    #[test]
+    fn test_backoff_doubles_up_to_max() {
+        let mut backoff = ReconnectBackoff::new(Duration::from_millis(100), Duration::from_secs(1));
+        let delays: Vec<_> = (0..6).map(|_| backoff.next_delay().as_millis()).collect();
+        assert_eq!(delays, [100, 200, 400, 800, 1000, 1000]);
+        assert_eq!(backoff.attempt(), 6);
+
+        backoff.reset();
+        assert_eq!(backoff.next_delay(), Duration::from_millis(100));
+        for _ in 0..100 {
+            backoff.next_delay();
+        }
+        assert_eq!(backoff.next_delay(), Duration::from_secs(1));
+    }
+}
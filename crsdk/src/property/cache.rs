@@ -0,0 +1,402 @@
+//! Opt-in property snapshot cache.
+//!
+//! [`PropertyCache`] keeps the last [`DeviceProperty`] read for each
+//! [`DevicePropertyCode`]. The SDK callback marks entries stale as soon as the
+//! camera reports a `PropertyChanged` for them, so a cached entry that isn't
+//! stale reflects the camera's current state without a round trip.
+//!
+//! Enable it with `CameraDeviceBuilder::property_cache(true)` and refresh it
+//! with `CameraDevice::refresh_properties()`, which re-reads only stale codes
+//! and returns what actually changed.
+
+use super::DeviceProperty;
+use crsdk_sys::DevicePropertyCode;
+use std::collections::{HashMap, HashSet};
+use std::sync::{Arc, Mutex};
+
+/// A property whose snapshot changed during a cache refresh
+#[derive(Debug, Clone)]
+pub struct PropertyDiff {
+    /// Property code
+    pub code: DevicePropertyCode,
+    /// Previous snapshot (`None` if the property wasn't cached yet)
+    pub old: Option<DeviceProperty>,
+    /// New snapshot (`None` if the camera no longer exposes the property)
+    pub new: Option<DeviceProperty>,
+}
+
+#[derive(Debug, Default)]
+struct CacheState {
+    entries: HashMap<DevicePropertyCode, DeviceProperty>,
+    /// Stale codes, tagged with the generation in which they were invalidated
+    stale: HashMap<DevicePropertyCode, u64>,
+    /// Bumped on every invalidation
+    generation: u64,
+    /// Whether `entries` covers every property the camera exposes
+    complete: bool,
+}
+
+/// Shared cache of the last property snapshot per code
+///
+/// Cloning is cheap and yields a handle to the same cache, which is how the
+/// SDK callback thread and the device share it.
+#[derive(Debug, Clone, Default)]
+pub struct PropertyCache {
+    state: Arc<Mutex<CacheState>>,
+}
+
+impl PropertyCache {
+    /// Create an empty cache
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    /// Get the cached snapshot for a property, stale or not
+    pub fn get(&self, code: DevicePropertyCode) -> Option<DeviceProperty> {
+        self.state.lock().unwrap().entries.get(&code).cloned()
+    }
+
+    /// Get the cached snapshot only if the camera hasn't reported a change since
+    pub fn get_fresh(&self, code: DevicePropertyCode) -> Option<DeviceProperty> {
+        let state = self.state.lock().unwrap();
+        if state.stale.contains_key(&code) {
+            return None;
+        }
+        state.entries.get(&code).cloned()
+    }
+
+    /// Check whether a property has been reported as changed since it was cached
+    pub fn is_stale(&self, code: DevicePropertyCode) -> bool {
+        self.state.lock().unwrap().stale.contains_key(&code)
+    }
+
+    /// Check whether the cache holds no snapshots at all
+    pub fn is_empty(&self) -> bool {
+        self.state.lock().unwrap().entries.is_empty()
+    }
+
+    /// Number of cached snapshots
+    pub fn len(&self) -> usize {
+        self.state.lock().unwrap().entries.len()
+    }
+
+    /// Check whether the cache holds every property, not just some
+    ///
+    /// Set by [`apply_all`](Self::apply_all); a cache filled only by single
+    /// reads, a priority prefetch or a saved snapshot is partial.
+    pub fn is_complete(&self) -> bool {
+        self.state.lock().unwrap().complete
+    }
+
+    /// All codes that must be re-read to bring the cache up to date
+    pub fn stale_codes(&self) -> Vec<DevicePropertyCode> {
+        self.state.lock().unwrap().stale.keys().copied().collect()
+    }
+
+    /// Current invalidation generation
+    ///
+    /// Take this before reading properties from the camera and pass it to
+    /// [`apply`](Self::apply), so changes reported while the read was in
+    /// flight keep their entries stale.
+    pub fn generation(&self) -> u64 {
+        self.state.lock().unwrap().generation
+    }
+
+    /// Snapshot of every cached property
+    pub fn snapshot(&self) -> Vec<DeviceProperty> {
+        self.state
+            .lock()
+            .unwrap()
+            .entries
+            .values()
+            .cloned()
+            .collect()
+    }
+
+    /// Mark properties as stale
+    ///
+    /// Called from the SDK callback thread for every `PropertyChanged` event,
+    /// so this only touches the stale set.
+    pub fn invalidate(&self, codes: impl IntoIterator<Item = DevicePropertyCode>) {
+        let mut codes = codes.into_iter().peekable();
+        if codes.peek().is_none() {
+            return;
+        }
+        let mut state = self.state.lock().unwrap();
+        state.generation += 1;
+        let generation = state.generation;
+        for code in codes {
+            state.stale.insert(code, generation);
+        }
+    }
+
+    /// Record a value we just wrote to the camera
+    ///
+    /// `get()` serves the written value right away, but the entry stays stale
+    /// until a read confirms it: a camera that clamps or silently rejects the
+    /// write may never send a `PropertyChanged` for it.
+    pub fn write_through(&self, code: DevicePropertyCode, value: u64) {
+        let mut state = self.state.lock().unwrap();
+        let Some(prop) = state.entries.get_mut(&code) else {
+            return;
+        };
+        prop.current_value = value;
+        state.generation += 1;
+        let generation = state.generation;
+        state.stale.insert(code, generation);
+    }
+
+    /// Store freshly read properties and return the ones that differ
+    ///
+    /// `generation` is the value of [`generation`](Self::generation) taken
+    /// before the read started. Codes in `properties` become fresh unless they
+    /// were invalidated again after that point. Codes listed in `requested`
+    /// that the camera didn't return are dropped from the cache, since the
+    /// camera no longer exposes them, and reported with no new snapshot.
+    pub fn apply(
+        &self,
+        generation: u64,
+        requested: &[DevicePropertyCode],
+        properties: Vec<DeviceProperty>,
+    ) -> Vec<PropertyDiff> {
+        let mut state = self.state.lock().unwrap();
+        let mut diffs = Vec::new();
+        let mut returned = HashSet::with_capacity(properties.len());
+
+        for prop in properties {
+            let Some(code) = DevicePropertyCode::from_raw(prop.code) else {
+                continue;
+            };
+            returned.insert(code);
+            state.clear_stale(code, generation);
+
+            if state.entries.get(&code) == Some(&prop) {
+                continue;
+            }
+
+            let old = state.entries.insert(code, prop.clone());
+            diffs.push(PropertyDiff {
+                code,
+                old,
+                new: Some(prop),
+            });
+        }
+
+        for &code in requested {
+            if !returned.contains(&code) {
+                state.clear_stale(code, generation);
+                if let Some(old) = state.entries.remove(&code) {
+                    diffs.push(PropertyDiff {
+                        code,
+                        old: Some(old),
+                        new: None,
+                    });
+                }
+            }
+        }
+
+        diffs
+    }
+
+    /// Store a read of every property and mark the cache complete
+    ///
+    /// Same as [`apply`](Self::apply) with every cached code requested, so
+    /// snapshots of properties the camera no longer exposes are dropped and
+    /// reported.
+    pub fn apply_all(&self, generation: u64, properties: Vec<DeviceProperty>) -> Vec<PropertyDiff> {
+        let cached: Vec<_> = self.state.lock().unwrap().entries.keys().copied().collect();
+        let diffs = self.apply(generation, &cached, properties);
+        self.state.lock().unwrap().complete = true;
+        diffs
+    }
+
+    /// Fill the cache from a saved snapshot, with every entry stale
+    ///
+    /// `get()` serves the saved values right away while `get_fresh()` still
+    /// misses. The cache stays partial, since the camera may expose
+    /// properties the snapshot lacks, so the next `refresh_properties()` does
+    /// one full read and reports only what differs from the snapshot.
+    pub fn seed(&self, properties: Vec<DeviceProperty>) {
+        let mut state = self.state.lock().unwrap();
+        state.generation += 1;
+        let generation = state.generation;
+        for prop in properties {
+            let Some(code) = DevicePropertyCode::from_raw(prop.code) else {
+                continue;
+            };
+            state.stale.insert(code, generation);
+            state.entries.insert(code, prop);
+        }
+    }
+
+    /// Drop every snapshot (e.g. after a disconnect)
+    pub fn clear(&self) {
+        let mut state = self.state.lock().unwrap();
+        state.entries.clear();
+        state.stale.clear();
+        state.complete = false;
+    }
+}
+
+impl CacheState {
+    fn clear_stale(&mut self, code: DevicePropertyCode, generation: u64) {
+        if self.stale.get(&code).is_some_and(|&g| g <= generation) {
+            self.stale.remove(&code);
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::property::{DataType, EnableFlag, ValueConstraint};
+
+    fn prop(code: DevicePropertyCode, value: u64) -> DeviceProperty {
+        DeviceProperty {
+            code: code.as_raw(),
+            data_type: DataType::UInt32,
+            enable_flag: EnableFlag::ReadWrite,
+            current_value: value,
+            current_string: None,
+            constraint: ValueConstraint::Discrete(vec![100, 200, 400].into()),
+        }
+    }
+
+    #[test]
+    fn test_apply_returns_only_diffs() {
+        let cache = PropertyCache::new();
+        let iso = DevicePropertyCode::IsoSensitivity;
+        let fnum = DevicePropertyCode::FNumber;
+
+        let diffs = cache.apply(
+            cache.generation(),
+            &[],
+            vec![prop(iso, 100), prop(fnum, 280)],
+        );
+        assert_eq!(diffs.len(), 2);
+        assert!(diffs.iter().all(|d| d.old.is_none()));
+
+        let diffs = cache.apply(
+            cache.generation(),
+            &[iso, fnum],
+            vec![prop(iso, 200), prop(fnum, 280)],
+        );
+        assert_eq!(diffs.len(), 1);
+        assert_eq!(diffs[0].code, iso);
+        assert_eq!(diffs[0].old.as_ref().unwrap().current_value, 100);
+        assert_eq!(diffs[0].new.as_ref().unwrap().current_value, 200);
+    }
+
+    #[test]
+    fn test_invalidate_and_refresh() {
+        let cache = PropertyCache::new();
+        let iso = DevicePropertyCode::IsoSensitivity;
+
+        cache.apply(cache.generation(), &[], vec![prop(iso, 100)]);
+        assert!(cache.get_fresh(iso).is_some());
+
+        cache.invalidate([iso]);
+        assert!(cache.is_stale(iso));
+        assert!(cache.get_fresh(iso).is_none());
+        assert!(cache.get(iso).is_some());
+        assert_eq!(cache.stale_codes(), vec![iso]);
+
+        cache.apply(cache.generation(), &[iso], vec![prop(iso, 100)]);
+        assert!(!cache.is_stale(iso));
+        assert!(cache.stale_codes().is_empty());
+    }
+
+    #[test]
+    fn test_change_during_read_stays_stale() {
+        let cache = PropertyCache::new();
+        let iso = DevicePropertyCode::IsoSensitivity;
+
+        cache.apply(cache.generation(), &[], vec![prop(iso, 100)]);
+        cache.invalidate([iso]);
+
+        // Read starts, then the camera reports another change before it lands
+        let generation = cache.generation();
+        cache.invalidate([iso]);
+        cache.apply(generation, &[iso], vec![prop(iso, 200)]);
+
+        assert!(cache.is_stale(iso));
+        assert_eq!(cache.get(iso).unwrap().current_value, 200);
+    }
+
+    #[test]
+    fn test_apply_drops_missing_requested_codes() {
+        let cache = PropertyCache::new();
+        let iso = DevicePropertyCode::IsoSensitivity;
+
+        cache.apply(cache.generation(), &[], vec![prop(iso, 100)]);
+        cache.invalidate([iso]);
+        let diffs = cache.apply(cache.generation(), &[iso], vec![]);
+
+        assert_eq!(diffs.len(), 1);
+        assert_eq!(diffs[0].code, iso);
+        assert_eq!(diffs[0].old.as_ref().unwrap().current_value, 100);
+        assert!(diffs[0].new.is_none());
+        assert!(cache.get(iso).is_none());
+        assert!(!cache.is_stale(iso));
+    }
+
+    #[test]
+    fn test_partial_reads_leave_cache_incomplete() {
+        let cache = PropertyCache::new();
+        let iso = DevicePropertyCode::IsoSensitivity;
+        let fnum = DevicePropertyCode::FNumber;
+
+        cache.apply(cache.generation(), &[iso], vec![prop(iso, 100)]);
+        assert!(!cache.is_empty());
+        assert!(!cache.is_complete());
+
+        let diffs = cache.apply_all(cache.generation(), vec![prop(iso, 100), prop(fnum, 280)]);
+        assert_eq!(diffs.len(), 1);
+        assert_eq!(diffs[0].code, fnum);
+        assert!(cache.is_complete());
+
+        cache.clear();
+        assert!(!cache.is_complete());
+    }
+
+    #[test]
+    fn test_write_through_updates_value() {
+        let cache = PropertyCache::new();
+        let iso = DevicePropertyCode::IsoSensitivity;
+
+        cache.apply(cache.generation(), &[], vec![prop(iso, 100)]);
+        cache.write_through(iso, 400);
+        assert_eq!(cache.get(iso).unwrap().current_value, 400);
+        assert!(cache.get_fresh(iso).is_none());
+
+        // The camera clamped the write; the confirming read reports it
+        let diffs = cache.apply(cache.generation(), &[iso], vec![prop(iso, 200)]);
+        assert_eq!(diffs.len(), 1);
+        assert_eq!(cache.get_fresh(iso).unwrap().current_value, 200);
+    }
+
+    #[test]
+    fn test_seed_serves_stale_snapshot() {
+        let cache = PropertyCache::new();
+        let iso = DevicePropertyCode::IsoSensitivity;
+
+        let fnum = DevicePropertyCode::FNumber;
+        let shutter = DevicePropertyCode::ShutterSpeed;
+
+        cache.seed(vec![prop(iso, 800), prop(shutter, 100)]);
+        assert_eq!(cache.get(iso).unwrap().current_value, 800);
+        assert!(cache.get_fresh(iso).is_none());
+        assert!(!cache.is_complete());
+
+        // Only the live read's differences from the saved snapshot come
+        // back: a property the snapshot lacked and one the camera dropped
+        let diffs = cache.apply_all(cache.generation(), vec![prop(iso, 800), prop(fnum, 280)]);
+        assert_eq!(diffs.len(), 2);
+        assert!(diffs.iter().any(|d| d.code == fnum && d.new.is_some()));
+        assert!(diffs.iter().any(|d| d.code == shutter && d.new.is_none()));
+        assert!(cache.get_fresh(iso).is_some());
+        assert!(cache.get(shutter).is_none());
+        assert!(cache.stale_codes().is_empty());
+        assert!(cache.is_complete());
+    }
+}
@@ -0,0 +1,225 @@
+//! Fixed-size set of property codes
+//!
+//! [`PropertyCodeSet`] is a bitset keyed by [`DevicePropertyCode::index`], so
+//! it is `Copy`, never allocates, and two sets merge with a bitwise OR. Events
+//! use it to report which properties changed.
+
+use crsdk_sys::DevicePropertyCode;
+use std::fmt;
+use std::ops::{BitOr, BitOrAssign};
+
+const WORDS: usize = DevicePropertyCode::COUNT.div_ceil(64);
+
+/// A set of property codes stored as a bitset
+#[derive(Clone, Copy, PartialEq, Eq, Hash)]
+pub struct PropertyCodeSet {
+    words: [u64; WORDS],
+}
+
+impl PropertyCodeSet {
+    /// Create an empty set
+    pub const fn new() -> Self {
+        Self { words: [0; WORDS] }
+    }
+
+    /// Build a set from raw SDK codes, skipping codes this crate doesn't know
+    pub fn from_raw_codes(codes: &[u32]) -> Self {
+        codes
+            .iter()
+            .filter_map(|&code| DevicePropertyCode::from_raw(code))
+            .collect()
+    }
+
+    /// Add a code, returning whether it was newly inserted
+    pub fn insert(&mut self, code: DevicePropertyCode) -> bool {
+        let (word, bit) = Self::position(code);
+        let was_set = self.words[word] & bit != 0;
+        self.words[word] |= bit;
+        !was_set
+    }
+
+    /// Remove a code, returning whether it was present
+    pub fn remove(&mut self, code: DevicePropertyCode) -> bool {
+        let (word, bit) = Self::position(code);
+        let was_set = self.words[word] & bit != 0;
+        self.words[word] &= !bit;
+        was_set
+    }
+
+    /// Check whether a code is in the set
+    pub fn contains(&self, code: DevicePropertyCode) -> bool {
+        let (word, bit) = Self::position(code);
+        self.words[word] & bit != 0
+    }
+
+    /// Number of codes in the set
+    pub fn len(&self) -> usize {
+        self.words.iter().map(|w| w.count_ones() as usize).sum()
+    }
+
+    /// Check whether the set is empty
+    pub fn is_empty(&self) -> bool {
+        self.words.iter().all(|&w| w == 0)
+    }
+
+    /// Remove every code
+    pub fn clear(&mut self) {
+        self.words = [0; WORDS];
+    }
+
+    /// Iterate over the codes in ascending raw-code order
+    pub fn iter(&self) -> PropertyCodeIter {
+        PropertyCodeIter {
+            words: self.words,
+            word: 0,
+            bits: self.words[0],
+        }
+    }
+
+    /// Codes as a vector, for APIs that take a slice
+    pub fn to_vec(&self) -> Vec<DevicePropertyCode> {
+        self.iter().collect()
+    }
+
+    fn position(code: DevicePropertyCode) -> (usize, u64) {
+        let index = code.index();
+        (index / 64, 1 << (index % 64))
+    }
+}
+
+impl Default for PropertyCodeSet {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+impl fmt::Debug for PropertyCodeSet {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        f.debug_set().entries(self.iter()).finish()
+    }
+}
+
+impl BitOr for PropertyCodeSet {
+    type Output = Self;
+
+    fn bitor(mut self, rhs: Self) -> Self {
+        self |= rhs;
+        self
+    }
+}
+
+impl BitOrAssign for PropertyCodeSet {
+    fn bitor_assign(&mut self, rhs: Self) {
+        for (word, other) in self.words.iter_mut().zip(rhs.words) {
+            *word |= other;
+        }
+    }
+}
+
+impl FromIterator<DevicePropertyCode> for PropertyCodeSet {
+    fn from_iter<I: IntoIterator<Item = DevicePropertyCode>>(iter: I) -> Self {
+        let mut set = Self::new();
+        set.extend(iter);
+        set
+    }
+}
+
+impl Extend<DevicePropertyCode> for PropertyCodeSet {
+    fn extend<I: IntoIterator<Item = DevicePropertyCode>>(&mut self, iter: I) {
+        for code in iter {
+            self.insert(code);
+        }
+    }
+}
+
+impl IntoIterator for PropertyCodeSet {
+    type Item = DevicePropertyCode;
+    type IntoIter = PropertyCodeIter;
+
+    fn into_iter(self) -> PropertyCodeIter {
+        self.iter()
+    }
+}
+
+impl IntoIterator for &PropertyCodeSet {
+    type Item = DevicePropertyCode;
+    type IntoIter = PropertyCodeIter;
+
+    fn into_iter(self) -> PropertyCodeIter {
+        self.iter()
+    }
+}
+
+/// Iterator over the codes in a [`PropertyCodeSet`]
+#[derive(Debug, Clone)]
+pub struct PropertyCodeIter {
+    words: [u64; WORDS],
+    word: usize,
+    bits: u64,
+}
+
+impl Iterator for PropertyCodeIter {
+    type Item = DevicePropertyCode;
+
+    fn next(&mut self) -> Option<DevicePropertyCode> {
+        while self.bits == 0 {
+            self.word += 1;
+            if self.word >= WORDS {
+                return None;
+            }
+            self.bits = self.words[self.word];
+        }
+        let bit = self.bits.trailing_zeros() as usize;
+        self.bits &= self.bits - 1;
+        DevicePropertyCode::from_index(self.word * 64 + bit)
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_insert_contains_remove() {
+        let mut set = PropertyCodeSet::new();
+        assert!(set.is_empty());
+
+        assert!(set.insert(DevicePropertyCode::FNumber));
+        assert!(!set.insert(DevicePropertyCode::FNumber));
+        assert!(set.contains(DevicePropertyCode::FNumber));
+        assert!(!set.contains(DevicePropertyCode::IsoSensitivity));
+        assert_eq!(set.len(), 1);
+
+        assert!(set.remove(DevicePropertyCode::FNumber));
+        assert!(set.is_empty());
+    }
+
+    #[test]
+    fn test_iter_yields_every_code() {
+        let set: PropertyCodeSet = DevicePropertyCode::ALL.iter().copied().collect();
+        assert_eq!(set.len(), DevicePropertyCode::COUNT);
+        assert!(set.iter().eq(DevicePropertyCode::ALL.iter().copied()));
+    }
+
+    #[test]
+    fn test_union_merges_codes() {
+        let a: PropertyCodeSet = [DevicePropertyCode::FNumber].into_iter().collect();
+        let b: PropertyCodeSet = [
+            DevicePropertyCode::FNumber,
+            DevicePropertyCode::IsoSensitivity,
+        ]
+        .into_iter()
+        .collect();
+
+        let merged = a | b;
+        assert_eq!(merged.len(), 2);
+        assert!(merged.contains(DevicePropertyCode::IsoSensitivity));
+    }
+
+    #[test]
+    fn test_from_raw_codes_skips_unknown() {
+        let set =
+            PropertyCodeSet::from_raw_codes(&[DevicePropertyCode::FNumber.as_raw(), 0xFFFF_FFFF]);
+        assert_eq!(set.to_vec(), vec![DevicePropertyCode::FNumber]);
+    }
+}
@@ -1,5 +1,7 @@
 //! Value constraints for camera properties.
 
+use super::DiscreteValues;
+
 /// Constraint on what values a property can have.
 ///
 /// The SDK provides value constraints in two forms:
@@ -10,8 +12,8 @@ pub enum ValueConstraint {
     /// No constraint information available
     #[default]
     None,
-    /// Discrete list of allowed values
-    Discrete(Vec<u64>),
+    /// Discrete list of allowed values (shared between clones)
+    Discrete(DiscreteValues),
     /// Numeric range with min, max, and step
     Range {
         /// Minimum allowed value
@@ -54,7 +56,7 @@ impl ValueConstraint {
     /// Get all valid values if this is a discrete constraint
     pub fn discrete_values(&self) -> Option<&[u64]> {
         match self {
-            Self::Discrete(values) => Some(values),
+            Self::Discrete(values) => Some(values.as_slice()),
             _ => None,
         }
     }
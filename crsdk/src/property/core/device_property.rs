@@ -4,7 +4,7 @@ use super::{DataType, EnableFlag, ValueConstraint};
 use crate::types::FromCrsdk;
 
 /// A camera property with its current value and metadata.
-#[derive(Debug, Clone)]
+#[derive(Debug, Clone, PartialEq, Eq)]
 pub struct DeviceProperty {
     /// Property code (raw SDK value)
     pub code: u32,
@@ -59,6 +59,37 @@ impl DeviceProperty {
 
 const RANGE_BIT: u32 = 0x4000;
 
+/// Widen `bytes` to u64, `N` bytes per element
+///
+/// `chunks_exact` with a fixed-size conversion has no per-element bounds
+/// checks or type dispatch, so the loop vectorizes, and it reads unaligned
+/// data as-is.
+fn widen<const N: usize>(bytes: &[u8], each: impl Fn([u8; N]) -> u64) -> Vec<u64> {
+    bytes
+        .chunks_exact(N)
+        .map(|chunk| each(chunk.try_into().unwrap()))
+        .collect()
+}
+
+/// Decode SDK value bytes in one pass
+///
+/// Signed types are sign-extended, so each value reads as the unsigned view
+/// (for discrete lists) and, cast with `as i64`, as the signed view (for
+/// ranges). Trailing bytes that don't fill an element are ignored.
+fn decode_values(data_type: DataType, bytes: &[u8]) -> Vec<u64> {
+    match data_type {
+        DataType::UInt8 => bytes.iter().map(|b| *b as u64).collect(),
+        DataType::Int8 => bytes.iter().map(|b| *b as i8 as u64).collect(),
+        DataType::UInt16 => widen(bytes, |b| u16::from_ne_bytes(b) as u64),
+        DataType::Int16 => widen(bytes, |b| i16::from_ne_bytes(b) as u64),
+        DataType::UInt32 => widen(bytes, |b| u32::from_ne_bytes(b) as u64),
+        DataType::Int32 => widen(bytes, |b| i32::from_ne_bytes(b) as u64),
+        DataType::UInt64 => widen(bytes, u64::from_ne_bytes),
+        DataType::Int64 => widen(bytes, |b| i64::from_ne_bytes(b) as u64),
+        _ => Vec::new(),
+    }
+}
+
 /// Parse raw values from SDK property data as u64 (for discrete values)
 pub(crate) fn parse_raw_values(
     data_type: DataType,
@@ -69,142 +100,9 @@ pub(crate) fn parse_raw_values(
         return Vec::new();
     }
 
-    let element_size = match data_type {
-        DataType::UInt8 | DataType::Int8 => 1,
-        DataType::UInt16 | DataType::Int16 => 2,
-        DataType::UInt32 | DataType::Int32 => 4,
-        DataType::UInt64 | DataType::Int64 => 8,
-        _ => return Vec::new(),
-    };
-
-    let count = values_size as usize / element_size;
-    let mut result = Vec::with_capacity(count);
-
-    unsafe {
-        for i in 0..count {
-            let offset = i * element_size;
-            let value = match data_type {
-                DataType::UInt8 => *values_ptr.add(offset) as u64,
-                DataType::Int8 => *values_ptr.add(offset) as i8 as u64,
-                DataType::UInt16 => {
-                    u16::from_ne_bytes([*values_ptr.add(offset), *values_ptr.add(offset + 1)])
-                        as u64
-                }
-                DataType::Int16 => {
-                    i16::from_ne_bytes([*values_ptr.add(offset), *values_ptr.add(offset + 1)])
-                        as u64
-                }
-                DataType::UInt32 => u32::from_ne_bytes([
-                    *values_ptr.add(offset),
-                    *values_ptr.add(offset + 1),
-                    *values_ptr.add(offset + 2),
-                    *values_ptr.add(offset + 3),
-                ]) as u64,
-                DataType::Int32 => i32::from_ne_bytes([
-                    *values_ptr.add(offset),
-                    *values_ptr.add(offset + 1),
-                    *values_ptr.add(offset + 2),
-                    *values_ptr.add(offset + 3),
-                ]) as u64,
-                DataType::UInt64 => u64::from_ne_bytes([
-                    *values_ptr.add(offset),
-                    *values_ptr.add(offset + 1),
-                    *values_ptr.add(offset + 2),
-                    *values_ptr.add(offset + 3),
-                    *values_ptr.add(offset + 4),
-                    *values_ptr.add(offset + 5),
-                    *values_ptr.add(offset + 6),
-                    *values_ptr.add(offset + 7),
-                ]),
-                DataType::Int64 => i64::from_ne_bytes([
-                    *values_ptr.add(offset),
-                    *values_ptr.add(offset + 1),
-                    *values_ptr.add(offset + 2),
-                    *values_ptr.add(offset + 3),
-                    *values_ptr.add(offset + 4),
-                    *values_ptr.add(offset + 5),
-                    *values_ptr.add(offset + 6),
-                    *values_ptr.add(offset + 7),
-                ]) as u64,
-                _ => 0,
-            };
-            result.push(value);
-        }
-    }
-
-    result
-}
-
-/// Parse raw values as signed i64 (for range constraints with signed types)
-fn parse_raw_values_signed(data_type: DataType, values_ptr: *mut u8, values_size: u32) -> Vec<i64> {
-    if values_ptr.is_null() || values_size == 0 {
-        return Vec::new();
-    }
-
-    let element_size = match data_type {
-        DataType::UInt8 | DataType::Int8 => 1,
-        DataType::UInt16 | DataType::Int16 => 2,
-        DataType::UInt32 | DataType::Int32 => 4,
-        DataType::UInt64 | DataType::Int64 => 8,
-        _ => return Vec::new(),
-    };
-
-    let count = values_size as usize / element_size;
-    let mut result = Vec::with_capacity(count);
-
-    unsafe {
-        for i in 0..count {
-            let offset = i * element_size;
-            let value: i64 = match data_type {
-                DataType::UInt8 => *values_ptr.add(offset) as i64,
-                DataType::Int8 => (*values_ptr.add(offset) as i8) as i64,
-                DataType::UInt16 => {
-                    u16::from_ne_bytes([*values_ptr.add(offset), *values_ptr.add(offset + 1)])
-                        as i64
-                }
-                DataType::Int16 => {
-                    i16::from_ne_bytes([*values_ptr.add(offset), *values_ptr.add(offset + 1)])
-                        as i64
-                }
-                DataType::UInt32 => u32::from_ne_bytes([
-                    *values_ptr.add(offset),
-                    *values_ptr.add(offset + 1),
-                    *values_ptr.add(offset + 2),
-                    *values_ptr.add(offset + 3),
-                ]) as i64,
-                DataType::Int32 => i32::from_ne_bytes([
-                    *values_ptr.add(offset),
-                    *values_ptr.add(offset + 1),
-                    *values_ptr.add(offset + 2),
-                    *values_ptr.add(offset + 3),
-                ]) as i64,
-                DataType::UInt64 => u64::from_ne_bytes([
-                    *values_ptr.add(offset),
-                    *values_ptr.add(offset + 1),
-                    *values_ptr.add(offset + 2),
-                    *values_ptr.add(offset + 3),
-                    *values_ptr.add(offset + 4),
-                    *values_ptr.add(offset + 5),
-                    *values_ptr.add(offset + 6),
-                    *values_ptr.add(offset + 7),
-                ]) as i64,
-                DataType::Int64 => i64::from_ne_bytes([
-                    *values_ptr.add(offset),
-                    *values_ptr.add(offset + 1),
-                    *values_ptr.add(offset + 2),
-                    *values_ptr.add(offset + 3),
-                    *values_ptr.add(offset + 4),
-                    *values_ptr.add(offset + 5),
-                    *values_ptr.add(offset + 6),
-                    *values_ptr.add(offset + 7),
-                ]),
-                _ => continue,
-            };
-            result.push(value);
-        }
-    }
-
-    result
+    // SAFETY: the SDK guarantees values_ptr holds values_size bytes
+    let bytes = unsafe { std::slice::from_raw_parts(values_ptr, values_size as usize) };
+    decode_values(data_type, bytes)
 }
 
 /// Parse a ValueConstraint from SDK property data
@@ -214,34 +112,32 @@ pub(crate) fn parse_constraint(
     values_ptr: *mut u8,
     values_size: u32,
 ) -> ValueConstraint {
-    if values_ptr.is_null() || values_size == 0 {
-        return ValueConstraint::None;
-    }
+    let values = parse_raw_values(data_type, values_ptr, values_size);
 
-    let is_range = (raw_value_type & RANGE_BIT) != 0;
-
-    if is_range {
-        let signed_values = parse_raw_values_signed(data_type, values_ptr, values_size);
-        if signed_values.len() >= 3 {
-            return ValueConstraint::Range {
-                min: signed_values[0],
-                max: signed_values[1],
-                step: signed_values[2],
-            };
-        } else if signed_values.len() == 2 {
-            return ValueConstraint::Range {
-                min: signed_values[0],
-                max: signed_values[1],
-                step: 1,
-            };
+    if (raw_value_type & RANGE_BIT) != 0 {
+        match values[..] {
+            [min, max, step, ..] => {
+                return ValueConstraint::Range {
+                    min: min as i64,
+                    max: max as i64,
+                    step: step as i64,
+                };
+            }
+            [min, max] => {
+                return ValueConstraint::Range {
+                    min: min as i64,
+                    max: max as i64,
+                    step: 1,
+                };
+            }
+            _ => {}
         }
     }
 
-    let values = parse_raw_values(data_type, values_ptr, values_size);
     if values.is_empty() {
         ValueConstraint::None
     } else {
-        ValueConstraint::Discrete(values)
+        ValueConstraint::Discrete(values.into())
     }
 }
 
@@ -357,7 +253,7 @@ mod tests {
             enable_flag: EnableFlag::ReadWrite,
             current_value: 100,
             current_string: None,
-            constraint: ValueConstraint::Discrete(vec![100, 200, 400, 800]),
+            constraint: ValueConstraint::Discrete(vec![100, 200, 400, 800].into()),
         };
         assert!(prop.is_valid_value(100));
         assert!(prop.is_valid_value(400));
@@ -403,4 +299,59 @@ mod tests {
         assert_eq!(prop_range.range_params(), Some((1, 7, 1)));
         assert!(prop_range.possible_values().is_none());
     }
+
+    #[test]
+    fn test_decode_values_sign_extends_and_ignores_alignment() {
+        let mut bytes = vec![0xAA];
+        for v in [-3i16, 7, i16::MIN] {
+            bytes.extend(v.to_ne_bytes());
+        }
+        bytes.push(0xFF); // partial trailing element
+
+        let values = decode_values(DataType::Int16, &bytes[1..]);
+        assert_eq!(
+            values.iter().map(|v| *v as i64).collect::<Vec<_>>(),
+            vec![-3, 7, i16::MIN as i64]
+        );
+
+        let unsigned = decode_values(DataType::UInt16, &bytes[1..7]);
+        assert_eq!(unsigned, vec![0xFFFD, 7, 0x8000]);
+    }
+
+    #[test]
+    fn test_parse_constraint_range_and_discrete() {
+        let mut range: Vec<u8> = [-15i32, 15, 1]
+            .iter()
+            .flat_map(|v| v.to_ne_bytes())
+            .collect();
+        let constraint = parse_constraint(
+            crsdk_sys::SCRSDK::CrDataType_CrDataType_Int32 | RANGE_BIT,
+            DataType::Int32,
+            range.as_mut_ptr(),
+            range.len() as u32,
+        );
+        assert_eq!(
+            constraint,
+            ValueConstraint::Range {
+                min: -15,
+                max: 15,
+                step: 1
+            }
+        );
+
+        let mut list: Vec<u8> = [100u32, 200, 400]
+            .iter()
+            .flat_map(|v| v.to_ne_bytes())
+            .collect();
+        let constraint = parse_constraint(
+            crsdk_sys::SCRSDK::CrDataType_CrDataType_UInt32,
+            DataType::UInt32,
+            list.as_mut_ptr(),
+            list.len() as u32,
+        );
+        assert_eq!(
+            constraint,
+            ValueConstraint::Discrete(vec![100, 200, 400].into())
+        );
+    }
 }
@@ -0,0 +1,177 @@
+//! Shared storage for discrete value lists.
+//!
+//! A camera reports the same allowed-value lists (ISO steps, shutter speeds,
+//! f-numbers) on every read, and each [`DeviceProperty`](super::DeviceProperty)
+//! clone used to carry its own copy. [`DiscreteValues`] keeps short lists
+//! inline and interns longer ones, so a re-read yields the very same
+//! allocation: clones are a refcount bump and equality checks against a
+//! cached snapshot are a pointer comparison.
+
+use crate::sdk_string::Interner;
+use std::fmt;
+use std::hash::{Hash, Hasher};
+use std::ops::Deref;
+use std::sync::{Arc, OnceLock};
+
+/// Lists up to this long are stored inline, without allocating
+pub const INLINE_VALUES: usize = 4;
+
+/// Allowed values of a discrete constraint
+///
+/// Dereferences to `[u64]`. Build one with `From<Vec<u64>>`, `From<&[u64]>`
+/// or `collect()`; lists longer than [`INLINE_VALUES`] are interned by
+/// content.
+#[derive(Clone)]
+pub struct DiscreteValues(Repr);
+
+#[derive(Clone)]
+enum Repr {
+    Inline {
+        len: u8,
+        values: [u64; INLINE_VALUES],
+    },
+    Shared(Arc<[u64]>),
+}
+
+impl DiscreteValues {
+    /// Store `values`, interning them if they don't fit inline
+    pub fn new(values: &[u64]) -> Self {
+        if values.len() <= INLINE_VALUES {
+            let mut inline = [0; INLINE_VALUES];
+            inline[..values.len()].copy_from_slice(values);
+            return Self(Repr::Inline {
+                len: values.len() as u8,
+                values: inline,
+            });
+        }
+        Self(Repr::Shared(intern(values)))
+    }
+
+    /// The values as a slice
+    pub fn as_slice(&self) -> &[u64] {
+        match &self.0 {
+            Repr::Inline { len, values } => &values[..*len as usize],
+            Repr::Shared(values) => values,
+        }
+    }
+
+    /// Check whether both lists share one interned allocation
+    ///
+    /// Always false for inline lists, which have no allocation to share.
+    pub fn ptr_eq(&self, other: &Self) -> bool {
+        match (&self.0, &other.0) {
+            (Repr::Shared(a), Repr::Shared(b)) => Arc::ptr_eq(a, b),
+            _ => false,
+        }
+    }
+}
+
+fn intern(values: &[u64]) -> Arc<[u64]> {
+    static LISTS: OnceLock<Interner<[u64]>> = OnceLock::new();
+    LISTS.get_or_init(Interner::new).intern(values)
+}
+
+impl Default for DiscreteValues {
+    fn default() -> Self {
+        Self::new(&[])
+    }
+}
+
+impl Deref for DiscreteValues {
+    type Target = [u64];
+
+    fn deref(&self) -> &[u64] {
+        self.as_slice()
+    }
+}
+
+impl AsRef<[u64]> for DiscreteValues {
+    fn as_ref(&self) -> &[u64] {
+        self.as_slice()
+    }
+}
+
+impl From<&[u64]> for DiscreteValues {
+    fn from(values: &[u64]) -> Self {
+        Self::new(values)
+    }
+}
+
+impl From<Vec<u64>> for DiscreteValues {
+    fn from(values: Vec<u64>) -> Self {
+        Self::new(&values)
+    }
+}
+
+impl FromIterator<u64> for DiscreteValues {
+    fn from_iter<I: IntoIterator<Item = u64>>(iter: I) -> Self {
+        Self::new(&iter.into_iter().collect::<Vec<_>>())
+    }
+}
+
+impl<'a> IntoIterator for &'a DiscreteValues {
+    type Item = &'a u64;
+    type IntoIter = std::slice::Iter<'a, u64>;
+
+    fn into_iter(self) -> Self::IntoIter {
+        self.iter()
+    }
+}
+
+impl PartialEq for DiscreteValues {
+    fn eq(&self, other: &Self) -> bool {
+        self.ptr_eq(other) || self.as_slice() == other.as_slice()
+    }
+}
+
+impl Eq for DiscreteValues {}
+
+impl PartialEq<[u64]> for DiscreteValues {
+    fn eq(&self, other: &[u64]) -> bool {
+        self.as_slice() == other
+    }
+}
+
+impl PartialEq<Vec<u64>> for DiscreteValues {
+    fn eq(&self, other: &Vec<u64>) -> bool {
+        self.as_slice() == other.as_slice()
+    }
+}
+
+impl Hash for DiscreteValues {
+    fn hash<H: Hasher>(&self, state: &mut H) {
+        self.as_slice().hash(state);
+    }
+}
+
+impl fmt::Debug for DiscreteValues {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        fmt::Debug::fmt(self.as_slice(), f)
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_short_lists_are_inline() {
+        let values = DiscreteValues::from(vec![1, 2]);
+        assert!(matches!(values.0, Repr::Inline { len: 2, .. }));
+        assert_eq!(&*values, &[1, 2]);
+        assert!(DiscreteValues::default().is_empty());
+    }
+
+    #[test]
+    fn test_long_lists_are_interned() {
+        let a: DiscreteValues = (100..140).collect();
+        let b = DiscreteValues::from((100..140).collect::<Vec<_>>());
+        let c: DiscreteValues = (100..141).collect();
+
+        assert!(a.ptr_eq(&b));
+        assert_eq!(a, b);
+        assert!(!a.ptr_eq(&c));
+        assert_ne!(a, c);
+        assert_eq!(a.len(), 40);
+    }
+}
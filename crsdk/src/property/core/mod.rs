@@ -4,16 +4,19 @@
 //! - [`DataType`] - SDK data type classification
 //! - [`EnableFlag`] - Property enable/writable status
 //! - [`ValueConstraint`] - Constraint on property values (discrete or range)
+//! - [`DiscreteValues`] - Interned list of allowed discrete values
 //! - [`DeviceProperty`] - A camera property with its current value and metadata
 
 mod constraint;
 mod data_type;
 mod device_property;
+mod discrete;
 mod enable_flag;
 
 pub use constraint::ValueConstraint;
 pub use data_type::DataType;
 pub use device_property::DeviceProperty;
+pub use discrete::{DiscreteValues, INLINE_VALUES};
 pub use enable_flag::EnableFlag;
 
 pub(crate) use device_property::{device_property_from_sdk, device_property_from_sdk_debug};
@@ -19,7 +19,9 @@
 //! - No property code appears in multiple categories
 //! - All property codes are explicitly categorized
 
+mod cache;
 pub mod categories;
+mod code_set;
 mod core;
 mod traits;
 mod typed_value;
@@ -27,7 +29,15 @@ pub mod values;
 
 // Re-export core infrastructure types
 pub(crate) use core::{device_property_from_sdk, device_property_from_sdk_debug};
-pub use core::{DataType, DeviceProperty, EnableFlag, ValueConstraint};
+pub use core::{
+    DataType, DeviceProperty, DiscreteValues, EnableFlag, ValueConstraint, INLINE_VALUES,
+};
+
+// Re-export the opt-in snapshot cache
+pub use cache::{PropertyCache, PropertyDiff};
+
+// Re-export the allocation-free code set used by change events
+pub use code_set::{PropertyCodeIter, PropertyCodeSet};
 
 // Re-export core trait and typed value
 pub use traits::PropertyValue;
@@ -0,0 +1,211 @@
+//! Decoding of SDK `CrChar` strings
+//!
+//! `CrChar` is `char` holding UTF-8 everywhere except Windows, where it is a
+//! UTF-16 `wchar_t`. [`decode`] borrows UTF-8 strings in place and decodes
+//! UTF-16 straight into the result, so neither path copies into a scratch
+//! buffer first. Strings that repeat across cameras and callbacks (model and
+//! device names) go through [`intern`], so a discovery sweep over many
+//! identical bodies shares one allocation per distinct name. The same
+//! [`Interner`] backs the property value lists.
+
+use crsdk_sys::CrChar;
+use std::borrow::Cow;
+use std::collections::HashSet;
+use std::hash::Hash;
+use std::sync::{Arc, Mutex, OnceLock};
+
+/// Interned values kept before unreferenced ones are first swept
+const INTERN_SWEEP_THRESHOLD: usize = 1024;
+
+/// The code units of an SDK string, without trailing NULs
+///
+/// With `len` the SDK-reported size is used (it may or may not count the
+/// terminator); without it the string is read up to its NUL.
+///
+/// # Safety
+///
+/// `ptr` must be null or point to `len` code units (or a NUL-terminated
+/// string when `len` is `None`) that stay valid for `'a`.
+pub(crate) unsafe fn units<'a>(ptr: *const CrChar, len: Option<usize>) -> &'a [CrChar] {
+    if ptr.is_null() {
+        return &[];
+    }
+    let len = match len {
+        Some(len) => len,
+        // SAFETY: caller guarantees a NUL-terminated string
+        None => (0..).take_while(|&i| unsafe { *ptr.add(i) } != 0).count(),
+    };
+    // SAFETY: caller guarantees `len` readable code units
+    let units = unsafe { std::slice::from_raw_parts(ptr, len) };
+    let end = units.iter().rposition(|&c| c != 0).map_or(0, |i| i + 1);
+    &units[..end]
+}
+
+/// Decode an SDK string, borrowing it when it is already valid UTF-8
+///
+/// # Safety
+///
+/// Same as [`units`].
+pub(crate) unsafe fn decode<'a>(ptr: *const CrChar, len: Option<usize>) -> Cow<'a, str> {
+    // SAFETY: forwarded from the caller
+    let units = unsafe { units(ptr, len) };
+    decode_units(units)
+}
+
+#[cfg(not(windows))]
+fn decode_units(units: &[CrChar]) -> Cow<'_, str> {
+    // SAFETY: c_char and u8 have the same size and alignment
+    let bytes = unsafe { std::slice::from_raw_parts(units.as_ptr().cast::<u8>(), units.len()) };
+    String::from_utf8_lossy(bytes)
+}
+
+#[cfg(windows)]
+fn decode_units(units: &[CrChar]) -> Cow<'_, str> {
+    Cow::Owned(
+        char::decode_utf16(units.iter().copied())
+            .map(|c| c.unwrap_or(char::REPLACEMENT_CHARACTER))
+            .collect(),
+    )
+}
+
+/// Decode an SDK string into a shared `Arc<str>` with a single allocation
+///
+/// For one-off strings (file names) that are handed to several consumers.
+///
+/// # Safety
+///
+/// Same as [`units`].
+pub(crate) unsafe fn decode_shared(ptr: *const CrChar, len: Option<usize>) -> Arc<str> {
+    // SAFETY: forwarded from the caller
+    Arc::from(unsafe { decode(ptr, len) }.as_ref())
+}
+
+/// Share one allocation between equal strings
+pub(crate) fn intern(s: &str) -> Arc<str> {
+    static STRINGS: OnceLock<Interner<str>> = OnceLock::new();
+    STRINGS.get_or_init(Interner::new).intern(s)
+}
+
+/// Table handing out one shared allocation per distinct value
+///
+/// Values nobody holds any more would otherwise pile up as firmware or mode
+/// changes produce new ones, so they are swept once the table reaches
+/// [`INTERN_SWEEP_THRESHOLD`] and then whenever it doubles past what the
+/// last sweep kept. That keeps inserts amortized O(1) even when most
+/// entries are still in use.
+pub(crate) struct Interner<T: ?Sized> {
+    table: Mutex<InternTable<T>>,
+}
+
+struct InternTable<T: ?Sized> {
+    shared: HashSet<Arc<T>>,
+    /// Size at which the next insert sweeps
+    sweep_at: usize,
+}
+
+impl<T: ?Sized + Hash + Eq> Interner<T>
+where
+    for<'a> Arc<T>: From<&'a T>,
+{
+    pub(crate) fn new() -> Self {
+        Self {
+            table: Mutex::new(InternTable {
+                shared: HashSet::new(),
+                sweep_at: INTERN_SWEEP_THRESHOLD,
+            }),
+        }
+    }
+
+    /// The shared allocation equal to `value`, created if there is none
+    pub(crate) fn intern(&self, value: &T) -> Arc<T> {
+        let mut table = self.table.lock().unwrap();
+
+        if let Some(shared) = table.shared.get(value) {
+            return shared.clone();
+        }
+
+        if table.shared.len() >= table.sweep_at {
+            table.shared.retain(|shared| Arc::strong_count(shared) > 1);
+            table.sweep_at = INTERN_SWEEP_THRESHOLD.max(table.shared.len() * 2);
+        }
+
+        let shared = Arc::<T>::from(value);
+        table.shared.insert(shared.clone());
+        shared
+    }
+
+    /// Number of values in the table, referenced or not
+    #[cfg(test)]
+    fn len(&self) -> usize {
+        self.table.lock().unwrap().shared.len()
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn sdk(s: &str) -> Vec<CrChar> {
+        #[cfg(not(windows))]
+        let mut units: Vec<CrChar> = s.bytes().map(|b| b as CrChar).collect();
+        #[cfg(windows)]
+        let mut units: Vec<CrChar> = s.encode_utf16().collect();
+        units.push(0);
+        units
+    }
+
+    #[test]
+    fn test_decode_trims_terminators() {
+        let mut units = sdk("ILME-FX3");
+        units.push(0);
+
+        let sized = unsafe { decode(units.as_ptr(), Some(units.len())) };
+        let terminated = unsafe { decode(units.as_ptr(), None) };
+        assert_eq!(sized, "ILME-FX3");
+        assert_eq!(terminated, "ILME-FX3");
+        #[cfg(not(windows))]
+        assert!(matches!(sized, Cow::Borrowed(_)));
+    }
+
+    #[test]
+    fn test_decode_null_is_empty() {
+        assert_eq!(unsafe { decode(std::ptr::null(), Some(8)) }, "");
+        assert_eq!(unsafe { decode(std::ptr::null(), None) }, "");
+    }
+
+    #[test]
+    fn test_intern_shares_equal_strings() {
+        let a = intern("ILCE-7M4");
+        let b = intern(&String::from("ILCE-7M4"));
+        assert!(Arc::ptr_eq(&a, &b));
+        assert!(!Arc::ptr_eq(&a, &intern("ILCE-1")));
+    }
+
+    #[test]
+    fn test_interner_sweeps_when_table_doubles() {
+        let interner = Interner::<str>::new();
+
+        // Nothing else holds these, so the first sweep drops them all
+        for i in 0..INTERN_SWEEP_THRESHOLD {
+            interner.intern(&i.to_string());
+        }
+        assert_eq!(interner.len(), INTERN_SWEEP_THRESHOLD);
+        let _first = interner.intern("first");
+        assert_eq!(interner.len(), 1);
+
+        // With everything held, a sweep frees nothing and the next one
+        // waits for the table to double
+        let held: Vec<_> = (0..INTERN_SWEEP_THRESHOLD)
+            .map(|i| interner.intern(&format!("held {}", i)))
+            .collect();
+        let _second = interner.intern("second");
+        assert_eq!(interner.len(), INTERN_SWEEP_THRESHOLD + 2);
+        drop(held);
+        for i in 0..INTERN_SWEEP_THRESHOLD - 2 {
+            interner.intern(&format!("more {}", i));
+        }
+        assert_eq!(interner.len(), 2 * INTERN_SWEEP_THRESHOLD);
+        interner.intern("third");
+        assert_eq!(interner.len(), 3);
+    }
+}
@@ -0,0 +1,328 @@
+//! Waiting on capture milestones reported by the camera
+//!
+//! The SDK reports autofocus results as an extended warning
+//! ([`AF_STATUS_WARNING`]) and confirms saved shots through
+//! `OnCompleteDownload` / `OnNotifyContentsTransfer`. The event sender records
+//! these in a [`ShotSignals`] shared with the device, so capture helpers can
+//! block until the camera actually reports the milestone instead of sleeping
+//! for a fixed time. This works regardless of who owns the event receiver.
+//!
+//! The same signals carry backpressure for repeated shooting: a release the
+//! camera turns away while its buffer is still writing comes back as an
+//! operation-result warning, and a full card as [`STORAGE_FULL_WARNING`].
+
+use std::sync::{Arc, Condvar, Mutex};
+use std::time::{Duration, Instant};
+
+/// Warning code carrying autofocus status in its first parameter
+pub const AF_STATUS_WARNING: u32 = 0x00060001;
+
+/// Warning code the camera sends when the memory card is full
+pub const STORAGE_FULL_WARNING: u32 = 0x00020003;
+
+/// Extended warning reporting the result of the last operation
+pub const OPERATION_RESULT_WARNING: u32 = 0x00060002;
+
+/// Operation result: the camera can't take the operation in its current state
+const OPERATION_CAMERA_STATUS_ERROR: i32 = 4;
+
+/// How long `focus_and_capture` waits for an AF result before shooting anyway
+pub const DEFAULT_AF_TIMEOUT: Duration = Duration::from_secs(2);
+
+/// Autofocus state reported by the camera
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum AfStatus {
+    /// Shutter half-press released
+    Unlocked,
+    /// Focus achieved (AF-S)
+    Focused,
+    /// Focus failed (AF-S)
+    NotFocused,
+    /// Tracking a subject (AF-C), no final result yet
+    Tracking,
+    /// Focus achieved (AF-C)
+    FocusedContinuous,
+    /// Focus failed (AF-C)
+    NotFocusedContinuous,
+    /// Tracking resumed
+    Unpaused,
+    /// Tracking paused
+    Paused,
+}
+
+impl AfStatus {
+    /// Decode the first parameter of an [`AF_STATUS_WARNING`]
+    pub fn from_raw(value: i32) -> Option<Self> {
+        match value {
+            0x01 => Some(Self::Unlocked),
+            0x02 => Some(Self::Focused),
+            0x03 => Some(Self::NotFocused),
+            0x05 => Some(Self::Tracking),
+            0x06 => Some(Self::FocusedContinuous),
+            0x07 => Some(Self::NotFocusedContinuous),
+            0x08 => Some(Self::Unpaused),
+            0x09 => Some(Self::Paused),
+            _ => None,
+        }
+    }
+
+    /// Decode a warning event, if it is an AF status warning
+    pub fn from_warning(code: u32, params: Option<(i32, i32, i32)>) -> Option<Self> {
+        match (code, params) {
+            (AF_STATUS_WARNING, Some((p1, _, _))) => Self::from_raw(p1),
+            _ => None,
+        }
+    }
+
+    /// Check whether focus is achieved (either AF mode)
+    pub fn is_focused(self) -> bool {
+        matches!(self, Self::Focused | Self::FocusedContinuous)
+    }
+
+    /// Check whether this is a final AF result, focused or not
+    pub fn is_settled(self) -> bool {
+        matches!(
+            self,
+            Self::Focused | Self::NotFocused | Self::FocusedContinuous | Self::NotFocusedContinuous
+        )
+    }
+}
+
+/// Why the camera can't take more shots right now
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub(crate) enum Backpressure {
+    /// A release was rejected, typically because the buffer is full
+    Rejected,
+    /// The memory card is full
+    StorageFull,
+}
+
+/// Point in the signal history to wait from
+///
+/// Taken before triggering an operation so a result that arrives before the
+/// wait starts isn't missed, and a stale one from earlier isn't mistaken for
+/// it.
+#[derive(Debug, Clone, Copy)]
+pub(crate) struct ShotMark {
+    af_seq: u64,
+    shot_seq: u64,
+    rejected_seq: u64,
+    full_seq: u64,
+}
+
+#[derive(Debug, Default)]
+struct ShotState {
+    af_seq: u64,
+    af_status: Option<AfStatus>,
+    shot_seq: u64,
+    shot_filename: Option<Arc<str>>,
+    rejected_seq: u64,
+    full_seq: u64,
+}
+
+/// Capture milestones shared between a device and its event sender
+#[derive(Debug, Clone, Default)]
+pub(crate) struct ShotSignals {
+    inner: Arc<(Mutex<ShotState>, Condvar)>,
+}
+
+impl ShotSignals {
+    /// Record whatever a camera warning says about shooting
+    ///
+    /// `params` is `Some` for extended warnings.
+    pub(crate) fn warning(&self, code: u32, params: Option<(i32, i32, i32)>) {
+        if let Some(status) = AfStatus::from_warning(code, params) {
+            self.af_status(status);
+            return;
+        }
+        match (code, params) {
+            (STORAGE_FULL_WARNING, _) => self.bump(|state| state.full_seq += 1),
+            (OPERATION_RESULT_WARNING, Some((OPERATION_CAMERA_STATUS_ERROR, _, _))) => {
+                self.bump(|state| state.rejected_seq += 1)
+            }
+            _ => {}
+        }
+    }
+
+    /// Record an AF status report
+    pub(crate) fn af_status(&self, status: AfStatus) {
+        let (state, changed) = &*self.inner;
+        let mut state = state.lock().unwrap();
+        state.af_seq += 1;
+        state.af_status = Some(status);
+        changed.notify_all();
+    }
+
+    /// Record a confirmed shot
+    pub(crate) fn shot_saved(&self, filename: Option<Arc<str>>) {
+        self.bump(|state| {
+            state.shot_seq += 1;
+            state.shot_filename = filename;
+        });
+    }
+
+    fn bump(&self, update: impl FnOnce(&mut ShotState)) {
+        let (state, changed) = &*self.inner;
+        update(&mut state.lock().unwrap());
+        changed.notify_all();
+    }
+
+    /// Current position, to wait for milestones after it
+    pub(crate) fn mark(&self) -> ShotMark {
+        let state = self.inner.0.lock().unwrap();
+        ShotMark {
+            af_seq: state.af_seq,
+            shot_seq: state.shot_seq,
+            rejected_seq: state.rejected_seq,
+            full_seq: state.full_seq,
+        }
+    }
+
+    /// Wait for a settled AF result reported after `mark`
+    pub(crate) fn wait_af(&self, mark: ShotMark, timeout: Duration) -> Option<AfStatus> {
+        self.wait(timeout, |state| {
+            (state.af_seq > mark.af_seq)
+                .then_some(state.af_status)
+                .flatten()
+                .filter(|status| status.is_settled())
+        })
+    }
+
+    /// Wait for a shot confirmed after `mark`, returning its filename if known
+    pub(crate) fn wait_shot(&self, mark: ShotMark, timeout: Duration) -> Option<Option<String>> {
+        self.wait(timeout, |state| {
+            (state.shot_seq > mark.shot_seq)
+                .then(|| state.shot_filename.as_deref().map(str::to_owned))
+        })
+    }
+
+    /// Wait for a rejected release or a full card reported after `mark`
+    pub(crate) fn wait_backpressure(
+        &self,
+        mark: ShotMark,
+        timeout: Duration,
+    ) -> Option<Backpressure> {
+        self.wait(timeout, |state| {
+            if state.full_seq > mark.full_seq {
+                Some(Backpressure::StorageFull)
+            } else if state.rejected_seq > mark.rejected_seq {
+                Some(Backpressure::Rejected)
+            } else {
+                None
+            }
+        })
+    }
+
+    /// Wait for a full card reported after `mark`, ignoring rejections
+    pub(crate) fn wait_storage_full(&self, mark: ShotMark, timeout: Duration) -> bool {
+        self.wait(timeout, |state| {
+            (state.full_seq > mark.full_seq).then_some(())
+        })
+        .is_some()
+    }
+
+    fn wait<T>(
+        &self,
+        timeout: Duration,
+        mut ready: impl FnMut(&ShotState) -> Option<T>,
+    ) -> Option<T> {
+        let deadline = Instant::now() + timeout;
+        let (state, changed) = &*self.inner;
+        let mut state = state.lock().unwrap();
+        loop {
+            if let Some(value) = ready(&state) {
+                return Some(value);
+            }
+            let now = Instant::now();
+            if now >= deadline {
+                return None;
+            }
+            state = changed.wait_timeout(state, deadline - now).unwrap().0;
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_af_status_from_warning() {
+        assert_eq!(
+            AfStatus::from_warning(AF_STATUS_WARNING, Some((0x02, 0, 0))),
+            Some(AfStatus::Focused)
+        );
+        assert_eq!(AfStatus::from_warning(AF_STATUS_WARNING, None), None);
+        assert_eq!(AfStatus::from_warning(0x00060002, Some((0x02, 0, 0))), None);
+        assert!(!AfStatus::Tracking.is_settled());
+        assert!(AfStatus::NotFocused.is_settled());
+    }
+
+    #[test]
+    fn test_wait_af_ignores_results_before_mark() {
+        let signals = ShotSignals::default();
+        signals.af_status(AfStatus::Focused);
+
+        let mark = signals.mark();
+        assert_eq!(signals.wait_af(mark, Duration::ZERO), None);
+
+        signals.af_status(AfStatus::Tracking);
+        assert_eq!(signals.wait_af(mark, Duration::ZERO), None);
+
+        signals.af_status(AfStatus::NotFocused);
+        assert_eq!(
+            signals.wait_af(mark, Duration::ZERO),
+            Some(AfStatus::NotFocused)
+        );
+    }
+
+    #[test]
+    fn test_backpressure_from_warnings() {
+        let signals = ShotSignals::default();
+        let mark = signals.mark();
+
+        // Other operation results and AF reports aren't backpressure
+        signals.warning(OPERATION_RESULT_WARNING, Some((1, 0, 0)));
+        signals.warning(AF_STATUS_WARNING, Some((0x02, 0, 0)));
+        assert_eq!(signals.wait_backpressure(mark, Duration::ZERO), None);
+
+        signals.warning(
+            OPERATION_RESULT_WARNING,
+            Some((OPERATION_CAMERA_STATUS_ERROR, 0, 0)),
+        );
+        assert_eq!(
+            signals.wait_backpressure(mark, Duration::ZERO),
+            Some(Backpressure::Rejected)
+        );
+        assert!(!signals.wait_storage_full(mark, Duration::ZERO));
+
+        signals.warning(STORAGE_FULL_WARNING, None);
+        assert_eq!(
+            signals.wait_backpressure(mark, Duration::ZERO),
+            Some(Backpressure::StorageFull)
+        );
+        assert!(signals.wait_storage_full(mark, Duration::ZERO));
+        assert_eq!(
+            signals.wait_backpressure(signals.mark(), Duration::ZERO),
+            None
+        );
+    }
+
+    #[test]
+    fn test_wait_shot_wakes_on_confirmation() {
+        let signals = ShotSignals::default();
+        let mark = signals.mark();
+
+        let notifier = signals.clone();
+        let thread = std::thread::spawn(move || {
+            std::thread::sleep(Duration::from_millis(10));
+            notifier.shot_saved(Some("DSC00001.JPG".into()));
+        });
+
+        assert_eq!(
+            signals.wait_shot(mark, Duration::from_secs(5)),
+            Some(Some("DSC00001.JPG".to_string()))
+        );
+        thread.join().unwrap();
+    }
+}
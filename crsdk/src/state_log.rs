@@ -0,0 +1,1036 @@
+//! Append-only binary log of property snapshots and camera events
+//!
+//! [`StateLogWriter`] streams records to a file (or any writer) as they
+//! happen, so a log of many bodies over many hours never has to be held in
+//! memory. [`StateLogReader`] memory-maps a finished or still-growing log and
+//! indexes its record headers, so offline queries (the property state of one
+//! camera at a given time, the events in a time window) only decode the
+//! records they need.
+//!
+//! # Format
+//!
+//! A 12-byte header (`CRSDKLOG`, a `u16` version, two reserved bytes) is
+//! followed by records, all integers little-endian:
+//!
+//! ```text
+//! u32 body length | u8 kind | u64 time (µs since the Unix epoch) | u32 camera | payload
+//! ```
+//!
+//! Each writer takes times from a monotonic clock anchored to the wall clock
+//! when it starts, so they never go back within one writer even if the
+//! system clock is stepped. A log appended to by several writers can still
+//! go back between them; the reader detects that and searches linearly.
+//!
+//! The length prefix lets readers skip kinds they don't know, and a record
+//! cut short by a crash is detected and ignored. Property state is
+//! delta-encoded per camera: the first write is a full snapshot, later ones
+//! hold only the properties that changed or disappeared, with a full
+//! snapshot again every [`KEYFRAME_INTERVAL`] deltas so a query never
+//! replays more than that many records. The bytes of in-memory transfer
+//! chunks (`RemoteTransferData`) aren't logged, only their progress.
+
+use crate::error::{Error, Result};
+use crate::event::{CameraEvent, LiveViewCodes};
+use crate::property::{
+    DataType, DeviceProperty, DiscreteValues, EnableFlag, PropertyCodeSet, ValueConstraint,
+};
+use std::collections::HashMap;
+use std::fs::{File, OpenOptions};
+use std::io::{self, BufWriter, Write};
+use std::ops::{Deref, Range};
+use std::path::Path;
+use std::sync::Arc;
+use std::time::{Duration, Instant, SystemTime, UNIX_EPOCH};
+
+/// First bytes of every state log
+const MAGIC: [u8; 8] = *b"CRSDKLOG";
+
+/// Format version written to new logs
+const VERSION: u16 = 1;
+
+const HEADER_LEN: usize = 12;
+
+/// Length prefix, kind, time and camera
+const RECORD_HEADER_LEN: usize = 4 + 1 + 8 + 4;
+
+/// Deltas written for a camera before its next full snapshot
+pub const KEYFRAME_INTERVAL: u32 = 64;
+
+const KIND_CAMERA: u8 = 1;
+const KIND_SNAPSHOT: u8 = 2;
+const KIND_DELTA: u8 = 3;
+const KIND_EVENT: u8 = 4;
+
+/// Decoded contents of one log record
+#[derive(Debug, Clone)]
+pub enum LogRecord {
+    /// Name of the camera behind an id
+    Camera {
+        /// Model or user-given name
+        name: String,
+    },
+    /// Every property of the camera
+    Snapshot(Vec<DeviceProperty>),
+    /// Properties changed or gone since the previous snapshot or delta
+    Delta {
+        /// Properties whose snapshot differs
+        changed: Vec<DeviceProperty>,
+        /// Raw codes of properties the camera no longer reports
+        removed: Vec<u32>,
+    },
+    /// An event received from the camera
+    Event(CameraEvent),
+}
+
+/// One log record with the camera and time it belongs to
+#[derive(Debug, Clone)]
+pub struct LogEntry {
+    /// When the record was written
+    pub time: SystemTime,
+    /// Caller-chosen camera id
+    pub camera: u32,
+    /// What was recorded
+    pub record: LogRecord,
+}
+
+/// Streaming writer of a state log
+pub struct StateLogWriter<W: Write> {
+    out: W,
+    /// Last logged property state, per camera
+    previous: HashMap<u32, HashMap<u32, DeviceProperty>>,
+    /// Deltas since the last full snapshot, per camera
+    deltas: HashMap<u32, u32>,
+    /// Reused record body
+    body: Vec<u8>,
+    /// Wall-clock time (µs since the Unix epoch) at `started`
+    epoch_micros: u64,
+    started: Instant,
+}
+
+impl StateLogWriter<BufWriter<File>> {
+    /// Create (or truncate) a log file
+    pub fn create(path: impl AsRef<Path>) -> Result<Self> {
+        Self::new(BufWriter::new(File::create(path)?))
+    }
+
+    /// Append to an existing log file, or create it
+    ///
+    /// A record torn by a crash at the end of the file is cut off first;
+    /// otherwise its length prefix would reach into the new records. Property
+    /// state starts over with a full snapshot per camera.
+    pub fn append(path: impl AsRef<Path>) -> Result<Self> {
+        let path = path.as_ref();
+        let file = OpenOptions::new().append(true).create(true).open(path)?;
+        let len = file.metadata()?.len();
+        if len == 0 {
+            return Self::new(BufWriter::new(file));
+        }
+
+        // Index (and unmap) before truncating
+        let end = StateLogReader::open(path)?.records_end() as u64;
+        if end < len {
+            tracing::warn!(
+                "Dropping {} bytes of a torn record at the end of {}",
+                len - end,
+                path.display()
+            );
+            file.set_len(end)?;
+        }
+        Ok(Self::resume(BufWriter::new(file)))
+    }
+}
+
+impl<W: Write> StateLogWriter<W> {
+    /// Start a new log on `out`, writing the header
+    pub fn new(mut out: W) -> Result<Self> {
+        out.write_all(&MAGIC)?;
+        out.write_all(&VERSION.to_le_bytes())?;
+        out.write_all(&[0; 2])?;
+        Ok(Self::resume(out))
+    }
+
+    /// Continue a log whose header `out` already holds
+    fn resume(out: W) -> Self {
+        Self {
+            out,
+            previous: HashMap::new(),
+            deltas: HashMap::new(),
+            body: Vec::new(),
+            epoch_micros: SystemTime::now()
+                .duration_since(UNIX_EPOCH)
+                .unwrap_or_default()
+                .as_micros() as u64,
+            started: Instant::now(),
+        }
+    }
+
+    /// Record the name behind a camera id
+    pub fn write_camera(&mut self, camera: u32, name: &str) -> Result<()> {
+        self.body.clear();
+        put_str(&mut self.body, name);
+        self.emit(KIND_CAMERA, camera)
+    }
+
+    /// Record a camera's properties, as a delta against its last snapshot
+    ///
+    /// Writes nothing if no property changed.
+    pub fn write_properties(&mut self, camera: u32, properties: &[DeviceProperty]) -> Result<()> {
+        let deltas = self.deltas.entry(camera).or_insert(0);
+        let previous = self.previous.entry(camera).or_default();
+        self.body.clear();
+
+        if previous.is_empty() || *deltas >= KEYFRAME_INTERVAL {
+            *deltas = 0;
+            put_u32(&mut self.body, properties.len() as u32);
+            for prop in properties {
+                put_property(&mut self.body, prop);
+            }
+            *previous = properties.iter().map(|p| (p.code, p.clone())).collect();
+            return self.emit(KIND_SNAPSHOT, camera);
+        }
+
+        let changed: Vec<_> = properties
+            .iter()
+            .filter(|p| previous.get(&p.code) != Some(p))
+            .collect();
+        let removed: Vec<u32> = previous
+            .keys()
+            .copied()
+            .filter(|code| !properties.iter().any(|p| p.code == *code))
+            .collect();
+        if changed.is_empty() && removed.is_empty() {
+            return Ok(());
+        }
+
+        *deltas += 1;
+        put_u32(&mut self.body, changed.len() as u32);
+        for prop in &changed {
+            put_property(&mut self.body, prop);
+            previous.insert(prop.code, (*prop).clone());
+        }
+        put_u32(&mut self.body, removed.len() as u32);
+        for code in removed {
+            put_u32(&mut self.body, code);
+            previous.remove(&code);
+        }
+        self.emit(KIND_DELTA, camera)
+    }
+
+    /// Record an event received from a camera
+    pub fn write_event(&mut self, camera: u32, event: &CameraEvent) -> Result<()> {
+        self.body.clear();
+        put_event(&mut self.body, event);
+        self.emit(KIND_EVENT, camera)
+    }
+
+    /// Flush buffered records to the underlying writer
+    pub fn flush(&mut self) -> Result<()> {
+        Ok(self.out.flush()?)
+    }
+
+    /// Flush and return the underlying writer
+    pub fn into_inner(mut self) -> Result<W> {
+        self.out.flush()?;
+        Ok(self.out)
+    }
+
+    fn emit(&mut self, kind: u8, camera: u32) -> Result<()> {
+        let time = self.epoch_micros + self.started.elapsed().as_micros() as u64;
+        let len = (RECORD_HEADER_LEN - 4 + self.body.len()) as u32;
+
+        let mut header = [0; RECORD_HEADER_LEN];
+        header[0..4].copy_from_slice(&len.to_le_bytes());
+        header[4] = kind;
+        header[5..13].copy_from_slice(&time.to_le_bytes());
+        header[13..17].copy_from_slice(&camera.to_le_bytes());
+        self.out.write_all(&header)?;
+        self.out.write_all(&self.body)?;
+        Ok(())
+    }
+}
+
+/// Position and header of one record in a mapped log
+#[derive(Debug, Clone, Copy)]
+struct RecordIndex {
+    /// Offset of the payload
+    offset: usize,
+    /// Payload length
+    len: usize,
+    kind: u8,
+    time: SystemTime,
+    camera: u32,
+}
+
+enum LogBytes {
+    Mapped(memmap2::Mmap),
+    Owned(Vec<u8>),
+}
+
+impl Deref for LogBytes {
+    type Target = [u8];
+
+    fn deref(&self) -> &[u8] {
+        match self {
+            Self::Mapped(map) => map,
+            Self::Owned(bytes) => bytes,
+        }
+    }
+}
+
+/// Indexed, read-only view of a state log
+pub struct StateLogReader {
+    bytes: LogBytes,
+    records: Vec<RecordIndex>,
+    truncated: bool,
+    /// Whether record times never go back (false for some appended logs)
+    sorted: bool,
+}
+
+impl StateLogReader {
+    /// Memory-map and index a log file
+    ///
+    /// Records appended after this call aren't seen; open the log again to
+    /// pick them up.
+    pub fn open(path: impl AsRef<Path>) -> Result<Self> {
+        let file = File::open(path)?;
+        // SAFETY: logs are only ever appended to, so the mapped prefix doesn't
+        // change under us; truncating a log while it's open is not supported
+        let map = unsafe { memmap2::Mmap::map(&file)? };
+        Self::index(LogBytes::Mapped(map))
+    }
+
+    /// Index a log held in memory
+    pub fn from_bytes(bytes: Vec<u8>) -> Result<Self> {
+        Self::index(LogBytes::Owned(bytes))
+    }
+
+    fn index(bytes: LogBytes) -> Result<Self> {
+        let header = bytes
+            .get(..HEADER_LEN)
+            .ok_or_else(|| corrupt("missing header"))?;
+        check_header(header)?;
+
+        let mut records = Vec::new();
+        let mut offset = HEADER_LEN;
+        let truncated = loop {
+            let Some(header) = bytes.get(offset..offset + RECORD_HEADER_LEN) else {
+                break offset != bytes.len();
+            };
+            let len = u32::from_le_bytes(header[0..4].try_into().unwrap()) as usize;
+            let end = offset + 4 + len;
+            if len < RECORD_HEADER_LEN - 4 || end > bytes.len() {
+                break true;
+            }
+            let time = u64::from_le_bytes(header[5..13].try_into().unwrap());
+            records.push(RecordIndex {
+                offset: offset + RECORD_HEADER_LEN,
+                len: end - offset - RECORD_HEADER_LEN,
+                kind: header[4],
+                time: UNIX_EPOCH + Duration::from_micros(time),
+                camera: u32::from_le_bytes(header[13..17].try_into().unwrap()),
+            });
+            offset = end;
+        };
+
+        let sorted = records.windows(2).all(|pair| pair[0].time <= pair[1].time);
+        Ok(Self {
+            bytes,
+            records,
+            truncated,
+            sorted,
+        })
+    }
+
+    /// Offset just past the last complete record
+    fn records_end(&self) -> usize {
+        self.records
+            .last()
+            .map_or(HEADER_LEN, |record| record.offset + record.len)
+    }
+
+    /// Number of complete records
+    pub fn len(&self) -> usize {
+        self.records.len()
+    }
+
+    /// Check whether the log holds no records
+    pub fn is_empty(&self) -> bool {
+        self.records.is_empty()
+    }
+
+    /// Whether the log ends in a partly written record (which is ignored)
+    pub fn is_truncated(&self) -> bool {
+        self.truncated
+    }
+
+    /// Time span covered by the log
+    pub fn time_range(&self) -> Option<Range<SystemTime>> {
+        if !self.sorted {
+            let first = self.records.iter().map(|index| index.time).min()?;
+            let last = self.records.iter().map(|index| index.time).max()?;
+            return Some(first..last);
+        }
+        let first = self.records.first()?.time;
+        let last = self.records.last()?.time;
+        Some(first..last)
+    }
+
+    /// Decode every record, in the order they were written
+    ///
+    /// Records of kinds this version doesn't know are skipped.
+    pub fn entries(&self) -> impl Iterator<Item = Result<LogEntry>> + '_ {
+        self.records
+            .iter()
+            .filter(|index| index.kind <= KIND_EVENT)
+            .map(|index| self.decode(index))
+    }
+
+    /// Camera ids in the log with the last name recorded for each
+    pub fn cameras(&self) -> Result<Vec<(u32, Option<String>)>> {
+        let mut cameras: Vec<(u32, Option<String>)> = Vec::new();
+        for index in &self.records {
+            let name = match index.kind {
+                KIND_CAMERA => match self.decode(index)?.record {
+                    LogRecord::Camera { name } => Some(name),
+                    _ => unreachable!(),
+                },
+                _ => None,
+            };
+            match cameras.iter_mut().find(|(id, _)| *id == index.camera) {
+                Some(entry) => entry.1 = name.or(entry.1.take()),
+                None => cameras.push((index.camera, name)),
+            }
+        }
+        Ok(cameras)
+    }
+
+    /// Events recorded within `range`, optionally for one camera only
+    pub fn events(
+        &self,
+        camera: Option<u32>,
+        range: Range<SystemTime>,
+    ) -> impl Iterator<Item = Result<(SystemTime, u32, CameraEvent)>> + '_ {
+        self.records
+            .iter()
+            .filter(move |index| {
+                index.kind == KIND_EVENT
+                    && camera.map_or(true, |camera| camera == index.camera)
+                    && range.contains(&index.time)
+            })
+            .map(|index| {
+                let entry = self.decode(index)?;
+                match entry.record {
+                    LogRecord::Event(event) => Ok((entry.time, entry.camera, event)),
+                    _ => unreachable!(),
+                }
+            })
+    }
+
+    /// Property state of `camera` as of `time`
+    ///
+    /// Starts from the last full snapshot at or before `time` and applies
+    /// the deltas after it, so at most [`KEYFRAME_INTERVAL`] records are
+    /// decoded. Empty if nothing was logged for the camera by then.
+    ///
+    /// If the times go back somewhere in the log, the state is the one after
+    /// the last record stamped at or before `time`.
+    pub fn properties_at(&self, camera: u32, time: SystemTime) -> Result<Vec<DeviceProperty>> {
+        let end = if self.sorted {
+            self.records.partition_point(|index| index.time <= time)
+        } else {
+            self.records
+                .iter()
+                .rposition(|index| index.time <= time)
+                .map_or(0, |last| last + 1)
+        };
+        let history = &self.records[..end];
+        let Some(start) = history
+            .iter()
+            .rposition(|index| index.camera == camera && index.kind == KIND_SNAPSHOT)
+        else {
+            return Ok(Vec::new());
+        };
+
+        let mut state: Vec<DeviceProperty> = Vec::new();
+        for index in &history[start..] {
+            if index.camera != camera {
+                continue;
+            }
+            match self.decode(index)?.record {
+                LogRecord::Snapshot(properties) => state = properties,
+                LogRecord::Delta { changed, removed } => {
+                    state.retain(|p| !removed.contains(&p.code));
+                    for prop in changed {
+                        match state.iter_mut().find(|p| p.code == prop.code) {
+                            Some(slot) => *slot = prop,
+                            None => state.push(prop),
+                        }
+                    }
+                }
+                _ => {}
+            }
+        }
+        Ok(state)
+    }
+
+    fn decode(&self, index: &RecordIndex) -> Result<LogEntry> {
+        let mut input = Decoder(&self.bytes[index.offset..index.offset + index.len]);
+        let record = match index.kind {
+            KIND_CAMERA => LogRecord::Camera {
+                name: input.string()?,
+            },
+            KIND_SNAPSHOT => LogRecord::Snapshot(input.properties()?),
+            KIND_DELTA => LogRecord::Delta {
+                changed: input.properties()?,
+                removed: (0..input.u32()?)
+                    .map(|_| input.u32())
+                    .collect::<Result<_>>()?,
+            },
+            KIND_EVENT => LogRecord::Event(input.event()?),
+            kind => return Err(corrupt(&format!("unknown record kind {}", kind))),
+        };
+        Ok(LogEntry {
+            time: index.time,
+            camera: index.camera,
+            record,
+        })
+    }
+}
+
+fn check_header(header: &[u8]) -> Result<()> {
+    if header[..8] != MAGIC {
+        return Err(corrupt("not a state log"));
+    }
+    let version = u16::from_le_bytes([header[8], header[9]]);
+    if version != VERSION {
+        return Err(corrupt(&format!("unsupported version {}", version)));
+    }
+    Ok(())
+}
+
+fn corrupt(what: &str) -> Error {
+    Error::Io(io::Error::new(io::ErrorKind::InvalidData, what.to_string()))
+}
+
+// -----------------------------------------------------------------------------
+// Encoding
+// -----------------------------------------------------------------------------
+
+fn put_u32(out: &mut Vec<u8>, value: u32) {
+    out.extend_from_slice(&value.to_le_bytes());
+}
+
+fn put_u64(out: &mut Vec<u8>, value: u64) {
+    out.extend_from_slice(&value.to_le_bytes());
+}
+
+fn put_str(out: &mut Vec<u8>, value: &str) {
+    put_u32(out, value.len() as u32);
+    out.extend_from_slice(value.as_bytes());
+}
+
+fn put_opt_str(out: &mut Vec<u8>, value: Option<&str>) {
+    match value {
+        Some(value) => {
+            out.push(1);
+            put_str(out, value);
+        }
+        None => out.push(0),
+    }
+}
+
+fn put_property(out: &mut Vec<u8>, prop: &DeviceProperty) {
+    put_u32(out, prop.code);
+    match prop.data_type {
+        DataType::UInt8 => out.push(1),
+        DataType::UInt16 => out.push(2),
+        DataType::UInt32 => out.push(3),
+        DataType::UInt64 => out.push(4),
+        DataType::Int8 => out.push(5),
+        DataType::Int16 => out.push(6),
+        DataType::Int32 => out.push(7),
+        DataType::Int64 => out.push(8),
+        DataType::String => out.push(9),
+        DataType::Unknown(raw) => {
+            out.push(0);
+            put_u32(out, raw);
+        }
+    }
+    out.push(match prop.enable_flag {
+        EnableFlag::NotSupported => 0,
+        EnableFlag::Disabled => 1,
+        EnableFlag::ReadWrite => 2,
+        EnableFlag::ReadOnly => 3,
+        EnableFlag::WriteOnly => 4,
+    });
+    put_u64(out, prop.current_value);
+    put_opt_str(out, prop.current_string.as_deref());
+    match &prop.constraint {
+        ValueConstraint::None => out.push(0),
+        ValueConstraint::Discrete(values) => {
+            out.push(1);
+            put_u32(out, values.len() as u32);
+            for &value in values.iter() {
+                put_u64(out, value);
+            }
+        }
+        ValueConstraint::Range { min, max, step } => {
+            out.push(2);
+            for value in [min, max, step] {
+                out.extend_from_slice(&value.to_le_bytes());
+            }
+        }
+    }
+}
+
+fn put_event(out: &mut Vec<u8>, event: &CameraEvent) {
+    match event {
+        CameraEvent::Connected { version } => {
+            out.push(1);
+            put_u32(out, *version);
+        }
+        CameraEvent::Disconnected { error } => {
+            out.push(2);
+            put_u32(out, *error);
+        }
+        CameraEvent::PropertyChanged { codes } => {
+            out.push(3);
+            put_u32(out, codes.len() as u32);
+            for code in codes.iter() {
+                put_u32(out, code.as_raw());
+            }
+        }
+        CameraEvent::LiveViewPropertyChanged { codes } => {
+            out.push(4);
+            out.push(codes.is_overflowed() as u8);
+            put_u32(out, codes.len() as u32);
+            for &code in codes.iter() {
+                put_u32(out, code);
+            }
+        }
+        CameraEvent::DownloadComplete { filename } => {
+            out.push(5);
+            put_str(out, filename);
+        }
+        CameraEvent::ContentsTransfer {
+            notify,
+            handle,
+            filename,
+        } => {
+            out.push(6);
+            put_u32(out, *notify);
+            put_u64(out, *handle);
+            put_opt_str(out, filename.as_deref());
+        }
+        CameraEvent::Warning { code, params } => {
+            out.push(7);
+            put_u32(out, *code);
+            match params {
+                Some((p1, p2, p3)) => {
+                    out.push(1);
+                    for value in [p1, p2, p3] {
+                        out.extend_from_slice(&value.to_le_bytes());
+                    }
+                }
+                None => out.push(0),
+            }
+        }
+        CameraEvent::Error { code } => {
+            out.push(8);
+            put_u32(out, *code);
+        }
+        CameraEvent::RemoteTransferProgress {
+            notify,
+            percent,
+            filename,
+        } => {
+            out.push(9);
+            put_u32(out, *notify);
+            put_u32(out, *percent);
+            put_opt_str(out, filename.as_deref());
+        }
+        CameraEvent::RemoteTransferData {
+            notify, percent, ..
+        } => {
+            out.push(10);
+            put_u32(out, *notify);
+            put_u32(out, *percent);
+        }
+        CameraEvent::ContentsListChanged {
+            notify,
+            slot,
+            added,
+        } => {
+            out.push(11);
+            put_u32(out, *notify);
+            put_u32(out, *slot);
+            put_u32(out, *added);
+        }
+        CameraEvent::FirmwareUpdateProgress { notify } => {
+            out.push(12);
+            put_u32(out, *notify);
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Decoding
+// -----------------------------------------------------------------------------
+
+struct Decoder<'a>(&'a [u8]);
+
+impl<'a> Decoder<'a> {
+    fn take(&mut self, len: usize) -> Result<&'a [u8]> {
+        if self.0.len() < len {
+            return Err(corrupt("record ends early"));
+        }
+        let (head, rest) = self.0.split_at(len);
+        self.0 = rest;
+        Ok(head)
+    }
+
+    fn u8(&mut self) -> Result<u8> {
+        Ok(self.take(1)?[0])
+    }
+
+    fn u32(&mut self) -> Result<u32> {
+        Ok(u32::from_le_bytes(self.take(4)?.try_into().unwrap()))
+    }
+
+    fn u64(&mut self) -> Result<u64> {
+        Ok(u64::from_le_bytes(self.take(8)?.try_into().unwrap()))
+    }
+
+    fn i32(&mut self) -> Result<i32> {
+        Ok(self.u32()? as i32)
+    }
+
+    fn i64(&mut self) -> Result<i64> {
+        Ok(self.u64()? as i64)
+    }
+
+    fn string(&mut self) -> Result<String> {
+        let len = self.u32()? as usize;
+        String::from_utf8(self.take(len)?.to_vec()).map_err(|_| corrupt("invalid UTF-8"))
+    }
+
+    fn opt_string(&mut self) -> Result<Option<String>> {
+        Ok(match self.u8()? {
+            0 => None,
+            _ => Some(self.string()?),
+        })
+    }
+
+    fn opt_shared(&mut self) -> Result<Option<Arc<str>>> {
+        Ok(self.opt_string()?.map(Arc::from))
+    }
+
+    fn properties(&mut self) -> Result<Vec<DeviceProperty>> {
+        (0..self.u32()?).map(|_| self.property()).collect()
+    }
+
+    fn property(&mut self) -> Result<DeviceProperty> {
+        let code = self.u32()?;
+        let data_type = match self.u8()? {
+            1 => DataType::UInt8,
+            2 => DataType::UInt16,
+            3 => DataType::UInt32,
+            4 => DataType::UInt64,
+            5 => DataType::Int8,
+            6 => DataType::Int16,
+            7 => DataType::Int32,
+            8 => DataType::Int64,
+            9 => DataType::String,
+            _ => DataType::Unknown(self.u32()?),
+        };
+        let enable_flag = match self.u8()? {
+            1 => EnableFlag::Disabled,
+            2 => EnableFlag::ReadWrite,
+            3 => EnableFlag::ReadOnly,
+            4 => EnableFlag::WriteOnly,
+            _ => EnableFlag::NotSupported,
+        };
+        let current_value = self.u64()?;
+        let current_string = self.opt_string()?;
+        let constraint = match self.u8()? {
+            1 => {
+                let values: Vec<u64> = (0..self.u32()?)
+                    .map(|_| self.u64())
+                    .collect::<Result<_>>()?;
+                ValueConstraint::Discrete(DiscreteValues::new(&values))
+            }
+            2 => ValueConstraint::Range {
+                min: self.i64()?,
+                max: self.i64()?,
+                step: self.i64()?,
+            },
+            _ => ValueConstraint::None,
+        };
+        Ok(DeviceProperty {
+            code,
+            data_type,
+            enable_flag,
+            current_value,
+            current_string,
+            constraint,
+        })
+    }
+
+    fn event(&mut self) -> Result<CameraEvent> {
+        Ok(match self.u8()? {
+            1 => CameraEvent::Connected {
+                version: self.u32()?,
+            },
+            2 => CameraEvent::Disconnected { error: self.u32()? },
+            3 => {
+                let codes: Vec<u32> = (0..self.u32()?)
+                    .map(|_| self.u32())
+                    .collect::<Result<_>>()?;
+                CameraEvent::PropertyChanged {
+                    codes: PropertyCodeSet::from_raw_codes(&codes),
+                }
+            }
+            4 => {
+                let overflowed = self.u8()? != 0;
+                let mut codes = LiveViewCodes::new();
+                for _ in 0..self.u32()? {
+                    codes.insert(self.u32()?);
+                }
+                if overflowed {
+                    codes.set_overflowed();
+                }
+                CameraEvent::LiveViewPropertyChanged { codes }
+            }
+            5 => CameraEvent::DownloadComplete {
+                filename: self.string()?.into(),
+            },
+            6 => CameraEvent::ContentsTransfer {
+                notify: self.u32()?,
+                handle: self.u64()?,
+                filename: self.opt_shared()?,
+            },
+            7 => {
+                let code = self.u32()?;
+                let params = match self.u8()? {
+                    0 => None,
+                    _ => Some((self.i32()?, self.i32()?, self.i32()?)),
+                };
+                CameraEvent::Warning { code, params }
+            }
+            8 => CameraEvent::Error { code: self.u32()? },
+            9 => CameraEvent::RemoteTransferProgress {
+                notify: self.u32()?,
+                percent: self.u32()?,
+                filename: self.opt_shared()?,
+            },
+            10 => CameraEvent::RemoteTransferData {
+                notify: self.u32()?,
+                percent: self.u32()?,
+                data: Vec::new(),
+            },
+            11 => CameraEvent::ContentsListChanged {
+                notify: self.u32()?,
+                slot: self.u32()?,
+                added: self.u32()?,
+            },
+            12 => CameraEvent::FirmwareUpdateProgress {
+                notify: self.u32()?,
+            },
+            tag => return Err(corrupt(&format!("unknown event tag {}", tag))),
+        })
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crsdk_sys::DevicePropertyCode;
+
+    fn prop(code: DevicePropertyCode, value: u64) -> DeviceProperty {
+        DeviceProperty {
+            code: code.as_raw(),
+            data_type: DataType::UInt32,
+            enable_flag: EnableFlag::ReadWrite,
+            current_value: value,
+            current_string: None,
+            constraint: ValueConstraint::Discrete(vec![100, 200, 400].into()),
+        }
+    }
+
+    fn log(write: impl FnOnce(&mut StateLogWriter<Vec<u8>>)) -> Vec<u8> {
+        let mut writer = StateLogWriter::new(Vec::new()).unwrap();
+        write(&mut writer);
+        writer.into_inner().unwrap()
+    }
+
+    #[test]
+    fn test_properties_are_delta_encoded() {
+        let iso = DevicePropertyCode::IsoSensitivity;
+        let fnum = DevicePropertyCode::FNumber;
+        let bytes = log(|w| {
+            w.write_properties(0, &[prop(iso, 100), prop(fnum, 280)])
+                .unwrap();
+            // Unchanged state writes nothing
+            w.write_properties(0, &[prop(iso, 100), prop(fnum, 280)])
+                .unwrap();
+            w.write_properties(0, &[prop(iso, 400)]).unwrap();
+        });
+
+        let reader = StateLogReader::from_bytes(bytes).unwrap();
+        assert_eq!(reader.len(), 2);
+        let entries: Vec<_> = reader.entries().map(Result::unwrap).collect();
+        match &entries[1].record {
+            LogRecord::Delta { changed, removed } => {
+                assert_eq!(changed, &[prop(iso, 400)]);
+                assert_eq!(removed, &[fnum.as_raw()]);
+            }
+            other => panic!("expected a delta, got {:?}", other),
+        }
+
+        let end = reader.time_range().unwrap().end;
+        assert_eq!(reader.properties_at(0, end).unwrap(), vec![prop(iso, 400)]);
+        assert!(reader.properties_at(1, end).unwrap().is_empty());
+    }
+
+    #[test]
+    fn test_keyframes_bound_replay() {
+        let iso = DevicePropertyCode::IsoSensitivity;
+        let bytes = log(|w| {
+            for i in 0..=KEYFRAME_INTERVAL as u64 + 1 {
+                w.write_properties(7, &[prop(iso, i)]).unwrap();
+            }
+        });
+
+        let reader = StateLogReader::from_bytes(bytes).unwrap();
+        let snapshots = reader
+            .entries()
+            .filter(|e| matches!(e.as_ref().unwrap().record, LogRecord::Snapshot(_)))
+            .count();
+        assert_eq!(snapshots, 2);
+        let end = reader.time_range().unwrap().end;
+        let state = reader.properties_at(7, end).unwrap();
+        assert_eq!(state[0].current_value, KEYFRAME_INTERVAL as u64 + 1);
+    }
+
+    #[test]
+    fn test_properties_at_with_time_going_back() {
+        let iso = DevicePropertyCode::IsoSensitivity;
+        let mut bytes = log(|w| {
+            for value in [100, 200, 400, 800] {
+                w.write_properties(0, &[prop(iso, value)]).unwrap();
+            }
+        });
+
+        // Restamp as if a second writer appended after the clock went back:
+        // 100 at 10 s, 200 at 20 s, then 400 at 5 s and 800 at 6 s
+        let mut offset = HEADER_LEN;
+        for secs in [10u64, 20, 5, 6] {
+            let len = u32::from_le_bytes(bytes[offset..offset + 4].try_into().unwrap()) as usize;
+            bytes[offset + 5..offset + 13].copy_from_slice(&(secs * 1_000_000).to_le_bytes());
+            offset += 4 + len;
+        }
+
+        let reader = StateLogReader::from_bytes(bytes).unwrap();
+        let at = |secs| {
+            let state = reader
+                .properties_at(0, UNIX_EPOCH + Duration::from_secs(secs))
+                .unwrap();
+            state.first().map(|p| p.current_value)
+        };
+        assert_eq!(at(4), None);
+        assert_eq!(at(5), Some(400));
+        assert_eq!(at(15), Some(800));
+        assert_eq!(
+            reader.time_range().unwrap(),
+            UNIX_EPOCH + Duration::from_secs(5)..UNIX_EPOCH + Duration::from_secs(20)
+        );
+    }
+
+    #[test]
+    fn test_events_round_trip_per_camera() {
+        let bytes = log(|w| {
+            w.write_camera(0, "ILME-FX3").unwrap();
+            w.write_camera(1, "ILCE-1").unwrap();
+            w.write_event(
+                0,
+                &CameraEvent::Warning {
+                    code: 0x00060001,
+                    params: Some((2, -1, 0)),
+                },
+            )
+            .unwrap();
+            w.write_event(
+                1,
+                &CameraEvent::ContentsTransfer {
+                    notify: 1,
+                    handle: 42,
+                    filename: Some("DSC00001.JPG".into()),
+                },
+            )
+            .unwrap();
+        });
+
+        let reader = StateLogReader::from_bytes(bytes).unwrap();
+        assert_eq!(
+            reader.cameras().unwrap(),
+            vec![
+                (0, Some("ILME-FX3".to_string())),
+                (1, Some("ILCE-1".to_string()))
+            ]
+        );
+
+        let all = UNIX_EPOCH..SystemTime::now() + Duration::from_secs(1);
+        let events: Vec<_> = reader.events(Some(1), all).map(Result::unwrap).collect();
+        assert_eq!(events.len(), 1);
+        match &events[0].2 {
+            CameraEvent::ContentsTransfer {
+                handle, filename, ..
+            } => {
+                assert_eq!(*handle, 42);
+                assert_eq!(filename.as_deref(), Some("DSC00001.JPG"));
+            }
+            other => panic!("expected a transfer event, got {:?}", other),
+        }
+    }
+
+    #[test]
+    fn test_torn_record_is_ignored() {
+        let mut bytes = log(|w| {
+            w.write_camera(0, "ILME-FX3").unwrap();
+            w.write_camera(0, "renamed").unwrap();
+        });
+        bytes.truncate(bytes.len() - 3);
+
+        let reader = StateLogReader::from_bytes(bytes).unwrap();
+        assert_eq!(reader.len(), 1);
+        assert!(reader.is_truncated());
+        assert!(StateLogReader::from_bytes(b"not a log at all".to_vec()).is_err());
+    }
+
+    #[test]
+    fn test_append_cuts_off_torn_record() {
+        let path = std::env::temp_dir().join(format!("crsdk-state-log-{}.log", std::process::id()));
+        let mut bytes = log(|w| {
+            w.write_camera(0, "ILME-FX3").unwrap();
+            w.write_camera(0, "renamed").unwrap();
+        });
+        bytes.truncate(bytes.len() - 3);
+        std::fs::write(&path, &bytes).unwrap();
+
+        let mut writer = StateLogWriter::append(&path).unwrap();
+        writer.write_camera(1, "ILCE-1").unwrap();
+        drop(writer.into_inner().unwrap());
+
+        let reader = StateLogReader::open(&path).unwrap();
+        assert!(!reader.is_truncated());
+        assert_eq!(
+            reader.cameras().unwrap(),
+            vec![
+                (0, Some("ILME-FX3".to_string())),
+                (1, Some("ILCE-1".to_string()))
+            ]
+        );
+        drop(reader);
+        std::fs::remove_file(&path).unwrap();
+    }
+}
@@ -0,0 +1,220 @@
+//! Zero-copy sinks for in-memory remote transfers
+//!
+//! By default every chunk of an in-memory transfer is copied into a fresh
+//! `Vec<u8>` and queued as a [`CameraEvent::RemoteTransferData`]. For RAW and
+//! movie pulls that is one allocation per chunk, and the queue grows without
+//! bound when the consumer falls behind.
+//!
+//! Installing a [`TransferSink`] on the device routes chunks straight into the
+//! sink on the SDK thread instead. Only a lightweight
+//! [`CameraEvent::RemoteTransferProgress`] is queued per chunk, so consumers
+//! still see progress. [`TransferBuffer`] is a ready-made sink that writes into
+//! preallocated memory.
+//!
+//! [`CameraEvent::RemoteTransferData`]: crate::CameraEvent::RemoteTransferData
+//! [`CameraEvent::RemoteTransferProgress`]: crate::CameraEvent::RemoteTransferProgress
+
+use crate::error::{Error, Result};
+use std::sync::{Arc, Mutex, RwLock};
+
+/// Receives remote transfer data as the SDK delivers it
+///
+/// Called on the SDK callback thread, so implementations must not block for
+/// long. `data` is only valid for the duration of the call.
+pub trait TransferSink: Send + Sync {
+    /// Handle one chunk of transfer data
+    fn on_data(&self, notify: u32, percent: u32, data: &[u8]);
+
+    /// Called once the camera reports the transfer finished or failed
+    ///
+    /// The default does nothing.
+    fn on_finished(&self, _result: Result<()>) {}
+}
+
+/// A transfer sink backed by one preallocated, reusable buffer
+///
+/// Chunks are appended in place; memory is never grown past the capacity
+/// given at construction. Data that doesn't fit is discarded and the buffer
+/// is flagged as overflowed. Call [`clear`](Self::clear) between transfers
+/// to reuse the allocation.
+#[derive(Debug, Clone)]
+pub struct TransferBuffer {
+    inner: Arc<Mutex<BufferState>>,
+}
+
+#[derive(Debug)]
+struct BufferState {
+    data: Vec<u8>,
+    overflowed: bool,
+    percent: u32,
+}
+
+impl TransferBuffer {
+    /// Create a buffer that holds up to `capacity` bytes
+    pub fn with_capacity(capacity: usize) -> Self {
+        Self {
+            inner: Arc::new(Mutex::new(BufferState {
+                data: Vec::with_capacity(capacity),
+                overflowed: false,
+                percent: 0,
+            })),
+        }
+    }
+
+    /// Maximum number of bytes the buffer holds
+    pub fn capacity(&self) -> usize {
+        self.inner.lock().unwrap().data.capacity()
+    }
+
+    /// Number of bytes received so far
+    pub fn len(&self) -> usize {
+        self.inner.lock().unwrap().data.len()
+    }
+
+    /// Check whether no data has been received
+    pub fn is_empty(&self) -> bool {
+        self.len() == 0
+    }
+
+    /// Check whether data was discarded because the buffer was full
+    pub fn is_overflowed(&self) -> bool {
+        self.inner.lock().unwrap().overflowed
+    }
+
+    /// Last progress percentage reported by the SDK
+    pub fn percent(&self) -> u32 {
+        self.inner.lock().unwrap().percent
+    }
+
+    /// Run `f` with the received data without copying it
+    pub fn with_data<R>(&self, f: impl FnOnce(&[u8]) -> R) -> R {
+        f(&self.inner.lock().unwrap().data)
+    }
+
+    /// Copy the received data out
+    pub fn to_vec(&self) -> Vec<u8> {
+        self.with_data(|data| data.to_vec())
+    }
+
+    /// Reset the buffer for the next transfer, keeping its allocation
+    pub fn clear(&self) {
+        let mut state = self.inner.lock().unwrap();
+        state.data.clear();
+        state.overflowed = false;
+        state.percent = 0;
+    }
+}
+
+impl TransferSink for TransferBuffer {
+    fn on_data(&self, _notify: u32, percent: u32, data: &[u8]) {
+        let mut state = self.inner.lock().unwrap();
+        let room = state.data.capacity() - state.data.len();
+        if data.len() > room {
+            state.overflowed = true;
+        }
+        let take = data.len().min(room);
+        state.data.extend_from_slice(&data[..take]);
+        state.percent = percent;
+    }
+}
+
+/// Slot shared between a device and its event sender holding the active sink
+#[derive(Clone, Default)]
+pub(crate) struct TransferSinkSlot {
+    sink: Arc<RwLock<Option<Arc<dyn TransferSink>>>>,
+}
+
+impl TransferSinkSlot {
+    /// Replace the active sink
+    pub(crate) fn set(&self, sink: Option<Arc<dyn TransferSink>>) {
+        *self.sink.write().unwrap() = sink;
+    }
+
+    /// Hand `data` to the active sink, returning false if none is installed
+    pub(crate) fn deliver(&self, notify: u32, percent: u32, data: &[u8]) -> bool {
+        match self.sink.read().unwrap().as_ref() {
+            Some(sink) => {
+                sink.on_data(notify, percent, data);
+                true
+            }
+            None => false,
+        }
+    }
+
+    /// Tell the active sink if `notify` ends the transfer
+    pub(crate) fn finish(&self, notify: u32) {
+        let Some(result) = transfer_result(notify) else {
+            return;
+        };
+        if let Some(sink) = self.sink.read().unwrap().as_ref() {
+            sink.on_finished(result);
+        }
+    }
+}
+
+/// Outcome of a remote transfer notification, `None` while still running
+fn transfer_result(notify: u32) -> Option<Result<()>> {
+    // SAFETY: pure lookup on a notification code
+    match unsafe { crsdk_sys::crsdk_remote_transfer_status(notify) } {
+        crsdk_sys::CRSDK_RT_OK => Some(Ok(())),
+        crsdk_sys::CRSDK_RT_FAILED => Some(Err(Error::Other("Remote transfer failed".to_string()))),
+        crsdk_sys::CRSDK_RT_BUSY => Some(Err(Error::Other(
+            "Camera busy, remote transfer refused".to_string(),
+        ))),
+        _ => None,
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_transfer_buffer_appends_in_place() {
+        let buffer = TransferBuffer::with_capacity(8);
+        buffer.on_data(0, 50, &[1, 2, 3]);
+        buffer.on_data(0, 100, &[4, 5]);
+
+        assert_eq!(buffer.to_vec(), vec![1, 2, 3, 4, 5]);
+        assert_eq!(buffer.percent(), 100);
+        assert!(!buffer.is_overflowed());
+    }
+
+    #[test]
+    fn test_transfer_buffer_never_grows() {
+        let buffer = TransferBuffer::with_capacity(4);
+        let capacity = buffer.capacity();
+        buffer.on_data(0, 10, &[0; 3]);
+        buffer.on_data(0, 20, &[0; 3]);
+
+        assert_eq!(buffer.len(), capacity);
+        assert_eq!(buffer.capacity(), capacity);
+        assert!(buffer.is_overflowed());
+    }
+
+    #[test]
+    fn test_transfer_buffer_clear_keeps_allocation() {
+        let buffer = TransferBuffer::with_capacity(16);
+        let capacity = buffer.capacity();
+        buffer.on_data(0, 100, &[9; 16]);
+        buffer.clear();
+
+        assert!(buffer.is_empty());
+        assert!(!buffer.is_overflowed());
+        assert_eq!(buffer.capacity(), capacity);
+    }
+
+    #[test]
+    fn test_sink_slot_delivery() {
+        let slot = TransferSinkSlot::default();
+        assert!(!slot.deliver(0, 0, &[1]));
+
+        let buffer = TransferBuffer::with_capacity(4);
+        slot.set(Some(Arc::new(buffer.clone())));
+        assert!(slot.deliver(0, 100, &[1, 2]));
+        assert_eq!(buffer.to_vec(), vec![1, 2]);
+
+        slot.set(None);
+        assert!(!slot.deliver(0, 0, &[3]));
+    }
+}
@@ -4,6 +4,7 @@ use crate::error::{Error, Result};
 use std::fmt;
 use std::net::Ipv4Addr;
 use std::str::FromStr;
+use std::sync::Arc;
 
 /// Convert a Rust type to its CRSDK representation
 pub trait ToCrsdk<T> {
@@ -16,7 +17,7 @@ pub trait FromCrsdk<T>: Sized {
 }
 
 /// MAC address (6 bytes)
-#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+#[derive(Debug, Clone, Copy, PartialEq, Eq, PartialOrd, Ord, Hash)]
 pub struct MacAddr(pub [u8; 6]);
 
 impl MacAddr {
@@ -115,6 +116,34 @@ impl CameraModel {
         CameraModel::Alpha9Ii,
         CameraModel::Alpha9Iii,
     ];
+
+    /// Model name the SDK reports for this body (e.g. "ILME-FX3")
+    pub fn model_name(&self) -> &'static str {
+        match self {
+            CameraModel::Fx3 => "ILME-FX3",
+            CameraModel::Fx6 => "ILME-FX6",
+            CameraModel::Fx30 => "ILME-FX30",
+            CameraModel::Alpha1 => "ILCE-1",
+            CameraModel::Alpha7Iv => "ILCE-7M4",
+            CameraModel::Alpha7Rv => "ILCE-7RM5",
+            CameraModel::Alpha7Siii => "ILCE-7SM3",
+            CameraModel::Alpha9Ii => "ILCE-9M2",
+            CameraModel::Alpha9Iii => "ILCE-9M3",
+        }
+    }
+
+    /// Look up a model by the name discovery reports, as in
+    /// [`DiscoveredCamera::model`]
+    ///
+    /// Regional suffixes (e.g. "ILME-FX6V") are accepted.
+    pub fn from_model_name(name: &str) -> Option<Self> {
+        let name = name.trim();
+        // Only letters may follow, so "ILME-FX30" isn't taken for "ILME-FX3"
+        Self::ALL.iter().copied().find(|model| {
+            name.strip_prefix(model.model_name())
+                .is_some_and(|suffix| suffix.chars().all(|c| c.is_ascii_alphabetic()))
+        })
+    }
 }
 
 impl ToCrsdk<u32> for CameraModel {
@@ -153,12 +182,12 @@ impl fmt::Display for ConnectionType {
 }
 
 /// A camera discovered through network/USB enumeration
-#[derive(Debug, Clone)]
+#[derive(Debug, Clone, PartialEq, Eq)]
 pub struct DiscoveredCamera {
-    /// Camera model name (e.g., "ILME-FX3")
-    pub model: String,
+    /// Camera model name (e.g., "ILME-FX3"), shared between cameras of the same model
+    pub model: Arc<str>,
     /// Device name
-    pub name: String,
+    pub name: Arc<str>,
     /// Connection type
     pub connection_type: ConnectionType,
     /// IP address (for network connections)
@@ -253,6 +282,25 @@ mod tests {
         assert_eq!(ip.to_crsdk(), 0x64_01_a8_c0);
     }
 
+    #[test]
+    fn test_camera_model_from_name() {
+        for &model in CameraModel::ALL {
+            assert_eq!(
+                CameraModel::from_model_name(model.model_name()),
+                Some(model)
+            );
+        }
+        assert_eq!(
+            CameraModel::from_model_name("ILME-FX30"),
+            Some(CameraModel::Fx30)
+        );
+        assert_eq!(
+            CameraModel::from_model_name("ILME-FX6V"),
+            Some(CameraModel::Fx6)
+        );
+        assert_eq!(CameraModel::from_model_name("ILCE-7M3"), None);
+    }
+
     #[test]
     fn test_connection_type_display() {
         assert_eq!(ConnectionType::Network.to_string(), "Network");
@@ -262,8 +310,8 @@ mod tests {
     #[test]
     fn test_discovered_camera_is_network() {
         let camera = DiscoveredCamera {
-            model: "ILME-FX3".to_string(),
-            name: "ILME-FX3".to_string(),
+            model: "ILME-FX3".into(),
+            name: "ILME-FX3".into(),
             connection_type: ConnectionType::Network,
             ip_address: Some("192.168.1.100".parse().unwrap()),
             mac_address: Some("00:00:00:00:00:00".parse().unwrap()),
@@ -278,8 +326,8 @@ mod tests {
     #[test]
     fn test_discovered_camera_is_usb() {
         let camera = DiscoveredCamera {
-            model: "ILME-FX3".to_string(),
-            name: "ILME-FX3".to_string(),
+            model: "ILME-FX3".into(),
+            name: "ILME-FX3".into(),
             connection_type: ConnectionType::Usb,
             ip_address: None,
             mac_address: None,
@@ -294,8 +342,8 @@ mod tests {
     #[test]
     fn test_discovered_camera_display_network() {
         let camera = DiscoveredCamera {
-            model: "ILME-FX3".to_string(),
-            name: "ILME-FX3".to_string(),
+            model: "ILME-FX3".into(),
+            name: "ILME-FX3".into(),
             connection_type: ConnectionType::Network,
             ip_address: Some("192.168.1.100".parse().unwrap()),
             mac_address: Some("00:00:00:00:00:00".parse().unwrap()),
@@ -309,8 +357,8 @@ mod tests {
     #[test]
     fn test_discovered_camera_display_usb() {
         let camera = DiscoveredCamera {
-            model: "ILCE-7M4".to_string(),
-            name: "ILCE-7M4".to_string(),
+            model: "ILCE-7M4".into(),
+            name: "ILCE-7M4".into(),
             connection_type: ConnectionType::Usb,
             ip_address: None,
             mac_address: None,
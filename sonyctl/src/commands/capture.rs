@@ -1,8 +1,68 @@
-use crsdk::Result;
+use clap::Args as ClapArgs;
+use crsdk::{BufferPolicy, IntervalPlan, IntervalStop, Result, ShotOutcome};
+use std::ops::ControlFlow;
+use std::time::Duration;
 
-pub fn run(device: &crsdk::blocking::CameraDevice) -> Result<()> {
-    println!("Capturing...");
-    device.capture()?;
-    println!("✓ Capture complete");
+#[derive(ClapArgs)]
+pub struct Args {
+    /// Repeat the capture every this many seconds (host-timed, no drift)
+    #[arg(long)]
+    pub interval: Option<f64>,
+
+    /// Number of shots with --interval (runs until interrupted if omitted)
+    #[arg(long, requires = "interval")]
+    pub count: Option<u32>,
+
+    /// Half-press the shutter this many milliseconds before each shot
+    #[arg(long, requires = "interval")]
+    pub s1_lead_ms: Option<u64>,
+
+    /// Retry shots the camera rejects while its buffer is full
+    #[arg(long, requires = "interval")]
+    pub queue: bool,
+}
+
+pub fn run(device: &crsdk::blocking::CameraDevice, args: &Args) -> Result<()> {
+    let Some(interval) = args.interval else {
+        println!("Capturing...");
+        device.capture()?;
+        println!("✓ Capture complete");
+        return Ok(());
+    };
+
+    let interval = Duration::try_from_secs_f64(interval)
+        .map_err(|_| crsdk::Error::InvalidParameter("invalid --interval".into()))?;
+    let plan = IntervalPlan {
+        shots: args.count,
+        s1_lead: args.s1_lead_ms.map(Duration::from_millis),
+        buffer_policy: if args.queue {
+            BufferPolicy::Queue
+        } else {
+            BufferPolicy::Skip
+        },
+        ..IntervalPlan::new(interval)
+    };
+
+    println!("Shooting every {:?}...", interval);
+    let report = device.run_interval(&plan, |shot| {
+        match shot.outcome {
+            ShotOutcome::Skipped => println!("  #{:<5} skipped", shot.index + 1),
+            _ => println!(
+                "  #{:<5} {:?} (latency {:?})",
+                shot.index + 1,
+                shot.timing_error().unwrap_or_default(),
+                shot.send_latency
+            ),
+        }
+        ControlFlow::Continue(())
+    })?;
+
+    if report.stop == IntervalStop::StorageFull {
+        println!("Stopped: memory card full");
+    }
+    println!(
+        "✓ {} shots, {} skipped, {} retried, worst timing error {:?}",
+        report.fired, report.skipped, report.retried, report.max_timing_error
+    );
     Ok(())
 }
@@ -2,6 +2,8 @@ pub mod capture;
 pub mod info;
 pub mod props;
 pub mod record;
+pub mod record_log;
+pub mod replay_log;
 
 use clap::Subcommand;
 use crsdk::{CameraDevice, CameraModel, DeviceProperty, Result, TypedValue};
@@ -19,8 +21,8 @@ pub enum Command {
         #[command(subcommand)]
         action: props::Args,
     },
-    /// Capture a photo
-    Capture,
+    /// Capture a photo, once or on an interval
+    Capture(capture::Args),
     /// Video recording control
     Record {
         #[command(subcommand)]
@@ -28,6 +30,10 @@ pub enum Command {
     },
     /// Show camera info
     Info,
+    /// Record property snapshots and events to a binary log
+    RecordLog(record_log::Args),
+    /// Print a log written by record-log (no camera needed)
+    ReplayLog(replay_log::Args),
 }
 
 pub async fn run(cli: &Cli) -> anyhow::Result<()> {
@@ -35,16 +41,25 @@ pub async fn run(cli: &Cli) -> anyhow::Result<()> {
         Command::Tui(args) => {
             tui::run(cli, args).await?;
         }
+        Command::ReplayLog(args) => {
+            replay_log::run(args)?;
+        }
         _ => {
-            let device = connect(cli).await?;
+            // The log names the camera; ask discovery before the connection
+            // takes over the SDK
+            let camera_name = match &cli.command {
+                Command::RecordLog(_) => discovered_model(cli).await,
+                _ => None,
+            };
+            let mut device = connect(cli).await?;
 
             match &cli.command {
-                Command::Tui(_) => unreachable!(),
+                Command::Tui(_) | Command::ReplayLog(_) => unreachable!(),
                 Command::Props { action } => {
                     props::run(&device, action)?;
                 }
-                Command::Capture => {
-                    capture::run(&device)?;
+                Command::Capture(args) => {
+                    capture::run(&device, args)?;
                 }
                 Command::Record { action } => {
                     record::run(&device, action)?;
@@ -52,12 +67,34 @@ pub async fn run(cli: &Cli) -> anyhow::Result<()> {
                 Command::Info => {
                     info::run(&device)?;
                 }
+                Command::RecordLog(args) => {
+                    let camera_name = camera_name.as_deref().unwrap_or("unknown");
+                    record_log::run(&mut device, camera_name, args)?;
+                }
             }
         }
     }
     Ok(())
 }
 
+/// Seconds the pre-connect scan in `discovered_model` waits for answers
+const DISCOVERY_SECS: u8 = 2;
+
+/// Model name discovery reports for the camera at `--mac`, if it answers
+pub async fn discovered_model(cli: &Cli) -> Option<String> {
+    let mac: crsdk::MacAddr = cli.mac.as_ref()?.parse().ok()?;
+    match crsdk::discover_cameras(DISCOVERY_SECS).await {
+        Ok(cameras) => cameras
+            .into_iter()
+            .find(|camera| camera.mac_address == Some(mac))
+            .map(|camera| camera.model.to_string()),
+        Err(e) => {
+            eprintln!("Discovery failed: {}", e);
+            None
+        }
+    }
+}
+
 pub async fn connect(cli: &Cli) -> Result<crsdk::blocking::CameraDevice> {
     let ip = cli
         .ip
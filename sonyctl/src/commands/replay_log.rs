@@ -0,0 +1,94 @@
+use chrono::{DateTime, Local};
+use clap::Args as ClapArgs;
+use crsdk::{property_display_name, LogRecord, Result, StateLogReader};
+use crsdk_sys::DevicePropertyCode;
+use std::path::PathBuf;
+use std::time::SystemTime;
+
+use super::format_value;
+
+#[derive(ClapArgs)]
+pub struct Args {
+    /// Log file to read
+    pub file: PathBuf,
+
+    /// Only show records for this camera id
+    #[arg(long)]
+    pub camera: Option<u32>,
+
+    /// Print each camera's final property state instead of every record
+    #[arg(long)]
+    pub state: bool,
+}
+
+pub fn run(args: &Args) -> Result<()> {
+    let log = StateLogReader::open(&args.file)?;
+    if log.is_truncated() {
+        eprintln!("warning: log ends in a partly written record, ignoring it");
+    }
+
+    if args.state {
+        let Some(range) = log.time_range() else {
+            return Ok(());
+        };
+        for (camera, name) in log.cameras()? {
+            if args.camera.is_some_and(|c| c != camera) {
+                continue;
+            }
+            println!(
+                "Camera {} ({})",
+                camera,
+                name.as_deref().unwrap_or("unnamed")
+            );
+            for prop in log.properties_at(camera, range.end)? {
+                print_property("  ", prop.code, prop.current_value);
+            }
+        }
+        return Ok(());
+    }
+
+    for entry in log.entries() {
+        let entry = entry?;
+        if args.camera.is_some_and(|c| c != entry.camera) {
+            continue;
+        }
+        let prefix = format!("{} [{}]", timestamp(entry.time), entry.camera);
+        match entry.record {
+            LogRecord::Camera { name } => println!("{} camera {}", prefix, name),
+            LogRecord::Snapshot(props) => {
+                println!("{} snapshot of {} properties", prefix, props.len())
+            }
+            LogRecord::Delta { changed, removed } => {
+                for prop in changed {
+                    print_property(&format!("{} ", prefix), prop.code, prop.current_value);
+                }
+                for code in removed {
+                    println!("{} {} removed", prefix, name(code));
+                }
+            }
+            LogRecord::Event(event) => println!("{} {}", prefix, event),
+        }
+    }
+    Ok(())
+}
+
+fn timestamp(time: SystemTime) -> String {
+    DateTime::<Local>::from(time)
+        .format("%Y-%m-%d %H:%M:%S%.3f")
+        .to_string()
+}
+
+fn name(code: u32) -> String {
+    match DevicePropertyCode::from_raw(code) {
+        Some(code) => property_display_name(code).to_string(),
+        None => format!("0x{:08X}", code),
+    }
+}
+
+fn print_property(prefix: &str, code: u32, raw: u64) {
+    let value = match DevicePropertyCode::from_raw(code) {
+        Some(code) => format_value(code, raw),
+        None => raw.to_string(),
+    };
+    println!("{}{} = {}", prefix, name(code), value);
+}
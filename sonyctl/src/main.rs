@@ -35,9 +35,17 @@
 //! # Capture a photo
 //! sonyctl capture
 //!
+//! # Timelapse: 300 shots, one every 5 seconds
+//! sonyctl capture --interval 5 --count 300
+//!
 //! # Start/stop recording
 //! sonyctl record start
 //! sonyctl record stop
+//!
+//! # Log properties (every 2 seconds) and events for an hour, then inspect it
+//! sonyctl record-log session.crlog --interval 2 --duration 3600
+//! sonyctl replay-log session.crlog
+//! sonyctl replay-log session.crlog --state
 //! ```
 
 mod commands;
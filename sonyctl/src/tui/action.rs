@@ -29,6 +29,8 @@ pub enum Action {
     StopRecording,
     ShowPropertyEditor,
     ShowEventsExpanded,
+    ShowStats,
+    ToggleAnalysis,
     Disconnect,
 
     // Property editor
@@ -1,6 +1,9 @@
+use std::cell::RefCell;
 use std::collections::VecDeque;
 use std::net::Ipv4Addr;
+use std::ops::{BitOr, BitOrAssign};
 use std::str::FromStr;
+use std::sync::Arc;
 use std::time::{Duration, Instant};
 
 use super::action::Action;
@@ -9,14 +12,17 @@ use super::camera_service::{
     SlotInfo,
 };
 use super::property::PropertyStore;
+use super::ui::PropertyRowCache;
 use crsdk::{
-    property_category, property_display_name, CameraModel, DevicePropertyCode, MacAddr,
-    PropertyCategoryId,
+    property_category, property_display_name, CameraModel, DevicePropertyCode, FrameAnalysis,
+    MacAddr, MetricsSnapshot, PropertyCategoryId,
 };
 
 const PROPERTY_DEBOUNCE_MS: u64 = 400;
 const IN_FLIGHT_TIMEOUT_MS: u64 = 2000;
 const MAX_EVENT_LOG_SIZE: usize = 100;
+/// Sharpness samples kept for the dashboard sparkline
+const SHARPNESS_HISTORY_LEN: usize = 64;
 
 #[derive(Debug, Clone, Copy, PartialEq, Eq, Default)]
 pub enum Screen {
@@ -25,6 +31,59 @@ pub enum Screen {
     Dashboard,
     PropertyEditor,
     EventsExpanded,
+    Stats,
+}
+
+impl Screen {
+    /// Panes drawn on this screen
+    pub fn panes(self) -> Dirty {
+        match self {
+            Screen::Discovery => Dirty::DISCOVERY,
+            Screen::Dashboard => Dirty::HEADER | Dirty::DASHBOARD | Dirty::EVENTS | Dirty::ANALYSIS,
+            Screen::PropertyEditor => Dirty::HEADER | Dirty::PROPERTIES,
+            Screen::EventsExpanded => Dirty::HEADER | Dirty::EVENTS,
+            Screen::Stats => Dirty::HEADER | Dirty::STATS,
+        }
+    }
+}
+
+/// Panes whose contents changed since the last draw
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Default)]
+pub struct Dirty(u8);
+
+impl Dirty {
+    pub const NONE: Self = Self(0);
+    /// Connection, exposure mode and recording indicator
+    pub const HEADER: Self = Self(1 << 0);
+    /// Camera info, pinned properties and session time
+    pub const DASHBOARD: Self = Self(1 << 1);
+    /// Property editor lists
+    pub const PROPERTIES: Self = Self(1 << 2);
+    pub const EVENTS: Self = Self(1 << 3);
+    pub const STATS: Self = Self(1 << 4);
+    pub const DISCOVERY: Self = Self(1 << 5);
+    /// Live view exposure and sharpness sparklines
+    pub const ANALYSIS: Self = Self(1 << 6);
+    /// Everything, e.g. after input, a resize or a modal
+    pub const ALL: Self = Self(u8::MAX);
+
+    pub fn intersects(self, other: Self) -> bool {
+        self.0 & other.0 != 0
+    }
+}
+
+impl BitOr for Dirty {
+    type Output = Self;
+
+    fn bitor(self, rhs: Self) -> Self {
+        Self(self.0 | rhs.0)
+    }
+}
+
+impl BitOrAssign for Dirty {
+    fn bitor_assign(&mut self, rhs: Self) {
+        self.0 |= rhs.0;
+    }
 }
 
 #[derive(Debug, Clone)]
@@ -161,6 +220,28 @@ pub struct DashboardState {
     pub recording_seconds: u64,
     pub session_seconds: u64,
     pub camera_info: CameraInfo,
+    /// Live view analysis, while it's turned on
+    pub analysis: Option<AnalysisView>,
+}
+
+/// Latest live view analysis with a short sharpness history
+#[derive(Debug, Clone)]
+pub struct AnalysisView {
+    pub latest: Arc<FrameAnalysis>,
+    /// Rounded sharpness scores, oldest first
+    pub sharpness: VecDeque<u64>,
+}
+
+impl AnalysisView {
+    fn push(&mut self, analysis: Arc<FrameAnalysis>) {
+        if let Some(score) = analysis.sharpness {
+            self.sharpness.push_back(score.round() as u64);
+            while self.sharpness.len() > SHARPNESS_HISTORY_LEN {
+                self.sharpness.pop_front();
+            }
+        }
+        self.latest = analysis;
+    }
 }
 
 #[derive(Debug, Clone, Copy, PartialEq, Eq, Default)]
@@ -211,11 +292,18 @@ pub struct App {
     pub property_editor: PropertyEditorState,
     pub events_log: EventsLogState,
     pub properties: PropertyStore,
+    /// Latest metrics snapshot from the camera service (while connected)
+    pub metrics: Option<MetricsSnapshot>,
 
     pub connected_camera: Option<ConnectedCamera>,
     pub is_connecting: bool,
     pub should_quit: bool,
 
+    /// Panes changed since the last draw
+    dirty: Dirty,
+    /// Property editor rows kept between draws, rebuilt only when they change
+    pub property_rows: RefCell<PropertyRowCache>,
+
     camera_service: CameraServiceHandle,
 
     /// Whether to automatically trust SSH fingerprints (--trust flag)
@@ -238,9 +326,12 @@ impl App {
             property_editor: PropertyEditorState::default(),
             events_log: EventsLogState::default(),
             properties: PropertyStore::new(),
+            metrics: None,
             connected_camera: None,
             is_connecting: false,
             should_quit: false,
+            dirty: Dirty::ALL,
+            property_rows: RefCell::default(),
             camera_service,
             trust_ssh_fingerprint,
             pending_property: None,
@@ -265,6 +356,42 @@ impl App {
         }
     }
 
+    /// Wait for the next camera service update
+    pub async fn recv_camera_update(&mut self) -> Option<CameraUpdate> {
+        self.camera_service.recv().await
+    }
+
+    /// Apply an update, along with any others already queued behind it
+    ///
+    /// Property storms arrive as many updates in a row; taking them all at
+    /// once lets the next frame show the burst in a single draw.
+    pub fn apply_camera_update(&mut self, update: CameraUpdate) {
+        self.handle_camera_update(update);
+        self.poll_camera_updates();
+    }
+
+    /// Flag panes for the next draw
+    pub fn mark_dirty(&mut self, panes: Dirty) {
+        self.dirty |= panes;
+    }
+
+    /// Whether anything on the current screen changed since the last draw
+    pub fn needs_redraw(&self) -> bool {
+        let mut visible = self.screen.panes();
+        if self.modal.is_some() || self.help_visible {
+            visible = Dirty::ALL;
+        }
+        self.dirty.intersects(visible)
+    }
+
+    /// Record that the UI was just drawn
+    ///
+    /// Panes off screen are cleared too: switching screens is an input,
+    /// which marks everything dirty again.
+    pub fn mark_drawn(&mut self) {
+        self.dirty = Dirty::NONE;
+    }
+
     /// Get the duration until the pending property should be flushed, if any
     pub fn debounce_timeout(&self) -> Option<Duration> {
         self.pending_property.map(|(_, _, timestamp)| {
@@ -315,6 +442,7 @@ impl App {
     fn handle_camera_update(&mut self, update: CameraUpdate) {
         match update {
             CameraUpdate::Connected { model, address } => {
+                self.mark_dirty(Dirty::ALL);
                 self.connected_camera = Some(ConnectedCamera { model, address });
                 self.is_connecting = false;
                 self.discovery.is_scanning = false;
@@ -322,9 +450,12 @@ impl App {
                 self.log_event("Connected", "Camera connected");
             }
             CameraUpdate::Disconnected { error } => {
+                self.mark_dirty(Dirty::ALL);
                 self.connected_camera = None;
                 self.is_connecting = false;
                 self.properties.set_loaded(false);
+                self.metrics = None;
+                self.dashboard.analysis = None;
                 self.screen = Screen::Discovery;
                 if let Some(err) = error {
                     self.log_event("Disconnected", &err);
@@ -333,6 +464,7 @@ impl App {
                 }
             }
             CameraUpdate::PropertiesLoaded => {
+                self.mark_dirty(Dirty::ALL);
                 self.properties.set_loaded(true);
                 self.log_event("Properties", "Loaded from camera");
 
@@ -376,24 +508,87 @@ impl App {
                 kind,
             } => {
                 // Clear in-flight state if this property was waiting for confirmation
+                let mut confirmed = false;
                 if let Some((in_flight_code, _)) = self.in_flight_property {
                     if in_flight_code == code {
                         tracing::debug!("Clearing in_flight_property for {:?}", code);
                         self.in_flight_property = None;
+                        confirmed = true;
                     }
                 }
-                self.properties
+
+                let mut panes = Dirty::PROPERTIES;
+                if self.properties.is_pinned(code) {
+                    panes |= Dirty::DASHBOARD;
+                }
+                if code == DevicePropertyCode::ExposureProgramMode {
+                    panes |= Dirty::HEADER;
+                }
+                let changed = self
+                    .properties
                     .update_property(code, &value, raw_value, available, writable, kind);
+                if changed || confirmed {
+                    self.mark_dirty(panes);
+                }
+            }
+            CameraUpdate::PropertyRemoved { code } => {
+                if self.properties.remove_property(code) {
+                    self.mark_dirty(Dirty::PROPERTIES | Dirty::DASHBOARD);
+                }
             }
             CameraUpdate::Error { message } => {
+                self.mark_dirty(Dirty::ALL);
                 self.log_event("Error", &message);
                 self.modal = Some(Modal::Error { message });
             }
             CameraUpdate::DiscoveryResult { cameras } => {
+                self.mark_dirty(Dirty::DISCOVERY);
                 self.discovery.cameras = cameras.into_iter().map(DiscoveredCamera::from).collect();
                 self.discovery.is_scanning = false;
+                // Background rescans can shrink the list under the cursor
+                self.discovery.selected_index = self
+                    .discovery
+                    .selected_index
+                    .min(self.discovery.cameras.len().saturating_sub(1));
+            }
+            CameraUpdate::Metrics(snapshot) => {
+                self.mark_dirty(Dirty::STATS);
+                self.metrics = Some(*snapshot);
+            }
+            CameraUpdate::Analysis(analysis) => {
+                self.mark_dirty(Dirty::ANALYSIS);
+                match &mut self.dashboard.analysis {
+                    Some(view) => view.push(analysis),
+                    None => {
+                        let mut view = AnalysisView {
+                            latest: analysis.clone(),
+                            sharpness: VecDeque::with_capacity(SHARPNESS_HISTORY_LEN),
+                        };
+                        view.push(analysis);
+                        self.dashboard.analysis = Some(view);
+                        // The panel appears and shifts the left column
+                        self.mark_dirty(Dirty::DASHBOARD | Dirty::EVENTS);
+                    }
+                }
+            }
+            CameraUpdate::AnalysisStopped => {
+                if self.dashboard.analysis.take().is_some() {
+                    self.mark_dirty(Dirty::DASHBOARD | Dirty::EVENTS | Dirty::ANALYSIS);
+                }
+                self.log_event("Analysis", "Live view analysis stopped");
+            }
+            CameraUpdate::Reconnecting { attempt, retry_in } => {
+                self.mark_dirty(Dirty::ALL);
+                // Stay on the current screen; properties keep their last values
+                self.connected_camera = None;
+                self.is_connecting = true;
+                self.log_event(
+                    "Reconnecting",
+                    &format!("Attempt {} in {:.1}s", attempt, retry_in.as_secs_f64()),
+                );
             }
             CameraUpdate::DiscoveryStarted => {
+                self.mark_dirty(Dirty::DISCOVERY);
                 self.discovery.is_scanning = true;
                 self.discovery.cameras.clear();
             }
@@ -409,6 +604,7 @@ impl App {
                 }
             }
             CameraUpdate::RecordingStateChanged { is_recording } => {
+                self.mark_dirty(Dirty::HEADER | Dirty::DASHBOARD);
                 self.dashboard.is_recording = is_recording;
                 if is_recording {
                     self.dashboard.recording_seconds = 0;
@@ -421,6 +617,7 @@ impl App {
                 ssh_user,
                 ssh_pass,
             } => {
+                self.mark_dirty(Dirty::ALL);
                 if self.trust_ssh_fingerprint {
                     tracing::info!("Auto-trusting SSH fingerprint (--trust flag)");
                     let _ = self.camera_service.cmd_tx.try_send(
@@ -451,6 +648,7 @@ impl App {
                 slot2,
                 slot3,
             } => {
+                self.mark_dirty(Dirty::DASHBOARD);
                 if let Some(battery) = battery_percent {
                     self.dashboard.camera_info.battery = battery;
                 }
@@ -484,6 +682,7 @@ impl App {
     }
 
     fn log_event(&mut self, event_type: &str, details: &str) {
+        self.mark_dirty(Dirty::EVENTS);
         self.events_log.events.push_back(CameraEvent {
             timestamp: chrono::Local::now().format("%H:%M:%S").to_string(),
             event_type: event_type.to_string(),
@@ -502,6 +701,11 @@ impl App {
     }
 
     pub async fn update(&mut self, action: Action) {
+        // Input can change anything on screen; only ticks are selective
+        if !matches!(action, Action::Tick) {
+            self.mark_dirty(Dirty::ALL);
+        }
+
         if self.help_visible {
             self.help_visible = false;
             return;
@@ -526,10 +730,16 @@ impl App {
     fn handle_tick(&mut self) {
         if self.connected_camera.is_some() {
             self.dashboard.session_seconds += 1;
+            self.mark_dirty(Dirty::DASHBOARD);
             if self.dashboard.is_recording {
                 self.dashboard.recording_seconds += 1;
+                self.mark_dirty(Dirty::HEADER);
             }
         }
+        // In-flight markers expire on their own
+        if self.in_flight_property.is_some() {
+            self.mark_dirty(Dirty::DASHBOARD | Dirty::PROPERTIES);
+        }
     }
 
     async fn handle_back(&mut self) {
@@ -547,7 +757,7 @@ impl App {
                     self.screen = Screen::Dashboard;
                 }
             }
-            Screen::EventsExpanded => {
+            Screen::EventsExpanded | Screen::Stats => {
                 self.screen = Screen::Dashboard;
             }
         }
@@ -559,6 +769,7 @@ impl App {
             Screen::Dashboard => self.handle_dashboard_action(action).await,
             Screen::PropertyEditor => self.handle_property_editor_action(action).await,
             Screen::EventsExpanded => self.handle_events_action(action),
+            Screen::Stats => {}
         }
     }
 
@@ -665,6 +876,9 @@ impl App {
             Action::ShowEventsExpanded => {
                 self.screen = Screen::EventsExpanded;
             }
+            Action::ShowStats => {
+                self.screen = Screen::Stats;
+            }
             Action::ShowPropertySearch => {
                 let results = super::property::search_properties(&self.properties, "");
                 self.modal = Some(Modal::PropertySearch(PropertySearchState {
@@ -682,6 +896,12 @@ impl App {
                     .send(CameraCommand::HalfPressShutter)
                     .await;
             }
+            Action::ToggleAnalysis => {
+                let _ = self
+                    .camera_service
+                    .send(CameraCommand::ToggleAnalysis)
+                    .await;
+            }
             _ => {}
         }
     }
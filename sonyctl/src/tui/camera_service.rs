@@ -3,29 +3,85 @@
 //! This module provides a background service that manages SDK communication
 //! via bidirectional channels, keeping the UI responsive.
 
+use std::collections::HashMap;
 use std::net::Ipv4Addr;
+use std::path::PathBuf;
+use std::sync::Arc;
+use std::time::Duration;
 
 use tokio::sync::mpsc;
 
 use crsdk::{
-    warning_code_name, warning_param_description, CameraDevice, CameraEvent as SdkEvent,
-    DeviceProperty, DevicePropertyCode, MacAddr, ValueConstraint,
+    warning_code_name, warning_param_description, AfStatus, AnalysisPool, AnalysisReceiver,
+    CameraDevice, CameraEvent as SdkEvent, CameraModel, ConnectionProfile, DeviceProperty,
+    DevicePropertyCode, DiscoveryEvent, DiscoveryService, EventReceiver, FrameAnalysis,
+    LiveViewConfig, MacAddr, MetricsSnapshot, ProfileStore, PropertyCodeSet, PropertyDiff,
+    ReconnectBackoff, ValueConstraint,
 };
 
-use super::property::{format_sdk_value, PropertyKind};
+use super::property::{format_sdk_value, ChoiceCache, PropertyKind};
+
+/// How long to gather `PropertyChanged` codes before re-reading them.
+/// A mode dial turn produces several back-to-back events; merging them lets
+/// the whole burst be refreshed with one batched fetch.
+const PROPERTY_COALESCE_WINDOW_MS: u64 = 50;
+
+/// How long to wait for `OnConnected` before syncing properties anyway
+const CONNECTED_EVENT_TIMEOUT_MS: u64 = 1000;
+
+/// Reconnect attempts after an unexpected disconnect before giving up
+const MAX_RECONNECT_ATTEMPTS: u32 = 10;
+
+/// How often the stats screen gets a fresh metrics snapshot while connected
+const METRICS_INTERVAL_MS: u64 = 1000;
+
+/// Live view rate while the dashboard's exposure analysis is on; the
+/// sparklines don't need more, and each frame costs a JPEG decode
+const ANALYSIS_FPS: f32 = 10.0;
+
+/// Properties the header is built from
+const HEADER_PROPERTIES: &[DevicePropertyCode] = &[
+    DevicePropertyCode::BatteryRemain,
+    DevicePropertyCode::LensModelName,
+    DevicePropertyCode::ZoomDistance,
+    DevicePropertyCode::DeviceOverheatingState,
+    DevicePropertyCode::MediaSLOT1Status,
+    DevicePropertyCode::MediaSLOT1RemainingNumber,
+    DevicePropertyCode::MediaSLOT1RemainingTime,
+    DevicePropertyCode::MediaSLOT2Status,
+    DevicePropertyCode::MediaSLOT2RemainingNumber,
+    DevicePropertyCode::MediaSLOT2RemainingTime,
+    DevicePropertyCode::MediaSLOT3Status,
+    DevicePropertyCode::MediaSLOT3RemainingTime,
+];
+
+/// Exposure properties read (with the header's) before everything else, so
+/// the dashboard is usable while the full property list is still loading
+const EXPOSURE_PROPERTIES: &[DevicePropertyCode] = &[
+    DevicePropertyCode::ExposureProgramMode,
+    DevicePropertyCode::ShutterSpeed,
+    DevicePropertyCode::FNumber,
+    DevicePropertyCode::IsoSensitivity,
+    DevicePropertyCode::ExposureBiasCompensation,
+    DevicePropertyCode::FocusMode,
+    DevicePropertyCode::WhiteBalance,
+];
 
 /// Get available values from a property's constraint as formatted strings.
-/// For discrete values, formats each value. For ranges, returns the current value.
-fn format_available_values(code: DevicePropertyCode, prop: &DeviceProperty) -> Vec<String> {
+/// For discrete values, formats each value (once per distinct list, via
+/// `choices`). For ranges, returns the current value.
+fn format_available_values(
+    choices: &mut ChoiceCache,
+    code: DevicePropertyCode,
+    prop: &DeviceProperty,
+) -> Arc<[String]> {
     match &prop.constraint {
-        ValueConstraint::None => vec![],
-        ValueConstraint::Discrete(values) => {
-            values.iter().map(|&v| format_sdk_value(code, v)).collect()
-        }
+        ValueConstraint::None => Arc::new([]),
+        ValueConstraint::Discrete(values) => choices.choices(code, values),
         ValueConstraint::Range { .. } => {
             // For ranges, we just return the current formatted value
             // The actual range info is passed separately via PropertyKind
-            vec![format_sdk_value(code, prop.current_value)]
+            Arc::new([format_sdk_value(code, prop.current_value)])
         }
     }
 }
@@ -54,10 +110,12 @@ pub enum CameraUpdate {
         code: DevicePropertyCode,
         value: String,
         raw_value: u64,
-        available: Vec<String>,
+        available: Arc<[String]>,
         writable: bool,
         kind: PropertyKind,
     },
+    /// The camera no longer exposes a property
+    PropertyRemoved { code: DevicePropertyCode },
     /// An error occurred
     Error { message: String },
     /// Discovery results are available
@@ -91,6 +149,14 @@ pub enum CameraUpdate {
         ssh_user: String,
         ssh_pass: String,
     },
+    /// Latency and queue metrics of the connected camera
+    Metrics(Box<MetricsSnapshot>),
+    /// Connection dropped unexpectedly, retrying from the saved profile
+    Reconnecting { attempt: u32, retry_in: Duration },
+    /// Exposure and focus analysis of the latest live view frame
+    Analysis(Arc<FrameAnalysis>),
+    /// Live view analysis stopped (toggled off, or the stream ended)
+    AnalysisStopped,
 }
 
 /// Discovered camera info for the UI
@@ -169,6 +235,8 @@ pub enum CameraCommand {
     StopRecording,
     /// Half-press shutter (autofocus)
     HalfPressShutter,
+    /// Start or stop live view exposure analysis
+    ToggleAnalysis,
 }
 
 /// Handle to communicate with the camera service
@@ -190,6 +258,11 @@ impl CameraServiceHandle {
     pub fn try_recv(&mut self) -> Option<CameraUpdate> {
         self.update_rx.try_recv().ok()
     }
+
+    /// Wait for the next update (None once the service has stopped)
+    pub async fn recv(&mut self) -> Option<CameraUpdate> {
+        self.update_rx.recv().await
+    }
 }
 
 /// The camera service that runs as a background task
@@ -197,12 +270,51 @@ pub struct CameraService {
     cmd_rx: mpsc::Receiver<CameraCommand>,
     update_tx: mpsc::Sender<CameraUpdate>,
     device: Option<CameraDevice>,
-    event_rx: Option<mpsc::UnboundedReceiver<SdkEvent>>,
-    cached_properties: std::collections::HashMap<DevicePropertyCode, DeviceProperty>,
+    event_rx: Option<EventReceiver>,
+    cached_properties: HashMap<DevicePropertyCode, DeviceProperty>,
+    /// Formatted choice lists shared across updates of the same property
+    choices: ChoiceCache,
     /// Whether AF (half-press) is currently engaged
     af_engaged: bool,
     /// When to auto-release AF (following SDK example pattern of fixed delay)
     af_release_at: Option<tokio::time::Instant>,
+    /// Property codes reported as changed but not yet re-read from the camera
+    pending_property_codes: PropertyCodeSet,
+    /// When to flush `pending_property_codes` (armed by the first event of a burst)
+    property_refresh_at: Option<tokio::time::Instant>,
+    /// Where connection profiles are saved (None without a config directory)
+    profiles: Option<ProfileStore>,
+    /// How to reach the current camera again after a drop
+    session: Option<Session>,
+    /// Delays between reconnect attempts, reset once `OnConnected` arrives
+    backoff: ReconnectBackoff,
+    /// When to make the next reconnect attempt
+    reconnect_at: Option<tokio::time::Instant>,
+    /// Fallback for syncing properties if `OnConnected` doesn't arrive
+    initial_sync_at: Option<tokio::time::Instant>,
+    /// When to read the properties left after the priority fetch
+    warmup_at: Option<tokio::time::Instant>,
+    /// Background discovery, running from the first `Discover` until a connect
+    discovery: Option<DiscoveryService>,
+    /// Analysis threads, started the first time analysis is turned on
+    analysis_pool: Option<AnalysisPool>,
+    /// Results of the running live view analysis
+    analysis_rx: Option<AnalysisReceiver>,
+}
+
+/// Connection details kept for reconnecting
+struct Session {
+    profile: ConnectionProfile,
+    /// Kept in memory only; profiles never store it
+    ssh_password: Option<String>,
+}
+
+/// Profile directory under the user's config dir
+fn default_profile_store() -> Option<ProfileStore> {
+    let config = std::env::var_os("XDG_CONFIG_HOME")
+        .map(PathBuf::from)
+        .or_else(|| std::env::var_os("HOME").map(|home| PathBuf::from(home).join(".config")))?;
+    Some(ProfileStore::new(config.join("sonyctl").join("cameras")))
 }
 
 impl CameraService {
@@ -216,9 +328,21 @@ impl CameraService {
             update_tx,
             device: None,
             event_rx: None,
-            cached_properties: std::collections::HashMap::new(),
+            cached_properties: HashMap::new(),
+            choices: ChoiceCache::new(),
             af_engaged: false,
             af_release_at: None,
+            pending_property_codes: PropertyCodeSet::new(),
+            property_refresh_at: None,
+            profiles: default_profile_store(),
+            session: None,
+            backoff: ReconnectBackoff::default(),
+            reconnect_at: None,
+            initial_sync_at: None,
+            warmup_at: None,
+            discovery: None,
+            analysis_pool: None,
+            analysis_rx: None,
         };
 
         tokio::spawn(service.run());
@@ -227,18 +351,16 @@ impl CameraService {
     }
 
     async fn run(mut self) {
+        let mut metrics_tick =
+            tokio::time::interval(std::time::Duration::from_millis(METRICS_INTERVAL_MS));
+        metrics_tick.set_missed_tick_behavior(tokio::time::MissedTickBehavior::Skip);
+
         loop {
-            // Check if we need to auto-release AF
-            let af_timeout = if let Some(release_at) = self.af_release_at {
-                let now = tokio::time::Instant::now();
-                if release_at <= now {
-                    Some(tokio::time::Duration::ZERO)
-                } else {
-                    Some(release_at - now)
-                }
-            } else {
-                None
-            };
+            let af_release_at = self.af_release_at;
+            let property_refresh_at = self.property_refresh_at;
+            let reconnect_at = self.reconnect_at;
+            let initial_sync_at = self.initial_sync_at;
+            let warmup_at = self.warmup_at;
 
             tokio::select! {
                 Some(cmd) = self.cmd_rx.recv() => {
@@ -247,28 +369,81 @@ impl CameraService {
                 Some(event) = recv_event(&mut self.event_rx) => {
                     self.handle_device_event(event).await;
                 }
-                _ = async {
-                    if let Some(timeout) = af_timeout {
-                        tokio::time::sleep(timeout).await;
-                    } else {
-                        std::future::pending::<()>().await;
+                Some(change) = recv_discovery(&mut self.discovery) => {
+                    tracing::debug!("Discovery: {:?}", change);
+                    self.send_discovery_result().await;
+                }
+                analysis = recv_analysis(&mut self.analysis_rx) => match analysis {
+                    Some(analysis) => self.send_update(CameraUpdate::Analysis(analysis)).await,
+                    None => {
+                        // Live view stopped under us, e.g. on disconnect
+                        self.analysis_rx = None;
+                        self.send_update(CameraUpdate::AnalysisStopped).await;
                     }
-                } => {
+                },
+                _ = sleep_until(af_release_at) => {
                     // AF timeout - auto-release shutter
                     self.handle_af_timeout().await;
                 }
+                _ = sleep_until(property_refresh_at) => {
+                    // Coalescing window closed - re-read everything that changed
+                    self.flush_pending_properties().await;
+                }
+                _ = sleep_until(initial_sync_at) => {
+                    tracing::info!("No Connected event yet, syncing anyway");
+                    self.initial_sync().await;
+                }
+                _ = sleep_until(warmup_at) => {
+                    self.warmup().await;
+                }
+                _ = sleep_until(reconnect_at) => {
+                    self.attempt_reconnect().await;
+                }
+                _ = metrics_tick.tick(), if self.device.is_some() => {
+                    self.send_metrics().await;
+                }
             }
         }
     }
 }
 
-async fn recv_event(rx: &mut Option<mpsc::UnboundedReceiver<SdkEvent>>) -> Option<SdkEvent> {
+/// Sleep until `deadline`, or forever if there is none
+async fn sleep_until(deadline: Option<tokio::time::Instant>) {
+    match deadline {
+        Some(deadline) => tokio::time::sleep_until(deadline).await,
+        None => std::future::pending().await,
+    }
+}
+
+async fn recv_event(rx: &mut Option<EventReceiver>) -> Option<SdkEvent> {
     match rx {
         Some(receiver) => receiver.recv().await,
         None => std::future::pending().await,
     }
 }
 
+/// Next analysis result, or `None` once the stream has ended
+async fn recv_analysis(rx: &mut Option<AnalysisReceiver>) -> Option<Arc<FrameAnalysis>> {
+    match rx {
+        Some(receiver) => loop {
+            if !receiver.changed().await {
+                return None;
+            }
+            if let Some(analysis) = receiver.latest() {
+                return Some(analysis);
+            }
+        },
+        None => std::future::pending().await,
+    }
+}
+
+async fn recv_discovery(discovery: &mut Option<DiscoveryService>) -> Option<DiscoveryEvent> {
+    match discovery {
+        Some(discovery) => discovery.recv_event().await,
+        None => std::future::pending().await,
+    }
+}
+
 impl CameraService {
     async fn send_update(&self, update: CameraUpdate) {
         if let Err(e) = self.update_tx.send(update).await {
@@ -276,6 +451,13 @@ impl CameraService {
         }
     }
 
+    async fn send_metrics(&self) {
+        if let Some(device) = &self.device {
+            self.send_update(CameraUpdate::Metrics(Box::new(device.metrics())))
+                .await;
+        }
+    }
+
     async fn handle_command(&mut self, cmd: CameraCommand) {
         match cmd {
             CameraCommand::Discover => {
@@ -321,44 +503,61 @@ impl CameraService {
             CameraCommand::HalfPressShutter => {
                 self.handle_half_press().await;
             }
+            CameraCommand::ToggleAnalysis => {
+                self.handle_toggle_analysis().await;
+            }
         }
     }
 
+    /// Show the cached camera list right away and rescan in the background
+    ///
+    /// The first call starts the discovery service, whose first scan fills
+    /// the list; later calls only ask it for an early rescan. Changes found
+    /// by background scans are sent as they come in.
     async fn handle_discover(&mut self) {
-        self.send_update(CameraUpdate::DiscoveryStarted).await;
-
-        match crsdk::discover_cameras(5).await {
-            Ok(cameras) => {
-                let infos: Vec<DiscoveredCameraInfo> = cameras
-                    .into_iter()
-                    .map(|c| DiscoveredCameraInfo {
-                        model: c.model.clone(),
-                        address: c
-                            .ip_address
-                            .map(|ip| ip.to_string())
-                            .unwrap_or_else(|| "USB".to_string()),
-                        mac_address: c.mac_address.map(|m| m.to_string()).unwrap_or_default(),
-                        connection_type: if c.ip_address.is_some() {
-                            ConnectionType::Network
-                        } else {
-                            ConnectionType::Usb
-                        },
-                        ssh_supported: c.ssh_supported,
-                    })
-                    .collect();
-
-                self.send_update(CameraUpdate::DiscoveryResult { cameras: infos })
-                    .await;
+        match &self.discovery {
+            Some(discovery) if discovery.has_scanned() => {
+                discovery.rescan();
+                self.send_discovery_result().await;
             }
-            Err(e) => {
-                self.send_update(CameraUpdate::Error {
-                    message: format!("Discovery failed: {}", e),
-                })
-                .await;
+            Some(discovery) => discovery.rescan(),
+            None => {
+                self.send_update(CameraUpdate::DiscoveryStarted).await;
+                self.discovery = Some(DiscoveryService::start());
             }
         }
     }
 
+    async fn send_discovery_result(&mut self) {
+        let Some(discovery) = &mut self.discovery else {
+            return;
+        };
+        // Drain whatever else arrived; the update carries the whole list
+        while discovery.try_recv_event().is_some() {}
+
+        let infos: Vec<DiscoveredCameraInfo> = discovery
+            .cameras()
+            .into_iter()
+            .map(|c| DiscoveredCameraInfo {
+                model: c.model.to_string(),
+                address: c
+                    .ip_address
+                    .map(|ip| ip.to_string())
+                    .unwrap_or_else(|| "USB".to_string()),
+                mac_address: c.mac_address.map(|m| m.to_string()).unwrap_or_default(),
+                connection_type: if c.ip_address.is_some() {
+                    ConnectionType::Network
+                } else {
+                    ConnectionType::Usb
+                },
+                ssh_supported: c.ssh_supported,
+            })
+            .collect();
+
+        self.send_update(CameraUpdate::DiscoveryResult { cameras: infos })
+            .await;
+    }
+
     async fn handle_fetch_ssh_fingerprint(
         &mut self,
         ip: Ipv4Addr,
@@ -366,6 +565,16 @@ impl CameraService {
         ssh_user: String,
         ssh_pass: String,
     ) {
+        let saved = self.load_profile(mac).filter(|profile| {
+            profile.ip_address == ip && profile.ssh_user.as_deref() == Some(ssh_user.as_str())
+        });
+        if let Some(fingerprint) = saved.and_then(|profile| profile.ssh_fingerprint) {
+            tracing::info!("Using SSH fingerprint verified in an earlier session");
+            self.handle_connect_with_fingerprint(ip, mac, ssh_user, ssh_pass, fingerprint)
+                .await;
+            return;
+        }
+
         tracing::info!("Fetching SSH fingerprint for {}...", ip);
 
         let mut builder = CameraDevice::builder()
@@ -405,88 +614,282 @@ impl CameraService {
     ) {
         tracing::info!("Connecting to {} with SSH (user={})...", ip, ssh_user);
 
-        let builder = CameraDevice::builder()
-            .ip_address(ip)
-            .mac_address(mac)
-            .ssh_enabled(true)
-            .ssh_credentials(&ssh_user, &ssh_pass)
-            .ssh_fingerprint(fingerprint);
+        let profile = self.profile_for(ip, mac).with_ssh(ssh_user, fingerprint);
+        self.connect(profile, Some(ssh_pass)).await;
+    }
 
-        match builder.connect().await {
-            Ok(mut device) => {
-                let model = device.model().await.to_string();
-                let address = ip.to_string();
-                tracing::info!("Connected to {} ({})", model, address);
+    async fn handle_connect(&mut self, ip: Ipv4Addr, mac: MacAddr) {
+        tracing::info!("Connecting to {} (no SSH)...", ip);
 
-                self.event_rx = device.take_event_receiver();
-                self.device = Some(device);
+        let mut profile = self.profile_for(ip, mac);
+        profile.ssh_user = None;
+        profile.ssh_fingerprint = None;
+        self.connect(profile, None).await;
+    }
 
-                self.send_update(CameraUpdate::Connected {
-                    model: model.clone(),
-                    address,
-                })
-                .await;
+    /// Saved profile for `mac` pointed at `ip`, or a fresh one
+    fn profile_for(&self, ip: Ipv4Addr, mac: MacAddr) -> ConnectionProfile {
+        match self.load_profile(mac) {
+            Some(mut profile) => {
+                profile.ip_address = ip;
+                profile
+            }
+            None => ConnectionProfile::new(ip, mac, None),
+        }
+    }
 
-                // Wait for camera to initialize and send property updates
-                tracing::info!("Waiting for camera to initialize...");
-                tokio::time::sleep(tokio::time::Duration::from_secs(1)).await;
+    /// Model of the camera with `mac`, as reported by the last discovery scan
+    fn discovered_model(&self, mac: MacAddr) -> Option<CameraModel> {
+        self.discovery
+            .as_ref()?
+            .cameras()
+            .into_iter()
+            .find(|camera| camera.mac_address == Some(mac))
+            .and_then(|camera| CameraModel::from_model_name(&camera.model))
+    }
 
-                tracing::info!("Syncing properties...");
-                self.sync_all_properties().await;
-                tracing::info!("Property sync complete");
-            }
+    fn load_profile(&self, mac: MacAddr) -> Option<ConnectionProfile> {
+        let store = self.profiles.as_ref()?;
+        match store.load(mac) {
+            Ok(profile) => profile,
             Err(e) => {
-                tracing::error!("Connection failed: {}", e);
-                self.send_update(CameraUpdate::Error {
-                    message: format!("Connection failed: {}", e),
-                })
-                .await;
+                tracing::warn!("Ignoring unreadable profile for {}: {}", mac, e);
+                None
             }
         }
     }
 
-    async fn handle_connect(&mut self, ip: Ipv4Addr, mac: MacAddr) {
-        tracing::info!("Connecting to {} (no SSH)...", ip);
+    /// Save the current session's profile with the latest property values
+    fn save_profile(&mut self) {
+        let (Some(store), Some(session)) = (&self.profiles, &mut self.session) else {
+            return;
+        };
+        // A snapshot saved between the priority fetch and the warmup would
+        // seed the next connect with only a handful of properties
+        let complete = self
+            .device
+            .as_ref()
+            .and_then(|device| device.property_cache())
+            .map_or(true, |cache| cache.is_complete());
+        if complete && !self.cached_properties.is_empty() {
+            session.profile.properties = self.cached_properties.values().cloned().collect();
+        }
+        if let Err(e) = store.save(&session.profile) {
+            tracing::warn!("Failed to save connection profile: {}", e);
+        }
+    }
+
+    /// Connect from `profile`, skipping discovery and fingerprint fetch
+    ///
+    /// Returns whether `Connect` succeeded. Properties are synced once the
+    /// camera reports `OnConnected` (or after a short fallback delay).
+    async fn connect(
+        &mut self,
+        mut profile: ConnectionProfile,
+        ssh_password: Option<String>,
+    ) -> bool {
+        // New profiles start out without a model; take it from what the
+        // camera reported to discovery, so it's saved and reconnects right
+        if let Some(model) = self.discovered_model(profile.mac_address) {
+            if profile.model != Some(model) {
+                tracing::info!("Camera reports model {}, updating profile", model);
+                profile.model = Some(model);
+            }
+        }
 
-        let builder = CameraDevice::builder().ip_address(ip).mac_address(mac);
+        // Background scans would compete with the connection for the SDK
+        if let Some(discovery) = self.discovery.take() {
+            discovery.stop().await;
+        }
+
+        // Show the last known settings while the live read is pending
+        if self.cached_properties.is_empty() && !profile.properties.is_empty() {
+            tracing::info!(
+                "Warming {} properties from saved profile",
+                profile.properties.len()
+            );
+            for prop in profile.properties.clone() {
+                self.publish_property(prop).await;
+            }
+            self.publish_camera_info().await;
+        }
+
+        let mut builder = CameraDevice::builder().profile(&profile);
+        if let (Some(user), Some(pass)) = (&profile.ssh_user, &ssh_password) {
+            builder = builder.ssh_credentials(user, pass);
+        }
 
         match builder.connect().await {
             Ok(mut device) => {
                 let model = device.model().await.to_string();
-                let address = ip.to_string();
+                let address = profile.ip_address.to_string();
                 tracing::info!("Connected to {} ({})", model, address);
 
                 self.event_rx = device.take_event_receiver();
                 self.device = Some(device);
+                self.session = Some(Session {
+                    profile,
+                    ssh_password,
+                });
+                self.reconnect_at = None;
+                self.initial_sync_at = Some(
+                    tokio::time::Instant::now() + Duration::from_millis(CONNECTED_EVENT_TIMEOUT_MS),
+                );
+
+                self.send_update(CameraUpdate::Connected { model, address })
+                    .await;
+                true
+            }
+            Err(e) => {
+                tracing::error!("Connection failed: {}", e);
+                if self.session.is_none() {
+                    self.cached_properties.clear();
+                    self.send_update(CameraUpdate::Error {
+                        message: format!("Connection failed: {}", e),
+                    })
+                    .await;
+                }
+                false
+            }
+        }
+    }
 
-                self.send_update(CameraUpdate::Connected {
-                    model: model.clone(),
-                    address,
-                })
-                .await;
+    /// First property read after (re)connecting, priority properties only
+    ///
+    /// The exposure and header properties come in one small fetch and are
+    /// shown right away; the rest is read by `warmup` on the next loop turn,
+    /// so commands queued meanwhile aren't held up behind the full read.
+    async fn initial_sync(&mut self) {
+        self.initial_sync_at = None;
+        let Some(ref device) = self.device else {
+            return;
+        };
 
-                // Wait for camera to initialize and send property updates
-                tracing::info!("Waiting for camera to initialize...");
-                tokio::time::sleep(tokio::time::Duration::from_secs(1)).await;
+        tracing::info!("Syncing priority properties...");
+        let codes: Vec<_> = EXPOSURE_PROPERTIES
+            .iter()
+            .chain(HEADER_PROPERTIES)
+            .copied()
+            .collect();
+        match device.prefetch_properties(&codes).await {
+            Ok(diffs) => {
+                for diff in diffs {
+                    self.publish_diff(diff).await;
+                }
+            }
+            Err(e) => {
+                tracing::error!("Failed to prefetch properties: {}", e);
+            }
+        }
 
-                tracing::info!("Syncing properties...");
-                self.sync_all_properties().await;
-                tracing::info!("Property sync complete");
+        self.publish_camera_info().await;
+        self.warmup_at = Some(tokio::time::Instant::now());
+    }
+
+    /// Read everything the priority fetch left out
+    ///
+    /// Goes through the device's property cache: from a saved snapshot only
+    /// what changed since is published, otherwise everything is.
+    async fn warmup(&mut self) {
+        self.warmup_at = None;
+        let Some(ref device) = self.device else {
+            return;
+        };
+
+        match device.refresh_properties().await {
+            Ok(diffs) => {
+                tracing::info!("{} properties differ from the last snapshot", diffs.len());
+                for diff in diffs {
+                    self.publish_diff(diff).await;
+                }
             }
             Err(e) => {
-                tracing::error!("Connection failed: {}", e);
-                self.send_update(CameraUpdate::Error {
-                    message: format!("Connection failed: {}", e),
-                })
-                .await;
+                tracing::error!("Failed to refresh properties: {}", e);
             }
         }
+        tracing::info!("Property sync complete");
+
+        self.send_update(CameraUpdate::PropertiesLoaded).await;
+        self.publish_camera_info().await;
+        self.save_profile();
     }
 
-    async fn handle_disconnect(&mut self) {
+    /// Drop the device after an unexpected disconnect and schedule a retry
+    async fn schedule_reconnect(&mut self) {
         self.device = None;
         self.event_rx = None;
+        self.initial_sync_at = None;
+        self.warmup_at = None;
+        self.pending_property_codes.clear();
+        self.property_refresh_at = None;
+
+        if self.backoff.attempt() >= MAX_RECONNECT_ATTEMPTS {
+            tracing::warn!(
+                "Giving up after {} reconnect attempts",
+                self.backoff.attempt()
+            );
+            self.end_session();
+            self.send_update(CameraUpdate::Disconnected {
+                error: Some("Reconnect failed".to_string()),
+            })
+            .await;
+            return;
+        }
+
+        let retry_in = self.backoff.next_delay();
+        let attempt = self.backoff.attempt();
+        tracing::info!("Reconnect attempt {} in {:?}", attempt, retry_in);
+        self.reconnect_at = Some(tokio::time::Instant::now() + retry_in);
+        self.send_update(CameraUpdate::Reconnecting { attempt, retry_in })
+            .await;
+    }
+
+    async fn attempt_reconnect(&mut self) {
+        self.reconnect_at = None;
+        let Some(session) = &mut self.session else {
+            return;
+        };
+
+        // The new cache is seeded from the profile and only reports what
+        // differs from it, so it has to hold what the UI shows now rather
+        // than the values from the last save
+        if !self.cached_properties.is_empty() {
+            let mut properties: HashMap<u32, DeviceProperty> = session
+                .profile
+                .properties
+                .drain(..)
+                .map(|prop| (prop.code, prop))
+                .collect();
+            for prop in self.cached_properties.values() {
+                properties.insert(prop.code, prop.clone());
+            }
+            session.profile.properties = properties.into_values().collect();
+        }
+
+        let profile = session.profile.clone();
+        let ssh_password = session.ssh_password.clone();
+        if !self.connect(profile, ssh_password).await {
+            self.schedule_reconnect().await;
+        }
+    }
+
+    /// Forget the current camera: no reconnects, no cached state
+    fn end_session(&mut self) {
+        self.save_profile();
+        self.session = None;
+        self.reconnect_at = None;
+        self.initial_sync_at = None;
+        self.warmup_at = None;
+        self.backoff.reset();
         self.cached_properties.clear();
+    }
+
+    async fn handle_disconnect(&mut self) {
+        self.end_session();
+        self.device = None;
+        self.event_rx = None;
+        self.pending_property_codes.clear();
+        self.property_refresh_at = None;
         self.send_update(CameraUpdate::Disconnected { error: None })
             .await;
     }
@@ -501,38 +904,7 @@ impl CameraService {
                 tracing::info!("Camera exposes {} properties", all_props.len());
 
                 for (prop, _debug_info) in all_props {
-                    if !prop.enable_flag.is_readable() {
-                        continue;
-                    }
-
-                    if let Some(code) = DevicePropertyCode::from_raw(prop.code) {
-                        let current = format_sdk_value(code, prop.current_value);
-                        let raw_value = prop.current_value;
-                        let available = format_available_values(code, &prop);
-                        let writable = prop.enable_flag.is_writable();
-                        let kind = constraint_to_kind(&prop.constraint);
-
-                        tracing::debug!(
-                            "Property {}: raw={} formatted='{}' writable={} constraint={:?}",
-                            code.name(),
-                            prop.current_value,
-                            current,
-                            writable,
-                            prop.constraint
-                        );
-
-                        self.cached_properties.insert(code, prop);
-
-                        self.send_update(CameraUpdate::PropertyChanged {
-                            code,
-                            value: current,
-                            raw_value,
-                            available,
-                            writable,
-                            kind,
-                        })
-                        .await;
-                    }
+                    self.publish_property(prop).await;
                 }
             }
             Err(e) => {
@@ -542,155 +914,101 @@ impl CameraService {
 
         self.send_update(CameraUpdate::PropertiesLoaded).await;
 
-        self.sync_camera_info().await;
+        self.publish_camera_info().await;
     }
 
-    async fn sync_camera_info(&mut self) {
+    /// Re-read every property code gathered during the coalescing window
+    /// with a single batched fetch
+    async fn flush_pending_properties(&mut self) {
+        self.property_refresh_at = None;
+        if self.pending_property_codes.is_empty() {
+            return;
+        }
+
+        let codes = std::mem::take(&mut self.pending_property_codes).to_vec();
+
         let Some(ref device) = self.device else {
             return;
         };
 
-        let mut battery_percent: Option<u8> = None;
-        let mut lens_model: Option<String> = None;
-        let mut focal_length_mm: Option<u32> = None;
-        let mut overheating_state: Option<u8> = None;
+        tracing::debug!("Refreshing {} changed properties", codes.len());
 
-        // Battery
-        if let Ok(prop) = device.get_property(DevicePropertyCode::BatteryRemain).await {
-            battery_percent = Some(prop.current_value as u8);
-            tracing::debug!("Battery: {}%", prop.current_value);
+        match device.get_properties(&codes).await {
+            Ok(props) => {
+                for prop in props {
+                    self.publish_property(prop).await;
+                }
+            }
+            Err(e) => {
+                tracing::warn!("Failed to refresh changed properties: {}", e);
+            }
         }
 
-        // Lens model - uses string property API
-        if let Ok(prop) = device.get_property(DevicePropertyCode::LensModelName).await {
-            tracing::debug!(
-                "Lens model property: data_type={:?} current_value={} current_string={:?}",
-                prop.data_type,
-                prop.current_value,
-                prop.current_string
-            );
-            lens_model = prop.current_string;
-        }
-
-        // Focal length / zoom distance (in mm)
-        if let Ok(prop) = device.get_property(DevicePropertyCode::ZoomDistance).await {
-            if prop.current_value > 0 && prop.current_value != 0xFFFFFFFF {
-                focal_length_mm = Some(prop.current_value as u32);
-                tracing::debug!("Zoom distance: {}mm", prop.current_value);
-            }
-        }
-
-        // Overheating state (0=normal, 1=pre-overheating, 2=overheating)
-        if let Ok(prop) = device
-            .get_property(DevicePropertyCode::DeviceOverheatingState)
-            .await
-        {
-            overheating_state = Some(prop.current_value as u8);
-            tracing::debug!("Overheating state: {}", prop.current_value);
-        }
-
-        // Media slot 1 - if status read fails, camera doesn't have this slot
-        let slot1 = if let Ok(prop) = device
-            .get_property(DevicePropertyCode::MediaSLOT1Status)
-            .await
-        {
-            let status = parse_slot_status(prop.current_value);
-            tracing::debug!("Slot 1 status: {:?}", status);
-
-            let remaining_photos = device
-                .get_property(DevicePropertyCode::MediaSLOT1RemainingNumber)
-                .await
-                .ok()
-                .map(|p| p.current_value as u32);
-            let remaining_time_sec = device
-                .get_property(DevicePropertyCode::MediaSLOT1RemainingTime)
-                .await
-                .ok()
-                .map(|p| p.current_value as u32);
-
-            tracing::debug!(
-                "Slot 1: photos={:?}, time={:?}s",
-                remaining_photos,
-                remaining_time_sec
-            );
-            Some(SlotInfo {
-                status,
-                remaining_photos,
-                remaining_time_sec,
-            })
-        } else {
-            None
-        };
+        if codes.iter().any(|code| HEADER_PROPERTIES.contains(code)) {
+            self.publish_camera_info().await;
+        }
+    }
 
-        // Media slot 2
-        let slot2 = if let Ok(prop) = device
-            .get_property(DevicePropertyCode::MediaSLOT2Status)
-            .await
-        {
-            let status = parse_slot_status(prop.current_value);
-            tracing::debug!("Slot 2 status: {:?}", status);
-
-            let remaining_photos = device
-                .get_property(DevicePropertyCode::MediaSLOT2RemainingNumber)
-                .await
-                .ok()
-                .map(|p| p.current_value as u32);
-            let remaining_time_sec = device
-                .get_property(DevicePropertyCode::MediaSLOT2RemainingTime)
-                .await
-                .ok()
-                .map(|p| p.current_value as u32);
-
-            tracing::debug!(
-                "Slot 2: photos={:?}, time={:?}s",
-                remaining_photos,
-                remaining_time_sec
-            );
-            Some(SlotInfo {
-                status,
-                remaining_photos,
-                remaining_time_sec,
-            })
-        } else {
-            None
-        };
+    /// Cache a property read from the camera and forward it to the UI
+    async fn publish_property(&mut self, prop: DeviceProperty) {
+        if !prop.enable_flag.is_readable() {
+            return;
+        }
 
-        // Media slot 3 (optional - some cameras have 3 slots)
-        let slot3 = if let Ok(prop) = device
-            .get_property(DevicePropertyCode::MediaSLOT3Status)
-            .await
-        {
-            let status = parse_slot_status(prop.current_value);
-            tracing::debug!("Slot 3 status: {:?}", status);
-
-            let remaining_time_sec = device
-                .get_property(DevicePropertyCode::MediaSLOT3RemainingTime)
-                .await
-                .ok()
-                .map(|p| p.current_value as u32);
-
-            tracing::debug!("Slot 3: time={:?}s", remaining_time_sec);
-            Some(SlotInfo {
-                status,
-                remaining_photos: None,
-                remaining_time_sec,
-            })
-        } else {
-            None
+        let Some(code) = DevicePropertyCode::from_raw(prop.code) else {
+            return;
         };
 
-        self.send_update(CameraUpdate::CameraInfoUpdate {
-            battery_percent,
-            lens_model,
-            focal_length_mm,
-            overheating_state,
-            slot1,
-            slot2,
-            slot3,
+        let available = format_available_values(&mut self.choices, code, &prop);
+        let current = match prop.constraint {
+            ValueConstraint::Range { .. } => available[0].clone(),
+            _ => self.choices.format(code, prop.current_value),
+        };
+        let raw_value = prop.current_value;
+        let writable = prop.enable_flag.is_writable();
+        let kind = constraint_to_kind(&prop.constraint);
+
+        tracing::debug!(
+            "Property {}: raw={} formatted='{}' writable={} constraint={:?}",
+            code.name(),
+            prop.current_value,
+            current,
+            writable,
+            prop.constraint
+        );
+
+        self.cached_properties.insert(code, prop);
+
+        self.send_update(CameraUpdate::PropertyChanged {
+            code,
+            value: current,
+            raw_value,
+            available,
+            writable,
+            kind,
         })
         .await;
     }
 
+    /// Forward a property cache diff to the UI
+    async fn publish_diff(&mut self, diff: PropertyDiff) {
+        match diff.new {
+            Some(prop) => self.publish_property(prop).await,
+            None => {
+                self.cached_properties.remove(&diff.code);
+                self.send_update(CameraUpdate::PropertyRemoved { code: diff.code })
+                    .await;
+            }
+        }
+    }
+
+    /// Send the header's camera info, derived from the cached properties
+    async fn publish_camera_info(&mut self) {
+        let update = camera_info(&self.cached_properties);
+        tracing::debug!("Camera info: {:?}", update);
+        self.send_update(update).await;
+    }
+
     async fn handle_set_property(&mut self, code: DevicePropertyCode, value_index: usize) {
         let Some(cached) = self.cached_properties.get(&code) else {
             self.send_update(CameraUpdate::Error {
@@ -869,6 +1187,58 @@ impl CameraService {
         }
     }
 
+    /// Turn live view analysis on (starting live view) or off (stopping it)
+    async fn handle_toggle_analysis(&mut self) {
+        let Some(ref device) = self.device else {
+            tracing::warn!("Analysis: no device connected");
+            return;
+        };
+
+        if self.analysis_rx.take().is_some() {
+            device.stop_live_view().await;
+            self.send_update(CameraUpdate::AnalysisStopped).await;
+            return;
+        }
+
+        let pool = match &self.analysis_pool {
+            Some(pool) => pool,
+            None => match AnalysisPool::new(0) {
+                Ok(pool) => &*self.analysis_pool.insert(pool),
+                Err(e) => {
+                    tracing::error!("Failed to start analysis threads: {}", e);
+                    self.send_update(CameraUpdate::Error {
+                        message: format!("Live view analysis failed: {}", e),
+                    })
+                    .await;
+                    return;
+                }
+            },
+        };
+
+        let config = LiveViewConfig {
+            fps: ANALYSIS_FPS,
+            frame_info: true,
+        };
+        let started = match device.start_live_view(config).await {
+            Ok(_) => device.start_live_view_analysis(pool).await,
+            Err(e) => Err(e),
+        };
+        match started {
+            Ok(receiver) => {
+                tracing::info!("Live view analysis started");
+                self.analysis_rx = Some(receiver);
+            }
+            Err(e) => {
+                tracing::error!("Live view analysis failed to start: {}", e);
+                device.stop_live_view().await;
+                self.send_update(CameraUpdate::Error {
+                    message: format!("Live view analysis failed: {}", e),
+                })
+                .await;
+            }
+        }
+    }
+
     async fn handle_af_timeout(&mut self) {
         tracing::info!("AF timeout - auto-releasing shutter");
         self.af_release_at = None;
@@ -884,6 +1254,11 @@ impl CameraService {
     async fn handle_device_event(&mut self, event: SdkEvent) {
         match event {
             SdkEvent::Connected { version } => {
+                // The camera is ready: sync now instead of waiting out the fallback
+                self.backoff.reset();
+                if self.initial_sync_at.is_some() {
+                    self.initial_sync().await;
+                }
                 self.send_update(CameraUpdate::SdkEvent {
                     event_type: "Connected".to_string(),
                     details: format!("Protocol v{}", version),
@@ -891,46 +1266,35 @@ impl CameraService {
                 .await;
             }
             SdkEvent::Disconnected { error } => {
+                if error != 0 && self.session.is_some() {
+                    tracing::warn!("Connection lost (0x{:08X}), reconnecting", error);
+                    self.save_profile();
+                    self.schedule_reconnect().await;
+                    return;
+                }
+
                 let error_msg = if error == 0 {
                     None
                 } else {
                     Some(format!("Error code: 0x{:08X}", error))
                 };
+                self.end_session();
                 self.device = None;
                 self.event_rx = None;
-                self.cached_properties.clear();
+                self.pending_property_codes.clear();
+                self.property_refresh_at = None;
                 self.send_update(CameraUpdate::Disconnected { error: error_msg })
                     .await;
             }
             SdkEvent::PropertyChanged { codes } => {
-                for sdk_code in codes {
-                    if let Some(code) = DevicePropertyCode::from_raw(sdk_code.as_raw()) {
-                        if let Some(ref device) = self.device {
-                            if let Ok(prop) = device.get_property(sdk_code).await {
-                                if !prop.enable_flag.is_readable() {
-                                    continue;
-                                }
-
-                                let current = format_sdk_value(code, prop.current_value);
-                                let raw_value = prop.current_value;
-                                let available = format_available_values(code, &prop);
-                                let writable = prop.enable_flag.is_writable();
-                                let kind = constraint_to_kind(&prop.constraint);
-
-                                self.cached_properties.insert(code, prop);
-
-                                self.send_update(CameraUpdate::PropertyChanged {
-                                    code,
-                                    value: current,
-                                    raw_value,
-                                    available,
-                                    writable,
-                                    kind,
-                                })
-                                .await;
-                            }
-                        }
-                    }
+                // Merge into the pending set; the refresh runs once the
+                // coalescing window armed by the first event of the burst closes
+                self.pending_property_codes |= codes;
+                if self.property_refresh_at.is_none() && !self.pending_property_codes.is_empty() {
+                    self.property_refresh_at = Some(
+                        tokio::time::Instant::now()
+                            + tokio::time::Duration::from_millis(PROPERTY_COALESCE_WINDOW_MS),
+                    );
                 }
             }
             SdkEvent::Warning { code, params } => {
@@ -938,17 +1302,10 @@ impl CameraService {
                 let details = if let Some((p1, p2, p3)) = params {
                     let param_desc = warning_param_description(code, p1);
 
-                    // Handle AF Status events (0x00060001)
-                    if code == 0x00060001 {
-                        // AF Status codes:
-                        // 0x02 = Focused (AF-S), 0x03 = Not Focused (AF-S)
-                        // 0x06 = Focused (AF-C), 0x07 = Not Focused (AF-C)
-                        // 0x01 = Unlocked
-                        let is_focused = p1 == 0x02 || p1 == 0x06;
-                        let is_not_focused = p1 == 0x03 || p1 == 0x07;
-                        let is_unlocked = p1 == 0x01;
-
-                        if self.af_engaged && (is_focused || is_not_focused) {
+                    if let Some(status) = AfStatus::from_warning(code, params) {
+                        let is_unlocked = status == AfStatus::Unlocked;
+
+                        if self.af_engaged && status.is_settled() {
                             // Release the shutter now that focus result is known
                             if let Some(ref device) = self.device {
                                 tracing::info!("AF complete (status={}), releasing shutter", p1);
@@ -994,7 +1351,7 @@ impl CameraService {
             SdkEvent::DownloadComplete { filename } => {
                 self.send_update(CameraUpdate::SdkEvent {
                     event_type: "Download".to_string(),
-                    details: filename,
+                    details: filename.to_string(),
                 })
                 .await;
             }
@@ -1015,3 +1372,44 @@ fn parse_slot_status(value: u64) -> MediaSlotStatus {
         _ => MediaSlotStatus::Error,
     }
 }
+
+/// Header info from one property snapshot
+///
+/// A slot whose status property is missing doesn't exist on this body.
+fn camera_info(props: &HashMap<DevicePropertyCode, DeviceProperty>) -> CameraUpdate {
+    let value = |code| props.get(&code).map(|p| p.current_value);
+    let slot = |status, photos: Option<DevicePropertyCode>, time| {
+        Some(SlotInfo {
+            status: parse_slot_status(value(status)?),
+            remaining_photos: photos.and_then(value).map(|v| v as u32),
+            remaining_time_sec: value(time).map(|v| v as u32),
+        })
+    };
+
+    CameraUpdate::CameraInfoUpdate {
+        battery_percent: value(DevicePropertyCode::BatteryRemain).map(|v| v as u8),
+        lens_model: props
+            .get(&DevicePropertyCode::LensModelName)
+            .and_then(|p| p.current_string.clone()),
+        focal_length_mm: value(DevicePropertyCode::ZoomDistance)
+            .filter(|&v| v > 0 && v != 0xFFFFFFFF)
+            .map(|v| v as u32),
+        // 0=normal, 1=pre-overheating, 2=overheating
+        overheating_state: value(DevicePropertyCode::DeviceOverheatingState).map(|v| v as u8),
+        slot1: slot(
+            DevicePropertyCode::MediaSLOT1Status,
+            Some(DevicePropertyCode::MediaSLOT1RemainingNumber),
+            DevicePropertyCode::MediaSLOT1RemainingTime,
+        ),
+        slot2: slot(
+            DevicePropertyCode::MediaSLOT2Status,
+            Some(DevicePropertyCode::MediaSLOT2RemainingNumber),
+            DevicePropertyCode::MediaSLOT2RemainingTime,
+        ),
+        slot3: slot(
+            DevicePropertyCode::MediaSLOT3Status,
+            None,
+            DevicePropertyCode::MediaSLOT3RemainingTime,
+        ),
+    }
+}
@@ -1,11 +1,11 @@
-use std::time::Duration;
+use std::time::{Duration, Instant};
 
 use crossterm::event::{Event, EventStream, KeyCode, KeyEvent, KeyModifiers};
 use futures::StreamExt;
 use tokio::time::{interval, Interval};
 
 use super::action::Action;
-use super::app::{App, PropertyEditorFocus, Screen};
+use super::app::{App, Dirty, PropertyEditorFocus, Screen};
 
 pub struct EventHandler {
     events: EventStream,
@@ -20,7 +20,11 @@ impl EventHandler {
         }
     }
 
-    pub async fn next(&mut self, app: &App) -> Option<Action> {
+    /// Wait for input, a camera update or the next frame
+    ///
+    /// Camera updates are applied to `app` directly and yield `None`, as does
+    /// `redraw_at` (when the frame-rate cap allows the next draw).
+    pub async fn next(&mut self, app: &mut App, redraw_at: Option<Instant>) -> Option<Action> {
         // Get debounce timeout if there's a pending property change
         let debounce_timeout = app.debounce_timeout();
 
@@ -28,9 +32,17 @@ impl EventHandler {
             biased;
 
             Some(Ok(event)) = self.events.next() => {
+                if let Event::Resize(_, _) = event {
+                    app.mark_dirty(Dirty::ALL);
+                }
                 Self::map_terminal_event(event, app)
             }
 
+            Some(update) = app.recv_camera_update() => {
+                app.apply_camera_update(update);
+                None
+            }
+
             // Fire debounce timeout if pending property exists and timeout elapsed
             _ = async {
                 if let Some(timeout) = debounce_timeout {
@@ -42,6 +54,16 @@ impl EventHandler {
                 Some(Action::FlushPendingProperty)
             }
 
+            _ = async {
+                if let Some(at) = redraw_at {
+                    tokio::time::sleep_until(at.into()).await;
+                } else {
+                    std::future::pending::<()>().await;
+                }
+            } => {
+                None
+            }
+
             _ = self.tick_interval.tick() => {
                 Some(Action::Tick)
             }
@@ -78,6 +100,7 @@ impl EventHandler {
             Screen::Dashboard => Self::map_dashboard_key(key),
             Screen::PropertyEditor => Self::map_property_editor_key(key, app.property_editor.focus),
             Screen::EventsExpanded => Self::map_events_key(key),
+            Screen::Stats => Self::map_stats_key(key),
         }
     }
 
@@ -138,6 +161,8 @@ impl EventHandler {
             // Navigation
             KeyCode::Char('p') => Some(Action::ShowPropertyEditor),
             KeyCode::Char('e') => Some(Action::ShowEventsExpanded),
+            KeyCode::Char('m') => Some(Action::ShowStats),
+            KeyCode::Char('a') => Some(Action::ToggleAnalysis),
             KeyCode::Char('/') => Some(Action::ShowPropertySearch),
             KeyCode::Char('d') | KeyCode::Esc => Some(Action::Disconnect),
             _ => None,
@@ -218,4 +243,13 @@ impl EventHandler {
             _ => None,
         }
     }
+
+    fn map_stats_key(key: KeyEvent) -> Option<Action> {
+        match key.code {
+            KeyCode::Char('q') => Some(Action::Quit),
+            KeyCode::Char('?') => Some(Action::ShowHelp),
+            KeyCode::Esc => Some(Action::Back),
+            _ => None,
+        }
+    }
 }
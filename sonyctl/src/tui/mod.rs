@@ -1,5 +1,6 @@
 use std::io;
 use std::path::PathBuf;
+use std::time::{Duration, Instant};
 
 use anyhow::Result;
 use clap::Args as ClapArgs;
@@ -26,6 +27,12 @@ use event::EventHandler;
 
 use crate::Cli;
 
+/// Shortest time between two draws
+///
+/// Updates arriving faster than this are folded into the next frame, which
+/// keeps property storms from flooding slow (e.g. SSH) terminals.
+const FRAME_INTERVAL: Duration = Duration::from_millis(50);
+
 #[derive(ClapArgs)]
 pub struct Args {
     /// Log file path
@@ -72,6 +79,14 @@ fn restore_terminal() -> Result<()> {
 pub async fn run(cli: &Cli, args: &Args) -> Result<()> {
     let _guard = setup_logging(args)?;
 
+    // Load the SDK's adapters while the terminal is set up; discovery and
+    // connecting wait for this instead of initializing again
+    tokio::spawn(async {
+        if let Err(e) = crsdk::init_sdk().await {
+            tracing::error!("SDK initialization failed: {}", e);
+        }
+    });
+
     let terminal = setup_terminal()?;
     let result = run_app(terminal, cli).await;
     restore_terminal()?;
@@ -116,12 +131,21 @@ async fn run_app(mut terminal: Terminal<CrosstermBackend<io::Stdout>>, cli: &Cli
         }
     }
 
-    loop {
-        app.poll_camera_updates();
+    let mut last_draw: Option<Instant> = None;
 
-        terminal.draw(|frame| ui::render(frame, &app))?;
+    loop {
+        let next_frame = last_draw.map(|at| at + FRAME_INTERVAL);
+        if app.needs_redraw() && next_frame.map_or(true, |at| at <= Instant::now()) {
+            terminal.draw(|frame| ui::render(frame, &app))?;
+            app.mark_drawn();
+            last_draw = Some(Instant::now());
+        }
 
-        if let Some(action) = events.next(&app).await {
+        // Wake up for the capped frame only when something is waiting to be drawn
+        let redraw_at = app
+            .needs_redraw()
+            .then(|| last_draw.map_or_else(Instant::now, |at| at + FRAME_INTERVAL));
+        if let Some(action) = events.next(&mut app, redraw_at).await {
             app.update(action).await;
         }
 
@@ -1,11 +1,13 @@
 use std::collections::HashMap;
+use std::sync::Arc;
 
 use crsdk::{
-    property_category, property_display_name, DevicePropertyCode, PropertyCategoryId, TypedValue,
+    property_category, property_display_name, DevicePropertyCode, DiscreteValues,
+    PropertyCategoryId, TypedValue,
 };
 
 /// How a property's values are constrained
-#[derive(Debug, Clone, Default)]
+#[derive(Debug, Clone, Default, PartialEq, Eq)]
 pub enum PropertyKind {
     /// Discrete list of allowed values
     #[default]
@@ -18,7 +20,10 @@ pub enum PropertyKind {
 pub struct Property {
     pub code: DevicePropertyCode,
     /// For discrete: formatted value strings. For range: may be empty or contain formatted current.
-    pub values: Vec<String>,
+    ///
+    /// Shared with the camera service's [`ChoiceCache`], so updates that keep
+    /// the same choices don't copy them.
+    pub values: Arc<[String]>,
     /// For discrete: index into values. For range: index in the range (0 = min).
     pub current_index: usize,
     pub writable: bool,
@@ -32,7 +37,7 @@ impl Property {
     pub fn new(code: DevicePropertyCode) -> Self {
         Self {
             code,
-            values: Vec::new(),
+            values: Arc::new([]),
             current_index: 0,
             writable: false,
             kind: PropertyKind::Discrete,
@@ -237,7 +242,7 @@ impl PropertyStore {
         code: DevicePropertyCode,
         current: &str,
         current_raw: u64,
-        available: Vec<String>,
+        available: Arc<[String]>,
         writable: bool,
         kind: PropertyKind,
     ) {
@@ -259,35 +264,42 @@ impl PropertyStore {
                     prop.current_index = ((raw_signed - min) / step) as usize;
                 }
                 // Store the formatted current value
-                prop.values = vec![current.to_string()];
+                prop.values = Arc::new([current.to_string()]);
             }
         }
 
         let is_new = !self.properties.contains_key(&code);
         self.properties.insert(code, prop);
 
-        if is_new && is_default_pinned(code) {
+        // A property that went away and came back keeps its pin
+        if is_new && is_default_pinned(code) && !self.is_pinned(code) {
             self.insert_pinned_sorted(code);
         }
     }
 
+    /// Apply a value reported by the camera, returning whether anything shown changed
     pub fn update_property(
         &mut self,
         code: DevicePropertyCode,
         current: &str,
         current_raw: u64,
-        available: Vec<String>,
+        available: Arc<[String]>,
         writable: bool,
         kind: PropertyKind,
-    ) {
+    ) -> bool {
         if let Some(prop) = self.properties.get_mut(&code) {
+            let before = (prop.current_index, prop.current_raw, prop.writable);
+            let mut changed = prop.kind != kind;
             prop.writable = writable;
-            prop.kind = kind.clone();
+            prop.kind = kind;
             prop.current_raw = current_raw;
 
             match &prop.kind {
                 PropertyKind::Discrete => {
-                    prop.values = available;
+                    if !Arc::ptr_eq(&prop.values, &available) && prop.values != available {
+                        prop.values = available;
+                        changed = true;
+                    }
                     prop.set_value(current);
                 }
                 PropertyKind::Range { min, step, .. } => {
@@ -297,13 +309,26 @@ impl PropertyStore {
                         prop.current_index = ((raw_signed - min) / step) as usize;
                     }
                     // Store the formatted current value
-                    prop.values = vec![current.to_string()];
+                    if prop.values.len() != 1 || prop.values[0] != current {
+                        prop.values = Arc::new([current.to_string()]);
+                        changed = true;
+                    }
                 }
             }
+
+            changed || before != (prop.current_index, prop.current_raw, prop.writable)
         } else {
             self.add_property(code, current, current_raw, available, writable, kind);
+            true
         }
     }
+
+    /// Forget a property the camera no longer exposes, returning whether it was shown
+    ///
+    /// Its pin is kept, so it shows up in place again if the camera brings it back.
+    pub fn remove_property(&mut self, code: DevicePropertyCode) -> bool {
+        self.properties.remove(&code).is_some()
+    }
 }
 
 impl Default for PropertyStore {
@@ -356,6 +381,45 @@ pub fn format_sdk_value(code: DevicePropertyCode, raw: u64) -> String {
     TypedValue::from_raw(code, raw).to_string()
 }
 
+/// Formatted choice lists, reused while a property's constraint is unchanged
+///
+/// Most refreshes after a `PropertyChanged` only move the current value, so
+/// each distinct list is formatted once and then handed out as a shared
+/// `Arc<[String]>`.
+#[derive(Debug, Default)]
+pub struct ChoiceCache {
+    lists: HashMap<DevicePropertyCode, (DiscreteValues, Arc<[String]>)>,
+}
+
+impl ChoiceCache {
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    /// Formatted strings for `values`, formatting them only if the list changed
+    pub fn choices(&mut self, code: DevicePropertyCode, values: &DiscreteValues) -> Arc<[String]> {
+        if let Some((cached, choices)) = self.lists.get(&code) {
+            if cached == values {
+                return choices.clone();
+            }
+        }
+
+        let choices: Arc<[String]> = values.iter().map(|&v| format_sdk_value(code, v)).collect();
+        self.lists.insert(code, (values.clone(), choices.clone()));
+        choices
+    }
+
+    /// Format a value, reusing its string from the cached choices if it's one
+    pub fn format(&self, code: DevicePropertyCode, raw: u64) -> String {
+        if let Some((values, choices)) = self.lists.get(&code) {
+            if let Some(index) = values.iter().position(|&v| v == raw) {
+                return choices[index].clone();
+            }
+        }
+        format_sdk_value(code, raw)
+    }
+}
+
 fn fuzzy_match_score(query: &str, name: &str) -> Option<i32> {
     if query.is_empty() {
         return Some(0);
@@ -471,7 +535,7 @@ mod tests {
             DevicePropertyCode::FNumber,
             "f/2.8",
             280, // raw value
-            vec!["f/1.4".into(), "f/2.8".into(), "f/4.0".into()],
+            vec!["f/1.4".into(), "f/2.8".into(), "f/4.0".into()].into(),
             true,
             PropertyKind::Discrete,
         );
@@ -489,7 +553,7 @@ mod tests {
             DevicePropertyCode::AFTransitionSpeed,
             "3",
             3,
-            vec!["3".into()],
+            vec!["3".into()].into(),
             true,
             PropertyKind::Range {
                 min: 1,
@@ -509,6 +573,50 @@ mod tests {
         assert!((progress - (2.0 / 6.0)).abs() < 0.01);
     }
 
+    #[test]
+    fn test_update_property_reports_changes() {
+        let mut store = PropertyStore::new();
+        let values = || -> Arc<[String]> { vec!["f/1.4".to_string(), "f/2.8".to_string()].into() };
+        let code = DevicePropertyCode::FNumber;
+
+        assert!(store.update_property(code, "f/1.4", 140, values(), true, PropertyKind::Discrete));
+        assert!(!store.update_property(code, "f/1.4", 140, values(), true, PropertyKind::Discrete));
+        assert!(store.update_property(code, "f/2.8", 280, values(), true, PropertyKind::Discrete));
+        assert!(store.update_property(code, "f/2.8", 280, values(), false, PropertyKind::Discrete));
+    }
+
+    #[test]
+    fn test_remove_property_keeps_pin() {
+        let mut store = PropertyStore::new();
+        let values = || -> Arc<[String]> { vec!["f/1.4".to_string(), "f/2.8".to_string()].into() };
+        let code = DevicePropertyCode::FNumber;
+
+        store.update_property(code, "f/1.4", 140, values(), true, PropertyKind::Discrete);
+        assert!(store.remove_property(code));
+        assert!(!store.remove_property(code));
+        assert!(store.get(code).is_none());
+        assert_eq!(store.pinned_ids(), [code]);
+
+        store.update_property(code, "f/2.8", 280, values(), true, PropertyKind::Discrete);
+        assert_eq!(store.pinned_ids(), [code]);
+    }
+
+    #[test]
+    fn test_choice_cache_reuses_unchanged_lists() {
+        let mut cache = ChoiceCache::new();
+        let code = DevicePropertyCode::IsoSensitivity;
+        let values: DiscreteValues = vec![100, 200, 400].into();
+
+        let first = cache.choices(code, &values);
+        let again = cache.choices(code, &vec![100, 200, 400].into());
+        assert!(Arc::ptr_eq(&first, &again));
+        assert_eq!(cache.format(code, 200), first[1]);
+
+        let changed = cache.choices(code, &vec![100, 200].into());
+        assert!(!Arc::ptr_eq(&first, &changed));
+        assert_eq!(changed.len(), 2);
+    }
+
     #[test]
     fn test_property_range_navigation() {
         let mut prop = Property::new(DevicePropertyCode::AFTransitionSpeed);
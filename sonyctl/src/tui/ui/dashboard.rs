@@ -4,6 +4,7 @@ use ratatui::{
     text::{Line, Span},
     widgets::{
         Block, Borders, List, ListItem, Paragraph, Scrollbar, ScrollbarOrientation, ScrollbarState,
+        Sparkline,
     },
     Frame,
 };
@@ -26,7 +27,9 @@ fn scroll_offset_for_selection(
     }
 }
 
-use crate::tui::app::{App, ConnectedCamera, DashboardState, EventsLogState, MediaSlotInfo};
+use crate::tui::app::{
+    AnalysisView, App, ConnectedCamera, DashboardState, EventsLogState, MediaSlotInfo,
+};
 use crate::tui::property::Property;
 use crsdk::{property_category, property_display_name, PropertyCategoryId};
 
@@ -63,8 +66,17 @@ fn render_panels(frame: &mut Frame, area: Rect, app: &App) {
     let columns =
         Layout::horizontal([Constraint::Percentage(50), Constraint::Percentage(50)]).split(area);
 
-    let left_panels =
-        Layout::vertical([Constraint::Length(8), Constraint::Min(8)]).split(columns[0]);
+    let analysis_height = if app.dashboard.analysis.is_some() {
+        8
+    } else {
+        0
+    };
+    let left_panels = Layout::vertical([
+        Constraint::Length(8),
+        Constraint::Length(analysis_height),
+        Constraint::Min(8),
+    ])
+    .split(columns[0]);
 
     let is_connected = app.connected_camera.is_some();
     let is_ready = app.properties.is_loaded();
@@ -75,7 +87,10 @@ fn render_panels(frame: &mut Frame, area: Rect, app: &App) {
         is_connected,
         is_ready,
     );
-    render_events_panel(frame, left_panels[1], &app.events_log);
+    if let Some(analysis) = &app.dashboard.analysis {
+        render_analysis_panel(frame, left_panels[1], analysis);
+    }
+    render_events_panel(frame, left_panels[2], &app.events_log);
     render_quick_settings_panel(frame, columns[1], app);
 }
 
@@ -454,6 +469,81 @@ fn render_property_line(
     }
 }
 
+/// Luma histogram, clipping and a sharpness history from live view analysis
+fn render_analysis_panel(frame: &mut Frame, area: Rect, view: &AnalysisView) {
+    let block = Block::default()
+        .title(Span::styled(
+            " Exposure ",
+            Style::default().fg(Color::Rgb(180, 180, 180)),
+        ))
+        .borders(Borders::ALL)
+        .border_style(Style::default().fg(Color::Rgb(60, 60, 60)));
+
+    let inner = block.inner(area);
+    frame.render_widget(block, area);
+
+    let rows = Layout::vertical([
+        Constraint::Length(3),
+        Constraint::Length(1),
+        Constraint::Length(2),
+    ])
+    .split(inner);
+
+    let analysis = &view.latest;
+    let histogram = analysis.luma.downsample(rows[0].width as usize);
+    frame.render_widget(
+        Sparkline::default()
+            .data(histogram.as_slice())
+            .style(Style::default().fg(Color::Rgb(180, 180, 180))),
+        rows[0],
+    );
+
+    let clipping = analysis.clipping();
+    let clip_style = |fraction: f32| {
+        if fraction >= 0.01 {
+            Style::default().fg(Color::Red)
+        } else {
+            Style::default().fg(Color::White)
+        }
+    };
+    let sharpness = analysis
+        .sharpness
+        .map_or_else(|| "--".to_string(), |score| format!("{:.0}", score));
+    let stats = Line::from(vec![
+        Span::styled("  Clip ▼ ", Style::default().fg(Color::DarkGray)),
+        Span::styled(
+            format!("{:.1}%", clipping.shadows * 100.0),
+            clip_style(clipping.shadows),
+        ),
+        Span::styled("  ▲ ", Style::default().fg(Color::DarkGray)),
+        Span::styled(
+            format!("{:.1}%", clipping.highlights * 100.0),
+            clip_style(clipping.highlights),
+        ),
+        Span::styled("  Sharpness ", Style::default().fg(Color::DarkGray)),
+        Span::styled(sharpness, Style::default().fg(Color::White)),
+        Span::styled(
+            if analysis.focus_frame.is_some() {
+                " (AF)"
+            } else {
+                " (centre)"
+            },
+            Style::default().fg(Color::DarkGray),
+        ),
+    ]);
+    frame.render_widget(Paragraph::new(stats), rows[1]);
+
+    // Newest samples on the right, as many as fit
+    let history: Vec<u64> = view.sharpness.iter().copied().collect();
+    let start = history.len().saturating_sub(rows[2].width as usize);
+    frame.render_widget(
+        Sparkline::default()
+            .data(&history[start..])
+            .style(Style::default().fg(Color::Cyan)),
+        rows[2],
+    );
+}
+
 fn render_events_panel(frame: &mut Frame, area: Rect, events: &EventsLogState) {
     let block = Block::default()
         .title(Span::styled(
@@ -517,6 +607,12 @@ fn render_shortcuts(frame: &mut Frame, area: Rect, state: &DashboardState) {
         Span::raw("  "),
         Span::styled(" p ", Style::default().fg(Color::Cyan)),
         Span::styled("Properties", Style::default().fg(Color::DarkGray)),
+        Span::raw("  "),
+        Span::styled(" m ", Style::default().fg(Color::Cyan)),
+        Span::styled("Stats", Style::default().fg(Color::DarkGray)),
+        Span::raw("  "),
+        Span::styled(" a ", Style::default().fg(Color::Cyan)),
+        Span::styled("Analysis", Style::default().fg(Color::DarkGray)),
     ];
 
     if state.is_recording {
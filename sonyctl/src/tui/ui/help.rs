@@ -27,6 +27,7 @@ pub fn render(frame: &mut Frame, screen: Screen) {
         Screen::Dashboard => dashboard_help(),
         Screen::PropertyEditor => property_editor_help(),
         Screen::EventsExpanded => events_help(),
+        Screen::Stats => stats_help(),
     };
 
     let paragraph = Paragraph::new(content);
@@ -75,6 +76,8 @@ fn dashboard_help() -> Vec<Line<'static>> {
         two_columns("Screens", "General"),
         two_col_shortcut("p", "Properties", "?", "Help"),
         two_col_shortcut("e", "Events log", "q", "Quit"),
+        two_col_shortcut("m", "Stats", "", ""),
+        two_col_shortcut("a", "Exposure analysis", "", ""),
         two_col_shortcut("d/Esc", "Disconnect", "", ""),
         Line::from(""),
         footer(),
@@ -121,6 +124,24 @@ fn events_help() -> Vec<Line<'static>> {
     ]
 }
 
+fn stats_help() -> Vec<Line<'static>> {
+    vec![
+        Line::from(""),
+        section("About"),
+        shortcut("", "SDK call and event latency,"),
+        shortcut("", "refreshed every second"),
+        Line::from(""),
+        section("Actions"),
+        shortcut("Esc", "Back to dashboard"),
+        Line::from(""),
+        section("General"),
+        shortcut("?", "Toggle help"),
+        shortcut("q", "Quit"),
+        Line::from(""),
+        footer(),
+    ]
+}
+
 fn section(text: &str) -> Line<'static> {
     Line::from(vec![
         Span::raw("  "),
@@ -5,17 +5,21 @@ mod header;
 mod help;
 mod modals;
 mod properties;
+mod stats;
 
 use ratatui::Frame;
 
 use super::app::{App, Screen};
 
+pub use properties::PropertyRowCache;
+
 pub fn render(frame: &mut Frame, app: &App) {
     match app.screen {
         Screen::Discovery => discovery::render(frame, &app.discovery),
         Screen::Dashboard => dashboard::render(frame, app, &app.connected_camera),
         Screen::PropertyEditor => properties::render(frame, app, &app.connected_camera),
         Screen::EventsExpanded => events::render(frame, app, &app.connected_camera),
+        Screen::Stats => stats::render(frame, app, &app.connected_camera),
     }
 
     if let Some(ref modal) = app.modal {
@@ -1,3 +1,5 @@
+use std::collections::HashMap;
+
 use ratatui::{
     layout::{Constraint, Layout, Rect},
     style::{Color, Modifier, Style},
@@ -9,7 +11,7 @@ use ratatui::{
     Frame,
 };
 
-use crate::tui::property::PropertyKind;
+use crate::tui::property::{Property, PropertyKind};
 
 fn scroll_offset_for_selection(
     selected: usize,
@@ -30,7 +32,7 @@ fn scroll_offset_for_selection(
 }
 
 use crate::tui::app::{App, ConnectedCamera, PropertyEditorFocus};
-use crsdk::{property_description, property_display_name};
+use crsdk::{property_description, property_display_name, DevicePropertyCode};
 
 use super::header::{self, HeaderState};
 
@@ -209,12 +211,101 @@ fn truncate_to_width(s: &str, max_width: usize) -> String {
     }
 }
 
-fn render_property_list(
-    frame: &mut Frame,
-    area: Rect,
-    app: &App,
-    properties: &[&crate::tui::property::Property],
-) {
+/// How a property row is drawn, apart from its value
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+struct RowState {
+    selected: bool,
+    focused: bool,
+    pinned: bool,
+    writable: bool,
+    name_width: usize,
+}
+
+#[derive(Debug)]
+struct CachedRow {
+    state: RowState,
+    value: String,
+    item: ListItem<'static>,
+}
+
+/// Property editor rows kept between draws
+///
+/// A row is rebuilt only when its value or [`RowState`] differs from the last
+/// draw, so a burst of property changes re-formats just the rows that changed.
+#[derive(Debug, Default)]
+pub struct PropertyRowCache {
+    rows: HashMap<DevicePropertyCode, CachedRow>,
+}
+
+impl PropertyRowCache {
+    fn row(&mut self, prop: &Property, state: RowState) -> ListItem<'static> {
+        if let Some(cached) = self.rows.get(&prop.code) {
+            if cached.state == state && cached.value == prop.current_value() {
+                return cached.item.clone();
+            }
+        }
+
+        let item = property_row(prop, state);
+        self.rows.insert(
+            prop.code,
+            CachedRow {
+                state,
+                value: prop.current_value().to_string(),
+                item: item.clone(),
+            },
+        );
+        item
+    }
+}
+
+fn property_row(prop: &Property, state: RowState) -> ListItem<'static> {
+    let highlighted = state.selected && state.focused;
+
+    let name_style = if !state.writable {
+        Style::default().fg(Color::Rgb(80, 80, 80))
+    } else if highlighted {
+        Style::default().fg(Color::Cyan)
+    } else if state.selected {
+        Style::default().fg(Color::White)
+    } else {
+        Style::default().fg(Color::DarkGray)
+    };
+
+    let value_style = if highlighted {
+        Style::default()
+            .fg(Color::Cyan)
+            .add_modifier(Modifier::BOLD)
+    } else if state.selected {
+        Style::default().fg(Color::White)
+    } else {
+        Style::default().fg(Color::DarkGray)
+    };
+
+    let prefix = if highlighted { "▸ " } else { "  " };
+
+    let pin_indicator = if state.pinned { "★ " } else { "  " };
+    let pin_style = if state.pinned {
+        Style::default().fg(Color::Yellow)
+    } else {
+        Style::default()
+    };
+
+    let lock_indicator = if !state.writable { "🔒" } else { "  " };
+    let lock_style = Style::default().fg(Color::Rgb(80, 80, 80));
+
+    ListItem::new(Line::from(vec![
+        Span::styled(prefix, name_style),
+        Span::styled(pin_indicator, pin_style),
+        Span::styled(
+            truncate_to_width(property_display_name(prop.code), state.name_width),
+            name_style,
+        ),
+        Span::styled(lock_indicator, lock_style),
+        Span::styled(prop.current_value().to_string(), value_style),
+    ]))
+}
+
+fn render_property_list(frame: &mut Frame, area: Rect, app: &App, properties: &[&Property]) {
     // Layout: prefix(2) + pin(2) + name + lock(2) + value
     // Leave ~20 chars for value display, cap name at 35
     let max_name_width = (area.width as usize).saturating_sub(26).min(35);
@@ -226,63 +317,26 @@ fn render_property_list(
         properties.len(),
     );
 
-    let items: Vec<ListItem> = properties
+    // Only the rows on screen, and of those only the changed ones, get rebuilt
+    let mut cache = app.property_rows.borrow_mut();
+    let visible_items: Vec<ListItem> = properties
         .iter()
         .enumerate()
+        .skip(scroll_offset)
+        .take(visible_height)
         .map(|(i, prop)| {
-            let is_selected = i == app.property_editor.property_index;
-            let is_pinned = app.properties.is_pinned(prop.code);
-
-            let name_style = if !prop.writable {
-                Style::default().fg(Color::Rgb(80, 80, 80))
-            } else if is_selected && props_focused {
-                Style::default().fg(Color::Cyan)
-            } else if is_selected {
-                Style::default().fg(Color::White)
-            } else {
-                Style::default().fg(Color::DarkGray)
-            };
-
-            let value_style = if is_selected && props_focused {
-                Style::default()
-                    .fg(Color::Cyan)
-                    .add_modifier(Modifier::BOLD)
-            } else if is_selected {
-                Style::default().fg(Color::White)
-            } else {
-                Style::default().fg(Color::DarkGray)
+            let state = RowState {
+                selected: i == app.property_editor.property_index,
+                focused: props_focused,
+                pinned: app.properties.is_pinned(prop.code),
+                writable: prop.writable,
+                name_width: max_name_width,
             };
-
-            let prefix = if is_selected && props_focused {
-                "▸ "
-            } else {
-                "  "
-            };
-
-            let pin_indicator = if is_pinned { "★ " } else { "  " };
-            let pin_style = if is_pinned {
-                Style::default().fg(Color::Yellow)
-            } else {
-                Style::default()
-            };
-
-            let lock_indicator = if !prop.writable { "🔒" } else { "  " };
-            let lock_style = Style::default().fg(Color::Rgb(80, 80, 80));
-
-            ListItem::new(Line::from(vec![
-                Span::styled(prefix, name_style),
-                Span::styled(pin_indicator, pin_style),
-                Span::styled(
-                    truncate_to_width(property_display_name(prop.code), max_name_width),
-                    name_style,
-                ),
-                Span::styled(lock_indicator, lock_style),
-                Span::styled(prop.current_value(), value_style),
-            ]))
+            cache.row(prop, state)
         })
         .collect();
+    drop(cache);
 
-    let visible_items: Vec<ListItem> = items.into_iter().skip(scroll_offset).collect();
     let list = List::new(visible_items);
     frame.render_widget(list, area);
 
@@ -294,12 +348,7 @@ fn render_property_list(
     }
 }
 
-fn render_value_list(
-    frame: &mut Frame,
-    area: Rect,
-    app: &App,
-    properties: &[&crate::tui::property::Property],
-) {
+fn render_value_list(frame: &mut Frame, area: Rect, app: &App, properties: &[&Property]) {
     let Some(prop) = properties.get(app.property_editor.property_index) else {
         return;
     };
@@ -398,7 +447,7 @@ fn render_value_list(
 fn render_range_slider(
     frame: &mut Frame,
     area: Rect,
-    prop: &crate::tui::property::Property,
+    prop: &Property,
     min: i64,
     max: i64,
     step: i64,
@@ -0,0 +1,184 @@
+use std::time::Duration;
+
+use ratatui::{
+    layout::{Constraint, Layout, Rect},
+    style::{Color, Modifier, Style},
+    text::{Line, Span},
+    widgets::{Block, Borders, Paragraph, Row, Table},
+    Frame,
+};
+
+use crate::tui::app::{App, ConnectedCamera};
+use crsdk::{EventKind, LatencySnapshot, MetricsSnapshot, SdkCall};
+
+use super::header::{self, HeaderState};
+
+pub fn render(frame: &mut Frame, app: &App, camera: &Option<ConnectedCamera>) {
+    let area = frame.area();
+
+    let layout = Layout::vertical([
+        Constraint::Length(1),
+        Constraint::Min(10),
+        Constraint::Length(1),
+    ])
+    .split(area);
+
+    let header_state = HeaderState {
+        camera,
+        exposure_mode: Some(app.properties.exposure_mode()),
+        is_recording: app.dashboard.is_recording,
+        recording_seconds: if app.dashboard.is_recording {
+            Some(app.dashboard.recording_seconds)
+        } else {
+            None
+        },
+        is_connecting: app.is_connecting,
+    };
+    header::render(frame, layout[0], &header_state);
+
+    match &app.metrics {
+        Some(metrics) => render_metrics(frame, layout[1], metrics),
+        None => {
+            let paragraph = Paragraph::new("\n  Waiting for metrics…")
+                .style(Style::default().fg(Color::DarkGray))
+                .block(panel_block(" Stats "));
+            frame.render_widget(paragraph, layout[1]);
+        }
+    }
+
+    render_shortcuts(frame, layout[2]);
+}
+
+fn render_metrics(frame: &mut Frame, area: Rect, metrics: &MetricsSnapshot) {
+    let rows = Layout::vertical([
+        Constraint::Length(SdkCall::ALL.len() as u16 + 3),
+        Constraint::Length(3),
+        Constraint::Min(5),
+    ])
+    .split(area);
+
+    let sdk_rows = SdkCall::ALL
+        .iter()
+        .map(|call| latency_row(call.name(), metrics.sdk_call(*call)));
+    render_latency_table(frame, rows[0], " SDK Calls ", sdk_rows);
+
+    render_queue_panel(frame, rows[1], metrics);
+
+    // Only kinds that actually arrived, so the table stays readable
+    let event_rows = EventKind::ALL
+        .iter()
+        .filter(|kind| !metrics.event(**kind).is_empty())
+        .map(|kind| latency_row(kind.name(), metrics.event(*kind)));
+    render_latency_table(
+        frame,
+        rows[2],
+        " Event Delivery (callback → recv) ",
+        event_rows,
+    );
+}
+
+fn render_queue_panel(frame: &mut Frame, area: Rect, metrics: &MetricsSnapshot) {
+    let queue = &metrics.queue;
+    let label = Style::default().fg(Color::DarkGray);
+    let value = Style::default().fg(Color::White);
+    let warn = if queue.dropped > 0 {
+        Style::default().fg(Color::Yellow)
+    } else {
+        value
+    };
+
+    let line = Line::from(vec![
+        Span::styled("  Queued ", label),
+        Span::styled(queue.queued.to_string(), value),
+        Span::styled("   Peak ", label),
+        Span::styled(queue.peak_queued.to_string(), value),
+        Span::styled("   Coalesced ", label),
+        Span::styled(queue.coalesced.to_string(), value),
+        Span::styled("   Dropped ", label),
+        Span::styled(queue.dropped.to_string(), warn),
+    ]);
+
+    frame.render_widget(
+        Paragraph::new(line).block(panel_block(" Event Queue ")),
+        area,
+    );
+}
+
+fn render_latency_table<'a>(
+    frame: &mut Frame,
+    area: Rect,
+    title: &'a str,
+    rows: impl Iterator<Item = Row<'a>>,
+) {
+    let header = Row::new(["Name", "Count", "Mean", "p50", "p99", "Max"]).style(
+        Style::default()
+            .fg(Color::White)
+            .add_modifier(Modifier::BOLD),
+    );
+
+    let table = Table::new(
+        rows,
+        [
+            Constraint::Min(26),
+            Constraint::Length(8),
+            Constraint::Length(10),
+            Constraint::Length(10),
+            Constraint::Length(10),
+            Constraint::Length(10),
+        ],
+    )
+    .header(header)
+    .block(panel_block(title));
+
+    frame.render_widget(table, area);
+}
+
+fn latency_row<'a>(name: &'a str, latency: &LatencySnapshot) -> Row<'a> {
+    let style = if latency.is_empty() {
+        Style::default().fg(Color::Rgb(80, 80, 80))
+    } else {
+        Style::default().fg(Color::DarkGray)
+    };
+
+    Row::new(vec![
+        name.to_string(),
+        latency.count.to_string(),
+        format_latency(latency.mean()),
+        format_latency(latency.percentile(0.5)),
+        format_latency(latency.percentile(0.99)),
+        format_latency(latency.max),
+    ])
+    .style(style)
+}
+
+fn format_latency(latency: Duration) -> String {
+    let micros = latency.as_micros();
+    if micros == 0 {
+        "—".to_string()
+    } else if micros < 1000 {
+        format!("{}µs", micros)
+    } else if micros < 1_000_000 {
+        format!("{:.1}ms", micros as f64 / 1000.0)
+    } else {
+        format!("{:.2}s", latency.as_secs_f64())
+    }
+}
+
+fn panel_block(title: &str) -> Block<'_> {
+    Block::default()
+        .title(title)
+        .borders(Borders::ALL)
+        .border_style(Style::default().fg(Color::Rgb(60, 60, 60)))
+}
+
+fn render_shortcuts(frame: &mut Frame, area: Rect) {
+    let shortcuts = Line::from(vec![
+        Span::styled(" Esc ", Style::default().fg(Color::Cyan)),
+        Span::styled("Back", Style::default().fg(Color::DarkGray)),
+        Span::raw("  "),
+        Span::styled(" ? ", Style::default().fg(Color::Cyan)),
+        Span::styled("Help", Style::default().fg(Color::DarkGray)),
+    ]);
+
+    frame.render_widget(Paragraph::new(shortcuts), area);
+}